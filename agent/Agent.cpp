@@ -0,0 +1,292 @@
+// In-process agent, loaded into a target with LD_PRELOAD=libEasyReverseAgent.so. On load it
+// creates the shared memory segment described in src/Engine/AgentProtocol.ixx and serves
+// reads, writes and value searches from a thread of its own, so the engine reaches the target's
+// memory without a system call per access.
+//
+// Accesses to unmapped or protected memory are caught with a SIGSEGV/SIGBUS handler that only
+// acts on the agent thread and hands every other fault to the handler installed before it.
+// Targets that install their own handler after the agent take faults away from it.
+
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+import std;
+import Engine.AgentProtocol;
+
+constexpr size_t PageSize = 4096;
+constexpr size_t FindChunkSize = 64 * 1024;
+
+// Spins spent yielding without work before the agent sleeps on the doorbell, enough for the
+// engine's next poll at kHz rates to find it awake.
+constexpr uint32_t IdleSpins = 20000;
+
+// How long a reply waits for room in the Replies ring. A client that has not made room by then
+// has given up on the rings, the command is dropped.
+constexpr auto ReplyTimeout = std::chrono::seconds(1);
+
+namespace {
+    // Volatile, the compiler sees no reader between the stores around a copy and would drop the
+    // first one as dead, and a fault would then take the target down.
+    thread_local sigjmp_buf *volatile t_FaultJump = nullptr;
+    struct sigaction g_PreviousSegv{};
+    struct sigaction g_PreviousBus{};
+
+    void OnFault(int signal, siginfo_t *info, void *context) {
+        if (t_FaultJump != nullptr) {
+            siglongjmp(*t_FaultJump, 1);
+        }
+        const struct sigaction &previous = signal == SIGSEGV ? g_PreviousSegv : g_PreviousBus;
+        if (previous.sa_flags & SA_SIGINFO) {
+            previous.sa_sigaction(signal, info, context);
+        } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(signal);
+        } else {
+            // Returning re-runs the faulting instruction, which now gets the default action.
+            sigaction(signal, &previous, nullptr);
+        }
+    }
+
+    void InstallFaultHandlers() {
+        struct sigaction action{};
+        action.sa_sigaction = OnFault;
+        // SA_NODEFER keeps the signal unblocked after the jump out of the handler, so
+        // sigsetjmp does not have to save the mask with a system call on every access.
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &g_PreviousSegv);
+        sigaction(SIGBUS, &action, &g_PreviousBus);
+    }
+
+    // memcpy that returns false instead of crashing when either side is not accessible.
+    bool GuardedCopy(void *destination, const void *source, size_t size) {
+        sigjmp_buf jump;
+        if (sigsetjmp(jump, 0) != 0) {
+            t_FaultJump = nullptr;
+            return false;
+        }
+        t_FaultJump = &jump;
+        std::memcpy(destination, source, size);
+        t_FaultJump = nullptr;
+        return true;
+    }
+
+    // Copies the accessible prefix of [address, address + size), like a partial remote read.
+    size_t CopyReadable(std::byte *destination, uint64_t address, size_t size) {
+        if (GuardedCopy(destination, reinterpret_cast<const void *>(address), size)) {
+            return size;
+        }
+        size_t copied = 0;
+        while (copied < size) {
+            size_t piece = std::min(size - copied, PageSize - (address + copied) % PageSize);
+            if (!GuardedCopy(destination + copied, reinterpret_cast<const void *>(address + copied), piece)) {
+                break;
+            }
+            copied += piece;
+        }
+        return copied;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+class Agent {
+public:
+    Agent() {
+        m_Name = GetAgentSegmentName(static_cast<uint32_t>(getpid()));
+        // A segment of an earlier process with the same pid may have been left behind.
+        shm_unlink(m_Name.c_str());
+        int fd = shm_open(m_Name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            return;
+        }
+        void *memory = MAP_FAILED;
+        if (ftruncate(fd, sizeof(AgentSegment)) == 0) {
+            memory = mmap(nullptr, sizeof(AgentSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(m_Name.c_str());
+            return;
+        }
+
+        InstallFaultHandlers();
+        m_Segment = new(memory) AgentSegment();
+        m_Segment->Version = AgentVersion;
+        m_Segment->ProcessId = static_cast<uint32_t>(getpid());
+        m_Segment->Magic.store(AgentMagic, std::memory_order_release);
+        m_Thread = std::jthread([this](std::stop_token stopToken) { Serve(stopToken); });
+    }
+
+    Agent(const Agent &) = delete;
+
+    Agent &operator=(const Agent &) = delete;
+
+    ~Agent() {
+        if (m_Segment == nullptr) {
+            return;
+        }
+        m_Thread.request_stop();
+        RingDoorbell(*m_Segment);
+        m_Thread.join();
+        m_Segment->Magic.store(0);
+        shm_unlink(m_Name.c_str());
+        munmap(m_Segment, sizeof(AgentSegment));
+    }
+
+private:
+    void Serve(const std::stop_token &stopToken) {
+        std::array<AgentSlot, 16> commands;
+        uint32_t idle = 0;
+        while (!stopToken.stop_requested()) {
+            size_t count = m_Segment->Commands.PopBulk(commands);
+            if (count == 0 && ++idle > IdleSpins) {
+                // The engine checks Sleeping after pushing, so either it sees the flag and rings,
+                // or the pop below sees its command.
+                uint32_t seen = m_Segment->Doorbell.load();
+                m_Segment->Sleeping.store(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                count = m_Segment->Commands.PopBulk(commands);
+                if (count == 0) {
+                    WaitForDoorbell(*m_Segment, seen, std::chrono::milliseconds(100));
+                }
+                m_Segment->Sleeping.store(0);
+            } else if (count == 0) {
+                std::this_thread::yield();
+            }
+
+            if (count != 0) {
+                idle = 0;
+            }
+            for (size_t i = 0; i < count; i++) {
+                Execute(commands[i], stopToken);
+            }
+        }
+    }
+
+    // Whether the client that sent a command with this generation still owns the rings.
+    bool IsCurrent(uint32_t generation) const {
+        return m_Segment->ClientId.load() != 0 && m_Segment->Generation.load() == generation;
+    }
+
+    void Execute(const AgentSlot &command, const std::stop_token &stopToken) {
+        if (!IsCurrent(command.Generation)) {
+            return;
+        }
+        AgentSlot reply{};
+        reply.Kind = static_cast<uint32_t>(AgentReply::Done);
+        reply.Address = command.Address;
+        reply.Generation = command.Generation;
+        size_t size = std::min<size_t>(command.Size, AgentPayloadSize);
+        switch (static_cast<AgentCommand>(command.Kind)) {
+            case AgentCommand::Read:
+                reply.Size = static_cast<uint16_t>(CopyReadable(reply.Payload.data(), command.Address, size));
+                break;
+            case AgentCommand::Write:
+                reply.Length = GuardedCopy(reinterpret_cast<void *>(command.Address), command.Payload.data(), size)
+                                   ? size
+                                   : 0;
+                break;
+            case AgentCommand::Find: {
+                std::optional<uint64_t> found = Find(command, stopToken);
+                if (!found) {
+                    return;
+                }
+                reply.Length = *found;
+                break;
+            }
+        }
+        Reply(reply, stopToken);
+    }
+
+    // Copies the range chunk by chunk and compares the copy, a fault then only costs the rest
+    // of its page. Hits go out in More replies as they fill up, and at least every
+    // AgentProgressInterval, empty if need be. Returns their count, nullopt if the command was
+    // dropped because its client went away or stopped reading replies.
+    std::optional<uint64_t> Find(const AgentSlot &command, const std::stop_token &stopToken) {
+        auto value = std::span(command.Payload).first(std::min<size_t>(command.Size, AgentPayloadSize));
+        uint64_t alignment = std::max<uint64_t>(command.Alignment, 1);
+        uint64_t end = command.Address + command.Length;
+        if (value.empty() || end < command.Address) {
+            return 0;
+        }
+
+        std::vector<std::byte> chunk(FindChunkSize + value.size() - 1);
+        AgentSlot hits{};
+        hits.Kind = static_cast<uint32_t>(AgentReply::More);
+        hits.Generation = command.Generation;
+        uint64_t found = 0;
+        auto lastReply = std::chrono::steady_clock::now();
+        auto send = [&] {
+            bool sent = Reply(hits, stopToken);
+            hits.Size = 0;
+            lastReply = std::chrono::steady_clock::now();
+            return sent;
+        };
+
+        for (uint64_t at = AlignUp(command.Address, alignment); at < end;) {
+            if (stopToken.stop_requested() || !IsCurrent(command.Generation)) {
+                return std::nullopt;
+            }
+            size_t wanted = static_cast<size_t>(std::min<uint64_t>(chunk.size(), end - at));
+            size_t copied = CopyReadable(chunk.data(), at, wanted);
+            for (size_t offset = 0; offset + value.size() <= copied; offset += alignment) {
+                if (std::memcmp(chunk.data() + offset, value.data(), value.size()) != 0) {
+                    continue;
+                }
+                uint64_t address = at + offset;
+                std::memcpy(hits.Payload.data() + hits.Size, &address, sizeof(address));
+                hits.Size = static_cast<uint16_t>(hits.Size + sizeof(address));
+                found++;
+                if (hits.Size + sizeof(address) > AgentPayloadSize && !send()) {
+                    return std::nullopt;
+                }
+            }
+            if (std::chrono::steady_clock::now() - lastReply >= AgentProgressInterval && !send()) {
+                return std::nullopt;
+            }
+            // Continue after the chunk, or past the page that faulted.
+            uint64_t next = at + FindChunkSize;
+            if (copied < std::min(wanted, FindChunkSize)) {
+                next = (at + copied) / PageSize * PageSize + PageSize;
+            }
+            at = AlignUp(next, alignment);
+        }
+        if (hits.Size != 0 && !send()) {
+            return std::nullopt;
+        }
+        return found;
+    }
+
+    // Waits for room in the Replies ring while the reply's client still owns the rings and is
+    // alive, at most ReplyTimeout. Returns false if the reply was dropped.
+    bool Reply(const AgentSlot &reply, const std::stop_token &stopToken) {
+        auto deadline = std::chrono::steady_clock::now() + ReplyTimeout;
+        for (uint32_t spins = 0; IsCurrent(reply.Generation); spins++) {
+            if (m_Segment->Replies.TryPush(reply)) {
+                return true;
+            }
+            if (stopToken.stop_requested() || std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            // A client killed while it owned the rings never resets ClientId.
+            uint32_t owner = m_Segment->ClientId.load();
+            if (spins % 1024 == 1023 && kill(static_cast<pid_t>(owner), 0) != 0) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    std::string m_Name;
+    AgentSegment *m_Segment = nullptr;
+    std::jthread m_Thread;
+};
+
+// Constructed when the library is loaded, before the target's main runs.
+static Agent g_Agent;
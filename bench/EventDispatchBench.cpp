@@ -0,0 +1,156 @@
+// Compares the cost of dispatching and formatting events through the polymorphic Event
+// hierarchy against the CompactEvent variant with its compile-time handler table.
+// Prints one "benchmark,ns_per_event" line per case.
+
+import std;
+import Event.AllEvents;
+import Events.Compact;
+
+constexpr size_t EventCount = 1 << 16;
+constexpr size_t Iterations = 64;
+
+// Mirrors how layers handle events today: virtual OnEvent plus an EventDispatcher chain.
+class IEventLayer {
+public:
+    virtual ~IEventLayer() = default;
+
+    virtual bool OnEvent(Event &event) = 0;
+};
+
+class VirtualLayer : public IEventLayer {
+public:
+    bool OnEvent(Event &event) override {
+        EventDispatcher dispatcher(event);
+        dispatcher.Dispatch<MouseMovedEvent>([this](MouseMovedEvent &e) {
+            m_Sum += e.GetX() + e.GetY();
+            return false;
+        });
+        dispatcher.Dispatch<KeyPressedEvent>([this](KeyPressedEvent &e) {
+            m_Sum += static_cast<float>(e.GetKeyCode());
+            return true;
+        });
+        dispatcher.Dispatch<MouseButtonPressedEvent>([this](MouseButtonPressedEvent &e) {
+            m_Sum += static_cast<float>(e.GetMouseButton());
+            return true;
+        });
+        return event.Handled;
+    }
+
+    float m_Sum = 0.0f;
+};
+
+struct CompactHandler {
+    bool operator()(const EventData::MouseMoved &e) {
+        Sum += e.X + e.Y;
+        return false;
+    }
+
+    bool operator()(const EventData::KeyPressed &e) {
+        Sum += static_cast<float>(e.KeyCode);
+        return true;
+    }
+
+    bool operator()(const EventData::MouseButtonPressed &e) {
+        Sum += static_cast<float>(e.Button);
+        return true;
+    }
+
+    float Sum = 0.0f;
+};
+
+// Mostly mouse moves, like a real input stream.
+std::vector<CompactEvent> MakeEventStream() {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> kind(0, 99);
+    std::vector<CompactEvent> events;
+    events.reserve(EventCount);
+    for (size_t i = 0; i < EventCount; i++) {
+        int k = kind(random);
+        if (k < 80) {
+            events.emplace_back(EventData::MouseMoved{static_cast<float>(i % 1920), static_cast<float>(i % 1080)});
+        } else if (k < 90) {
+            events.emplace_back(EventData::KeyPressed{static_cast<Key::KeyCode>(32 + i % 64), false});
+        } else if (k < 95) {
+            events.emplace_back(EventData::MouseButtonPressed{static_cast<Mouse::MouseCode>(i % 3)});
+        } else {
+            events.emplace_back(EventData::MouseScrolled{0.0f, 1.0f});
+        }
+    }
+    return events;
+}
+
+std::unique_ptr<Event> ToPolymorphic(const CompactEvent &event) {
+    return std::visit([]<typename T>(const T &e) -> std::unique_ptr<Event> {
+        if constexpr (std::same_as<T, EventData::MouseMoved>) {
+            return std::make_unique<MouseMovedEvent>(e.X, e.Y);
+        } else if constexpr (std::same_as<T, EventData::KeyPressed>) {
+            return std::make_unique<KeyPressedEvent>(e.KeyCode, e.IsRepeat);
+        } else if constexpr (std::same_as<T, EventData::MouseButtonPressed>) {
+            return std::make_unique<MouseButtonPressedEvent>(e.Button);
+        } else if constexpr (std::same_as<T, EventData::MouseScrolled>) {
+            return std::make_unique<MouseScrolledEvent>(e.XOffset, e.YOffset);
+        } else {
+            return std::make_unique<WindowCloseEvent>();
+        }
+    }, event);
+}
+
+template<typename F>
+double MeasureNsPerEvent(F &&body) {
+    body(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < Iterations; i++) {
+        body();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / static_cast<double>(Iterations * EventCount);
+}
+
+int main() {
+    auto compactEvents = MakeEventStream();
+    std::vector<std::unique_ptr<Event>> events;
+    events.reserve(compactEvents.size());
+    for (const auto &event: compactEvents) {
+        events.push_back(ToPolymorphic(event));
+    }
+
+    std::unique_ptr<IEventLayer> layer = std::make_unique<VirtualLayer>();
+    double virtualDispatch = MeasureNsPerEvent([&] {
+        for (auto &event: events) {
+            event->Handled = false;
+            layer->OnEvent(*event);
+        }
+    });
+
+    CompactHandler handler;
+    double staticDispatch = MeasureNsPerEvent([&] {
+        for (const auto &event: compactEvents) {
+            StaticEventDispatcher<CompactHandler>::Dispatch(handler, event);
+        }
+    });
+
+    size_t formattedBytes = 0;
+    double virtualFormat = MeasureNsPerEvent([&] {
+        for (const auto &event: events) {
+            formattedBytes += event->ToString().size();
+        }
+    });
+
+    std::array<char, 128> buffer;
+    double compactFormat = MeasureNsPerEvent([&] {
+        for (const auto &event: compactEvents) {
+            formattedBytes += FormatTo(buffer, event).size();
+        }
+    });
+
+    std::cout << "benchmark,ns_per_event\n";
+    std::cout << std::format("event_dispatch_virtual,{:.3f}\n", virtualDispatch);
+    std::cout << std::format("event_dispatch_static,{:.3f}\n", staticDispatch);
+    std::cout << std::format("event_format_to_string,{:.3f}\n", virtualFormat);
+    std::cout << std::format("event_format_to_buffer,{:.3f}\n", compactFormat);
+
+    // Keep the results observable so the loops are not optimized away.
+    std::cerr << std::format("checksum {} {} {}\n",
+                             static_cast<VirtualLayer &>(*layer).m_Sum, handler.Sum, formattedBytes);
+    return 0;
+}
@@ -0,0 +1,391 @@
+// Runs the engine's scanners against a SyntheticTarget child process and prints one CSV line
+// per case: benchmark,seconds,bytes,operations,gb_per_s,ops_per_s
+//
+//     ScanBench [--agent <libEasyReverseAgent.so>] <path to SyntheticTarget> [arguments passed on to it]
+//
+// With --agent the target runs with the agent preloaded, and the small read and watch cases
+// run once over system calls and once over the agent's rings.
+
+#ifndef _WIN32
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+import std;
+import Engine.AgentMemory;
+import Engine.ProcessMemory;
+import Engine.PointerScan;
+import Engine.Scanner;
+import Engine.Session;
+import Engine.Targets;
+import WorkerPool;
+
+#ifdef _WIN32
+import <windows.h>;
+#endif
+
+// Child process with its stdout read up to the ready line and its stdin kept open, closing
+// stdin tells it to exit.
+class Victim {
+public:
+    Victim(const std::filesystem::path &executable, std::span<char *> arguments, const std::string &preload) {
+#ifdef _WIN32
+        SECURITY_ATTRIBUTES attributes{sizeof(attributes), nullptr, TRUE};
+        HANDLE childStdin = nullptr;
+        HANDLE childStdout = nullptr;
+        CreatePipe(&childStdin, &m_Stdin, &attributes, 0);
+        CreatePipe(&m_Stdout, &childStdout, &attributes, 0);
+        SetHandleInformation(m_Stdin, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(m_Stdout, HANDLE_FLAG_INHERIT, 0);
+
+        std::wstring commandLine = L"\"" + executable.wstring() + L"\"";
+        for (char *argument: arguments) {
+            std::string_view text = argument;
+            commandLine += L" " + std::wstring(text.begin(), text.end());
+        }
+
+        STARTUPINFOW startup{};
+        startup.cb = sizeof(startup);
+        startup.dwFlags = STARTF_USESTDHANDLES;
+        startup.hStdInput = childStdin;
+        startup.hStdOutput = childStdout;
+        startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+        PROCESS_INFORMATION info{};
+        if (!CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup,
+                            &info)) {
+            throw std::runtime_error("cannot start " + executable.string());
+        }
+        CloseHandle(childStdin);
+        CloseHandle(childStdout);
+        CloseHandle(info.hThread);
+        m_Process = info.hProcess;
+        m_ProcessId = info.dwProcessId;
+#else
+        int toChild[2];
+        int fromChild[2];
+        if (pipe(toChild) != 0 || pipe(fromChild) != 0) {
+            throw std::runtime_error("cannot create pipes");
+        }
+        std::string path = executable.string();
+        std::vector<char *> argv{path.data()};
+        argv.insert(argv.end(), arguments.begin(), arguments.end());
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (!preload.empty()) {
+                setenv("LD_PRELOAD", preload.c_str(), 1);
+            }
+            dup2(toChild[0], 0);
+            dup2(fromChild[1], 1);
+            close(toChild[1]);
+            close(fromChild[0]);
+            execv(path.c_str(), argv.data());
+            _exit(127);
+        }
+        close(toChild[0]);
+        close(fromChild[1]);
+        if (pid < 0) {
+            throw std::runtime_error("cannot start " + path);
+        }
+        m_Stdin = toChild[1];
+        m_Stdout = fromChild[0];
+        m_ProcessId = static_cast<uint32_t>(pid);
+#endif
+    }
+
+    Victim(const Victim &) = delete;
+
+    Victim &operator=(const Victim &) = delete;
+
+    ~Victim() {
+#ifdef _WIN32
+        CloseHandle(m_Stdin);
+        WaitForSingleObject(m_Process, INFINITE);
+        CloseHandle(m_Process);
+        CloseHandle(m_Stdout);
+#else
+        close(m_Stdin);
+        waitpid(static_cast<pid_t>(m_ProcessId), nullptr, 0);
+        close(m_Stdout);
+#endif
+    }
+
+    [[nodiscard]] uint32_t GetProcessId() const { return m_ProcessId; }
+
+    // Blocks until the child printed a full line.
+    std::string ReadLine() {
+        std::string line;
+        char c;
+        while (ReadByte(c) && c != '\n') {
+            line += c;
+        }
+        return line;
+    }
+
+private:
+    bool ReadByte(char &c) {
+#ifdef _WIN32
+        DWORD read = 0;
+        return ReadFile(m_Stdout, &c, 1, &read, nullptr) && read == 1;
+#else
+        return read(m_Stdout, &c, 1) == 1;
+#endif
+    }
+
+#ifdef _WIN32
+    HANDLE m_Stdin = nullptr;
+    HANDLE m_Stdout = nullptr;
+    HANDLE m_Process = nullptr;
+#else
+    int m_Stdin = -1;
+    int m_Stdout = -1;
+#endif
+    uint32_t m_ProcessId = 0;
+};
+
+// key=value pairs of the ready line, numbers in decimal or 0x hex.
+static std::unordered_map<std::string, uint64_t> ParseLayout(std::string_view line) {
+    std::unordered_map<std::string, uint64_t> layout;
+    for (auto part: std::views::split(line, ' ')) {
+        std::string_view token(part.begin(), part.end());
+        auto equals = token.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        std::string_view value = token.substr(equals + 1);
+        int base = value.starts_with("0x") ? 16 : 10;
+        if (base == 16) {
+            value.remove_prefix(2);
+        }
+        uint64_t number = 0;
+        std::from_chars(value.data(), value.data() + value.size(), number, base);
+        layout[std::string(token.substr(0, equals))] = number;
+    }
+    return layout;
+}
+
+static void Report(std::string_view name, double seconds, uint64_t bytes, uint64_t operations) {
+    std::println("{},{:.6f},{},{},{:.3f},{:.1f}", name, seconds, bytes, operations,
+                 static_cast<double>(bytes) / seconds / 1e9, static_cast<double>(operations) / seconds);
+}
+
+template<typename F>
+static double Time(F &&func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::shared_ptr<const ScanResults> Wait(const std::shared_ptr<ScanJob> &job) {
+    while (!job->IsDone()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return job->GetResults();
+}
+
+// Single small reads, then the same reads handed over as one batch per round.
+static void BenchSmallReads(std::string_view suffix, const MemorySource &source, const ScanResults &counters) {
+    constexpr size_t Rounds = 1000;
+    uint64_t value = 0;
+    uint64_t bytes = 0;
+    double seconds = Time([&] {
+        for (size_t round = 0; round < Rounds; round++) {
+            for (const auto &record: counters) {
+                bytes += source.Read(record.Address, std::as_writable_bytes(std::span(&value, 1)).first(4));
+            }
+        }
+    });
+    Report(std::format("read_4b_{}", suffix), seconds, bytes, Rounds * counters.size());
+
+    std::vector<uint32_t> values(counters.size());
+    std::vector<BatchRead> reads;
+    for (size_t i = 0; i < counters.size(); i++) {
+        reads.push_back({counters[i].Address, std::as_writable_bytes(std::span(&values[i], 1))});
+    }
+    bytes = 0;
+    seconds = Time([&] {
+        for (size_t round = 0; round < Rounds; round++) {
+            source.ReadBatch(reads);
+            for (const auto &read: reads) {
+                bytes += read.Copied;
+            }
+        }
+    });
+    Report(std::format("read_batch_{}", suffix), seconds, bytes, Rounds * counters.size());
+}
+
+static void BenchWatchPoll(WorkerPool &pool, std::string_view suffix, std::shared_ptr<MemorySource> source,
+                           const ScanResults &counters) {
+    TargetSet targets(pool);
+    auto target = targets.Add(std::move(source), "synthetic");
+    for (const auto &record: counters) {
+        target->AddWatch(record.Address, ScanValueType::Int32, {});
+    }
+    constexpr size_t PollCount = 1000;
+    double seconds = Time([&] {
+        for (size_t i = 0; i < PollCount; i++) {
+            target->PollWatches();
+        }
+    });
+    Report(std::format("watch_poll_{}", suffix), seconds, PollCount * counters.size() * sizeof(uint32_t),
+           PollCount * counters.size());
+}
+
+int main(int argc, char **argv) {
+    std::string agentLibrary;
+    if (argc >= 3 && std::string_view(argv[1]) == "--agent") {
+        agentLibrary = std::filesystem::absolute(argv[2]).string();
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc < 2) {
+        std::println(std::cerr, "usage: ScanBench [--agent <agent library>] <SyntheticTarget> [target arguments]");
+        return 1;
+    }
+
+    Victim victim(argv[1], std::span(argv + 2, static_cast<size_t>(argc - 2)), agentLibrary);
+    auto layout = ParseLayout(victim.ReadLine());
+    auto process = ProcessMemory::Open(victim.GetProcessId());
+    if (!process || !layout.contains("marker")) {
+        std::println(std::cerr, "cannot attach to the synthetic target");
+        return 1;
+    }
+
+    std::vector<MemoryRegion> regions = process->QueryRegions();
+    uint64_t regionBytes = 0;
+    for (const auto &region: regions) {
+        regionBytes += region.Size;
+    }
+
+    WorkerPool pool;
+    WorkerPool::QueueId queue = pool.AddQueue(WorkClass::Bulk);
+
+    std::println("benchmark,seconds,bytes,operations,gb_per_s,ops_per_s");
+
+    // First scan: every readable byte of the process.
+    ScanRequest markerRequest{
+        .Type = ScanValueType::Int32,
+        .Compare = ScanCompare::Exact,
+        .Value = static_cast<uint32_t>(layout["marker"]),
+    };
+    std::shared_ptr<const ScanResults> markers;
+    double seconds = Time([&] {
+        markers = Wait(ScanJob::StartFirst(pool, queue, process, regions, markerRequest));
+    });
+    Report("first_scan", seconds, regionBytes, markers->size());
+    if (markers->size() < layout["heap_bytes"] / layout["marker_stride"]) {
+        std::println(std::cerr, "first_scan found {} markers, expected at least {}", markers->size(),
+                     layout["heap_bytes"] / layout["marker_stride"]);
+    }
+
+    // Next scan: revisit every marker, all of them stay unchanged.
+    std::shared_ptr<const ScanResults> unchanged;
+    seconds = Time([&] {
+        unchanged = Wait(ScanJob::StartNext(pool, queue, process, markers,
+                                            {.Type = ScanValueType::Int32, .Compare = ScanCompare::Unchanged}));
+    });
+    Report("next_scan", seconds, markers->size() * sizeof(int32_t), markers->size());
+
+    // Next scan over the mutating counters, they all drop out.
+    ScanResults counterResults;
+    for (uint64_t i = 0; i < layout["counter_count"]; i++) {
+        uint64_t address = layout["counters"] + i * sizeof(uint32_t);
+        counterResults.push_back({address, process->ReadValue<uint32_t>(address).value_or(0)});
+    }
+    auto counters = std::make_shared<const ScanResults>(std::move(counterResults));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::shared_ptr<const ScanResults> changed;
+    seconds = Time([&] {
+        changed = Wait(ScanJob::StartNext(pool, queue, process, counters,
+                                          {.Type = ScanValueType::Int32, .Compare = ScanCompare::Changed}));
+    });
+    Report("next_scan_changed", seconds, counters->size() * sizeof(uint32_t), counters->size());
+
+    // AOB scan.
+    auto pattern = ParsePattern("DE AD BE EF ?? 42 7A");
+    std::shared_ptr<const ScanResults> patternHits;
+    seconds = Time([&] {
+        patternHits = Wait(ScanJob::StartPattern(pool, queue, process, regions, *pattern));
+    });
+    Report("pattern_scan", seconds, regionBytes, patternHits->size());
+
+    // The same first and pattern scans at each read depth, 0 reads a chunk whole before
+    // comparing it.
+    const size_t defaultDepth = GetScanReadDepth();
+    for (size_t depth: {0, 1, 2, 4, 8, 15}) {
+        SetScanReadDepth(depth);
+        std::shared_ptr<const ScanResults> found;
+        seconds = Time([&] { found = Wait(ScanJob::StartFirst(pool, queue, process, regions, markerRequest)); });
+        Report(std::format("first_scan_depth_{}", depth), seconds, regionBytes, found->size());
+        seconds = Time([&] { found = Wait(ScanJob::StartPattern(pool, queue, process, regions, *pattern)); });
+        Report(std::format("pattern_scan_depth_{}", depth), seconds, regionBytes, found->size());
+    }
+    SetScanReadDepth(defaultDepth);
+
+    // Pointer scan: build the map, then walk back from the chain target.
+    std::vector<PointerMapRecord> pointerMap;
+    seconds = Time([&] { pointerMap = BuildPointerMap(*process, regions); });
+    Report("pointer_map", seconds, regionBytes, pointerMap.size());
+
+    std::vector<MemoryRegion> roots;
+    for (const auto &region: regions) {
+        if (layout["chain_root"] - region.Base < region.Size) {
+            roots.push_back(region);
+        }
+    }
+    std::vector<PointerPath> paths;
+    seconds = Time([&] {
+        paths = FindPointerPaths(pointerMap, roots, layout["chain_target"], {.MaxDepth = 4, .MaxOffset = 0x100});
+    });
+    Report("pointer_paths", seconds, pointerMap.size() * sizeof(PointerMapRecord), paths.size());
+
+    // Batched reads: random pages out of the heap sized regions.
+    std::vector<MemoryRegion> large;
+    std::ranges::copy_if(regions, std::back_inserter(large), [&](const MemoryRegion &region) {
+        return region.Size >= layout["block_bytes"];
+    });
+    for (uint64_t readSize: {uint64_t{4096}, uint64_t{64 * 1024}}) {
+        constexpr size_t ReadCount = 16384;
+        std::mt19937_64 random(1);
+        std::vector<std::byte> buffer(readSize);
+        uint64_t bytes = 0;
+        seconds = Time([&] {
+            for (size_t i = 0; i < ReadCount && !large.empty(); i++) {
+                const auto &region = large[random() % large.size()];
+                uint64_t offset = random() % (region.Size / readSize) * readSize;
+                bytes += process->Read(region.Base + offset, buffer);
+            }
+        });
+        Report(std::format("read_{}k", readSize / 1024), seconds, bytes, ReadCount);
+    }
+
+    // Small reads and watch list polling over the counters, over system calls and the agent.
+    BenchSmallReads("syscall", *process, *counters);
+    BenchWatchPoll(pool, "syscall", process, *counters);
+
+    if (!agentLibrary.empty()) {
+        auto agent = AgentMemory::Connect(victim.GetProcessId());
+        if (!agent) {
+            std::println(std::cerr, "the synthetic target runs no agent");
+            return 1;
+        }
+        BenchSmallReads("agent", *agent, *counters);
+        BenchWatchPoll(pool, "agent", agent, *counters);
+
+        // Marker search done inside the target, only the hits cross over.
+        int32_t marker = static_cast<int32_t>(layout["marker"]);
+        size_t hits = 0;
+        seconds = Time([&] {
+            for (const auto &region: regions) {
+                auto found = agent->Find(region.Base, region.Size, std::as_bytes(std::span(&marker, 1)),
+                                         sizeof(marker));
+                hits += found.size();
+            }
+        });
+        Report("find_agent", seconds, regionBytes, hits);
+    }
+
+    return 0;
+}
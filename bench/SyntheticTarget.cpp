@@ -0,0 +1,129 @@
+// Victim process for ScanBench. Allocates a heap of pseudo random data with known values at
+// known places, keeps a set of counters mutating at a fixed rate and holds a pointer chain
+// rooted in a global. Prints one "ready key=value ..." line describing the layout, then runs
+// until its stdin is closed.
+//
+//     SyntheticTarget [--heap-mb N] [--block-mb N] [--counters N] [--mutate-hz N] [--seed N]
+
+import std;
+
+// Planted as int32 at the start of every MarkerStride bytes of the heap.
+constexpr int32_t MarkerValue = 0x1337C0DE;
+constexpr size_t MarkerStride = 64 * 1024;
+
+// Planted at PatternOffset into every PatternStride bytes, ScanBench searches "DE AD BE EF ?? 42 7A".
+constexpr std::array<uint8_t, 7> PatternBytes{0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x42, 0x7A};
+constexpr size_t PatternStride = 1024 * 1024;
+constexpr size_t PatternOffset = 100;
+
+struct ChainNode {
+    std::array<uint8_t, 0x40> Padding{};
+    ChainNode *Next = nullptr;
+    int32_t Value = 0;
+};
+
+constexpr size_t ChainDepth = 3;
+
+// Lives in the data section, the base every pointer path should end at.
+ChainNode *g_ChainRoot = nullptr;
+
+struct Options {
+    size_t HeapMegabytes = 1024;
+    size_t BlockMegabytes = 64;
+    size_t CounterCount = 1024;
+    double MutateHz = 1000.0;
+    uint64_t Seed = 1;
+};
+
+static Options ParseOptions(std::span<char *> args) {
+    Options options;
+    for (size_t i = 1; i + 1 < args.size(); i += 2) {
+        std::string_view name = args[i];
+        std::string_view value = args[i + 1];
+        auto parse = [&](auto &target) {
+            std::from_chars(value.data(), value.data() + value.size(), target);
+        };
+        if (name == "--heap-mb") {
+            parse(options.HeapMegabytes);
+        } else if (name == "--block-mb") {
+            parse(options.BlockMegabytes);
+        } else if (name == "--counters") {
+            parse(options.CounterCount);
+        } else if (name == "--mutate-hz") {
+            parse(options.MutateHz);
+        } else if (name == "--seed") {
+            parse(options.Seed);
+        }
+    }
+    options.BlockMegabytes = std::max<size_t>(options.BlockMegabytes, 1);
+    return options;
+}
+
+static void FillBlock(std::span<uint64_t> words, uint64_t &state) {
+    // xorshift64, the heap only has to look like data, not be good randomness.
+    for (auto &word: words) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        word = state;
+    }
+
+    auto bytes = std::as_writable_bytes(words);
+    for (size_t offset = 0; offset + sizeof(MarkerValue) <= bytes.size(); offset += MarkerStride) {
+        std::memcpy(bytes.data() + offset, &MarkerValue, sizeof(MarkerValue));
+    }
+    for (size_t offset = PatternOffset; offset + PatternBytes.size() <= bytes.size(); offset += PatternStride) {
+        std::memcpy(bytes.data() + offset, PatternBytes.data(), PatternBytes.size());
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options = ParseOptions(std::span(argv, static_cast<size_t>(argc)));
+
+    const size_t blockWords = options.BlockMegabytes * 1024 * 1024 / sizeof(uint64_t);
+    const size_t blockCount = (options.HeapMegabytes + options.BlockMegabytes - 1) / options.BlockMegabytes;
+    std::vector<std::unique_ptr<uint64_t[]>> blocks;
+    uint64_t state = options.Seed | 1;
+    for (size_t i = 0; i < blockCount; i++) {
+        blocks.push_back(std::make_unique_for_overwrite<uint64_t[]>(blockWords));
+        FillBlock(std::span(blocks.back().get(), blockWords), state);
+    }
+
+    std::vector<std::unique_ptr<ChainNode>> chain;
+    for (size_t i = 0; i < ChainDepth; i++) {
+        chain.push_back(std::make_unique<ChainNode>());
+    }
+    for (size_t i = 0; i + 1 < ChainDepth; i++) {
+        chain[i]->Next = chain[i + 1].get();
+    }
+    chain.back()->Value = MarkerValue;
+    g_ChainRoot = chain.front().get();
+
+    // Separate allocation so a scan for unchanged values sees every counter drop out.
+    auto counters = std::make_unique<std::atomic<uint32_t>[]>(options.CounterCount);
+    std::jthread mutator([&](std::stop_token stop) {
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(options.MutateHz, 1.0)));
+        auto next = std::chrono::steady_clock::now();
+        while (!stop.stop_requested()) {
+            for (size_t i = 0; i < options.CounterCount; i++) {
+                counters[i].fetch_add(1, std::memory_order_relaxed);
+            }
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    std::println(std::cout, "ready heap_bytes={} block_bytes={} marker={} marker_stride={} pattern_stride={} "
+                 "chain_root=0x{:X} chain_target=0x{:X} counters=0x{:X} counter_count={}",
+                 blockCount * blockWords * sizeof(uint64_t), blockWords * sizeof(uint64_t), MarkerValue,
+                 MarkerStride, PatternStride, reinterpret_cast<uintptr_t>(&g_ChainRoot),
+                 reinterpret_cast<uintptr_t>(&chain.back()->Value), reinterpret_cast<uintptr_t>(counters.get()),
+                 options.CounterCount);
+    std::cout.flush();
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+    }
+    return 0;
+}
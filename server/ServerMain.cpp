@@ -0,0 +1,38 @@
+// Scan server: attaches to processes and runs scans for a UI connected over a local socket.
+// Run it with the privileges needed to read the targets, the UI does not need them. Only the
+// user given with --user may connect, by default whoever started the server, also through sudo.
+//
+//     EasyReverseServer [--socket <path>] [--user <uid allowed to connect>]
+
+import std;
+import Engine.IpcChannel;
+import Engine.ScanServer;
+
+int main(int argc, char **argv) {
+    std::filesystem::path socketPath = "/tmp/easy-reverse.sock";
+    uint32_t user = GetInvokingUser();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view name = argv[i];
+        std::string_view value = argv[i + 1];
+        if (name == "--socket") {
+            socketPath = value;
+        } else if (name == "--user") {
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), user);
+            if (error != std::errc{} || end != value.data() + value.size()) {
+                std::println(std::cerr, "invalid user id {}", value);
+                return 1;
+            }
+        }
+    }
+
+    auto listener = IpcListener::Listen(socketPath, user);
+    if (!listener) {
+        std::println(std::cerr, "cannot listen on {}", socketPath.string());
+        return 1;
+    }
+    std::println(std::cerr, "listening on {} for user {}", socketPath.string(), user);
+
+    ScanServer server(std::move(*listener));
+    server.Run();
+    return 0;
+}
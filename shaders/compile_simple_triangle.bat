@@ -1,2 +1,5 @@
 glslc simple_triangle.vert -o simple_triangle.vert.spv
-glslc simple_triangle.frag -o simple_triangle.frag.spv
\ No newline at end of file
+glslc simple_triangle.frag -o simple_triangle.frag.spv
+glslc memory_heatmap.comp -o memory_heatmap.comp.spv
+glslc line_plot.vert -o line_plot.vert.spv
+glslc line_plot.frag -o line_plot.frag.spv
\ No newline at end of file
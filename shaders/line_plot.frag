@@ -0,0 +1,11 @@
+#version 450
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform Params {
+    vec4 color;
+} params;
+
+void main() {
+    outColor = params.color;
+}
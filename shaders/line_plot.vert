@@ -0,0 +1,8 @@
+#version 450
+
+// Points arrive in normalized device coordinates, the CPU already scaled them to the plot.
+layout(location = 0) in vec2 inPosition;
+
+void main() {
+    gl_Position = vec4(inPosition, 0.0, 1.0);
+}
@@ -21,63 +21,53 @@ void ImGuiImageRenderTarget::Rebuild() {
     CreateRenderPass();
     CreateGraphicsPipeline();
     CreateFramebuffer();
-    CreateSyncObjects();
-    CreateCommandBuffer();
     CreateDescriptorSetLayout();
 }
 
 void ImGuiImageRenderTarget::Flush() {
     if (m_NeedsRebuild) {
-        m_Ctx->GetLogicalDevice().waitIdle();
-        ImGui_ImplVulkan_RemoveTexture(m_SetHandler);
+        RetireResources();
         Rebuild();
         m_NeedsRebuild = false;
     }
-    auto waitResult = m_Ctx->GetLogicalDevice().waitForFences(*m_RenderFinishedFence, vk::True, std::numeric_limits<uint64_t>::max());
-    if (waitResult != vk::Result::eSuccess) {
-        throw std::runtime_error("Failed to wait for fence");
-    }
-    m_Ctx->GetLogicalDevice().resetFences(*m_RenderFinishedFence);
-    m_CommandBuffer.reset();
-
-    RecordCommandBuffer();
-
-    vk::CommandBuffer commandBuffers[] = {*m_CommandBuffer};
-
-    vk::SubmitInfo submitInfo{
-        .sType = vk::StructureType::eSubmitInfo,
-        .pNext = nullptr,
-        .waitSemaphoreCount = 0,
-        .pWaitSemaphores = nullptr,
-        .pWaitDstStageMask = nullptr,
-        .commandBufferCount = 1,
-        .pCommandBuffers = commandBuffers,
-        .signalSemaphoreCount = 0,
-        .pSignalSemaphores = nullptr
-    };
-
-    m_Ctx->GetGraphicsQueue().submit(submitInfo, *m_RenderFinishedFence);
+    vk::CommandBuffer commandBuffer = m_Ctx->AllocateFrameCommandBuffer();
+    RecordCommandBuffer(commandBuffer);
+    m_RenderFinishedValue = m_Ctx->SubmitBeforeFrame(commandBuffer);
 }
 
-void ImGuiImageRenderTarget::FlushAndWait() {
-    Flush();
-    auto waitResult = m_Ctx->GetLogicalDevice().waitForFences(*m_RenderFinishedFence, vk::True, std::numeric_limits<uint64_t>::max());
-    if (waitResult != vk::Result::eSuccess) {
-        throw std::runtime_error("Failed to wait for fence");
-    }
+uint64_t ImGuiImageRenderTarget::GetRenderFinishedValue() const {
+    return m_RenderFinishedValue;
 }
 
-vk::Fence ImGuiImageRenderTarget::GetFence() const {
-    return *m_RenderFinishedFence;
+bool ImGuiImageRenderTarget::IsRenderFinished() const {
+    return m_Ctx->IsTimelineValueReached(m_RenderFinishedValue);
 }
 
 ImGuiImageRenderTarget::~ImGuiImageRenderTarget()  {
     if (m_Ctx) {
-        m_Ctx->GetLogicalDevice().waitIdle();
-        ImGui_ImplVulkan_RemoveTexture(m_SetHandler);
+        RetireResources();
     }
 }
 
+void ImGuiImageRenderTarget::RetireResources() {
+    auto &deletionQueue = m_Ctx->GetDeletionQueue();
+
+    if (m_TextureID) {
+        deletionQueue.Retire([texture = m_TextureID] {
+            RemoveImGuiTexture(texture);
+        });
+        m_TextureID = {};
+    }
+
+    deletionQueue.Retire(std::move(m_Framebuffer));
+    deletionQueue.Retire(std::move(m_GraphicsPipeline));
+    deletionQueue.Retire(std::move(m_PipelineLayout));
+    deletionQueue.Retire(std::move(m_RenderPass));
+    deletionQueue.Retire(std::move(m_ImageView));
+    deletionQueue.Retire(std::move(m_Image));
+    deletionQueue.Retire(std::move(m_ImageAllocation));
+}
+
 void ImGuiImageRenderTarget::CreateImageAndView() {
     vk::ImageCreateInfo imageInfo{
         .pNext = nullptr,
@@ -100,35 +90,10 @@ void ImGuiImageRenderTarget::CreateImageAndView() {
         .initialLayout = vk::ImageLayout::eUndefined // or any other initial layout you need
     };
 
-    m_Image = m_Ctx->GetLogicalDevice().createImage(imageInfo).value();
-    vk::DeviceImageMemoryRequirements deviceImageMemoryRequirements{
-        .sType = vk::StructureType::eDeviceImageMemoryRequirementsKHR,
-        .pNext = nullptr,
-        .pCreateInfo = &imageInfo,
-        .planeAspect = vk::ImageAspectFlagBits::eColor,
-    };
-
-    vk::MemoryRequirements memRequirements =
-        m_Ctx->GetLogicalDevice().getImageMemoryRequirements(deviceImageMemoryRequirements).memoryRequirements;
-
-    vk::MemoryAllocateInfo allocInfo{
-        .sType = vk::StructureType::eMemoryAllocateInfo,
-        .pNext = nullptr,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal)
-    };
-
-    m_ImageMemory = m_Ctx->GetLogicalDevice().allocateMemory(allocInfo).value();
-
-    vk::BindImageMemoryInfo bindInfo{
-        .sType = vk::StructureType::eBindImageMemoryInfo,
-        .pNext = nullptr,
-        .image = *m_Image,
-        .memory = *m_ImageMemory,
-        .memoryOffset = 0
-    };
-
-    m_Ctx->GetLogicalDevice().bindImageMemory2(bindInfo);
+    auto [image, allocation] = m_Ctx->GetMemoryAllocator().CreateImage(imageInfo,
+                                                                        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    m_Image = std::move(image);
+    m_ImageAllocation = std::move(allocation);
 
     vk::ImageViewCreateInfo viewInfo{
         .sType = vk::StructureType::eImageViewCreateInfo,
@@ -185,14 +150,28 @@ void ImGuiImageRenderTarget::CreateRenderPass() {
         .pPreserveAttachments = nullptr
     };
 
-    vk::SubpassDependency dependency{
-        .srcSubpass = vk::SubpassExternal, // No previous subpass
-        .dstSubpass = 0, // Our subpass
-        .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-        .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-        .srcAccessMask = {},
-        .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
-        .dependencyFlags = {}
+    // Submitted in the same batch as the frames sampling the image, the external dependencies
+    // order our writes against those reads on both sides.
+    vk::SubpassDependency dependencies[] = {
+        {
+            .srcSubpass = vk::SubpassExternal, // Previous frames sampling the image
+            .dstSubpass = 0, // Our subpass
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                            vk::PipelineStageFlagBits::eFragmentShader,
+            .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dependencyFlags = {}
+        },
+        {
+            .srcSubpass = 0,
+            .dstSubpass = vk::SubpassExternal, // The swap chain pass sampling the image
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStageMask = vk::PipelineStageFlagBits::eFragmentShader,
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+            .dependencyFlags = {}
+        }
     };
 
     vk::RenderPassCreateInfo renderPassInfo{
@@ -202,8 +181,8 @@ void ImGuiImageRenderTarget::CreateRenderPass() {
         .pAttachments = &colorAttachment,
         .subpassCount = 1,
         .pSubpasses = &subpass,
-        .dependencyCount = 1,
-        .pDependencies = &dependency
+        .dependencyCount = 2,
+        .pDependencies = dependencies
     };
 
     m_RenderPass = m_Ctx->GetLogicalDevice().createRenderPass(renderPassInfo).value();
@@ -396,59 +375,19 @@ void ImGuiImageRenderTarget::CreateFramebuffer() {
     m_Framebuffer = m_Ctx->GetLogicalDevice().createFramebuffer(framebufferInfo).value();
 }
 
-void ImGuiImageRenderTarget::CreateSyncObjects() {
-    vk::FenceCreateInfo fenceInfo{
-        .sType = vk::StructureType::eFenceCreateInfo,
-        .pNext = nullptr,
-        .flags = vk::FenceCreateFlagBits::eSignaled // Start in signaled state
-    };
-
-    m_RenderFinishedFence = m_Ctx->GetLogicalDevice().createFence(fenceInfo).value();
-}
-
-void ImGuiImageRenderTarget::CreateCommandBuffer() {
-    vk::CommandBufferAllocateInfo allocInfo{
-        .sType = vk::StructureType::eCommandBufferAllocateInfo,
-        .pNext = nullptr,
-        .commandPool = *m_Ctx->GetCommandPool(),
-        .level = vk::CommandBufferLevel::ePrimary,
-        .commandBufferCount = 1
-    };
-
-    m_CommandBuffer = std::move(m_Ctx->GetLogicalDevice().allocateCommandBuffers(allocInfo).value().front());
-}
-
 void ImGuiImageRenderTarget::CreateDescriptorSetLayout() {
-    m_ImageDescriptorSet = ImGui_ImplVulkan_AddTexture(
-        *m_Ctx->GetSampler(),
-        *m_ImageView,
-        static_cast<VkImageLayout>(vk::ImageLayout::eShaderReadOnlyOptimal)
-    );
-
-    m_SetHandler = m_ImageDescriptorSet;
+    m_TextureID = AddImGuiTexture(*m_Ctx->GetSampler(), *m_ImageView);
 }
 
-uint32_t ImGuiImageRenderTarget::FindMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) {
-    vk::PhysicalDeviceMemoryProperties memProperties = m_Ctx->GetPhysicalDevice().getMemoryProperties();
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("failed to find suitable memory type!");
-}
-
-void ImGuiImageRenderTarget::RecordCommandBuffer() {
+void ImGuiImageRenderTarget::RecordCommandBuffer(vk::CommandBuffer commandBuffer) {
     // start recording commands
     vk::CommandBufferBeginInfo beginInfo{
         .pNext = nullptr,
-        .flags = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
         .pInheritanceInfo = nullptr // No inheritance for primary command buffers
     };
 
-    m_CommandBuffer.begin(beginInfo);
+    commandBuffer.begin(beginInfo);
 
     vk::RenderPassBeginInfo renderPassInfo{
         .pNext = nullptr,
@@ -465,8 +404,8 @@ void ImGuiImageRenderTarget::RecordCommandBuffer() {
         .pClearValues = &m_ClearColor
     };
 
-    m_CommandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-    m_CommandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_GraphicsPipeline);
+    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_GraphicsPipeline);
 
     vk::Viewport viewport = {
         .x = 0.0f,
@@ -485,13 +424,13 @@ void ImGuiImageRenderTarget::RecordCommandBuffer() {
         }
     };
 
-    m_CommandBuffer.setViewport(0, viewport);
-    m_CommandBuffer.setScissor(0, scissor);
-    m_CommandBuffer.draw(3, 1, 0, 0); // Draw a triangle (3 vertices)
+    commandBuffer.setViewport(0, viewport);
+    commandBuffer.setScissor(0, scissor);
+    commandBuffer.draw(3, 1, 0, 0); // Draw a triangle (3 vertices)
 
-    m_CommandBuffer.endRenderPass();
+    commandBuffer.endRenderPass();
 
-    m_CommandBuffer.end();
+    commandBuffer.end();
 }
 
 VKAPI_ATTR vk::Bool32 VKAPI_CALL DebugCallback(
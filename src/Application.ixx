@@ -9,6 +9,7 @@ import ImGui;
 
 import BasicContext;
 import Event.AllEvents;
+import Events.Compact;
 
 
 class ImGuiImageRenderTarget {
@@ -18,11 +19,14 @@ public:
 public:
     void Rebuild();
 
+    // Records the offscreen pass into a frame command buffer, it is submitted together with the frame.
+    // Never waits for the GPU, use IsRenderFinished to check for completion.
     void Flush();
 
-    void FlushAndWait();
+    // Graphics timeline value signalled once the last flushed pass finished rendering.
+    uint64_t GetRenderFinishedValue() const;
 
-    vk::Fence GetFence() const;
+    bool IsRenderFinished() const;
 
     vk::ClearValue m_ClearColor{
         vk::ClearColorValue(std::array<float, 4>{1.0f, 1.0f, 1.0f, 1.0f})
@@ -31,6 +35,9 @@ public:
     ~ImGuiImageRenderTarget();
 
 private:
+    // Hands every GPU object to the context's deletion queue, frames in flight may still use them.
+    void RetireResources();
+
     void CreateImageAndView();
 
     void CreateRenderPass();
@@ -39,37 +46,30 @@ private:
 
     void CreateFramebuffer();
 
-    void CreateSyncObjects();
-
-    void CreateCommandBuffer();
-
     void CreateDescriptorSetLayout();
 
-    uint32_t FindMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
-
-    void RecordCommandBuffer();
+    void RecordCommandBuffer(vk::CommandBuffer commandBuffer);
 
     IBasicContext *m_Ctx{nullptr};
 
 public:
     vk::raii::Image m_Image{nullptr};
-    vk::raii::DeviceMemory m_ImageMemory{nullptr};
+    GpuAllocation m_ImageAllocation;
     vk::raii::ImageView m_ImageView{nullptr};
     vk::raii::Pipeline m_GraphicsPipeline{nullptr};
     vk::raii::PipelineLayout m_PipelineLayout{nullptr};
     vk::raii::RenderPass m_RenderPass{nullptr};
     vk::raii::Framebuffer m_Framebuffer{nullptr};
-    vk::raii::Fence m_RenderFinishedFence{nullptr};
-    vk::raii::CommandBuffer m_CommandBuffer{nullptr};
 
-    vk::DescriptorSet m_ImageDescriptorSet{nullptr};
-    VkDescriptorSet m_SetHandler;
+    ImTextureID m_TextureID{};
 
     vk::Rect2D m_RenderArea{
         .offset = vk::Offset2D{0, 0},
         .extent = vk::Extent2D{960, 640} // Set your desired width and height
     };
 
+    uint64_t m_RenderFinishedValue = 0;
+
     bool m_NeedsRebuild = false;
 };
 
@@ -92,7 +92,7 @@ public:
 
         m_RenderTarget->Flush();
 
-        ImTextureID id = reinterpret_cast<ImTextureID>(m_RenderTarget->m_SetHandler);
+        ImTextureID id = m_RenderTarget->m_TextureID;
         auto [width, height] = m_RenderTarget->m_RenderArea.extent;
 
 
@@ -106,13 +106,14 @@ public:
         }
     }
 
-    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer, std::vector<std::any> &dependentContexts) override {
-        dependentContexts.push_back(m_RenderTarget);
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {
+        // The render target is flushed in OnUpdate and retires its resources on destruction.
     }
 
     bool OnEvent(const Event *event) override {
         if (event->GetEventType() == EventType::KeyTyped) {
-            std::cout << event->ToString() << std::endl;
+            std::array<char, 64> buffer;
+            std::cout << FormatTo(buffer, ToCompactEvent(*event)) << '\n';
         }
         return true;
     }
@@ -177,7 +178,7 @@ public:
         RenderBackgroundSpace([]{});
     }
 
-    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer, std::vector<std::any> &dependentContexts) override {
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {
         // No specific command buffer submission for this layer
     }
 
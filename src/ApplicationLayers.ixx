@@ -5,6 +5,11 @@ import BasicContext;
 import Application;
 import vulkan_hpp;
 import Atomic;
+import Engine.AddressExpression;
+import Engine.ProcessMemory;
+import Engine.Session;
+import Engine.Targets;
+import Engine.ValueTypes;
 
 import <windows.h>;
 import "vendor/glfwpp/native.h";
@@ -64,21 +69,11 @@ std::string exec(const std::wstring &command) { // get the powershell command as
     return output_string;
 }
 
-void *StringToAddress(const std::string &addressString) {
-    uintptr_t address = 0;
-
-    try {
-        address = std::stoull(addressString, nullptr, 16); // base 16 for hex
-    } catch (...) {
-        return nullptr;
-    }
-
-    return reinterpret_cast<void *>(address);
-}
-
 export class AppUiLayer : public IUpdatableLayer {
 public:
-    AppUiLayer() : m_WindowTitle{"Easy Reverse Native###id_easy_reverse"} {
+    AppUiLayer(std::shared_ptr<TargetProcess> target, std::shared_ptr<TargetSet> targets)
+        : m_WindowTitle{"Easy Reverse Native###id_easy_reverse"}, m_Target(std::move(target)),
+          m_Targets(std::move(targets)) {
 
     }
 
@@ -136,8 +131,8 @@ public:
         {
             ImGui::Text("Data Type: ");
             ImGui::SameLine(300);
-            ImGui::Combo("##Data Type", &dataType.GetProxy().Get(),
-                         "Int\0Float\0Double\0Pointer\0", 4); // 4 is the number of items
+            ImGui::Combo("##Data Type", &dataType.GetProxy().Get(), ValueTypeNames.data(),
+                         static_cast<int>(ValueTypeNames.size()));
         }
 
         // Value
@@ -163,10 +158,28 @@ public:
             ImGui::Button("Write Value");
         }
 
+        // Session
+        {
+            ImGui::Text("Session: ");
+            ImGui::SameLine(300);
+            {
+                auto sessionPathProxy = m_SessionPath.GetProxy();
+                ImGui::InputText("##SessionPath", &sessionPathProxy.Get());
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save")) {
+                OnSaveSessionClicked();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Load")) {
+                OnLoadSessionClicked();
+            }
+        }
+
         ImGui::End();
     }
 
-    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer, std::vector<std::any> &dependentContexts) override {}
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
 
     bool OnEvent(const Event *event) override {
         return false;
@@ -231,6 +244,42 @@ public:
         // gameWindowHandle = target;
         gameProcessID = processID;
         gameHandle = gameKernelProcess;
+        m_Target->Set(ProcessMemory::Open(processID));
+        m_Targets->Attach(processID, resultTarget);
+    }
+
+    void OnSaveSessionClicked() {
+        SessionMetadata metadata{};
+        CopyToField(metadata.GameName, m_GameName.GetProxy().Get());
+        CopyToField(metadata.Address, m_Address.GetProxy().Get());
+        metadata.DataType = static_cast<uint32_t>(dataType.GetProxy().Get());
+        metadata.ProcessId = gameProcessID.GetProxy().Get();
+
+        SessionWriter writer(m_SessionPath.GetProxy().Get());
+        writer.AddSection(SessionSectionKind::Metadata, {}, std::span(&metadata, 1));
+        if (!writer.Finish()) {
+            std::cerr << "Failed to write session " << m_SessionPath.GetProxy().Get() << std::endl;
+        }
+    }
+
+    void OnLoadSessionClicked() {
+        auto session = SessionFile::Open(m_SessionPath.GetProxy().Get());
+        if (!session) {
+            std::cerr << "Failed to load session: " << session.error() << std::endl;
+            return;
+        }
+        if (auto verified = session->VerifyAll(); !verified) {
+            std::cerr << "Failed to load session: " << verified.error() << std::endl;
+            return;
+        }
+
+        auto metadata = session->Get<SessionMetadata>(SessionSectionKind::Metadata);
+        if (metadata.empty()) {
+            return;
+        }
+        m_GameName = std::string(FieldToString(metadata[0].GameName));
+        m_Address = std::string(FieldToString(metadata[0].Address));
+        dataType = static_cast<int>(metadata[0].DataType);
     }
 
     void OnReadClicked() {
@@ -242,37 +291,29 @@ public:
         // first get the address from the box:
         // QString readAddressString = ui->txtInputAddress->text(); // NOLINT
         // QString showValue;
-        uintptr_t targetAddress = reinterpret_cast<uintptr_t>(StringToAddress(m_Address.GetProxy().Get()));
-        auto targetReadingAddress = (LPCVOID) targetAddress; // NOLINT
-        int type = dataType.GetProxy().Get(); // get the data type from the box
+        // the address box takes expressions like [game.exe+1A2B30]+8
+        auto expression = AddressExpression::Compile(m_Address.GetProxy().Get());
+        if (!expression) {
+            m_Value = expression.error();
+            return;
+        }
+        auto resolved = m_Targets->GetResolver(m_Target->Get())->Resolve(*expression);
+        if (!resolved) {
+            m_Value = "address does not resolve";
+            return;
+        }
+        auto targetReadingAddress = reinterpret_cast<LPCVOID>(*resolved); // NOLINT
+        auto type = static_cast<ValueType>(dataType.GetProxy().Get()); // get the data type from the box
         HANDLE targetHandle = gameHandle.GetProxy().Get(); // get the handle from the global variable
-        switch (type) {
-            case 0: // this is int
-                ReadProcessMemory(targetHandle, targetReadingAddress, &readValueInt.GetProxy().Get(),
-                                  sizeof(int), nullptr);
-                m_Value = std::to_string(readValueInt.GetProxy().Get());
-                break;
-            case 1:
-                ReadProcessMemory(targetHandle, targetReadingAddress, &readValueFloat.GetProxy().Get(), sizeof(float),
-                                  NULL);
-                m_Value = std::to_string(readValueFloat.GetProxy().Get());
-                break;
-            case 2:
-                ReadProcessMemory(targetHandle, targetReadingAddress, &readValueDouble.GetProxy().Get(),
-                                  sizeof(double), NULL);
-                m_Value = std::to_string(readValueDouble.GetProxy().Get());
-                break;
-            case 3:
-                ReadProcessMemory(targetHandle, targetReadingAddress, &readValuePtr.GetProxy().Get(), sizeof(int),
-                                  NULL);
-                m_Value = std::format("0x{:X}", readValuePtr.GetProxy().Get()); // format as hex
-                break;
-            default:
-                ReadProcessMemory(targetHandle, targetReadingAddress, &readValueInt.GetProxy().Get(),
-                                  sizeof(int), NULL);
-                m_Value = std::to_string(readValueInt.GetProxy().Get());
-                break;
+        // strings show up to their first NUL within the buffer, byte arrays as its first 16 bytes
+        std::array<std::byte, 64> buffer{};
+        size_t size = IsScalarType(type) ? GetValueTypeSize(type) : type == ValueType::String ? buffer.size() : 16;
+        SIZE_T read = 0;
+        if (!ReadProcessMemory(targetHandle, targetReadingAddress, buffer.data(), size, &read) && read == 0) {
+            m_Value = "address is not readable";
+            return;
         }
+        m_Value = FormatValueBytes(std::span(buffer).first(read), type);
     }
 
 public:
@@ -280,6 +321,7 @@ public:
 
     Atomic<std::string> m_Address;
     Atomic<std::string> m_Value;
+    Atomic<std::string> m_SessionPath{std::string("session.ers")};
 
     // same id different title, use ## to map to same id
     Atomic<std::string> m_WindowTitle;
@@ -289,11 +331,10 @@ public:
     Atomic<DWORD> gameProcessID = 0;
     Atomic<HANDLE> gameHandle = nullptr;
 
-    Atomic<int> dataType = 0; // 0 for int, 1 for float, 2 for double, 3 for pointer
+    Atomic<int> dataType = 0; // a ValueType, the same numbers the session stores
 
-    // last read value as global variable
-    Atomic<int> readValueInt = 0;
-    Atomic<float> readValueFloat = 0.0;
-    Atomic<double> readValueDouble = 0.0;
-    Atomic<int> readValuePtr = 0; // this will be base 16
+    // shared with the memory panels
+    std::shared_ptr<TargetProcess> m_Target;
+    // every attached process, also the ones attached in the Targets panel
+    std::shared_ptr<TargetSet> m_Targets;
 };
@@ -4,7 +4,8 @@ import "vendor/glfwpp/native.h";
 import Event.AllEvents;
 
 BasicContextImpl::BasicContextImpl(const WindowSpec &windowSpec) : m_GlfwLibrary(glfw::init()),
-                                                                   m_Context(vk::raii::Context{}) {
+                                                                   m_Context(vk::raii::Context{}),
+                                                                   m_WorkerPool(std::make_unique<WorkerPool>()) {
     InitializeWindow(windowSpec);
     InitVulkan();
 }
@@ -17,109 +18,58 @@ void BasicContextImpl::InitializeWindow(const WindowSpec &windowSpec) {
 
     m_Window = glfw::Window{windowSpec.width, windowSpec.height, windowSpec.title.c_str()};
 
+    // Callbacks only queue events, they are dispatched once per frame by DispatchEvents.
     m_Window->framebufferSizeEvent.setCallback([this](glfw::Window &window, int width, int height) {
-        if (width > 0 && height > 0) {
-            m_ShouldUpdate = true;
-            RecreateSwapChain();
-        } else {
-            m_ShouldUpdate = false;
-        }
-
-        WindowResizeEvent event{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
-        for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-            if ((*reverseIt)->OnEvent(&event)) {
-                break;
-            }
-        }
+        m_EventQueue.Post(WindowResizeEvent{
+            static_cast<uint32_t>(std::max(width, 0)), static_cast<uint32_t>(std::max(height, 0))
+        });
     });
 
-
     m_Window->closeEvent.setCallback([this](glfw::Window &window) {
-        WindowCloseEvent event{};
-        for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-            if ((*reverseIt)->OnEvent(&event)) {
-                break;
-            }
-        }
+        m_EventQueue.Post(WindowCloseEvent{});
     });
 
     m_Window->keyEvent.setCallback([this](glfw::Window &window, glfw::KeyCode key, int scanCode,
                                           glfw::KeyState action, glfw::ModifierKeyBit mods) {
         switch (action) {
-            case glfw::KeyState::Press: {
-                KeyPressedEvent event{Key::KeyCode(key), false};
-                for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-                    if ((*reverseIt)->OnEvent(&event)) {
-                        break;
-                    }
-                }
+            case glfw::KeyState::Press:
+                m_EventQueue.Post(KeyPressedEvent{Key::KeyCode(key), false});
                 break;
-            }
-            case glfw::KeyState::Release: {
-                KeyReleasedEvent event{Key::KeyCode(key)};
-                for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-                    if ((*reverseIt)->OnEvent(&event)) {
-                        break;
-                    }
-                }
+            case glfw::KeyState::Release:
+                m_EventQueue.Post(KeyReleasedEvent{Key::KeyCode(key)});
                 break;
-            }
-            case glfw::KeyState::Repeat: {
-                KeyPressedEvent event{Key::KeyCode(key), true};
-                for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-                    if ((*reverseIt)->OnEvent(&event)) {
-                        break;
-                    }
-                }
+            case glfw::KeyState::Repeat:
+                m_EventQueue.Post(KeyPressedEvent{Key::KeyCode(key), true});
                 break;
-            }
             default:
                 std::cerr << "Unknown key action: " << static_cast<int>(action) << std::endl;
         }
     });
 
     m_Window->charEvent.setCallback([this](glfw::Window &window, unsigned int keyCode) {
-        KeyTypedEvent event{keyCode};
-        for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-            if ((*reverseIt)->OnEvent(&event)) {
-                break;
-            }
-        }
+        m_EventQueue.Post(KeyTypedEvent{keyCode});
     });
 
     m_Window->mouseButtonEvent.setCallback([this](glfw::Window &window, glfw::MouseButton button,
                                                     glfw::MouseButtonState action, glfw::ModifierKeyBit mods) {
         switch (action) {
-            case glfw::MouseButtonState::Press: {
-                MouseButtonPressedEvent event{static_cast<uint16_t>(button)};
-                for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-                    if ((*reverseIt)->OnEvent(&event)) {
-                        break;
-                    }
-                }
+            case glfw::MouseButtonState::Press:
+                m_EventQueue.Post(MouseButtonPressedEvent{static_cast<uint16_t>(button)});
                 break;
-            }
-            case glfw::MouseButtonState::Release: {
-                MouseButtonReleasedEvent event{static_cast<uint16_t>(button)};
-                for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-                    if ((*reverseIt)->OnEvent(&event)) {
-                        break;
-                    }
-                }
+            case glfw::MouseButtonState::Release:
+                m_EventQueue.Post(MouseButtonReleasedEvent{static_cast<uint16_t>(button)});
                 break;
-            }
             default:
                 std::cerr << "Unknown mouse button action: " << static_cast<int>(action) << std::endl;
         }
     });
 
     m_Window->cursorPosEvent.setCallback([this](glfw::Window &window, double xPos, double yPos) {
-        MouseMovedEvent event{static_cast<float>(xPos), static_cast<float>(yPos)};
-        for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-            if ((*reverseIt)->OnEvent(&event)) {
-                break;
-            }
-        }
+        m_EventQueue.Post(MouseMovedEvent{static_cast<float>(xPos), static_cast<float>(yPos)});
+    });
+
+    m_Window->scrollEvent.setCallback([this](glfw::Window &window, double xOffset, double yOffset) {
+        m_EventQueue.Post(MouseScrolledEvent{static_cast<float>(xOffset), static_cast<float>(yOffset)});
     });
 }
 
@@ -140,7 +90,7 @@ void BasicContextImpl::InitVulkan() {
 
     CreateCommandPool();
     CreateSyncObjects();
-    CreateCommandBuffer();
+    CreateFrameThreadResources();
 
     InitImGui();
 }
@@ -258,6 +208,7 @@ void BasicContextImpl::PickPhysicalDevice() {
             return;
         }
     }
+    throw std::runtime_error("no GPU supports everything the renderer needs, see the messages above");
 }
 
 void BasicContextImpl::CreateLogicalDevice() {
@@ -288,8 +239,18 @@ void BasicContextImpl::CreateLogicalDevice() {
 
     vk::PhysicalDeviceFeatures deviceFeatures{};
 
-    vk::DeviceCreateInfo deviceCreateInfo{
+    vk::PhysicalDeviceVulkan13Features vulkan13Features{
         .pNext = nullptr,
+        .synchronization2 = vk::True
+    };
+
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{
+        .pNext = &vulkan13Features,
+        .timelineSemaphore = vk::True
+    };
+
+    vk::DeviceCreateInfo deviceCreateInfo{
+        .pNext = &vulkan12Features,
         .flags = {},
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
         .pQueueCreateInfos = queueCreateInfos.data(),
@@ -303,6 +264,8 @@ void BasicContextImpl::CreateLogicalDevice() {
     m_Device = m_PhysicalDevice.createDevice(deviceCreateInfo).value();
     m_GraphicsQueue = m_Device.getQueue(queueFamilies.GraphicsFamily.value(), 0).value();
     m_PresentQueue = m_Device.getQueue(queueFamilies.PresentFamily.value(), 0).value();
+
+    m_MemoryAllocator = std::make_unique<GpuMemoryAllocator>(m_PhysicalDevice, m_Device);
 }
 
 void BasicContextImpl::CreateSurface() {
@@ -345,6 +308,8 @@ bool BasicContextImpl::IsDeviceSuitable(const vk::raii::PhysicalDevice &device)
 
     bool extensionSupported = CheckDeviceExtensionSupport(device);
 
+    bool featuresSupported = CheckDeviceFeatureSupport(device);
+
     bool swapChainAdequate = false;
 
     if (extensionSupported) {
@@ -352,7 +317,30 @@ bool BasicContextImpl::IsDeviceSuitable(const vk::raii::PhysicalDevice &device)
         swapChainAdequate = !swapChainSupport.Formats.empty() && !swapChainSupport.PresentModes.empty();
     }
 
-    return queueFamilies.IsComplete() && extensionSupported && swapChainAdequate;
+    return queueFamilies.IsComplete() && extensionSupported && featuresSupported && swapChainAdequate;
+}
+
+// Frames are submitted with submit2 and paced by timeline semaphores, CreateLogicalDevice
+// enables both features, so a device without them cannot be picked.
+bool BasicContextImpl::CheckDeviceFeatureSupport(const vk::raii::PhysicalDevice &device) const {
+    auto properties = device.getProperties();
+    if (properties.apiVersion < vk::ApiVersion13) {
+        std::cerr << properties.deviceName << ": Vulkan 1.3 is not supported!" << std::endl;
+        return false;
+    }
+
+    auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features,
+                                        vk::PhysicalDeviceVulkan13Features>();
+    bool supported = true;
+    if (!features.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore) {
+        std::cerr << properties.deviceName << ": missing feature: timelineSemaphore" << std::endl;
+        supported = false;
+    }
+    if (!features.get<vk::PhysicalDeviceVulkan13Features>().synchronization2) {
+        std::cerr << properties.deviceName << ": missing feature: synchronization2" << std::endl;
+        supported = false;
+    }
+    return supported;
 }
 
 bool BasicContextImpl::CheckDeviceExtensionSupport(vk::PhysicalDevice device) const {
@@ -625,6 +613,8 @@ void BasicContextImpl::InitImGui() {
 }
 
 void BasicContextImpl::BeginImGuiFrame() {
+    // Runs after the deletion queue released finished frames, so removed texture sets are reused before a new pool is created.
+    PrepareImGuiTextures();
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -725,19 +715,93 @@ void BasicContextImpl::CreateCommandPool() {
     m_CommandPool = m_Device.createCommandPool(poolInfo).value();
 }
 
-void BasicContextImpl::CreateCommandBuffer() {
-    vk::CommandBufferAllocateInfo allocInfo{
+void BasicContextImpl::CreateFrameThreadResources() {
+    auto queueFamilies = FindQueueFamilies(*m_PhysicalDevice);
+    vk::CommandPoolCreateInfo poolInfo{
         .pNext = nullptr,
-        .commandPool = *m_CommandPool,
-        .level = vk::CommandBufferLevel::ePrimary,
-        .commandBufferCount = 1
+        .flags = vk::CommandPoolCreateFlagBits::eTransient, // reset as a whole, never per buffer
+        .queueFamilyIndex = queueFamilies.GraphicsFamily.value()
     };
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_CommandBuffers.push_back(std::move(m_Device.allocateCommandBuffers(allocInfo).value().front()));
+    m_FrameThreadResources.resize(MAX_FRAMES_IN_FLIGHT);
+    for (auto &frameResources: m_FrameThreadResources) {
+        frameResources.resize(m_WorkerPool->GetThreadCount());
+        for (auto &threadResources: frameResources) {
+            threadResources.CommandPool = m_Device.createCommandPool(poolInfo).value();
+        }
+    }
+}
+
+vk::CommandBuffer FrameThreadResources::Acquire(const vk::raii::Device &device, vk::CommandBufferLevel level) {
+    bool isPrimary = level == vk::CommandBufferLevel::ePrimary;
+    auto &buffers = isPrimary ? PrimaryCommandBuffers : SecondaryCommandBuffers;
+    auto &used = isPrimary ? UsedPrimaryCommandBuffers : UsedSecondaryCommandBuffers;
+
+    if (used == buffers.size()) {
+        vk::CommandBufferAllocateInfo allocInfo{
+            .pNext = nullptr,
+            .commandPool = *CommandPool,
+            .level = level,
+            .commandBufferCount = 1
+        };
+        buffers.push_back(std::move(device.allocateCommandBuffers(allocInfo).value().front()));
+    }
+
+    return *buffers[used++];
+}
+
+void FrameThreadResources::Reset() {
+    CommandPool.reset({});
+    UsedPrimaryCommandBuffers = 0;
+    UsedSecondaryCommandBuffers = 0;
+}
+
+vk::CommandBuffer BasicContextImpl::AllocateFrameCommandBuffer() {
+    // Command pools are externally synchronized, so each thread records into pools of its own and
+    // only the UI thread and the pool's workers have any.
+    size_t threadIndex = m_WorkerPool->GetThreadIndex();
+    if (threadIndex == WorkerPool::ForeignThread) {
+        throw std::runtime_error("frame command buffers can only be allocated on the UI thread or a pool worker");
+    }
+    auto &threadResources = m_FrameThreadResources[m_CurrentFrame][threadIndex];
+    return threadResources.Acquire(m_Device, vk::CommandBufferLevel::ePrimary);
+}
+
+uint64_t BasicContextImpl::SubmitBeforeFrame(vk::CommandBuffer commandBuffer) {
+    std::lock_guard lock(m_PendingSubmitMutex);
+    m_PendingCommandBuffers.push_back({.commandBuffer = commandBuffer});
+    return GetFrameTimelineValue();
+}
+
+uint64_t BasicContextImpl::GetCompletedTimelineValue() {
+    if (m_CompletedTimelineValue < m_LastSubmittedTimelineValue) {
+        m_CompletedTimelineValue = m_GraphicsTimeline.getCounterValue();
+    }
+    return m_CompletedTimelineValue;
+}
+
+bool BasicContextImpl::WaitTimelineValue(uint64_t value) {
+    if (GetCompletedTimelineValue() >= value) {
+        return true;
+    }
+
+    vk::Semaphore semaphores[] = {*m_GraphicsTimeline};
+    vk::SemaphoreWaitInfo waitInfo{
+        .pNext = nullptr,
+        .flags = {},
+        .semaphoreCount = 1,
+        .pSemaphores = semaphores,
+        .pValues = &value
+    };
+
+    auto waitResult = m_Device.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+    if (waitResult != vk::Result::eSuccess) {
+        std::cerr << "Failed to wait for timeline: " << vk::to_string(waitResult) << std::endl;
+        return false;
     }
 
-    m_CommandBufferDependentContexts.resize(MAX_FRAMES_IN_FLIGHT);
+    m_CompletedTimelineValue = std::max(m_CompletedTimelineValue, value);
+    return true;
 }
 
 void BasicContextImpl::CreateSyncObjects() {
@@ -745,35 +809,45 @@ void BasicContextImpl::CreateSyncObjects() {
         .pNext = nullptr,
         .flags = {}
     };
-    vk::FenceCreateInfo fenceInfo{
-        .pNext = nullptr,
-        .flags = vk::FenceCreateFlagBits::eSignaled // Start with the fence signaled
-    };
-
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         m_ImageAvailableSemaphores.push_back(m_Device.createSemaphore(semaphoreInfo).value());
-        m_InFlightFences.push_back(m_Device.createFence(fenceInfo).value());
     }
 
-    // m_InFlightFence = m_Device.createFence(fenceInfo).value();
+    vk::SemaphoreTypeCreateInfo timelineTypeInfo{
+        .pNext = nullptr,
+        .semaphoreType = vk::SemaphoreType::eTimeline,
+        .initialValue = 0
+    };
+
+    vk::SemaphoreCreateInfo timelineInfo{
+        .pNext = &timelineTypeInfo,
+        .flags = {}
+    };
+
+    m_GraphicsTimeline = m_Device.createSemaphore(timelineInfo).value();
+
     for (size_t i = 0; i < m_SwapChainImages.size(); i++) {
         m_RenderFinishedSemaphores.push_back(m_Device.createSemaphore(semaphoreInfo).value());
     }
 }
 
 void BasicContextImpl::DrawFrame() {
+    // Wait for the slot before any layer records into its pools during OnUpdate. With
+    // MAX_FRAMES_IN_FLIGHT slots this is usually already reached and costs a counter read.
+    if (!WaitTimelineValue(m_FrameTimelineValues[m_CurrentFrame])) {
+        return;
+    }
+
+    for (auto &threadResources: m_FrameThreadResources[m_CurrentFrame]) {
+        threadResources.Reset();
+    }
+    m_PendingCommandBuffers.clear();
+    m_DeletionQueue.BeginFrame(m_CurrentFrame, GetFrameTimelineValue(), GetCompletedTimelineValue());
+
     BeginImGuiFrame();
     OnUpdate();
     ImGui::Render();
 
-    auto waitForFenceResult = m_Device.waitForFences(*m_InFlightFences[m_CurrentFrame], vk::True,
-                                                     std::numeric_limits<uint64_t>::max());
-
-    if (waitForFenceResult != vk::Result::eSuccess) {
-        std::cerr << "Failed to wait for fence: " << vk::to_string(waitForFenceResult) << std::endl;
-        return;
-    }
-
     auto [resultAcquireImage, imageIndex] = m_SwapChain.acquireNextImage(
         std::numeric_limits<uint64_t>::max(), m_ImageAvailableSemaphores[m_CurrentFrame], nullptr
     );
@@ -789,20 +863,103 @@ void BasicContextImpl::DrawFrame() {
         }
     }
 
-    m_Device.resetFences(*m_InFlightFences[m_CurrentFrame]);
+    vk::CommandBuffer frameCommandBuffer = AllocateFrameCommandBuffer();
+    RecordFrameCommandBuffer(frameCommandBuffer, imageIndex);
+
+    uint64_t frameTimelineValue = GetFrameTimelineValue();
+
+    // Offscreen targets flushed during OnUpdate do not touch the swap chain image, so they go in
+    // their own batch entry that does not wait for the acquire. Queue submission order makes the
+    // swap chain pass observe their writes through the render pass external dependencies.
+    m_SubmitCommandBuffers.clear();
+    m_SubmitCommandBuffers.swap(m_PendingCommandBuffers);
+
+    vk::SemaphoreSubmitInfo waitSemaphores[] = {
+        {
+            .semaphore = *m_ImageAvailableSemaphores[m_CurrentFrame],
+            .value = 0,
+            .stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+            .deviceIndex = 0
+        }
+    };
+
+    vk::SemaphoreSubmitInfo signalSemaphores[] = {
+        {
+            .semaphore = *m_RenderFinishedSemaphores[imageIndex],
+            .value = 0,
+            .stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+            .deviceIndex = 0
+        },
+        {
+            .semaphore = *m_GraphicsTimeline,
+            .value = frameTimelineValue,
+            .stageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .deviceIndex = 0
+        }
+    };
+
+    vk::CommandBufferSubmitInfo frameCommandBufferInfo{
+        .commandBuffer = frameCommandBuffer,
+        .deviceMask = 0
+    };
+
+    vk::SubmitInfo2 submitInfos[] = {
+        {
+            .flags = {},
+            .waitSemaphoreInfoCount = 0,
+            .pWaitSemaphoreInfos = nullptr,
+            .commandBufferInfoCount = static_cast<uint32_t>(m_SubmitCommandBuffers.size()),
+            .pCommandBufferInfos = m_SubmitCommandBuffers.data(),
+            .signalSemaphoreInfoCount = 0,
+            .pSignalSemaphoreInfos = nullptr
+        },
+        {
+            .flags = {},
+            .waitSemaphoreInfoCount = 1,
+            .pWaitSemaphoreInfos = waitSemaphores,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &frameCommandBufferInfo,
+            .signalSemaphoreInfoCount = 2,
+            .pSignalSemaphoreInfos = signalSemaphores
+        }
+    };
+
+    uint32_t firstSubmitInfo = m_SubmitCommandBuffers.empty() ? 1 : 0;
+    m_GraphicsQueue.submit2(vk::ArrayProxy<const vk::SubmitInfo2>(2 - firstSubmitInfo, submitInfos + firstSubmitInfo));
+
+    m_LastSubmittedTimelineValue = frameTimelineValue;
+    m_FrameTimelineValues[m_CurrentFrame] = frameTimelineValue;
+
+    vk::Semaphore presentWaitSemaphores[] = {*m_RenderFinishedSemaphores[imageIndex]};
+
+    vk::SwapchainKHR swapChains[] = {*m_SwapChain};
+    vk::PresentInfoKHR presentInfo{
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = presentWaitSemaphores,
+        .swapchainCount = 1,
+        .pSwapchains = swapChains,
+        .pImageIndices = &imageIndex
+    };
 
-    // m_ImageViewDependentRenderTargetsPerFrameBuffer[imageIndex] = std::move(m_DependentRenderTargets);
+    vk::Result presentResult = m_PresentQueue.presentKHR(presentInfo);
 
-    m_CommandBufferDependentContexts[m_CurrentFrame].clear();
-    m_CommandBuffers[m_CurrentFrame].reset();
+    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    auto &io = ImGui::GetIO();
+    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+        ImGui::UpdatePlatformWindows();
+        ImGui::RenderPlatformWindowsDefault();
+    }
+}
 
+void BasicContextImpl::RecordFrameCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex) {
     vk::CommandBufferBeginInfo beginInfo{
         .pNext = nullptr,
-        .flags = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
         .pInheritanceInfo = nullptr // No inheritance for primary command buffers
     };
 
-    m_CommandBuffers[m_CurrentFrame].begin(beginInfo);
+    commandBuffer.begin(beginInfo);
 
     vk::ClearValue clearColor{
         m_ClearColor
@@ -820,56 +977,49 @@ void BasicContextImpl::DrawFrame() {
         .pClearValues = &clearColor
     };
 
-    m_CommandBuffers[m_CurrentFrame].beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-
-    for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
-        auto &layer = *reverseIt;
-        layer->OnSubmitCommandBuffer(m_CommandBuffers[m_CurrentFrame],
-                                     m_CommandBufferDependentContexts[m_CurrentFrame]);
-    }
+    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
 
-    ImDrawData *draw_data = ImGui::GetDrawData();
-    ImGui_ImplVulkan_RenderDrawData(draw_data, *m_CommandBuffers[m_CurrentFrame]);
-
-    m_CommandBuffers[m_CurrentFrame].endRenderPass();
+    vk::CommandBufferInheritanceInfo inheritanceInfo{
+        .pNext = nullptr,
+        .renderPass = *m_RenderPass,
+        .subpass = 0,
+        .framebuffer = *m_SwapChainFramebuffers[imageIndex]
+    };
 
-    m_CommandBuffers[m_CurrentFrame].end();
+    vk::CommandBufferBeginInfo secondaryBeginInfo{
+        .pNext = nullptr,
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                 vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritanceInfo
+    };
 
-    vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-    vk::Semaphore waitSemaphores[] = {*m_ImageAvailableSemaphores[m_CurrentFrame]};
-    vk::Semaphore signalSemaphores[] = {*m_RenderFinishedSemaphores[imageIndex]};
-    vk::CommandBuffer commandBuffers[] = {*m_CommandBuffers[m_CurrentFrame]};
+    // One secondary buffer per layer plus one for the ImGui draw data, recorded in parallel.
+    // Layers keep their reverse order, ImGui is drawn on top of everything.
+    size_t layerCount = m_Layers.size();
+    m_SecondaryCommandBuffers.resize(layerCount + 1);
 
-    vk::SubmitInfo submitInfo{
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = waitSemaphores,
-        .pWaitDstStageMask = waitStages,
-        .commandBufferCount = 1,
-        .pCommandBuffers = commandBuffers,
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = signalSemaphores
-    };
+    m_WorkerPool->ParallelFor(layerCount + 1, [&](size_t index, size_t threadIndex) {
+        auto &threadResources = m_FrameThreadResources[m_CurrentFrame][threadIndex];
+        vk::CommandBuffer secondary = threadResources.Acquire(m_Device, vk::CommandBufferLevel::eSecondary);
+        secondary.begin(secondaryBeginInfo);
 
-    m_GraphicsQueue.submit(submitInfo, m_InFlightFences[m_CurrentFrame]);
+        if (index < layerCount) {
+            auto &layer = m_Layers[layerCount - 1 - index];
+            layer->OnSubmitCommandBuffer(secondary);
+        } else {
+            ImDrawData *draw_data = ImGui::GetDrawData();
+            ImGui_ImplVulkan_RenderDrawData(draw_data, secondary);
+        }
 
-    vk::SwapchainKHR swapChains[] = {*m_SwapChain};
-    vk::PresentInfoKHR presentInfo{
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = signalSemaphores,
-        .swapchainCount = 1,
-        .pSwapchains = swapChains,
-        .pImageIndices = &imageIndex
-    };
+        secondary.end();
+        m_SecondaryCommandBuffers[index] = secondary;
+    });
 
-    vk::Result presentResult = m_PresentQueue.presentKHR(presentInfo);
+    commandBuffer.executeCommands(m_SecondaryCommandBuffers);
 
-    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    commandBuffer.endRenderPass();
 
-    auto &io = ImGui::GetIO();
-    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
-        ImGui::UpdatePlatformWindows();
-        ImGui::RenderPlatformWindowsDefault();
-    }
+    commandBuffer.end();
 }
 
 void BasicContextImpl::RecreateSwapChain() {
@@ -884,6 +1034,34 @@ void BasicContextImpl::RecreateSwapChain() {
     std::cout << "Swap chain recreated successfully." << std::endl;
 }
 
+void BasicContextImpl::PostEvent(const QueuedEvent &event) {
+    if (!m_EventQueue.Post(event)) {
+        std::cerr << "Event queue full, dropped: " << std::visit([](const Event &e) { return e.ToString(); }, event)
+                << std::endl;
+    }
+}
+
+void BasicContextImpl::DispatchEvents() {
+    m_EventQueue.Drain([this](const Event &event) {
+        if (event.GetEventType() == EventType::WindowResize) {
+            // Resizes are coalesced, so the swap chain is rebuilt at most once per frame.
+            const auto &resizeEvent = static_cast<const WindowResizeEvent &>(event);
+            if (resizeEvent.GetWidth() > 0 && resizeEvent.GetHeight() > 0) {
+                m_ShouldUpdate = true;
+                RecreateSwapChain();
+            } else {
+                m_ShouldUpdate = false;
+            }
+        }
+
+        for (auto reverseIt = m_Layers.rbegin(); reverseIt != m_Layers.rend(); ++reverseIt) {
+            if ((*reverseIt)->OnEvent(&event)) {
+                break;
+            }
+        }
+    });
+}
+
 void BasicContextImpl::CleanupSwapChain() {
     m_SwapChainFramebuffers.clear();
     m_SwapChainImageViews.clear();
@@ -895,6 +1073,7 @@ void BasicContextImpl::CleanupSwapChain() {
 void BasicContextImpl::MainLoop() {
     while (!m_Window->shouldClose()) {
         glfw::pollEvents();
+        DispatchEvents();
         if (!m_ShouldUpdate) {
             continue;
             std::this_thread::sleep_for(std::chrono::milliseconds(16));
@@ -906,7 +1085,10 @@ void BasicContextImpl::MainLoop() {
 }
 
 void BasicContextImpl::Cleanup() {
-    m_CommandBufferDependentContexts.clear();
+    // Layers retire their resources on destruction, which still needs ImGui for textures.
+    m_Layers.clear();
+    m_PendingCommandBuffers.clear();
+    m_DeletionQueue.Flush();
     CleanupSwapChain();
 
     ShutdownImGuiForMyProgram();
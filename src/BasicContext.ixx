@@ -9,6 +9,10 @@ import ImGui;
 import <memory>;
 
 import Event;
+export import Events.EventQueue;
+export import WorkerPool;
+export import Render.DeletionQueue;
+export import Render.MemoryAllocator;
 
 #ifdef NDEBUG
 constexpr bool enableValidationLayers = false;
@@ -24,7 +28,11 @@ public:
 
     virtual void OnUpdate() = 0;
 
-    virtual void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer, std::vector<std::any> &dependentContexts) = 0;
+    // Called once per frame on an arbitrary worker thread with a secondary command buffer that
+    // already inherits the swap chain render pass. Layers record concurrently, so implementations
+    // must not touch ImGui or other layers from here. Resources referenced by the recorded
+    // commands have to be released through IBasicContext::GetDeletionQueue.
+    virtual void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) = 0;
 
     virtual bool OnEvent(const Event* event) = 0;
 };
@@ -58,10 +66,43 @@ public:
 
     virtual vk::raii::Sampler &GetSampler() = 0;
 
+    virtual WorkerPool &GetWorkerPool() = 0;
+
+    // Primary command buffer from the calling thread's pool for the frame being built. It is
+    // recycled together with its pool once the frame slot comes around again, never free it.
+    // Only the UI thread and the worker pool's threads have pools, other threads get an exception.
+    virtual vk::CommandBuffer AllocateFrameCommandBuffer() = 0;
+
+    // Queues a recorded command buffer so it is submitted in the same batch as, and ahead of,
+    // the swap chain frame. Returns the graphics timeline value that is signalled once the
+    // commands completed.
+    virtual uint64_t SubmitBeforeFrame(vk::CommandBuffer commandBuffer) = 0;
+
+    // Destroys retired objects once every frame that could still use them finished.
+    virtual DeletionQueue &GetDeletionQueue() = 0;
+
+    virtual GpuMemoryAllocator &GetMemoryAllocator() = 0;
+
+    // Timeline semaphore signalled by every submission on the graphics queue.
+    virtual vk::raii::Semaphore &GetGraphicsTimeline() = 0;
+
+    // Value the frame currently being built signals when it is done on the GPU.
+    virtual uint64_t GetFrameTimelineValue() const = 0;
+
+    // Last value the GPU has reached on the graphics timeline, never blocks.
+    virtual uint64_t GetCompletedTimelineValue() = 0;
+
+    bool IsTimelineValueReached(uint64_t value) {
+        return GetCompletedTimelineValue() >= value;
+    }
+
     virtual void SetClearColor(const vk::ClearColorValue &clearColor) = 0;
 
     virtual void RecreateSwapChain() = 0;
 
+    // Queues an event for the next frame's dispatch, callable from any thread.
+    virtual void PostEvent(const QueuedEvent &event) = 0;
+
     template<std::derived_from<IUpdatableLayer> T>
     std::shared_ptr<T> EmplaceLayer(auto &&... args) {
         auto layer = std::make_shared<T>(std::forward<decltype(args)>(args)...);
@@ -93,6 +134,20 @@ struct QueueFamilyIndices {
     [[nodiscard]] bool IsComplete() const;
 };
 
+// Command pool owned by one thread for one frame slot. The whole pool is reset once the slot's
+// fence signalled, so command buffers are handed out again without resetting them one by one.
+struct FrameThreadResources {
+    vk::raii::CommandPool CommandPool{nullptr};
+    std::vector<vk::raii::CommandBuffer> PrimaryCommandBuffers;
+    std::vector<vk::raii::CommandBuffer> SecondaryCommandBuffers;
+    size_t UsedPrimaryCommandBuffers = 0;
+    size_t UsedSecondaryCommandBuffers = 0;
+
+    vk::CommandBuffer Acquire(const vk::raii::Device &device, vk::CommandBufferLevel level);
+
+    void Reset();
+};
+
 struct SwapChainSupportDetails {
     vk::SurfaceCapabilitiesKHR Capabilities;
     std::vector<vk::SurfaceFormatKHR> Formats;
@@ -130,6 +185,8 @@ private:
 
     [[nodiscard]] bool CheckDeviceExtensionSupport(vk::PhysicalDevice device) const;
 
+    [[nodiscard]] bool CheckDeviceFeatureSupport(const vk::raii::PhysicalDevice &device) const;
+
     SwapChainSupportDetails QuerySwapChainSupport(vk::PhysicalDevice device);
 
     [[nodiscard]] vk::SurfaceFormatKHR ChooseSwapSurfaceFormat(
@@ -156,14 +213,22 @@ private:
 
     void CreateCommandPool();
 
-    void CreateCommandBuffer();
+    void CreateFrameThreadResources();
 
     void CreateSyncObjects();
 
     void DrawFrame();
 
+    void RecordFrameCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
+
+    bool WaitTimelineValue(uint64_t value);
+
     void RecreateSwapChain() override;
 
+    void PostEvent(const QueuedEvent &event) override;
+
+    void DispatchEvents();
+
     void CleanupSwapChain();
 
     void MainLoop() override;
@@ -196,17 +261,36 @@ private:
     std::vector<vk::raii::Framebuffer> m_SwapChainFramebuffers;
     vk::raii::CommandPool m_CommandPool{nullptr};
 
+    // Binary semaphores remain for acquire and present, which cannot use timelines.
     std::vector<vk::raii::Semaphore> m_ImageAvailableSemaphores;
     std::vector<vk::raii::Semaphore> m_RenderFinishedSemaphores;
-    std::vector<vk::raii::Fence> m_InFlightFences;
+
+    vk::raii::Semaphore m_GraphicsTimeline{nullptr};
+    uint64_t m_LastSubmittedTimelineValue = 0;
+    uint64_t m_CompletedTimelineValue = 0;
+    // Timeline value each frame slot has to reach before its resources can be reused.
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_FrameTimelineValues{};
     size_t m_CurrentFrame = 0;
-    std::vector<vk::raii::CommandBuffer> m_CommandBuffers;
     bool m_ShouldUpdate = true;
 
-    std::vector<std::vector<std::any>> m_CommandBufferDependentContexts;
+    std::unique_ptr<WorkerPool> m_WorkerPool;
+
+    // Declared before the deletion queue, retired allocations are returned to it.
+    std::unique_ptr<GpuMemoryAllocator> m_MemoryAllocator;
+    DeletionQueue m_DeletionQueue{MAX_FRAMES_IN_FLIGHT};
+
+    // [frame slot][thread index]
+    std::vector<std::vector<FrameThreadResources>> m_FrameThreadResources;
+    std::vector<vk::CommandBuffer> m_SecondaryCommandBuffers;
+
+    std::mutex m_PendingSubmitMutex;
+    std::vector<vk::CommandBufferSubmitInfo> m_PendingCommandBuffers;
+    std::vector<vk::CommandBufferSubmitInfo> m_SubmitCommandBuffers;
 
     std::vector<std::shared_ptr<IUpdatableLayer>> m_Layers;
 
+    EventQueue<256> m_EventQueue;
+
 private:
     size_t m_MinImageCount = 0;
     size_t m_ImageCount = 0;
@@ -235,6 +319,14 @@ public:
     vk::raii::RenderPass &GetRenderPass() override { return m_RenderPass; }
     vk::raii::CommandPool &GetCommandPool() override { return m_CommandPool; }
     vk::raii::Sampler &GetSampler() override { return m_Sampler; }
+    WorkerPool &GetWorkerPool() override { return *m_WorkerPool; }
+    vk::CommandBuffer AllocateFrameCommandBuffer() override;
+    uint64_t SubmitBeforeFrame(vk::CommandBuffer commandBuffer) override;
+    DeletionQueue &GetDeletionQueue() override { return m_DeletionQueue; }
+    GpuMemoryAllocator &GetMemoryAllocator() override { return *m_MemoryAllocator; }
+    vk::raii::Semaphore &GetGraphicsTimeline() override { return m_GraphicsTimeline; }
+    uint64_t GetFrameTimelineValue() const override { return m_LastSubmittedTimelineValue + 1; }
+    uint64_t GetCompletedTimelineValue() override;
     void SetClearColor(const vk::ClearColorValue &clearColor) override { m_ClearColor = clearColor; }
 
     void PushLayer(std::shared_ptr<IUpdatableLayer> layer) override {
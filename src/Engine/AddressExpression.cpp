@@ -0,0 +1,364 @@
+module Engine.AddressExpression;
+
+// Deeper nesting than this is rejected instead of recursing further.
+constexpr size_t MaxNesting = 64;
+
+static bool IsWordCharacter(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+// Recursive descent over the text, emitting postfix code as it goes:
+//     sum     = product { ("+" | "-") product }
+//     product = unary { "*" unary }
+//     unary   = "-" unary | primary
+//     primary = number | name | '"' name '"' | "(" sum ")" | "[" sum "]"
+struct ExpressionParser {
+    std::string_view Text;
+    size_t Position = 0;
+    size_t Nesting = 0;
+    std::vector<AddressInstruction> Code;
+    std::vector<uint64_t> Constants;
+    std::vector<std::string> ModuleNames;
+    std::string Error;
+
+    bool Fail(std::string_view message) {
+        if (Error.empty()) {
+            Error = std::format("{} at column {}", message, Position + 1);
+        }
+        return false;
+    }
+
+    void SkipSpaces() {
+        while (Position < Text.size() && std::isspace(static_cast<unsigned char>(Text[Position]))) {
+            Position++;
+        }
+    }
+
+    bool Accept(char c) {
+        SkipSpaces();
+        if (Position < Text.size() && Text[Position] == c) {
+            Position++;
+            return true;
+        }
+        return false;
+    }
+
+    void EmitConstant(uint64_t value) {
+        Code.push_back({AddressOp::Constant, static_cast<uint32_t>(Constants.size())});
+        Constants.push_back(value);
+    }
+
+    // Folds operations on constants right away, so "base+10*4" costs a single Add.
+    void Emit(AddressOp op) {
+        size_t size = Code.size();
+        if (op == AddressOp::Negate && size >= 1 && Code[size - 1].Op == AddressOp::Constant) {
+            Constants.back() = 0 - Constants.back();
+            return;
+        }
+        if (op != AddressOp::Negate && op != AddressOp::Dereference && size >= 2 &&
+            Code[size - 1].Op == AddressOp::Constant && Code[size - 2].Op == AddressOp::Constant) {
+            uint64_t right = Constants.back();
+            Constants.pop_back();
+            Code.pop_back();
+            uint64_t &left = Constants.back();
+            left = op == AddressOp::Add ? left + right : op == AddressOp::Subtract ? left - right : left * right;
+            return;
+        }
+        Code.push_back({op, 0});
+    }
+
+    bool ParseSum() {
+        if (!ParseProduct()) {
+            return false;
+        }
+        while (true) {
+            if (Accept('+')) {
+                if (!ParseProduct()) {
+                    return false;
+                }
+                Emit(AddressOp::Add);
+            } else if (Accept('-')) {
+                if (!ParseProduct()) {
+                    return false;
+                }
+                Emit(AddressOp::Subtract);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool ParseProduct() {
+        if (!ParseUnary()) {
+            return false;
+        }
+        while (Accept('*')) {
+            if (!ParseUnary()) {
+                return false;
+            }
+            Emit(AddressOp::Multiply);
+        }
+        return true;
+    }
+
+    bool ParseUnary() {
+        if (Accept('-')) {
+            if (!ParseUnary()) {
+                return false;
+            }
+            Emit(AddressOp::Negate);
+            return true;
+        }
+        return ParsePrimary();
+    }
+
+    bool ParseNested(char close, bool dereference) {
+        if (++Nesting > MaxNesting) {
+            return Fail("nested too deeply");
+        }
+        if (!ParseSum()) {
+            return false;
+        }
+        if (!Accept(close)) {
+            return Fail(std::format("expected '{}'", close));
+        }
+        if (dereference) {
+            Emit(AddressOp::Dereference);
+        }
+        Nesting--;
+        return true;
+    }
+
+    bool ParsePrimary() {
+        SkipSpaces();
+        if (Accept('(')) {
+            return ParseNested(')', false);
+        }
+        if (Accept('[')) {
+            return ParseNested(']', true);
+        }
+        if (Accept('"')) {
+            size_t end = Text.find('"', Position);
+            if (end == std::string_view::npos || end == Position) {
+                return Fail("expected a module name and a closing '\"'");
+            }
+            AddModule(Text.substr(Position, end - Position));
+            Position = end + 1;
+            return true;
+        }
+
+        size_t start = Position;
+        while (Position < Text.size() && IsWordCharacter(Text[Position])) {
+            Position++;
+        }
+        std::string_view word = Text.substr(start, Position - start);
+        if (word.empty()) {
+            return Fail(Position < Text.size() ? std::format("unexpected '{}'", Text[Position]) : "unexpected end");
+        }
+
+        std::string_view digits = word.starts_with("0x") || word.starts_with("0X") ? word.substr(2) : word;
+        auto isHexDigit = [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; };
+        if (!digits.empty() && std::ranges::all_of(digits, isHexDigit)) {
+            uint64_t value = 0;
+            auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value, 16);
+            if (error != std::errc{}) {
+                Position = start;
+                return Fail("number too large");
+            }
+            EmitConstant(value);
+            return true;
+        }
+        AddModule(word);
+        return true;
+    }
+
+    void AddModule(std::string_view name) {
+        auto it = std::ranges::find(ModuleNames, name);
+        auto index = static_cast<uint32_t>(it - ModuleNames.begin());
+        if (it == ModuleNames.end()) {
+            ModuleNames.emplace_back(name);
+        }
+        Code.push_back({AddressOp::Module, index});
+    }
+};
+
+std::expected<AddressExpression, std::string> AddressExpression::Compile(std::string_view text) {
+    ExpressionParser parser{text};
+    if (!parser.ParseSum()) {
+        return std::unexpected(std::move(parser.Error));
+    }
+    parser.SkipSpaces();
+    if (parser.Position != text.size()) {
+        parser.Fail(std::format("unexpected '{}'", text[parser.Position]));
+        return std::unexpected(std::move(parser.Error));
+    }
+
+    AddressExpression expression;
+    expression.m_Text = std::string(text);
+    expression.m_Code = std::move(parser.Code);
+    expression.m_Constants = std::move(parser.Constants);
+    expression.m_ModuleNames = std::move(parser.ModuleNames);
+    return expression;
+}
+
+bool AddressExpression::IsConstant() const {
+    return std::ranges::none_of(m_Code, [](const AddressInstruction &instruction) {
+        return instruction.Op == AddressOp::Module || instruction.Op == AddressOp::Dereference;
+    });
+}
+
+size_t AddressExpression::GetDepth() const {
+    std::vector<size_t> depths;
+    for (const auto &instruction: m_Code) {
+        switch (instruction.Op) {
+            case AddressOp::Constant:
+            case AddressOp::Module:
+                depths.push_back(0);
+                break;
+            case AddressOp::Add:
+            case AddressOp::Subtract:
+            case AddressOp::Multiply: {
+                size_t right = depths.back();
+                depths.pop_back();
+                depths.back() = std::max(depths.back(), right);
+                break;
+            }
+            case AddressOp::Negate:
+                break;
+            case AddressOp::Dereference:
+                depths.back()++;
+                break;
+        }
+    }
+    return depths.empty() ? 0 : depths.back();
+}
+
+// Module names compare case insensitively, Windows does not care about the case either.
+static std::optional<uint64_t> FindModuleBase(const SymbolIndex *symbols, std::string_view name) {
+    if (symbols == nullptr) {
+        return std::nullopt;
+    }
+    auto lower = [](char c) { return std::tolower(static_cast<unsigned char>(c)); };
+    for (const auto &entry: symbols->GetModules()) {
+        if (std::ranges::equal(entry.Module.Name, name, {}, lower, lower)) {
+            return entry.Module.Base;
+        }
+    }
+    return std::nullopt;
+}
+
+struct Evaluation {
+    size_t Next = 0;
+    std::vector<uint64_t> Stack;
+    bool Failed = false;
+    bool Done = false;
+};
+
+// Runs the expression until it finishes or reaches a dereference of a pointer that is not in
+// pointers yet, whose address then goes to pending and where the next run picks up.
+static void Run(const AddressExpression &expression, Evaluation &evaluation, const SymbolIndex *symbols,
+                const std::unordered_map<uint64_t, std::optional<uint64_t>> &pointers,
+                std::vector<uint64_t> &pending) {
+    auto code = expression.GetCode();
+    auto &stack = evaluation.Stack;
+    for (; evaluation.Next < code.size(); evaluation.Next++) {
+        const AddressInstruction &instruction = code[evaluation.Next];
+        switch (instruction.Op) {
+            case AddressOp::Constant:
+                stack.push_back(expression.GetConstants()[instruction.Operand]);
+                break;
+            case AddressOp::Module: {
+                auto base = FindModuleBase(symbols, expression.GetModuleNames()[instruction.Operand]);
+                if (!base) {
+                    evaluation.Failed = evaluation.Done = true;
+                    return;
+                }
+                stack.push_back(*base);
+                break;
+            }
+            case AddressOp::Add:
+            case AddressOp::Subtract:
+            case AddressOp::Multiply: {
+                uint64_t right = stack.back();
+                stack.pop_back();
+                uint64_t &left = stack.back();
+                left = instruction.Op == AddressOp::Add
+                           ? left + right
+                           : instruction.Op == AddressOp::Subtract ? left - right : left * right;
+                break;
+            }
+            case AddressOp::Negate:
+                stack.back() = 0 - stack.back();
+                break;
+            case AddressOp::Dereference: {
+                auto found = pointers.find(stack.back());
+                if (found == pointers.end()) {
+                    pending.push_back(stack.back());
+                    return;
+                }
+                if (!found->second) {
+                    evaluation.Failed = evaluation.Done = true;
+                    return;
+                }
+                stack.back() = *found->second;
+                break;
+            }
+        }
+    }
+    evaluation.Done = true;
+    evaluation.Failed = stack.size() != 1;
+}
+
+void AddressResolver::SetSymbols(std::shared_ptr<const SymbolIndex> symbols) {
+    std::lock_guard lock(m_Mutex);
+    m_Symbols = std::move(symbols);
+}
+
+void AddressResolver::Refresh() {
+    std::lock_guard lock(m_Mutex);
+    m_Pointers.clear();
+}
+
+void AddressResolver::Resolve(std::span<const AddressExpression *const> expressions,
+                              std::span<std::optional<uint64_t>> results) {
+    std::vector<Evaluation> evaluations(expressions.size());
+    std::vector<uint64_t> pending;
+    std::vector<uint64_t> values;
+    std::vector<BatchRead> reads;
+    while (true) {
+        pending.clear(); {
+            std::lock_guard lock(m_Mutex);
+            for (size_t i = 0; i < expressions.size(); i++) {
+                if (!evaluations[i].Done) {
+                    Run(*expressions[i], evaluations[i], m_Symbols.get(), m_Pointers, pending);
+                }
+            }
+        }
+        if (pending.empty()) {
+            break;
+        }
+
+        // One read per distinct pointer, however many chains pass through it.
+        std::ranges::sort(pending);
+        auto duplicates = std::ranges::unique(pending);
+        pending.erase(duplicates.begin(), duplicates.end());
+        values.assign(pending.size(), 0);
+        reads.clear();
+        for (size_t i = 0; i < pending.size(); i++) {
+            reads.push_back({pending[i], std::as_writable_bytes(std::span(&values[i], 1))});
+        }
+        if (m_Source) {
+            m_Source->ReadBatch(reads);
+        }
+        m_PointerReads.fetch_add(pending.size(), std::memory_order_relaxed);
+
+        std::lock_guard lock(m_Mutex);
+        for (size_t i = 0; i < pending.size(); i++) {
+            m_Pointers[pending[i]] = reads[i].Copied == sizeof(uint64_t) ? std::optional(values[i]) : std::nullopt;
+        }
+    }
+
+    for (size_t i = 0; i < expressions.size(); i++) {
+        results[i] = evaluations[i].Failed ? std::nullopt : std::optional(evaluations[i].Stack.back());
+    }
+}
@@ -0,0 +1,96 @@
+export module Engine.AddressExpression;
+
+import std;
+import Engine.ProcessMemory;
+import Engine.Symbols;
+
+export enum class AddressOp : uint8_t {
+    Constant, // pushes Constants[Operand]
+    Module, // pushes the base of ModuleNames[Operand]
+    Add,
+    Subtract,
+    Multiply,
+    Negate,
+    Dereference // replaces the top with the pointer stored there
+};
+
+export struct AddressInstruction {
+    AddressOp Op;
+    uint32_t Operand;
+};
+
+// An address written as an expression, compiled once into stack machine code:
+//
+//     game.so+1A2B30          module base plus an offset
+//     [[base]+20]+8           [x] is the 8 byte pointer stored at x
+//     "libfoo-1.so"+(10*4)    quoted names for modules with odd characters, + - * and ( )
+//
+// Numbers are hex, with or without 0x. A word made only of hex digits is a number, anything
+// else is a module name looked up in the target's SymbolIndex.
+export class AddressExpression {
+public:
+    static std::expected<AddressExpression, std::string> Compile(std::string_view text);
+
+    [[nodiscard]] const std::string &GetText() const { return m_Text; }
+
+    [[nodiscard]] std::span<const AddressInstruction> GetCode() const { return m_Code; }
+
+    [[nodiscard]] std::span<const uint64_t> GetConstants() const { return m_Constants; }
+
+    [[nodiscard]] std::span<const std::string> GetModuleNames() const { return m_ModuleNames; }
+
+    // Neither reads memory nor needs the module list, so it resolves to the same address always.
+    [[nodiscard]] bool IsConstant() const;
+
+    // Levels of dereference, the number of batched reads resolving it takes at most.
+    [[nodiscard]] size_t GetDepth() const;
+
+private:
+    std::string m_Text;
+    std::vector<AddressInstruction> m_Code;
+    std::vector<uint64_t> m_Constants;
+    std::vector<std::string> m_ModuleNames;
+};
+
+// Resolves expressions against one target. All expressions of a Resolve call run side by side
+// until each stops at a dereference, the pointers they wait for are read with one ReadBatch,
+// and they all continue; so resolving thousands of pointer chains costs one batch per level.
+// Pointer values are remembered until Refresh, so chains sharing a prefix and everybody
+// resolving between two refreshes (watch polling, freezes, the hex view) share one set of reads.
+// Thread safe.
+export class AddressResolver {
+public:
+    // Without a source every dereference fails, constant expressions still resolve.
+    explicit AddressResolver(std::shared_ptr<MemorySource> source) : m_Source(std::move(source)) {
+    }
+
+    void SetSymbols(std::shared_ptr<const SymbolIndex> symbols);
+
+    // Forgets the pointer values read so far.
+    void Refresh();
+
+    // results[i] is the address of expressions[i], nullopt where a pointer could not be read or
+    // a module is not loaded.
+    void Resolve(std::span<const AddressExpression *const> expressions, std::span<std::optional<uint64_t>> results);
+
+    std::optional<uint64_t> Resolve(const AddressExpression &expression) {
+        const AddressExpression *expressions[] = {&expression};
+        std::optional<uint64_t> result;
+        Resolve(expressions, std::span(&result, 1));
+        return result;
+    }
+
+    [[nodiscard]] uint64_t GetPointerReads() const {
+        return m_PointerReads.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<MemorySource> m_Source;
+
+    mutable std::mutex m_Mutex;
+    std::shared_ptr<const SymbolIndex> m_Symbols;
+    // Pointer values read since the last Refresh, nullopt for unreadable ones.
+    std::unordered_map<uint64_t, std::optional<uint64_t>> m_Pointers;
+
+    std::atomic<uint64_t> m_PointerReads = 0;
+};
@@ -0,0 +1,302 @@
+module;
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module Engine.AgentMemory;
+
+import std;
+import Engine.AgentProtocol;
+export import Engine.ProcessMemory;
+
+// A process running the in-process agent (agent/Agent.cpp, preloaded with LD_PRELOAD). Small
+// reads and writes go through the agent's shared memory rings, a batch of them costs no system
+// call per value, only a wake-up if the agent went to sleep. Large reads and region queries
+// take the ProcessMemory path, where the one system call is cheap next to the copy.
+export class AgentMemory final : public MemorySource {
+public:
+    static constexpr size_t DirectReadLimit = 4096;
+
+    // Returns nullptr if the process runs no agent or another engine is using it.
+    static std::shared_ptr<AgentMemory> Connect(uint32_t processId) {
+#ifdef _WIN32
+        // There is no Windows agent yet.
+        return nullptr;
+#else
+        auto fallback = ProcessMemory::Open(processId);
+        if (!fallback) {
+            return nullptr;
+        }
+        int fd = shm_open(GetAgentSegmentName(processId).c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info{};
+        void *memory = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(AgentSegment)) {
+            memory = mmap(nullptr, sizeof(AgentSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (memory == MAP_FAILED) {
+            return nullptr;
+        }
+
+        auto *segment = static_cast<AgentSegment *>(memory);
+        std::optional<uint32_t> generation;
+        if (segment->Magic.load(std::memory_order_acquire) == AgentMagic && segment->Version == AgentVersion &&
+            segment->ProcessId == processId) {
+            generation = Claim(*segment);
+        }
+        if (!generation) {
+            munmap(memory, sizeof(AgentSegment));
+            return nullptr;
+        }
+        return std::shared_ptr<AgentMemory>(new AgentMemory(segment, *generation, std::move(fallback)));
+#endif
+    }
+
+    AgentMemory(const AgentMemory &) = delete;
+
+    AgentMemory &operator=(const AgentMemory &) = delete;
+
+    ~AgentMemory() override {
+#ifndef _WIN32
+        m_Segment->ClientId.store(0);
+        munmap(m_Segment, sizeof(AgentSegment));
+#endif
+    }
+
+    [[nodiscard]] uint32_t GetProcessId() const override { return m_Fallback->GetProcessId(); }
+
+    // Only large reads are worth overlapping, and those take the ProcessMemory path anyway.
+    [[nodiscard]] std::shared_ptr<AsyncReader> OpenAsyncReader() const override {
+        return m_Fallback->OpenAsyncReader();
+    }
+
+    size_t Read(uint64_t address, std::span<std::byte> buffer) const override {
+        if (buffer.size() > DirectReadLimit) {
+            return m_Fallback->Read(address, buffer);
+        }
+        BatchRead read{address, buffer};
+        ReadBatch(std::span(&read, 1));
+        return read.Copied;
+    }
+
+    void ReadBatch(std::span<BatchRead> reads) const override {
+        // Reads are cut into payload sized pieces, replies come back in the same order.
+        std::vector<size_t> direct;
+        for (size_t i = 0; i < reads.size(); i++) {
+            reads[i].Copied = 0;
+            if (reads[i].Buffer.size() > DirectReadLimit) {
+                reads[i].Copied = m_Fallback->Read(reads[i].Address, reads[i].Buffer);
+            } else if (!reads[i].Buffer.empty()) {
+                direct.push_back(i);
+            }
+        }
+        if (direct.empty()) {
+            return;
+        }
+
+        struct Cursor {
+            size_t Index = 0;
+            size_t Offset = 0;
+        };
+        auto advance = [&](Cursor &cursor) {
+            cursor.Offset += AgentPayloadSize;
+            if (cursor.Offset >= reads[direct[cursor.Index]].Buffer.size()) {
+                cursor.Index++;
+                cursor.Offset = 0;
+            }
+        };
+
+        Cursor sent;
+        Cursor received;
+        bool exchanged = Exchange(
+            [&](AgentSlot &command) {
+                if (sent.Index == direct.size()) {
+                    return false;
+                }
+                const BatchRead &read = reads[direct[sent.Index]];
+                command.Kind = static_cast<uint32_t>(AgentCommand::Read);
+                command.Address = read.Address + sent.Offset;
+                command.Size = static_cast<uint16_t>(std::min(AgentPayloadSize, read.Buffer.size() - sent.Offset));
+                advance(sent);
+                return true;
+            },
+            [&](const AgentSlot &reply) {
+                BatchRead &read = reads[direct[received.Index]];
+                // A short piece ends the readable prefix, later pieces do not count.
+                if (read.Copied == received.Offset && reply.Size != 0) {
+                    std::memcpy(read.Buffer.data() + received.Offset, reply.Payload.data(), reply.Size);
+                    read.Copied += reply.Size;
+                }
+                advance(received);
+            });
+        if (!exchanged) {
+            for (size_t index: direct) {
+                reads[index].Copied = m_Fallback->Read(reads[index].Address, reads[index].Buffer);
+            }
+        }
+    }
+
+    size_t Write(uint64_t address, std::span<const std::byte> buffer) const override {
+        size_t sent = 0;
+        size_t received = 0;
+        size_t written = 0;
+        bool exchanged = Exchange(
+            [&](AgentSlot &command) {
+                if (sent == buffer.size()) {
+                    return false;
+                }
+                size_t size = std::min(AgentPayloadSize, buffer.size() - sent);
+                command.Kind = static_cast<uint32_t>(AgentCommand::Write);
+                command.Address = address + sent;
+                command.Size = static_cast<uint16_t>(size);
+                std::memcpy(command.Payload.data(), buffer.data() + sent, size);
+                sent += size;
+                return true;
+            },
+            [&](const AgentSlot &reply) {
+                // Like reads, only the prefix up to the first short piece counts.
+                if (written == received) {
+                    written += reply.Length;
+                }
+                received += std::min(AgentPayloadSize, buffer.size() - received);
+            });
+        return exchanged ? written : m_Fallback->Write(address, buffer);
+    }
+
+    [[nodiscard]] std::vector<MemoryRegion> QueryRegions() const override {
+        return m_Fallback->QueryRegions();
+    }
+
+    // Addresses in [address, address + size) holding value, stepping by alignment. The agent
+    // compares in place, only the hits cross over.
+    [[nodiscard]] std::vector<uint64_t> Find(uint64_t address, uint64_t size, std::span<const std::byte> value,
+                                             uint16_t alignment) const {
+        std::vector<uint64_t> hits;
+        if (value.empty() || value.size() > AgentPayloadSize) {
+            return hits;
+        }
+        bool sent = false;
+        Exchange(
+            [&](AgentSlot &command) {
+                if (std::exchange(sent, true)) {
+                    return false;
+                }
+                command.Kind = static_cast<uint32_t>(AgentCommand::Find);
+                command.Address = address;
+                command.Length = size;
+                command.Size = static_cast<uint16_t>(value.size());
+                command.Alignment = alignment;
+                std::memcpy(command.Payload.data(), value.data(), value.size());
+                return true;
+            },
+            [&](const AgentSlot &reply) {
+                for (size_t i = 0; i < reply.Size / sizeof(uint64_t); i++) {
+                    uint64_t hit;
+                    std::memcpy(&hit, reply.Payload.data() + i * sizeof(uint64_t), sizeof(hit));
+                    hits.push_back(hit);
+                }
+            });
+        return hits;
+    }
+
+private:
+    AgentMemory(AgentSegment *segment, uint32_t generation, std::shared_ptr<ProcessMemory> fallback)
+        : m_Segment(segment), m_Generation(generation), m_Fallback(std::move(fallback)) {
+    }
+
+#ifndef _WIN32
+    // One engine per agent, the rings have a single producer and consumer on each side. A
+    // client that died without letting go is replaced. Returns the new client's generation, the
+    // agent drops commands of earlier ones and Exchange drops replies to them, so whatever a
+    // previous client left in either ring, or a Find of its that is still running, cannot get
+    // the rings out of step.
+    static std::optional<uint32_t> Claim(AgentSegment &segment) {
+        auto self = static_cast<uint32_t>(getpid());
+        uint32_t owner = segment.ClientId.load();
+        while (true) {
+            if (owner != 0 && owner != self && kill(static_cast<pid_t>(owner), 0) == 0) {
+                return std::nullopt;
+            }
+            if (segment.ClientId.compare_exchange_weak(owner, self)) {
+                break;
+            }
+        }
+        uint32_t generation = segment.Generation.fetch_add(1) + 1;
+        // Leftovers of a previous client.
+        std::array<AgentSlot, 16> stale;
+        while (segment.Replies.PopBulk(stale) != 0) {
+        }
+        return generation;
+    }
+#endif
+
+    // Pushes the commands next produces until it returns false and passes every reply to
+    // onReply, skipping replies to an earlier client. Both rings are served in the same loop, so
+    // neither side can stall on a full ring. Returns false if the agent stopped answering, the rings are out of step then and
+    // everything takes the fallback path from there on. Long commands keep replying while
+    // they run, so only silence counts, not how long a command takes.
+    template<typename Next, typename OnReply>
+    bool Exchange(Next &&next, OnReply &&onReply) const {
+        constexpr auto Timeout = std::chrono::seconds(1);
+        static_assert(Timeout >= 5 * AgentProgressInterval, "a busy agent must not look dead");
+        std::lock_guard lock(m_Mutex);
+        if (m_Broken) {
+            return false;
+        }
+
+        AgentSlot command{};
+        bool pending = next(command);
+        command.Generation = m_Generation;
+        size_t outstanding = 0;
+        std::array<AgentSlot, 16> replies;
+        auto lastProgress = std::chrono::steady_clock::now();
+        while (pending || outstanding != 0) {
+            bool pushed = false;
+            while (pending && m_Segment->Commands.TryPush(command)) {
+                outstanding++;
+                pushed = true;
+                pending = next(command);
+                command.Generation = m_Generation;
+            }
+            if (pushed) {
+                RingDoorbell(*m_Segment);
+            }
+
+            size_t count = m_Segment->Replies.PopBulk(replies);
+            for (size_t i = 0; i < count; i++) {
+                if (replies[i].Generation != m_Generation) {
+                    continue;
+                }
+                if (replies[i].Kind == static_cast<uint32_t>(AgentReply::Done)) {
+                    outstanding--;
+                }
+                onReply(replies[i]);
+            }
+
+            if (pushed || count != 0) {
+                lastProgress = std::chrono::steady_clock::now();
+            } else if (std::chrono::steady_clock::now() - lastProgress > Timeout) {
+                m_Broken = true;
+                return false;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    AgentSegment *m_Segment;
+    uint32_t m_Generation;
+    std::shared_ptr<ProcessMemory> m_Fallback;
+
+    mutable std::mutex m_Mutex;
+    mutable bool m_Broken = false;
+};
@@ -0,0 +1,99 @@
+module;
+
+#ifndef _WIN32
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+export module Engine.AgentProtocol;
+
+import std;
+export import Engine.SpscRing;
+
+// Layout of the shared memory segment between the engine and the in-process agent
+// (agent/Agent.cpp). The agent creates it under GetAgentSegmentName(its pid), the engine maps it
+// when attaching. Everything in it is plain data and lock-free atomics, so both processes can
+// use it at whatever address it is mapped.
+
+export constexpr uint32_t AgentMagic = 0x54474145; // "EAGT"
+export constexpr uint32_t AgentVersion = 2;
+
+export constexpr size_t AgentPayloadSize = 224;
+export constexpr size_t AgentRingCapacity = 1024;
+
+export enum class AgentCommand : uint32_t {
+    Read = 1, // Size bytes at Address, the reply carries the readable prefix
+    Write, // Size payload bytes to Address, the reply's Length is the number written
+    Find, // the Size byte value in the payload, every Alignment bytes of [Address, Address + Length)
+};
+
+// Every command gets exactly one Done reply, a Find sends its hits in More replies before it.
+// Commands of a client that has since been replaced are dropped without a reply.
+export enum class AgentReply : uint32_t {
+    Done = 1,
+    More,
+};
+
+// A command running longer than this sends a More reply at least this often, empty if it has
+// nothing to report, so the engine can tell a long Find from an agent that stopped answering.
+export constexpr auto AgentProgressInterval = std::chrono::milliseconds(100);
+
+export struct AgentSlot {
+    uint64_t Address;
+    uint64_t Length;
+    uint32_t Kind; // AgentCommand in commands, AgentReply in replies
+    uint16_t Size; // payload bytes in use
+    uint16_t Alignment;
+    uint32_t Generation; // the sending client's, see AgentSegment::Generation, echoed in replies
+    uint32_t Reserved;
+    std::array<std::byte, AgentPayloadSize> Payload;
+};
+
+static_assert(sizeof(AgentSlot) == 256);
+static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free);
+
+export struct AgentSegment {
+    std::atomic<uint32_t> Magic; // stored last by the agent, once the rest is set up
+    uint32_t Version;
+    uint32_t ProcessId;
+    std::atomic<uint32_t> ClientId; // pid of the engine using the rings, 0 when free
+    std::atomic<uint32_t> Generation; // bumped by every client that claims the rings
+    std::atomic<uint32_t> Sleeping; // set while the agent waits on Doorbell
+    std::atomic<uint32_t> Doorbell;
+
+    SpscRing<AgentSlot, AgentRingCapacity> Commands; // engine to agent
+    SpscRing<AgentSlot, AgentRingCapacity> Replies; // agent to engine
+};
+
+export std::string GetAgentSegmentName(uint32_t processId) {
+    return std::format("/easy-reverse-agent-{}", processId);
+}
+
+// Agent side. Blocks until RingDoorbell moved the doorbell away from seen or timeout passed.
+export void WaitForDoorbell(AgentSegment &segment, uint32_t seen, std::chrono::milliseconds timeout) {
+#ifndef _WIN32
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec time{
+        static_cast<time_t>(seconds.count()),
+        static_cast<long>(std::chrono::nanoseconds(timeout - seconds).count())
+    };
+    // Not FUTEX_PRIVATE_FLAG, the waker is in another process.
+    syscall(SYS_futex, &segment.Doorbell, FUTEX_WAIT, seen, &time, nullptr, 0);
+#else
+    std::this_thread::sleep_for(timeout);
+#endif
+}
+
+// Engine side, after pushing commands. Only costs a system call if the agent went to sleep.
+export void RingDoorbell(AgentSegment &segment) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (segment.Sleeping.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    segment.Doorbell.fetch_add(1);
+#ifndef _WIN32
+    syscall(SYS_futex, &segment.Doorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
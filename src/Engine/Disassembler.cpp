@@ -0,0 +1,1232 @@
+module Engine.Disassembler;
+
+// Mnemonics separated by '|' are picked by ModRM.reg for group opcodes and by the mandatory
+// prefix (none, 66, F3, F2) otherwise, an empty or missing pick is an invalid encoding. A '/'
+// separates the W = 0 and W = 1 forms.
+//
+// Operands are comma separated codes after the Intel manual's opcode map: an upper case letter
+// for where the operand comes from and a lower case one for its size. Alternatives separate
+// with '|' like the mnemonics, a missing one repeats the last.
+//   E r/m, G ModRM.reg, Z opcode bits 0-2, R r/m register only, M r/m memory only, B VEX.vvvv,
+//   S segment register, C/D control and debug register in ModRM.reg, T st(i) in r/m
+//   V/W/U xmm or ymm in ModRM.reg, r/m, r/m register only, H in VEX.vvvv, L in imm8[7:4],
+//   X VSIB memory
+//   P/Q/N mm in ModRM.reg, r/m, r/m register only, xmm instead with a 66 prefix or VEX
+//   I immediate, J relative branch, O absolute address
+// Sizes: b byte, w word, d dword, q qword, t tbyte, v operand size, y dword or qword by W,
+// z word or dword by operand size, s byte sign extended to operand size, x vector, o xmm at any
+// vector length (the 128-bit side of broadcasts, lane inserts and extracts, and widening or
+// narrowing conversions).
+// Lower case codes are fixed registers, rax and eax sized by the operand size.
+//
+// H, B and L only exist with VEX, H is left out of the legacy SSE forms.
+struct OpcodeEntry {
+    const char *Names = nullptr;
+    const char *Operands = "";
+    bool Group = false;
+};
+
+constexpr const char *ConditionalJumps[] = {
+    "jo", "jno", "jb", "jae", "je", "jne", "jbe", "ja", "js", "jns", "jp", "jnp", "jl", "jge", "jle", "jg"
+};
+constexpr const char *ConditionalMoves[] = {
+    "cmovo", "cmovno", "cmovb", "cmovae", "cmove", "cmovne", "cmovbe", "cmova",
+    "cmovs", "cmovns", "cmovp", "cmovnp", "cmovl", "cmovge", "cmovle", "cmovg"
+};
+constexpr const char *ConditionalSets[] = {
+    "seto", "setno", "setb", "setae", "sete", "setne", "setbe", "seta",
+    "sets", "setns", "setp", "setnp", "setl", "setge", "setle", "setg"
+};
+
+constexpr auto OneByteMap = [] {
+    std::array<OpcodeEntry, 256> map{};
+    constexpr const char *arithmetic[] = {"add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"};
+    for (int i = 0; i < 8; i++) {
+        map[i * 8 + 0] = {arithmetic[i], "Eb,Gb"};
+        map[i * 8 + 1] = {arithmetic[i], "Ev,Gv"};
+        map[i * 8 + 2] = {arithmetic[i], "Gb,Eb"};
+        map[i * 8 + 3] = {arithmetic[i], "Gv,Ev"};
+        map[i * 8 + 4] = {arithmetic[i], "al,Ib"};
+        map[i * 8 + 5] = {arithmetic[i], "rax,Iz"};
+        map[0x50 + i] = {"push", "Zq"};
+        map[0x58 + i] = {"pop", "Zq"};
+        map[0x90 + i] = {"xchg", "Zv,rax"};
+        map[0xB0 + i] = {"mov", "Zb,Ib"};
+        map[0xB8 + i] = {"mov", "Zv,Iv"};
+    }
+    for (int i = 0; i < 16; i++) {
+        map[0x70 + i] = {ConditionalJumps[i], "Jb"};
+    }
+    map[0x63] = {"movsxd", "Gv,Ed"};
+    map[0x68] = {"push", "Iz"};
+    map[0x69] = {"imul", "Gv,Ev,Iz"};
+    map[0x6A] = {"push", "Is"};
+    map[0x6B] = {"imul", "Gv,Ev,Is"};
+    map[0x6C] = {"insb"};
+    map[0x6D] = {"ins"};
+    map[0x6E] = {"outsb"};
+    map[0x6F] = {"outs"};
+    map[0x80] = {"add|or|adc|sbb|and|sub|xor|cmp", "Eb,Ib", true};
+    map[0x81] = {"add|or|adc|sbb|and|sub|xor|cmp", "Ev,Iz", true};
+    map[0x83] = {"add|or|adc|sbb|and|sub|xor|cmp", "Ev,Is", true};
+    map[0x84] = {"test", "Eb,Gb"};
+    map[0x85] = {"test", "Ev,Gv"};
+    map[0x86] = {"xchg", "Eb,Gb"};
+    map[0x87] = {"xchg", "Ev,Gv"};
+    map[0x88] = {"mov", "Eb,Gb"};
+    map[0x89] = {"mov", "Ev,Gv"};
+    map[0x8A] = {"mov", "Gb,Eb"};
+    map[0x8B] = {"mov", "Gv,Ev"};
+    map[0x8C] = {"mov", "Ev,Sw"};
+    map[0x8D] = {"lea", "Gv,M"};
+    map[0x8E] = {"mov", "Sw,Ew"};
+    map[0x8F] = {"pop", "Eq", true};
+    map[0x90] = {"nop"};
+    map[0x98] = {"cbw"};
+    map[0x99] = {"cwd"};
+    map[0x9B] = {"fwait"};
+    map[0x9C] = {"pushfq"};
+    map[0x9D] = {"popfq"};
+    map[0x9E] = {"sahf"};
+    map[0x9F] = {"lahf"};
+    map[0xA0] = {"mov", "al,O"};
+    map[0xA1] = {"mov", "rax,O"};
+    map[0xA2] = {"mov", "O,al"};
+    map[0xA3] = {"mov", "O,rax"};
+    map[0xA4] = {"movsb"};
+    map[0xA5] = {"movs"};
+    map[0xA6] = {"cmpsb"};
+    map[0xA7] = {"cmps"};
+    map[0xA8] = {"test", "al,Ib"};
+    map[0xA9] = {"test", "rax,Iz"};
+    map[0xAA] = {"stosb"};
+    map[0xAB] = {"stos"};
+    map[0xAC] = {"lodsb"};
+    map[0xAD] = {"lods"};
+    map[0xAE] = {"scasb"};
+    map[0xAF] = {"scas"};
+    map[0xC0] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Eb,Ib", true};
+    map[0xC1] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Ev,Ib", true};
+    map[0xC2] = {"ret", "Iw"};
+    map[0xC3] = {"ret"};
+    map[0xC6] = {"mov|||||||xabort", "Eb,Ib|||||||Ib", true};
+    map[0xC7] = {"mov|||||||xbegin", "Ev,Iz|||||||Jz", true};
+    map[0xC8] = {"enter", "Iw,Ib"};
+    map[0xC9] = {"leave"};
+    map[0xCA] = {"retf", "Iw"};
+    map[0xCB] = {"retf"};
+    map[0xCC] = {"int3"};
+    map[0xCD] = {"int", "Ib"};
+    map[0xCF] = {"iret"};
+    map[0xD0] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Eb,1", true};
+    map[0xD1] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Ev,1", true};
+    map[0xD2] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Eb,cl", true};
+    map[0xD3] = {"rol|ror|rcl|rcr|shl|shr|sal|sar", "Ev,cl", true};
+    map[0xD7] = {"xlatb"};
+    for (int i = 0xD8; i <= 0xDF; i++) {
+        map[i] = {"x87", "", true};
+    }
+    map[0xE0] = {"loopne", "Jb"};
+    map[0xE1] = {"loope", "Jb"};
+    map[0xE2] = {"loop", "Jb"};
+    map[0xE3] = {"jrcxz", "Jb"};
+    map[0xE4] = {"in", "al,Ib"};
+    map[0xE5] = {"in", "eax,Ib"};
+    map[0xE6] = {"out", "Ib,al"};
+    map[0xE7] = {"out", "Ib,eax"};
+    map[0xE8] = {"call", "Jz"};
+    map[0xE9] = {"jmp", "Jz"};
+    map[0xEB] = {"jmp", "Jb"};
+    map[0xEC] = {"in", "al,dx"};
+    map[0xED] = {"in", "eax,dx"};
+    map[0xEE] = {"out", "dx,al"};
+    map[0xEF] = {"out", "dx,eax"};
+    map[0xF1] = {"int1"};
+    map[0xF4] = {"hlt"};
+    map[0xF5] = {"cmc"};
+    map[0xF6] = {"test|test|not|neg|mul|imul|div|idiv", "Eb,Ib|Eb,Ib|Eb", true};
+    map[0xF7] = {"test|test|not|neg|mul|imul|div|idiv", "Ev,Iz|Ev,Iz|Ev", true};
+    map[0xF8] = {"clc"};
+    map[0xF9] = {"stc"};
+    map[0xFA] = {"cli"};
+    map[0xFB] = {"sti"};
+    map[0xFC] = {"cld"};
+    map[0xFD] = {"std"};
+    map[0xFE] = {"inc|dec", "Eb", true};
+    map[0xFF] = {"inc|dec|call|call far|jmp|jmp far|push", "Ev|Ev|Eq|M|Eq|M|Eq", true};
+    return map;
+}();
+
+constexpr auto TwoByteMap = [] {
+    std::array<OpcodeEntry, 256> map{};
+    for (int i = 0; i < 16; i++) {
+        map[0x40 + i] = {ConditionalMoves[i], "Gv,Ev"};
+        map[0x80 + i] = {ConditionalJumps[i], "Jz"};
+        map[0x90 + i] = {ConditionalSets[i], "Eb"};
+    }
+    for (int i = 0; i < 8; i++) {
+        map[0xC8 + i] = {"bswap", "Zy"};
+    }
+    map[0x00] = {"sldt|str|lldt|ltr|verr|verw", "Ew", true};
+    map[0x01] = {"sgdt|sidt|lgdt|lidt|smsw||lmsw|invlpg", "M|M|M|M|Ew|Ew|Ew|M", true};
+    map[0x02] = {"lar", "Gv,Ew"};
+    map[0x03] = {"lsl", "Gv,Ew"};
+    map[0x05] = {"syscall"};
+    map[0x06] = {"clts"};
+    map[0x07] = {"sysret"};
+    map[0x08] = {"invd"};
+    map[0x09] = {"wbinvd"};
+    map[0x0B] = {"ud2"};
+    map[0x0D] = {"prefetch|prefetchw|prefetchwt1|prefetch|prefetch|prefetch|prefetch|prefetch", "M", true};
+    map[0x0E] = {"femms"};
+    map[0x0F] = {"3dnow", "Pq,Qq,Ib"};
+    map[0x10] = {"movups|movupd|movss|movsd", "Vx,Wx"};
+    map[0x11] = {"movups|movupd|movss|movsd", "Wx,Vx"};
+    map[0x12] = {"movlps|movlpd|movsldup|movddup", "Vx,Hx,M|Vx,Hx,M|Vx,Wx"};
+    map[0x13] = {"movlps|movlpd", "M,Vx"};
+    map[0x14] = {"unpcklps|unpcklpd", "Vx,Hx,Wx"};
+    map[0x15] = {"unpckhps|unpckhpd", "Vx,Hx,Wx"};
+    map[0x16] = {"movhps|movhpd|movshdup", "Vx,Hx,M|Vx,Hx,M|Vx,Wx"};
+    map[0x17] = {"movhps|movhpd", "M,Vx"};
+    map[0x18] = {"prefetchnta|prefetcht0|prefetcht1|prefetcht2|nop|nop|nop|nop", "M|M|M|M|Ev", true};
+    for (int i = 0x19; i <= 0x1F; i++) {
+        map[i] = {"nop", "Ev"};
+    }
+    map[0x20] = {"mov", "Rq,Cd"};
+    map[0x21] = {"mov", "Rq,Dd"};
+    map[0x22] = {"mov", "Cd,Rq"};
+    map[0x23] = {"mov", "Dd,Rq"};
+    map[0x28] = {"movaps|movapd", "Vx,Wx"};
+    map[0x29] = {"movaps|movapd", "Wx,Vx"};
+    map[0x2A] = {"cvtpi2ps|cvtpi2pd|cvtsi2ss|cvtsi2sd", "Vx,Qq|Vx,Qq|Vx,Hx,Ey"};
+    map[0x2B] = {"movntps|movntpd", "M,Vx"};
+    map[0x2C] = {"cvttps2pi|cvttpd2pi|cvttss2si|cvttsd2si", "Pq,Wx|Pq,Wx|Gy,Wx"};
+    map[0x2D] = {"cvtps2pi|cvtpd2pi|cvtss2si|cvtsd2si", "Pq,Wx|Pq,Wx|Gy,Wx"};
+    map[0x2E] = {"ucomiss|ucomisd", "Vx,Wx"};
+    map[0x2F] = {"comiss|comisd", "Vx,Wx"};
+    map[0x30] = {"wrmsr"};
+    map[0x31] = {"rdtsc"};
+    map[0x32] = {"rdmsr"};
+    map[0x33] = {"rdpmc"};
+    map[0x34] = {"sysenter"};
+    map[0x35] = {"sysexit"};
+    map[0x37] = {"getsec"};
+    map[0x50] = {"movmskps|movmskpd", "Gd,Ux"};
+    map[0x51] = {"sqrtps|sqrtpd|sqrtss|sqrtsd", "Vx,Wx|Vx,Wx|Vx,Hx,Wx"};
+    map[0x52] = {"rsqrtps||rsqrtss", "Vx,Wx|Vx,Wx|Vx,Hx,Wx"};
+    map[0x53] = {"rcpps||rcpss", "Vx,Wx|Vx,Wx|Vx,Hx,Wx"};
+    map[0x54] = {"andps|andpd", "Vx,Hx,Wx"};
+    map[0x55] = {"andnps|andnpd", "Vx,Hx,Wx"};
+    map[0x56] = {"orps|orpd", "Vx,Hx,Wx"};
+    map[0x57] = {"xorps|xorpd", "Vx,Hx,Wx"};
+    map[0x58] = {"addps|addpd|addss|addsd", "Vx,Hx,Wx"};
+    map[0x59] = {"mulps|mulpd|mulss|mulsd", "Vx,Hx,Wx"};
+    map[0x5A] = {"cvtps2pd|cvtpd2ps|cvtss2sd|cvtsd2ss", "Vx,Wo|Vo,Wx|Vx,Hx,Wx"};
+    map[0x5B] = {"cvtdq2ps|cvtps2dq|cvttps2dq", "Vx,Wx"};
+    map[0x5C] = {"subps|subpd|subss|subsd", "Vx,Hx,Wx"};
+    map[0x5D] = {"minps|minpd|minss|minsd", "Vx,Hx,Wx"};
+    map[0x5E] = {"divps|divpd|divss|divsd", "Vx,Hx,Wx"};
+    map[0x5F] = {"maxps|maxpd|maxss|maxsd", "Vx,Hx,Wx"};
+    constexpr const char *unpack[] = {
+        "punpcklbw", "punpcklwd", "punpckldq", "packsswb", "pcmpgtb", "pcmpgtw", "pcmpgtd", "packuswb",
+        "punpckhbw", "punpckhwd", "punpckhdq", "packssdw"
+    };
+    for (int i = 0; i < 12; i++) {
+        map[0x60 + i] = {unpack[i], "Px,Hx,Qx"};
+    }
+    map[0x6C] = {"|punpcklqdq", "Vx,Hx,Wx"};
+    map[0x6D] = {"|punpckhqdq", "Vx,Hx,Wx"};
+    map[0x6E] = {"movd/movq|movd/movq", "Pq,Ey|Vx,Ey"};
+    map[0x6F] = {"movq|movdqa|movdqu", "Pq,Qq|Vx,Wx"};
+    map[0x70] = {"pshufw|pshufd|pshufhw|pshuflw", "Pq,Qq,Ib|Vx,Wx,Ib"};
+    map[0x71] = {"||psrlw||psraw||psllw", "Hx,Nx,Ib", true};
+    map[0x72] = {"||psrld||psrad||pslld", "Hx,Nx,Ib", true};
+    map[0x73] = {"||psrlq|psrldq|||psllq|pslldq", "Hx,Nx,Ib", true};
+    map[0x74] = {"pcmpeqb", "Px,Hx,Qx"};
+    map[0x75] = {"pcmpeqw", "Px,Hx,Qx"};
+    map[0x76] = {"pcmpeqd", "Px,Hx,Qx"};
+    map[0x77] = {"emms"};
+    map[0x78] = {"vmread", "Eq,Gq"};
+    map[0x79] = {"vmwrite", "Gq,Eq"};
+    map[0x7C] = {"|haddpd||haddps", "Vx,Hx,Wx"};
+    map[0x7D] = {"|hsubpd||hsubps", "Vx,Hx,Wx"};
+    map[0x7E] = {"movd/movq|movd/movq|movq", "Ey,Pq|Ey,Vx|Vx,Wx"};
+    map[0x7F] = {"movq|movdqa|movdqu", "Qq,Pq|Wx,Vx"};
+    map[0xA0] = {"push", "fs"};
+    map[0xA1] = {"pop", "fs"};
+    map[0xA2] = {"cpuid"};
+    map[0xA3] = {"bt", "Ev,Gv"};
+    map[0xA4] = {"shld", "Ev,Gv,Ib"};
+    map[0xA5] = {"shld", "Ev,Gv,cl"};
+    map[0xA8] = {"push", "gs"};
+    map[0xA9] = {"pop", "gs"};
+    map[0xAA] = {"rsm"};
+    map[0xAB] = {"bts", "Ev,Gv"};
+    map[0xAC] = {"shrd", "Ev,Gv,Ib"};
+    map[0xAD] = {"shrd", "Ev,Gv,cl"};
+    map[0xAE] = {"fxsave|fxrstor|ldmxcsr|stmxcsr|xsave|xrstor|xsaveopt|clflush", "M", true};
+    map[0xAF] = {"imul", "Gv,Ev"};
+    map[0xB0] = {"cmpxchg", "Eb,Gb"};
+    map[0xB1] = {"cmpxchg", "Ev,Gv"};
+    map[0xB2] = {"lss", "Gv,M"};
+    map[0xB3] = {"btr", "Ev,Gv"};
+    map[0xB4] = {"lfs", "Gv,M"};
+    map[0xB5] = {"lgs", "Gv,M"};
+    map[0xB6] = {"movzx", "Gv,Eb"};
+    map[0xB7] = {"movzx", "Gv,Ew"};
+    map[0xB8] = {"||popcnt", "Gv,Ev"};
+    map[0xB9] = {"ud1", "Gv,Ev"};
+    map[0xBA] = {"||||bt|bts|btr|btc", "Ev,Ib", true};
+    map[0xBB] = {"btc", "Ev,Gv"};
+    map[0xBC] = {"bsf|bsf|tzcnt", "Gv,Ev"};
+    map[0xBD] = {"bsr|bsr|lzcnt", "Gv,Ev"};
+    map[0xBE] = {"movsx", "Gv,Eb"};
+    map[0xBF] = {"movsx", "Gv,Ew"};
+    map[0xC0] = {"xadd", "Eb,Gb"};
+    map[0xC1] = {"xadd", "Ev,Gv"};
+    map[0xC2] = {"cmpps|cmppd|cmpss|cmpsd", "Vx,Hx,Wx,Ib"};
+    map[0xC3] = {"movnti", "M,Gy"};
+    map[0xC4] = {"pinsrw", "Px,Hx,Ed,Ib"};
+    map[0xC5] = {"pextrw", "Gd,Nx,Ib"};
+    map[0xC6] = {"shufps|shufpd", "Vx,Hx,Wx,Ib"};
+    map[0xC7] = {"|cmpxchg8b/cmpxchg16b|||xrstors|xsavec|xsaves|", "M", true};
+    map[0xD0] = {"|addsubpd||addsubps", "Vx,Hx,Wx"};
+    map[0xD6] = {"|movq", "Wx,Vx"};
+    map[0xD7] = {"pmovmskb", "Gd,Nx"};
+    map[0xE6] = {"|cvttpd2dq|cvtdq2pd|cvtpd2dq", "Vo,Wx|Vo,Wx|Vx,Wo|Vo,Wx"};
+    map[0xE7] = {"movntq|movntdq", "M,Px"};
+    map[0xF0] = {"|||lddqu", "Vx,M"};
+    map[0xF7] = {"maskmovq|maskmovdqu", "Px,Nx"};
+    map[0xFF] = {"ud0", "Gv,Ev"};
+    // The rest of D0-FF are MMX and SSE2 integer operations of the same shape.
+    constexpr std::pair<int, const char *> integer[] = {
+        {0xD1, "psrlw"}, {0xD2, "psrld"}, {0xD3, "psrlq"}, {0xD4, "paddq"}, {0xD5, "pmullw"},
+        {0xD8, "psubusb"}, {0xD9, "psubusw"}, {0xDA, "pminub"}, {0xDB, "pand"}, {0xDC, "paddusb"},
+        {0xDD, "paddusw"}, {0xDE, "pmaxub"}, {0xDF, "pandn"}, {0xE0, "pavgb"}, {0xE1, "psraw"},
+        {0xE2, "psrad"}, {0xE3, "pavgw"}, {0xE4, "pmulhuw"}, {0xE5, "pmulhw"}, {0xE8, "psubsb"},
+        {0xE9, "psubsw"}, {0xEA, "pminsw"}, {0xEB, "por"}, {0xEC, "paddsb"}, {0xED, "paddsw"},
+        {0xEE, "pmaxsw"}, {0xEF, "pxor"}, {0xF1, "psllw"}, {0xF2, "pslld"}, {0xF3, "psllq"},
+        {0xF4, "pmuludq"}, {0xF5, "pmaddwd"}, {0xF6, "psadbw"}, {0xF8, "psubb"}, {0xF9, "psubw"},
+        {0xFA, "psubd"}, {0xFB, "psubq"}, {0xFC, "paddb"}, {0xFD, "paddw"}, {0xFE, "paddd"},
+    };
+    for (auto [opcode, name]: integer) {
+        map[opcode] = {name, "Px,Hx,Qx"};
+    }
+    return map;
+}();
+
+constexpr auto ThreeByteMap38 = [] {
+    std::array<OpcodeEntry, 256> map{};
+    constexpr const char *horizontal[] = {
+        "pshufb", "phaddw", "phaddd", "phaddsw", "pmaddubsw", "phsubw", "phsubd", "phsubsw",
+        "psignb", "psignw", "psignd", "pmulhrsw"
+    };
+    for (int i = 0; i < 12; i++) {
+        map[i] = {horizontal[i], "Px,Hx,Qx"};
+    }
+    constexpr const char *extend[] = {"bw", "bd", "bq", "wd", "wq", "dq"};
+    constexpr const char *signExtend[] = {"pmovsxbw", "pmovsxbd", "pmovsxbq", "pmovsxwd", "pmovsxwq", "pmovsxdq"};
+    constexpr const char *zeroExtend[] = {"pmovzxbw", "pmovzxbd", "pmovzxbq", "pmovzxwd", "pmovzxwq", "pmovzxdq"};
+    for (size_t i = 0; i < std::size(extend); i++) {
+        map[0x20 + i] = {signExtend[i], "Vx,Wo"};
+        map[0x30 + i] = {zeroExtend[i], "Vx,Wo"};
+    }
+    map[0x0C] = {"permilps", "Vx,Hx,Wx"};
+    map[0x0D] = {"permilpd", "Vx,Hx,Wx"};
+    map[0x0E] = {"testps", "Vx,Wx"};
+    map[0x0F] = {"testpd", "Vx,Wx"};
+    map[0x10] = {"pblendvb", "Vx,Wx,xmm0"};
+    map[0x13] = {"cvtph2ps", "Vx,Wo"};
+    map[0x14] = {"blendvps", "Vx,Wx,xmm0"};
+    map[0x15] = {"blendvpd", "Vx,Wx,xmm0"};
+    map[0x16] = {"permps", "Vx,Hx,Wx"};
+    map[0x17] = {"ptest", "Vx,Wx"};
+    map[0x18] = {"broadcastss", "Vx,Wo"};
+    map[0x19] = {"broadcastsd", "Vx,Wo"};
+    map[0x1A] = {"broadcastf128", "Vx,M"};
+    map[0x1C] = {"pabsb", "Px,Qx"};
+    map[0x1D] = {"pabsw", "Px,Qx"};
+    map[0x1E] = {"pabsd", "Px,Qx"};
+    map[0x28] = {"pmuldq", "Vx,Hx,Wx"};
+    map[0x29] = {"pcmpeqq", "Vx,Hx,Wx"};
+    map[0x2A] = {"movntdqa", "Vx,M"};
+    map[0x2B] = {"packusdw", "Vx,Hx,Wx"};
+    map[0x2C] = {"maskmovps", "Vx,Hx,M"};
+    map[0x2D] = {"maskmovpd", "Vx,Hx,M"};
+    map[0x2E] = {"maskmovps", "M,Hx,Vx"};
+    map[0x2F] = {"maskmovpd", "M,Hx,Vx"};
+    map[0x36] = {"permd", "Vx,Hx,Wx"};
+    map[0x37] = {"pcmpgtq", "Vx,Hx,Wx"};
+    map[0x38] = {"pminsb", "Vx,Hx,Wx"};
+    map[0x39] = {"pminsd", "Vx,Hx,Wx"};
+    map[0x3A] = {"pminuw", "Vx,Hx,Wx"};
+    map[0x3B] = {"pminud", "Vx,Hx,Wx"};
+    map[0x3C] = {"pmaxsb", "Vx,Hx,Wx"};
+    map[0x3D] = {"pmaxsd", "Vx,Hx,Wx"};
+    map[0x3E] = {"pmaxuw", "Vx,Hx,Wx"};
+    map[0x3F] = {"pmaxud", "Vx,Hx,Wx"};
+    map[0x40] = {"pmulld", "Vx,Hx,Wx"};
+    map[0x41] = {"phminposuw", "Vx,Wx"};
+    map[0x45] = {"psrlvd/psrlvq", "Vx,Hx,Wx"};
+    map[0x46] = {"psravd", "Vx,Hx,Wx"};
+    map[0x47] = {"psllvd/psllvq", "Vx,Hx,Wx"};
+    map[0x58] = {"pbroadcastd", "Vx,Wo"};
+    map[0x59] = {"pbroadcastq", "Vx,Wo"};
+    map[0x5A] = {"broadcasti128", "Vx,M"};
+    map[0x78] = {"pbroadcastb", "Vx,Wo"};
+    map[0x79] = {"pbroadcastw", "Vx,Wo"};
+    map[0x8C] = {"pmaskmovd/pmaskmovq", "Vx,Hx,M"};
+    map[0x8E] = {"pmaskmovd/pmaskmovq", "M,Hx,Vx"};
+    map[0x90] = {"pgatherdd/pgatherdq", "Vx,X,Hx"};
+    map[0x91] = {"pgatherqd/pgatherqq", "Vx,X,Hx"};
+    map[0x92] = {"gatherdps/gatherdpd", "Vx,X,Hx"};
+    map[0x93] = {"gatherqps/gatherqpd", "Vx,X,Hx"};
+    constexpr const char *fusedPacked[] = {
+        "fmaddsub{}ps/fmaddsub{}pd", "fmsubadd{}ps/fmsubadd{}pd", "fmadd{}ps/fmadd{}pd", "fmadd{}ss/fmadd{}sd",
+        "fmsub{}ps/fmsub{}pd", "fmsub{}ss/fmsub{}sd", "fnmadd{}ps/fnmadd{}pd", "fnmadd{}ss/fnmadd{}sd",
+        "fnmsub{}ps/fnmsub{}pd", "fnmsub{}ss/fnmsub{}sd"
+    };
+    // Filled in with the operand order (132, 213, 231) when formatting.
+    for (int i = 0; i < 10; i++) {
+        map[0x96 + i] = {fusedPacked[i], "Vx,Hx,Wx"};
+        map[0xA6 + i] = {fusedPacked[i], "Vx,Hx,Wx"};
+        map[0xB6 + i] = {fusedPacked[i], "Vx,Hx,Wx"};
+    }
+    map[0xC8] = {"sha1nexte", "Vx,Wx"};
+    map[0xC9] = {"sha1msg1", "Vx,Wx"};
+    map[0xCA] = {"sha1msg2", "Vx,Wx"};
+    map[0xCB] = {"sha256rnds2", "Vx,Wx,xmm0"};
+    map[0xCC] = {"sha256msg1", "Vx,Wx"};
+    map[0xCD] = {"sha256msg2", "Vx,Wx"};
+    map[0xCF] = {"gf2p8mulb", "Vx,Hx,Wx"};
+    map[0xDB] = {"aesimc", "Vx,Wx"};
+    map[0xDC] = {"aesenc", "Vx,Hx,Wx"};
+    map[0xDD] = {"aesenclast", "Vx,Hx,Wx"};
+    map[0xDE] = {"aesdec", "Vx,Hx,Wx"};
+    map[0xDF] = {"aesdeclast", "Vx,Hx,Wx"};
+    map[0xF0] = {"movbe|movbe||crc32", "Gv,M|Gv,M|Gv,M|Gd,Eb"};
+    map[0xF1] = {"movbe|movbe||crc32", "M,Gv|M,Gv|M,Gv|Gy,Ev"};
+    map[0xF2] = {"andn", "Gy,By,Ey"};
+    map[0xF3] = {"|blsr|blsmsk|blsi", "By,Ey", true};
+    map[0xF5] = {"bzhi||pext|pdep", "Gy,Ey,By|Gy,Ey,By|Gy,By,Ey"};
+    map[0xF6] = {"|adcx|adox|mulx", "Gy,Ey|Gy,Ey|Gy,Ey|Gy,By,Ey"};
+    map[0xF7] = {"bextr|shlx|sarx|shrx", "Gy,Ey,By"};
+    return map;
+}();
+
+constexpr auto ThreeByteMap3A = [] {
+    std::array<OpcodeEntry, 256> map{};
+    map[0x00] = {"permq", "Vx,Wx,Ib"};
+    map[0x01] = {"permpd", "Vx,Wx,Ib"};
+    map[0x02] = {"pblendd", "Vx,Hx,Wx,Ib"};
+    map[0x04] = {"permilps", "Vx,Wx,Ib"};
+    map[0x05] = {"permilpd", "Vx,Wx,Ib"};
+    map[0x06] = {"perm2f128", "Vx,Hx,Wx,Ib"};
+    map[0x08] = {"roundps", "Vx,Wx,Ib"};
+    map[0x09] = {"roundpd", "Vx,Wx,Ib"};
+    map[0x0A] = {"roundss", "Vx,Hx,Wx,Ib"};
+    map[0x0B] = {"roundsd", "Vx,Hx,Wx,Ib"};
+    map[0x0C] = {"blendps", "Vx,Hx,Wx,Ib"};
+    map[0x0D] = {"blendpd", "Vx,Hx,Wx,Ib"};
+    map[0x0E] = {"pblendw", "Vx,Hx,Wx,Ib"};
+    map[0x0F] = {"palignr", "Px,Hx,Qx,Ib"};
+    map[0x14] = {"pextrb", "Ed,Vx,Ib"};
+    map[0x15] = {"pextrw", "Ed,Vx,Ib"};
+    map[0x16] = {"pextrd/pextrq", "Ey,Vx,Ib"};
+    map[0x17] = {"extractps", "Ed,Vx,Ib"};
+    map[0x18] = {"insertf128", "Vx,Hx,Wo,Ib"};
+    map[0x19] = {"extractf128", "Wo,Vx,Ib"};
+    map[0x1D] = {"cvtps2ph", "Wo,Vx,Ib"};
+    map[0x20] = {"pinsrb", "Vx,Hx,Ed,Ib"};
+    map[0x21] = {"insertps", "Vx,Hx,Wx,Ib"};
+    map[0x22] = {"pinsrd/pinsrq", "Vx,Hx,Ey,Ib"};
+    map[0x38] = {"inserti128", "Vx,Hx,Wo,Ib"};
+    map[0x39] = {"extracti128", "Wo,Vx,Ib"};
+    map[0x40] = {"dpps", "Vx,Hx,Wx,Ib"};
+    map[0x41] = {"dppd", "Vx,Hx,Wx,Ib"};
+    map[0x42] = {"mpsadbw", "Vx,Hx,Wx,Ib"};
+    map[0x44] = {"pclmulqdq", "Vx,Hx,Wx,Ib"};
+    map[0x46] = {"perm2i128", "Vx,Hx,Wx,Ib"};
+    map[0x4A] = {"blendvps", "Vx,Hx,Wx,Lx"};
+    map[0x4B] = {"blendvpd", "Vx,Hx,Wx,Lx"};
+    map[0x4C] = {"pblendvb", "Vx,Hx,Wx,Lx"};
+    map[0x60] = {"pcmpestrm", "Vx,Wx,Ib"};
+    map[0x61] = {"pcmpestri", "Vx,Wx,Ib"};
+    map[0x62] = {"pcmpistrm", "Vx,Wx,Ib"};
+    map[0x63] = {"pcmpistri", "Vx,Wx,Ib"};
+    map[0xCC] = {"sha1rnds4", "Vx,Wx,Ib"};
+    map[0xCE] = {"gf2p8affineqb", "Vx,Hx,Wx,Ib"};
+    map[0xCF] = {"gf2p8affineinvqb", "Vx,Hx,Wx,Ib"};
+    map[0xDF] = {"aeskeygenassist", "Vx,Wx,Ib"};
+    map[0xF0] = {"|||rorx", "Gy,Ey,Ib"};
+    return map;
+}();
+
+// x87 escapes D8-DF, indexed by opcode - D8 and ModRM.reg. Memory forms name the operand
+// size per reg, '-' for none.
+constexpr const char *X87MemoryNames[] = {
+    "fadd|fmul|fcom|fcomp|fsub|fsubr|fdiv|fdivr",
+    "fld||fst|fstp|fldenv|fldcw|fnstenv|fnstcw",
+    "fiadd|fimul|ficom|ficomp|fisub|fisubr|fidiv|fidivr",
+    "fild|fisttp|fist|fistp||fld||fstp",
+    "fadd|fmul|fcom|fcomp|fsub|fsubr|fdiv|fdivr",
+    "fld|fisttp|fst|fstp|frstor||fnsave|fnstsw",
+    "fiadd|fimul|ficom|ficomp|fisub|fisubr|fidiv|fidivr",
+    "fild|fisttp|fist|fistp|fbld|fild|fbstp|fistp",
+};
+constexpr const char *X87MemorySizes[] = {
+    "dddddddd", "d-dd-w-w", "dddddddd", "dddd-t-t", "qqqqqqqq", "qqqq---w", "wwwwwwww", "wwwwtqtq"
+};
+constexpr const char *X87RegisterNames[] = {
+    "fadd|fmul|fcom|fcomp|fsub|fsubr|fdiv|fdivr",
+    "fld|fxch",
+    "fcmovb|fcmove|fcmovbe|fcmovu",
+    "fcmovnb|fcmovne|fcmovnbe|fcmovnu||fucomi|fcomi",
+    "fadd|fmul|fcom|fcomp|fsubr|fsub|fdivr|fdiv",
+    "ffree||fst|fstp|fucom|fucomp",
+    "faddp|fmulp|||fsubrp|fsubp|fdivrp|fdivp",
+    "|||||fucomip|fcomip",
+};
+constexpr const char *X87RegisterOperands[] = {
+    "st(0),Tx", "Tx", "st(0),Tx", "st(0),Tx", "Tx,st(0)", "Tx", "Tx,st(0)", "st(0),Tx"
+};
+
+// x87 register forms named by the whole ModRM byte.
+static const char *X87Special(uint8_t opcode, uint8_t modrm) {
+    constexpr const char *constants[] = {
+        "fchs", "fabs", nullptr, nullptr, "ftst", "fxam", nullptr, nullptr,
+        "fld1", "fldl2t", "fldl2e", "fldpi", "fldlg2", "fldln2", "fldz", nullptr,
+        "f2xm1", "fyl2x", "fptan", "fpatan", "fxtract", "fprem1", "fdecstp", "fincstp",
+        "fprem", "fyl2xp1", "fsqrt", "fsincos", "frndint", "fscale", "fsin", "fcos",
+    };
+    switch (opcode << 8 | modrm) {
+        case 0xD9D0: return "fnop";
+        case 0xDAE9: return "fucompp";
+        case 0xDBE2: return "fnclex";
+        case 0xDBE3: return "fninit";
+        case 0xDED9: return "fcompp";
+        default: break;
+    }
+    if (opcode == 0xD9 && modrm >= 0xE0) {
+        return constants[modrm - 0xE0];
+    }
+    return nullptr;
+}
+
+// 0F 01 with a register ModRM, named by the whole byte.
+static const char *SystemSpecial(uint8_t modrm) {
+    switch (modrm) {
+        case 0xC1: return "vmcall";
+        case 0xC2: return "vmlaunch";
+        case 0xC3: return "vmresume";
+        case 0xC4: return "vmxoff";
+        case 0xC8: return "monitor";
+        case 0xC9: return "mwait";
+        case 0xCA: return "clac";
+        case 0xCB: return "stac";
+        case 0xD0: return "xgetbv";
+        case 0xD1: return "xsetbv";
+        case 0xD4: return "vmfunc";
+        case 0xD5: return "xend";
+        case 0xD6: return "xtest";
+        case 0xEE: return "rdpkru";
+        case 0xEF: return "wrpkru";
+        case 0xF8: return "swapgs";
+        case 0xF9: return "rdtscp";
+        default: return nullptr;
+    }
+}
+
+constexpr const char *Registers64[] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+constexpr const char *Registers32[] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+constexpr const char *Registers16[] = {
+    "ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w"
+};
+constexpr const char *Registers8[] = {
+    "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+    "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"
+};
+constexpr const char *LegacyHighBytes[] = {"ah", "ch", "dh", "bh"};
+constexpr const char *SegmentRegisters[] = {"es", "cs", "ss", "ds", "fs", "gs"};
+
+// The index-th of the separated alternatives, empty if there are fewer. Without a separator
+// the one alternative stands for every index.
+static std::string_view Pick(std::string_view list, size_t index, char separator = '|') {
+    if (list.find(separator) == std::string_view::npos) {
+        return list;
+    }
+    size_t start = 0;
+    for (size_t i = 0; i < index; i++) {
+        start = list.find(separator, start);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        start++;
+    }
+    return list.substr(start, list.find(separator, start) - start);
+}
+
+static std::string_view PickOperands(std::string_view list, size_t index) {
+    size_t count = static_cast<size_t>(std::ranges::count(list, '|')) + 1;
+    return Pick(list, std::min(index, count - 1));
+}
+
+static std::string Hex(uint64_t value) {
+    return std::format("0x{:X}", value);
+}
+
+static std::string SignedHex(int64_t value) {
+    return value < 0 ? std::format("-0x{:X}", 0 - static_cast<uint64_t>(value)) : Hex(static_cast<uint64_t>(value));
+}
+
+class InstructionDecoder {
+public:
+    InstructionDecoder(std::span<const std::byte> code, uint64_t address)
+        : m_Code(code.first(std::min(code.size(), MaxInstructionLength))), m_Address(address) {
+    }
+
+    DecodedInstruction Decode();
+
+private:
+    enum class Encoding : uint8_t {
+        Legacy,
+        Vex,
+        Evex,
+        Xop,
+    };
+
+    struct Immediate {
+        uint64_t Value;
+        size_t Size;
+    };
+
+    bool Fetch(uint8_t &value) {
+        if (m_Position >= m_Code.size()) {
+            return false;
+        }
+        value = static_cast<uint8_t>(m_Code[m_Position++]);
+        return true;
+    }
+
+    bool FetchValue(uint64_t &value, size_t size) {
+        if (m_Position + size > m_Code.size()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < size; i++) {
+            value |= static_cast<uint64_t>(m_Code[m_Position + i]) << (i * 8);
+        }
+        m_Position += size;
+        return true;
+    }
+
+    static int64_t SignExtend(uint64_t value, size_t size) {
+        size_t shift = 64 - size * 8;
+        return size >= 8 ? static_cast<int64_t>(value) : static_cast<int64_t>(value << shift) >> shift;
+    }
+
+    bool ReadPrefixes(uint8_t &opcode);
+    bool ReadVex(uint8_t kind);
+    bool ReadModRm();
+    bool ReadImmediates(std::span<const std::string_view> operands);
+
+    [[nodiscard]] bool W() const { return m_Rex & 8; }
+    [[nodiscard]] uint8_t RegIndex() const { return m_Reg | (m_Rex & 4 ? 8 : 0); }
+    [[nodiscard]] uint8_t RmIndex() const { return m_Rm | (m_Rex & 1 ? 8 : 0); }
+
+    [[nodiscard]] size_t PrefixIndex() const {
+        if (m_Encoding != Encoding::Legacy) {
+            return m_VexPrefix;
+        }
+        return m_Repeat == 0xF3 ? 2 : m_Repeat == 0xF2 ? 3 : m_OperandSize ? 1 : 0;
+    }
+
+    [[nodiscard]] int OperandBits() const {
+        return W() ? 64 : m_OperandSize ? 16 : 32;
+    }
+
+    [[nodiscard]] int SizeBits(char size) const {
+        switch (size) {
+            case 'b': return 8;
+            case 'w': return 16;
+            case 'd': return 32;
+            case 'q': return 64;
+            case 't': return 80;
+            case 'v': return OperandBits();
+            case 'y': return W() ? 64 : 32;
+            case 'z': return OperandBits() == 16 ? 16 : 32;
+            default: return 0;
+        }
+    }
+
+    [[nodiscard]] std::string GeneralRegister(int bits, uint8_t index) const;
+    [[nodiscard]] std::string VectorRegister(uint8_t index, char size = 'x') const;
+    [[nodiscard]] std::string MmxRegister(uint8_t index, bool wide) const;
+    [[nodiscard]] std::string Memory(int bits, bool vsib) const;
+    [[nodiscard]] std::string Operand(std::string_view code, size_t &immediate, DecodedInstruction &result) const;
+
+    std::span<const std::byte> m_Code;
+    uint64_t m_Address;
+    size_t m_Position = 0;
+
+    bool m_OperandSize = false;
+    bool m_AddressSize = false;
+    bool m_Lock = false;
+    uint8_t m_Repeat = 0;
+    uint8_t m_Segment = 0;
+    uint8_t m_Rex = 0;
+
+    Encoding m_Encoding = Encoding::Legacy;
+    uint8_t m_Map = 0; // 0 one byte, 1 0F, 2 0F 38, 3 0F 3A, 5/6 EVEX, 8-10 XOP
+    uint8_t m_Opcode = 0;
+    uint8_t m_Vvvv = 0;
+    uint8_t m_VectorLength = 0;
+    uint8_t m_VexPrefix = 0;
+
+    bool m_HasModRm = false;
+    uint8_t m_ModRm = 0;
+    uint8_t m_Mod = 0;
+    uint8_t m_Reg = 0;
+    uint8_t m_Rm = 0;
+    bool m_RipRelative = false;
+    std::optional<uint8_t> m_Base;
+    std::optional<uint8_t> m_Index;
+    uint8_t m_Scale = 1;
+    int64_t m_Displacement = 0;
+
+    std::vector<Immediate> m_Immediates;
+};
+
+bool InstructionDecoder::ReadPrefixes(uint8_t &opcode) {
+    while (true) {
+        uint8_t byte;
+        if (!Fetch(byte)) {
+            return false;
+        }
+        switch (byte) {
+            case 0xF0:
+                m_Lock = true;
+                break;
+            case 0xF2:
+            case 0xF3:
+                m_Repeat = byte;
+                break;
+            case 0x26:
+            case 0x2E:
+            case 0x36:
+            case 0x3E:
+            case 0x64:
+            case 0x65:
+                m_Segment = byte;
+                break;
+            case 0x66:
+                m_OperandSize = true;
+                break;
+            case 0x67:
+                m_AddressSize = true;
+                break;
+            default:
+                if ((byte & 0xF0) == 0x40) {
+                    m_Rex = byte;
+                    continue;
+                }
+                opcode = byte;
+                return true;
+        }
+        // A REX only counts right before the opcode.
+        m_Rex = 0;
+    }
+}
+
+bool InstructionDecoder::ReadVex(uint8_t kind) {
+    if (m_Rex != 0 || m_OperandSize || m_Repeat != 0 || m_Lock) {
+        return false;
+    }
+    uint8_t first, second, third;
+    if (!Fetch(first)) {
+        return false;
+    }
+    if (kind == 0xC5) {
+        m_Encoding = Encoding::Vex;
+        m_Rex = 0x40 | (first & 0x80 ? 0 : 4);
+        m_Map = 1;
+        m_Vvvv = ~first >> 3 & 0xF;
+        m_VectorLength = first >> 2 & 1;
+        m_VexPrefix = first & 3;
+        return true;
+    }
+    if (!Fetch(second)) {
+        return false;
+    }
+    // R, X and B are stored inverted, like vvvv.
+    m_Rex = 0x40 | (~first >> 5 & 7) | (second & 0x80 ? 8 : 0);
+    m_Vvvv = ~second >> 3 & 0xF;
+    m_VexPrefix = second & 3;
+    if (kind == 0x62) {
+        m_Encoding = Encoding::Evex;
+        m_Map = first & 7;
+        if (!Fetch(third) || (second & 4) == 0 || m_Map == 0 || m_Map == 4 || m_Map == 7) {
+            return false;
+        }
+        m_VectorLength = third >> 5 & 3;
+        return true;
+    }
+    m_Encoding = kind == 0xC4 ? Encoding::Vex : Encoding::Xop;
+    m_Map = first & 0x1F;
+    m_VectorLength = second >> 2 & 1;
+    return kind == 0xC4 ? m_Map >= 1 && m_Map <= 3 : m_Map >= 8 && m_Map <= 10;
+}
+
+bool InstructionDecoder::ReadModRm() {
+    m_HasModRm = true;
+    if (!Fetch(m_ModRm)) {
+        return false;
+    }
+    m_Mod = m_ModRm >> 6;
+    m_Reg = m_ModRm >> 3 & 7;
+    m_Rm = m_ModRm & 7;
+    if (m_Mod == 3) {
+        return true;
+    }
+
+    size_t displacementSize = m_Mod == 1 ? 1 : m_Mod == 2 ? 4 : 0;
+    if (m_Rm == 4) {
+        uint8_t sib;
+        if (!Fetch(sib)) {
+            return false;
+        }
+        m_Scale = static_cast<uint8_t>(1 << (sib >> 6));
+        uint8_t index = (sib >> 3 & 7) | (m_Rex & 2 ? 8 : 0);
+        if (index != 4) {
+            m_Index = index;
+        }
+        if ((sib & 7) == 5 && m_Mod == 0) {
+            displacementSize = 4;
+        } else {
+            m_Base = (sib & 7) | (m_Rex & 1 ? 8 : 0);
+        }
+    } else if (m_Rm == 5 && m_Mod == 0) {
+        m_RipRelative = true;
+        displacementSize = 4;
+    } else {
+        m_Base = RmIndex();
+    }
+
+    uint64_t displacement = 0;
+    if (!FetchValue(displacement, displacementSize)) {
+        return false;
+    }
+    m_Displacement = displacementSize == 0 ? 0 : SignExtend(displacement, displacementSize);
+    return true;
+}
+
+bool InstructionDecoder::ReadImmediates(std::span<const std::string_view> operands) {
+    for (std::string_view code: operands) {
+        size_t size = 0;
+        if (code == "O") {
+            size = m_AddressSize ? 4 : 8;
+        } else if (code[0] == 'I' || code[0] == 'J') {
+            switch (code[1]) {
+                case 'b':
+                case 's':
+                    size = 1;
+                    break;
+                case 'w':
+                    size = 2;
+                    break;
+                case 'z':
+                    size = code[0] == 'J' || OperandBits() != 16 ? 4 : 2;
+                    break;
+                case 'v':
+                    size = OperandBits() / 8;
+                    break;
+                default:
+                    break;
+            }
+        } else if (code[0] == 'L') {
+            size = 1;
+        }
+        if (size == 0) {
+            continue;
+        }
+        uint64_t value;
+        if (!FetchValue(value, size)) {
+            return false;
+        }
+        m_Immediates.push_back({value, size});
+    }
+    return true;
+}
+
+std::string InstructionDecoder::GeneralRegister(int bits, uint8_t index) const {
+    switch (bits) {
+        case 8:
+            return m_Rex == 0 && index >= 4 && index < 8 ? LegacyHighBytes[index - 4] : Registers8[index];
+        case 16:
+            return Registers16[index];
+        case 32:
+            return Registers32[index];
+        default:
+            return Registers64[index];
+    }
+}
+
+std::string InstructionDecoder::VectorRegister(uint8_t index, char size) const {
+    const char *kind = size == 'o' ? "xmm" : m_VectorLength == 2 ? "zmm" : m_VectorLength == 1 ? "ymm" : "xmm";
+    return std::format("{}{}", kind, index);
+}
+
+std::string InstructionDecoder::MmxRegister(uint8_t index, bool wide) const {
+    return wide ? VectorRegister(index) : std::format("mm{}", index & 7);
+}
+
+std::string InstructionDecoder::Memory(int bits, bool vsib) const {
+    std::string text;
+    switch (bits) {
+        case 8: text = "byte ptr ";
+            break;
+        case 16: text = "word ptr ";
+            break;
+        case 32: text = "dword ptr ";
+            break;
+        case 64: text = "qword ptr ";
+            break;
+        case 80: text = "tbyte ptr ";
+            break;
+        default: break;
+    }
+    if (m_Segment == 0x64 || m_Segment == 0x65) {
+        text += m_Segment == 0x64 ? "fs:" : "gs:";
+    }
+    text += '[';
+    if (m_RipRelative) {
+        uint64_t target = m_Address + m_Position + static_cast<uint64_t>(m_Displacement);
+        return text + Hex(m_AddressSize ? target & 0xFFFFFFFF : target) + ']';
+    }
+
+    const char *const *registers = m_AddressSize ? Registers32 : Registers64;
+    bool first = true;
+    if (m_Base) {
+        text += registers[*m_Base];
+        first = false;
+    }
+    if (m_Index || vsib) {
+        uint8_t index = m_Index.value_or(4);
+        text += first ? "" : "+";
+        text += vsib ? VectorRegister(index) : registers[index];
+        if (m_Scale > 1) {
+            text += std::format("*{}", m_Scale);
+        }
+        first = false;
+    }
+    if (first) {
+        text += Hex(static_cast<uint32_t>(m_Displacement));
+    } else if (m_Displacement != 0) {
+        text += m_Displacement < 0 ? "-" : "+";
+        text += Hex(m_Displacement < 0 ? 0 - static_cast<uint64_t>(m_Displacement)
+                                       : static_cast<uint64_t>(m_Displacement));
+    }
+    return text + ']';
+}
+
+std::string InstructionDecoder::Operand(std::string_view code, size_t &immediate,
+                                        DecodedInstruction &result) const {
+    char size = code.size() > 1 ? code[1] : 0;
+    bool wide = m_Encoding != Encoding::Legacy || m_OperandSize;
+    switch (code[0]) {
+        case 'E':
+            return m_Mod == 3 ? GeneralRegister(SizeBits(size), RmIndex()) : Memory(SizeBits(size), false);
+        case 'G':
+            return GeneralRegister(SizeBits(size), RegIndex());
+        case 'R':
+            return GeneralRegister(SizeBits(size), RmIndex());
+        case 'B':
+            return GeneralRegister(SizeBits(size), m_Vvvv);
+        case 'Z':
+            return GeneralRegister(SizeBits(size), (m_Opcode & 7) | (m_Rex & 1 ? 8 : 0));
+        case 'M':
+            return Memory(SizeBits(size), false);
+        case 'X':
+            return Memory(0, true);
+        case 'S':
+            return m_Reg < std::size(SegmentRegisters) ? SegmentRegisters[m_Reg] : "?";
+        case 'C':
+            return std::format("cr{}", RegIndex());
+        case 'D':
+            return std::format("dr{}", RegIndex());
+        case 'T':
+            return std::format("st({})", m_Rm);
+        case 'V':
+            return VectorRegister(RegIndex(), size);
+        case 'U':
+            return VectorRegister(RmIndex(), size);
+        case 'W':
+            return m_Mod == 3 ? VectorRegister(RmIndex(), size) : Memory(0, false);
+        case 'H':
+            return VectorRegister(m_Vvvv, size);
+        case 'P':
+            return MmxRegister(RegIndex(), wide && size == 'x');
+        case 'N':
+            return MmxRegister(RmIndex(), wide && size == 'x');
+        case 'Q':
+            return m_Mod == 3 ? MmxRegister(RmIndex(), wide && size == 'x') : Memory(0, false);
+        case 'L':
+            return VectorRegister(static_cast<uint8_t>(m_Immediates[immediate++].Value >> 4));
+        case 'O': {
+            const Immediate &value = m_Immediates[immediate++];
+            std::string segment = m_Segment == 0x64 ? "fs:" : m_Segment == 0x65 ? "gs:" : "";
+            return std::format("{}[{}]", segment, Hex(value.Value));
+        }
+        case 'J': {
+            const Immediate &value = m_Immediates[immediate++];
+            uint64_t target = m_Address + m_Position + static_cast<uint64_t>(SignExtend(value.Value, value.Size));
+            result.BranchTarget = target;
+            return Hex(target);
+        }
+        case 'I': {
+            const Immediate &value = m_Immediates[immediate++];
+            // Sign extended immediates read better as negative numbers.
+            if (size == 's' || (size == 'z' && OperandBits() == 64)) {
+                return SignedHex(SignExtend(value.Value, value.Size));
+            }
+            return Hex(value.Value);
+        }
+        default:
+            break;
+    }
+    if (code == "rax") {
+        return GeneralRegister(OperandBits(), 0);
+    }
+    if (code == "eax") {
+        return m_OperandSize ? "ax" : "eax";
+    }
+    return std::string(code);
+}
+
+DecodedInstruction InstructionDecoder::Decode() {
+    uint8_t opcode;
+    if (!ReadPrefixes(opcode)) {
+        return {};
+    }
+
+    const OpcodeEntry *entry = nullptr;
+    if (opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62 ||
+        (opcode == 0x8F && m_Position < m_Code.size() && (static_cast<uint8_t>(m_Code[m_Position]) & 0x38) != 0)) {
+        if (!ReadVex(opcode) || !Fetch(m_Opcode)) {
+            return {};
+        }
+        entry = m_Map == 1 ? &TwoByteMap[m_Opcode] : m_Map == 2 ? &ThreeByteMap38[m_Opcode]
+                : m_Map == 3 ? &ThreeByteMap3A[m_Opcode] : nullptr;
+    } else if (opcode == 0x0F) {
+        uint8_t second;
+        if (!Fetch(second)) {
+            return {};
+        }
+        if (second == 0x38 || second == 0x3A) {
+            m_Map = second == 0x38 ? 2 : 3;
+            if (!Fetch(m_Opcode)) {
+                return {};
+            }
+            entry = m_Map == 2 ? &ThreeByteMap38[m_Opcode] : &ThreeByteMap3A[m_Opcode];
+        } else {
+            m_Map = 1;
+            m_Opcode = second;
+            entry = &TwoByteMap[second];
+        }
+    } else {
+        m_Opcode = opcode;
+        entry = &OneByteMap[opcode];
+        if (entry->Names == nullptr) {
+            return {};
+        }
+    }
+
+    // ModRM presence follows from the operands. Opcodes without a name in the escaped maps
+    // still get their length right: all of 0F 38 and 0F 3A, and nearly all of 0F, have one.
+    bool known = entry != nullptr && entry->Names != nullptr;
+    std::string_view allOperands = known ? entry->Operands : "";
+    // VEX forms of the general purpose 0F opcodes are the AVX-512 mask register instructions.
+    if (m_Encoding != Encoding::Legacy && m_Map == 1 && m_Opcode != 0x77 &&
+        allOperands.find_first_of("VWUHPQNLX") == std::string_view::npos) {
+        known = false;
+        allOperands = {};
+    }
+    bool hasModRm = known && (entry->Group || allOperands.find_first_of("EGMRSCDTVUWPQNX") != std::string_view::npos);
+    if (m_Encoding != Encoding::Legacy) {
+        hasModRm = !(m_Encoding == Encoding::Vex && m_Map == 1 && m_Opcode == 0x77);
+    } else if (!known) {
+        hasModRm = true;
+    }
+    if (hasModRm && !ReadModRm()) {
+        return {};
+    }
+
+    std::string_view name;
+    std::string_view operands;
+    if (known) {
+        size_t pick = entry->Group ? m_Reg : PrefixIndex();
+        name = Pick(entry->Names, pick);
+        operands = PickOperands(entry->Operands, pick);
+    }
+
+    // Encodings the tables cannot express.
+    if (m_Map == 0 && m_Opcode >= 0xD8 && m_Opcode <= 0xDF) {
+        size_t escape = m_Opcode - 0xD8;
+        if (m_Mod != 3) {
+            name = Pick(X87MemoryNames[escape], m_Reg);
+            char size = X87MemorySizes[escape][m_Reg];
+            constexpr std::string_view sized[] = {"M", "Mw", "Md", "Mq", "Mt"};
+            operands = sized[std::string_view("-wdqt").find(size)];
+        } else if (const char *special = X87Special(m_Opcode, m_ModRm)) {
+            name = special;
+            operands = "";
+        } else if (m_Opcode == 0xDF && m_ModRm == 0xE0) {
+            name = "fnstsw";
+            operands = "ax";
+        } else {
+            name = Pick(X87RegisterNames[escape], m_Reg);
+            operands = X87RegisterOperands[escape];
+            if (m_Opcode == 0xD9 && m_Reg >= 2) {
+                name = {};
+            }
+        }
+    } else if (m_Map == 0 && m_Opcode == 0x90) {
+        if (m_Rex & 1) {
+            name = "xchg";
+            operands = "Zv,rax";
+        } else if (m_Repeat == 0xF3) {
+            name = "pause";
+        }
+    } else if (m_Map == 1 && (m_Opcode == 0x12 || m_Opcode == 0x16) && m_Mod == 3 && PrefixIndex() == 0) {
+        name = m_Opcode == 0x12 ? "movhlps" : "movlhps";
+        operands = "Vx,Hx,Ux";
+    } else if (m_Map == 1 && m_Opcode == 0x01 && m_Mod == 3) {
+        name = SystemSpecial(m_ModRm) ? SystemSpecial(m_ModRm) : "";
+        operands = "";
+    } else if (m_Map == 1 && m_Opcode == 0xAE && m_Mod == 3) {
+        if (m_Repeat == 0xF3 && m_Reg < 4) {
+            constexpr const char *bases[] = {"rdfsbase", "rdgsbase", "wrfsbase", "wrgsbase"};
+            name = bases[m_Reg];
+            operands = "Ry";
+        } else {
+            name = m_Reg == 5 ? "lfence" : m_Reg == 6 ? "mfence" : m_Reg == 7 ? "sfence" : "";
+            operands = "";
+        }
+    } else if (m_Map == 1 && m_Opcode == 0xC7 && m_Mod == 3) {
+        name = m_Reg == 6 ? "rdrand" : m_Reg == 7 ? (m_Repeat == 0xF3 ? "rdpid" : "rdseed") : "";
+        operands = m_Repeat == 0xF3 ? "Rq" : "Rv";
+    } else if (m_Map == 1 && m_Opcode == 0x1E && m_Repeat == 0xF3 && (m_ModRm == 0xFA || m_ModRm == 0xFB)) {
+        name = m_ModRm == 0xFA ? "endbr64" : "endbr32";
+        operands = "";
+    } else if (m_Encoding == Encoding::Vex && m_Map == 1 && m_Opcode == 0x77) {
+        name = m_VectorLength ? "zeroall" : "zeroupper";
+    }
+
+    if (known && name.empty()) {
+        // EVEX reuses opcodes under prefixes the VEX and legacy forms leave invalid.
+        if (m_Encoding != Encoding::Evex) {
+            return {};
+        }
+        known = false;
+        operands = {};
+    }
+
+    std::vector<std::string_view> codes;
+    for (auto part: std::views::split(operands, ',')) {
+        std::string_view code(part.begin(), part.end());
+        // VEX.vvvv has no legacy encoding, the destination doubles as the first source.
+        if (!code.empty() && !(m_Encoding == Encoding::Legacy && code[0] == 'H')) {
+            codes.push_back(code);
+        }
+    }
+    if (known || m_Encoding == Encoding::Evex) {
+        if (!ReadImmediates(codes)) {
+            return {};
+        }
+    }
+    if (!known) {
+        bool hasImmediate = m_Map == 3 || m_Map == 8 || m_Map == 10 ||
+                            (m_Map == 1 && (m_Opcode == 0x0F || (m_Opcode >= 0x70 && m_Opcode <= 0x73) ||
+                                            m_Opcode == 0xC2 || (m_Opcode >= 0xC4 && m_Opcode <= 0xC6)));
+        uint64_t ignored;
+        if (hasImmediate && !FetchValue(ignored, m_Map == 10 ? 4 : 1)) {
+            return {};
+        }
+    }
+
+    DecodedInstruction result;
+    result.Length = static_cast<uint8_t>(m_Position);
+
+    if (!known) {
+        constexpr const char *maps[] = {"", "0F", "0F 38", "0F 3A", "", "map5", "map6", "", "xop8", "xop9", "xopA"};
+        const char *prefix = m_Encoding == Encoding::Evex ? "evex " : m_Encoding == Encoding::Vex ? "vex " : "";
+        result.Text = std::format("({}{} {:02X})", prefix, maps[m_Map], m_Opcode);
+        return result;
+    }
+
+    // The W form, then the fused multiply-add operand order from the opcode's row.
+    std::string mnemonic(Pick(name, W() ? 1 : 0, '/'));
+    if (auto slot = mnemonic.find("{}"); slot != std::string::npos) {
+        mnemonic.replace(slot, 2, m_Opcode < 0xA0 ? "132" : m_Opcode < 0xB0 ? "213" : "231");
+    }
+    if (m_Map == 0) {
+        switch (m_Opcode) {
+            case 0x6D:
+            case 0x6F:
+            case 0xA5:
+            case 0xA7:
+            case 0xAB:
+            case 0xAD:
+            case 0xAF:
+                mnemonic += OperandBits() == 64 ? 'q' : OperandBits() == 16 ? 'w' : 'd';
+                break;
+            case 0x98:
+                mnemonic = OperandBits() == 64 ? "cdqe" : OperandBits() == 16 ? "cbw" : "cwde";
+                break;
+            case 0x99:
+                mnemonic = OperandBits() == 64 ? "cqo" : OperandBits() == 16 ? "cwd" : "cdq";
+                break;
+            case 0xCF:
+                mnemonic = OperandBits() == 64 ? "iretq" : OperandBits() == 16 ? "iret" : "iretd";
+                break;
+            default:
+                break;
+        }
+        bool stringOperation = (m_Opcode >= 0x6C && m_Opcode <= 0x6F) || (m_Opcode >= 0xA4 && m_Opcode <= 0xA7) ||
+                               (m_Opcode >= 0xAA && m_Opcode <= 0xAF);
+        bool compares = m_Opcode == 0xA6 || m_Opcode == 0xA7 || m_Opcode == 0xAE || m_Opcode == 0xAF;
+        if (stringOperation && m_Repeat != 0) {
+            mnemonic = (m_Repeat == 0xF2 ? "repne " : compares ? "repe " : "rep ") + mnemonic;
+        }
+    }
+    bool vector = allOperands.find_first_of("VWUHPQNLX") != std::string_view::npos;
+    if (m_Encoding != Encoding::Legacy && (vector || m_Opcode == 0x77)) {
+        mnemonic = "v" + mnemonic;
+    }
+    if (m_Lock) {
+        mnemonic = "lock " + mnemonic;
+    }
+
+    if (m_Encoding == Encoding::Evex) {
+        // Masking, broadcast and the compressed displacement are not decoded.
+        result.Text = mnemonic + " {evex}";
+        return result;
+    }
+
+    size_t immediate = 0;
+    result.Text = mnemonic;
+    for (size_t i = 0; i < codes.size(); i++) {
+        result.Text += i == 0 ? " " : ", ";
+        result.Text += Operand(codes[i], immediate, result);
+    }
+    return result;
+}
+
+DecodedInstruction DecodeInstruction(std::span<const std::byte> code, uint64_t address) {
+    return InstructionDecoder(code, address).Decode();
+}
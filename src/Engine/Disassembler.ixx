@@ -0,0 +1,21 @@
+export module Engine.Disassembler;
+
+import std;
+
+// 64-bit mode x86 instruction decoder for the disassembly view. Lengths are exact for
+// everything up to AVX-512, including the VEX, EVEX and XOP forms. The text covers the
+// general purpose, x87, SSE and AVX instructions in Intel syntax; anything it has no name for
+// is shown with its opcode bytes, and EVEX instructions without their operands.
+
+export constexpr size_t MaxInstructionLength = 15;
+
+export struct DecodedInstruction {
+    // 0 when the bytes are not a valid instruction or run out before its end.
+    uint8_t Length = 0;
+    std::string Text;
+    // Jump and call destination, for rel8 and rel32 branches.
+    std::optional<uint64_t> BranchTarget;
+};
+
+// Decodes the instruction at the start of code, address being where code sits in the target.
+export DecodedInstruction DecodeInstruction(std::span<const std::byte> code, uint64_t address);
@@ -0,0 +1,140 @@
+module Engine.DisassemblyCache;
+
+// FNV-1a over 8 byte words, enough to notice code being patched or a module being replaced.
+static uint64_t HashBytes(std::span<const std::byte> bytes) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ull;
+    }
+    for (; i < bytes.size(); i++) {
+        hash = (hash ^ static_cast<uint8_t>(bytes[i])) * 0x100000001B3ull;
+    }
+    return hash ^ bytes.size();
+}
+
+// Decodes from start to the end of the page, appending to lines. An instruction that would run
+// over anchor is broken into single bytes, so anchor always ends up a boundary; returns false if
+// that or an invalid byte happened before it, meaning start was probably not a real boundary.
+static bool DecodeFrom(std::span<const std::byte> bytes, uint64_t pageAddress, size_t start, size_t anchor,
+                       std::vector<DisassembledLine> &lines) {
+    bool clean = true;
+    size_t offset = start;
+    while ((offset < DisassemblyCache::PageSize || offset < anchor) && offset < bytes.size()) {
+        DecodedInstruction instruction = DecodeInstruction(bytes.subspan(offset), pageAddress + offset);
+        bool crossesAnchor = offset < anchor && offset + instruction.Length > anchor;
+        if (instruction.Length == 0 || crossesAnchor) {
+            clean = clean && offset >= anchor;
+            lines.push_back({pageAddress + offset, 1, std::format("db 0x{:02X}", static_cast<uint8_t>(bytes[offset]))});
+            offset++;
+            continue;
+        }
+        lines.push_back({pageAddress + offset, instruction.Length, std::move(instruction.Text), instruction.BranchTarget});
+        offset += instruction.Length;
+    }
+    return clean;
+}
+
+// The page with the bytes past its end replaced by tail. Only instructions starting close enough
+// to the end to have read past it can decode differently, those are decoded again.
+static std::shared_ptr<const DisassembledPage> ReplaceTail(const DisassembledPage &page,
+                                                           std::span<const std::byte> bytes, size_t anchor) {
+    auto updated = std::make_shared<DisassembledPage>(page);
+    updated->Bytes.assign(bytes.begin(), bytes.end());
+    auto pageEnd = page.Address + DisassemblyCache::PageSize;
+    auto affected = std::ranges::find_if(updated->Lines, [pageEnd](const DisassembledLine &line) {
+        return line.Address + MaxInstructionLength > pageEnd;
+    });
+    size_t from = affected != updated->Lines.end() ? affected->Address - page.Address : page.End - page.Address;
+    updated->Lines.erase(affected, updated->Lines.end());
+    DecodeFrom(bytes, page.Address, from, std::max(from, anchor), updated->Lines);
+    updated->End = updated->Lines.empty() ? pageEnd : updated->Lines.back().Address + updated->Lines.back().Length;
+    return updated;
+}
+
+DisassemblyCache::DisassemblyCache(size_t capacityPages)
+    : m_Capacity(std::max<size_t>(capacityPages, 4)) {
+    m_Index.reserve(m_Capacity);
+}
+
+void DisassemblyCache::Clear() {
+    m_Pages.clear();
+    m_Index.clear();
+}
+
+std::shared_ptr<const DisassembledPage> DisassemblyCache::Get(PageCache &memory, uint64_t pageAddress,
+                                                              uint64_t anchor) {
+    m_Bytes.resize(PageSize + MaxInstructionLength);
+    m_Flags.resize(m_Bytes.size());
+    memory.Read(pageAddress, m_Bytes, m_Flags);
+    auto firstMissing = std::ranges::find_if(m_Flags, [](uint8_t flags) { return !(flags & CachedByte::Valid); });
+    auto available = static_cast<size_t>(firstMissing - m_Flags.begin());
+    if (available < PageSize) {
+        return nullptr;
+    }
+    auto bytes = std::span<const std::byte>(m_Bytes).first(available);
+    size_t anchorOffset = std::min<size_t>(anchor - pageAddress, available);
+
+    // The key covers the page alone: the next page changing or becoming readable only costs
+    // decoding the last few instructions again, not the whole page.
+    Key key{pageAddress, HashBytes(bytes.first(PageSize))};
+    if (auto found = m_Index.find(key); found != m_Index.end()) {
+        auto &cached = *found->second;
+        // The hash only finds the entry, a page patched into bytes with the same hash must not
+        // show the old code. Comparing costs about what hashing did.
+        bool samePage = std::ranges::equal(std::span(cached->Bytes).first(PageSize), bytes.first(PageSize));
+        if (samePage && !std::ranges::equal(std::span(cached->Bytes).subspan(PageSize), bytes.subspan(PageSize))) {
+            cached = ReplaceTail(*cached, bytes, anchorOffset);
+        }
+        if (samePage && cached->FindBoundary(anchor)) {
+            m_Pages.splice(m_Pages.begin(), m_Pages, found->second);
+            m_Stats.Hits++;
+            return *found->second;
+        }
+        // Other bytes, or decoded from a boundary that disagrees with this one, the new one wins.
+        m_Pages.erase(found->second);
+        m_Index.erase(found);
+    }
+
+    auto page = std::make_shared<DisassembledPage>();
+    page->Address = pageAddress;
+    page->Hash = key.Hash;
+    page->Bytes.assign(bytes.begin(), bytes.end());
+    if (anchorOffset < MaxInstructionLength) {
+        // The anchor is the page's first instruction, whatever precedes it belongs to the
+        // previous page.
+        DecodeFrom(bytes, pageAddress, anchorOffset, anchorOffset, page->Lines);
+    } else {
+        // x86 code resynchronizes within a few instructions, so some start in the first
+        // instruction's worth of bytes almost always decodes straight into the anchor.
+        bool synced = false;
+        for (size_t start = 0; start < MaxInstructionLength && !synced; start++) {
+            page->Lines.clear();
+            synced = DecodeFrom(bytes, pageAddress, start, anchorOffset, page->Lines);
+        }
+        if (!synced) {
+            page->Lines.clear();
+            DecodeFrom(bytes, pageAddress, 0, anchorOffset, page->Lines);
+        }
+    }
+    page->End = page->Lines.empty() ? pageAddress + PageSize
+                                    : page->Lines.back().Address + page->Lines.back().Length;
+    m_Stats.Decodes++;
+
+    if (m_Pages.size() >= m_Capacity) {
+        const auto &victim = m_Pages.back();
+        m_Index.erase(Key{victim->Address, victim->Hash});
+        m_Pages.pop_back();
+    }
+    m_Pages.push_front(page);
+    m_Index.emplace(key, m_Pages.begin());
+    return page;
+}
+
+DisassemblyCacheStats DisassemblyCache::GetStats() const {
+    DisassemblyCacheStats stats = m_Stats;
+    stats.CachedPages = m_Pages.size();
+    return stats;
+}
@@ -0,0 +1,95 @@
+export module Engine.DisassemblyCache;
+
+import std;
+export import Engine.Disassembler;
+export import Engine.PageCache;
+
+export struct DisassembledLine {
+    uint64_t Address;
+    // Bytes that do not decode, or run into memory that cannot be read, become one byte lines.
+    uint8_t Length;
+    std::string Text;
+    std::optional<uint64_t> BranchTarget;
+};
+
+// The instructions starting in one page. Instruction boundaries cannot be told from the bytes
+// alone, so every page is decoded from a boundary known to be good: the end of the page before
+// it, an address the user went to, or the first instruction of the page after it.
+export struct DisassembledPage {
+    uint64_t Address;
+    uint64_t Hash;
+    // The page and whatever part of the next one its last instruction reaches into.
+    std::vector<std::byte> Bytes;
+    std::vector<DisassembledLine> Lines;
+    // Where the instruction after the last line starts, in the next page.
+    uint64_t End;
+
+    // Index of the line starting at address, Lines.size() for End, nullopt for neither.
+    [[nodiscard]] std::optional<size_t> FindBoundary(uint64_t address) const {
+        if (address == End) {
+            return Lines.size();
+        }
+        auto it = std::ranges::lower_bound(Lines, address, {}, &DisassembledLine::Address);
+        if (it == Lines.end() || it->Address != address) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(it - Lines.begin());
+    }
+
+    [[nodiscard]] std::span<const std::byte> GetBytes(const DisassembledLine &line) const {
+        return std::span(Bytes).subspan(line.Address - Address, line.Length);
+    }
+};
+
+export struct DisassemblyCacheStats {
+    uint64_t Hits = 0;
+    uint64_t Decodes = 0;
+    size_t CachedPages = 0;
+};
+
+// Decoded pages keyed by page address and a hash of the page's bytes. A page is decoded once
+// and then served from here every frame until its bytes change, or until it is asked for with an
+// anchor that is not one of its boundaries. When only the bytes past its end change, just the
+// instructions that reach there are decoded again. Bytes come from a PageCache, so nothing here
+// waits on the target. Not thread safe, it belongs to one view.
+export class DisassemblyCache {
+public:
+    static constexpr uint64_t PageSize = PageCache::PageSize;
+
+    explicit DisassemblyCache(size_t capacityPages = 256);
+
+    void Clear();
+
+    // The page at pageAddress decoded so that anchor, which lies in the page or up to
+    // MaxInstructionLength past its end, starts an instruction or is the page's End. nullptr
+    // while the page is not cached yet or cannot be read.
+    std::shared_ptr<const DisassembledPage> Get(PageCache &memory, uint64_t pageAddress, uint64_t anchor);
+
+    [[nodiscard]] DisassemblyCacheStats GetStats() const;
+
+private:
+    struct Key {
+        uint64_t Page;
+        uint64_t Hash;
+
+        bool operator==(const Key &) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return static_cast<size_t>(key.Page * 0x9E3779B97F4A7C15ull ^ key.Hash);
+        }
+    };
+
+    using PageList = std::list<std::shared_ptr<const DisassembledPage>>;
+
+    size_t m_Capacity;
+    // Front is the most recently used page.
+    PageList m_Pages;
+    std::unordered_map<Key, PageList::iterator, KeyHash> m_Index;
+    DisassemblyCacheStats m_Stats;
+
+    // Reused by every Get.
+    std::vector<std::byte> m_Bytes;
+    std::vector<uint8_t> m_Flags;
+};
@@ -0,0 +1,418 @@
+export module Engine.Dissector;
+
+import std;
+export import Engine.ProcessMemory;
+
+export enum class FieldType : uint8_t {
+    Int8,
+    Int16,
+    Int32,
+    Int64,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    Float,
+    Double,
+    Bool,
+    Pointer,
+    // Types below are not scalars and have no entry in the decoder table.
+    Char,
+    Struct
+};
+
+constexpr size_t ScalarFieldTypeCount = static_cast<size_t>(FieldType::Char);
+
+template<FieldType Type>
+struct FieldTypeTraits;
+
+#define FIELD_TYPE_TRAITS(type, cppType, name, format) \
+    template<> struct FieldTypeTraits<FieldType::type> { \
+        using ValueType = cppType; \
+        static constexpr const char *Name = name; \
+        static constexpr std::string_view Format = format; \
+    };
+
+FIELD_TYPE_TRAITS(Int8, int8_t, "int8", "{}")
+FIELD_TYPE_TRAITS(Int16, int16_t, "int16", "{}")
+FIELD_TYPE_TRAITS(Int32, int32_t, "int32", "{}")
+FIELD_TYPE_TRAITS(Int64, int64_t, "int64", "{}")
+FIELD_TYPE_TRAITS(UInt8, uint8_t, "uint8", "{}")
+FIELD_TYPE_TRAITS(UInt16, uint16_t, "uint16", "{}")
+FIELD_TYPE_TRAITS(UInt32, uint32_t, "uint32", "{}")
+FIELD_TYPE_TRAITS(UInt64, uint64_t, "uint64", "{}")
+FIELD_TYPE_TRAITS(Float, float, "float", "{:.6g}")
+FIELD_TYPE_TRAITS(Double, double, "double", "{:.10g}")
+FIELD_TYPE_TRAITS(Bool, bool, "bool", "{}")
+FIELD_TYPE_TRAITS(Pointer, uint64_t, "ptr", "0x{:X}")
+
+#undef FIELD_TYPE_TRAITS
+
+// Formats the scalar at data into out, returns the formatted text.
+using FieldDecoder = std::string_view (*)(const std::byte *data, std::span<char> out);
+
+template<FieldType Type>
+std::string_view DecodeField(const std::byte *data, std::span<char> out) {
+    using Traits = FieldTypeTraits<Type>;
+    typename Traits::ValueType value;
+    std::memcpy(&value, data, sizeof(value));
+    if constexpr (std::same_as<typename Traits::ValueType, bool>) {
+        value = std::to_integer<uint8_t>(*data) != 0; // any byte pattern, not just 0 and 1
+    }
+    auto result = std::format_to_n(out.data(), static_cast<std::ptrdiff_t>(out.size()),
+                                   Traits::Format, value);
+    return {out.data(), static_cast<size_t>(result.out - out.data())};
+}
+
+template<size_t... Indices>
+consteval auto MakeFieldTables(std::index_sequence<Indices...>) {
+    struct Tables {
+        std::array<FieldDecoder, sizeof...(Indices)> Decoders;
+        std::array<uint32_t, sizeof...(Indices)> Sizes;
+        std::array<const char *, sizeof...(Indices)> Names;
+    };
+    return Tables{
+        {&DecodeField<static_cast<FieldType>(Indices)>...},
+        {sizeof(typename FieldTypeTraits<static_cast<FieldType>(Indices)>::ValueType)...},
+        {FieldTypeTraits<static_cast<FieldType>(Indices)>::Name...}
+    };
+}
+
+constexpr auto FieldTables = MakeFieldTables(std::make_index_sequence<ScalarFieldTypeCount>{});
+
+export constexpr bool IsScalar(FieldType type) {
+    return static_cast<size_t>(type) < ScalarFieldTypeCount;
+}
+
+// Size of one element of a scalar or char field.
+export constexpr uint32_t GetScalarSize(FieldType type) {
+    return type == FieldType::Char ? 1 : FieldTables.Sizes[static_cast<size_t>(type)];
+}
+
+export constexpr const char *GetFieldTypeName(FieldType type) {
+    switch (type) {
+        case FieldType::Char:
+            return "char";
+        case FieldType::Struct:
+            return "struct";
+        default:
+            return FieldTables.Names[static_cast<size_t>(type)];
+    }
+}
+
+// Formats one scalar element through the decoder table, data must hold GetScalarSize bytes.
+export std::string_view DecodeScalar(FieldType type, std::span<const std::byte> data, std::span<char> out) {
+    if (!IsScalar(type) || data.size() < GetScalarSize(type)) {
+        return {};
+    }
+    return FieldTables.Decoders[static_cast<size_t>(type)](data.data(), out);
+}
+
+export struct FieldDef {
+    std::string Name;
+    uint32_t Offset = 0;
+    FieldType Type = FieldType::UInt8;
+    // Elements for arrays, 1 otherwise. For Char it is the buffer length.
+    uint32_t Count = 1;
+    // Struct fields are inline, pointer fields with a layout point at one.
+    std::optional<uint32_t> Layout;
+};
+
+export struct StructLayout {
+    std::string Name;
+    uint32_t Size = 0;
+    std::vector<FieldDef> Fields; // sorted by offset
+};
+
+export struct DissectorSchema {
+    std::vector<StructLayout> Layouts;
+
+    [[nodiscard]] std::optional<uint32_t> Find(std::string_view name) const {
+        for (uint32_t i = 0; i < Layouts.size(); i++) {
+            if (Layouts[i].Name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+// Struct sizes and array lengths go up to 2^24 each, so the product needs 64 bits until it was
+// checked against the enclosing struct.
+uint64_t GetFieldExtent(const DissectorSchema &schema, const FieldDef &field) {
+    uint64_t elementSize;
+    if (field.Type == FieldType::Struct) {
+        elementSize = field.Layout ? schema.Layouts[*field.Layout].Size : 0;
+    } else {
+        elementSize = GetScalarSize(field.Type);
+    }
+    return elementSize * field.Count;
+}
+
+// Fits for every field of a schema ParseSchema accepted, which lie inside their struct.
+export uint32_t GetFieldSize(const DissectorSchema &schema, const FieldDef &field) {
+    return static_cast<uint32_t>(GetFieldExtent(schema, field));
+}
+
+// Parses layouts written as
+//
+//     struct Player 0x120
+//         0x00 ptr vtable
+//         0x10 float health
+//         0x18 Inventory* inventory
+//         0x20 int32[16] slots
+//         0x60 char[32] name
+//         0x80 Vector3 position
+//
+// Offsets and sizes accept hex with 0x or decimal. A type is a scalar name, char[N], or a
+// struct name, optionally followed by * for a pointer to it and [N] for an array.
+// Lines starting with # are comments.
+export std::expected<DissectorSchema, std::string> ParseSchema(std::string_view text) {
+    DissectorSchema schema;
+    // Struct names used before their definition are resolved at the end.
+    std::vector<std::tuple<uint32_t, size_t, std::string, size_t>> unresolved;
+
+    auto parseNumber = [](std::string_view token) -> std::optional<uint64_t> {
+        int base = 10;
+        if (token.starts_with("0x") || token.starts_with("0X")) {
+            token.remove_prefix(2);
+            base = 16;
+        }
+        uint64_t value = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value, base);
+        if (ec != std::errc{} || ptr != token.data() + token.size()) {
+            return std::nullopt;
+        }
+        return value;
+    };
+
+    size_t lineNumber = 0;
+    for (auto lineRange: std::views::split(text, '\n')) {
+        lineNumber++;
+        std::string_view line(lineRange.begin(), lineRange.end());
+        std::vector<std::string_view> tokens;
+        for (auto token: std::views::split(line, ' ')) {
+            std::string_view t(token.begin(), token.end());
+            while (!t.empty() && (t.back() == '\r' || t.back() == '\t')) {
+                t.remove_suffix(1);
+            }
+            while (!t.empty() && t.front() == '\t') {
+                t.remove_prefix(1);
+            }
+            if (!t.empty()) {
+                tokens.push_back(t);
+            }
+        }
+        if (tokens.empty() || tokens[0].starts_with('#')) {
+            continue;
+        }
+
+        auto error = [lineNumber](std::string_view message) {
+            return std::unexpected(std::format("line {}: {}", lineNumber, message));
+        };
+
+        if (tokens[0] == "struct") {
+            if (tokens.size() != 3) {
+                return error("expected 'struct <name> <size>'");
+            }
+            auto size = parseNumber(tokens[2]);
+            if (!size || *size == 0 || *size > (1u << 24)) {
+                return error("invalid struct size");
+            }
+            if (schema.Find(tokens[1])) {
+                return error("struct defined twice");
+            }
+            schema.Layouts.push_back({std::string(tokens[1]), static_cast<uint32_t>(*size), {}});
+            continue;
+        }
+
+        if (schema.Layouts.empty()) {
+            return error("field outside of a struct");
+        }
+        if (tokens.size() != 3) {
+            return error("expected '<offset> <type> <name>'");
+        }
+
+        auto offset = parseNumber(tokens[0]);
+        if (!offset) {
+            return error("invalid offset");
+        }
+        if (*offset >= schema.Layouts.back().Size) {
+            return error("offset outside of the struct");
+        }
+
+        FieldDef field{.Name = std::string(tokens[2]), .Offset = static_cast<uint32_t>(*offset)};
+        std::string_view type = tokens[1];
+        if (auto open = type.find('['); open != std::string_view::npos) {
+            if (!type.ends_with(']')) {
+                return error("unterminated array");
+            }
+            auto count = parseNumber(type.substr(open + 1, type.size() - open - 2));
+            if (!count || *count == 0 || *count > (1u << 24)) {
+                return error("invalid array length");
+            }
+            field.Count = static_cast<uint32_t>(*count);
+            type = type.substr(0, open);
+        }
+
+        bool pointer = type.ends_with('*');
+        if (pointer) {
+            type.remove_suffix(1);
+        }
+
+        std::optional<FieldType> scalar;
+        for (size_t i = 0; i < ScalarFieldTypeCount; i++) {
+            if (type == FieldTables.Names[i]) {
+                scalar = static_cast<FieldType>(i);
+            }
+        }
+
+        if (type == "char") {
+            // Char has no decoder entry, a char* is a plain pointer like any pointer to a scalar.
+            field.Type = pointer ? FieldType::Pointer : FieldType::Char;
+        } else if (scalar) {
+            // A pointer to a scalar is shown as a plain pointer.
+            field.Type = pointer ? FieldType::Pointer : *scalar;
+        } else {
+            field.Type = pointer ? FieldType::Pointer : FieldType::Struct;
+            unresolved.emplace_back(static_cast<uint32_t>(schema.Layouts.size() - 1),
+                                    schema.Layouts.back().Fields.size(), std::string(type), lineNumber);
+        }
+
+        schema.Layouts.back().Fields.push_back(std::move(field));
+    }
+
+    for (auto &[layoutIndex, fieldIndex, typeName, line]: unresolved) {
+        auto layout = schema.Find(typeName);
+        if (!layout) {
+            return std::unexpected(std::format("line {}: unknown type '{}'", line, typeName));
+        }
+        schema.Layouts[layoutIndex].Fields[fieldIndex].Layout = *layout;
+    }
+
+    for (auto &layout: schema.Layouts) {
+        std::ranges::sort(layout.Fields, {}, &FieldDef::Offset);
+        for (const auto &field: layout.Fields) {
+            if (field.Offset + GetFieldExtent(schema, field) > layout.Size) {
+                return std::unexpected(std::format("field {}.{} exceeds the struct size", layout.Name, field.Name));
+            }
+        }
+    }
+
+    // Inline struct fields nest without a pointer hop, so a cycle through them, direct or through
+    // other structs, would be drawn without end.
+    enum class VisitState : uint8_t { New, Active, Done };
+    std::vector<VisitState> states(schema.Layouts.size(), VisitState::New);
+    auto findCycle = [&](this auto &self, uint32_t index) -> std::optional<uint32_t> {
+        states[index] = VisitState::Active;
+        for (const auto &field: schema.Layouts[index].Fields) {
+            if (field.Type != FieldType::Struct) {
+                continue;
+            }
+            if (states[*field.Layout] == VisitState::Active) {
+                return *field.Layout;
+            }
+            if (states[*field.Layout] == VisitState::New) {
+                if (auto cycle = self(*field.Layout)) {
+                    return cycle;
+                }
+            }
+        }
+        states[index] = VisitState::Done;
+        return std::nullopt;
+    };
+    for (uint32_t i = 0; i < schema.Layouts.size(); i++) {
+        if (states[i] == VisitState::New) {
+            if (auto cycle = findCycle(i)) {
+                return std::unexpected(std::format("struct {} contains itself", schema.Layouts[*cycle].Name));
+            }
+        }
+    }
+
+    return schema;
+}
+
+export enum class GuessKind : uint8_t {
+    Zero,
+    Pointer,
+    Float,
+    Double,
+    String,
+    Integer
+};
+
+export struct FieldGuess {
+    GuessKind Kind;
+    uint32_t Size; // bytes covered by the guess
+};
+
+// Guesses what the bytes at the start of data hold, data is assumed to start 4 byte aligned.
+// Looks for, in order: NUL terminated printable text, canonical user mode pointers, doubles and
+// floats of plausible magnitude, and falls back to a 4 byte integer.
+export FieldGuess GuessField(std::span<const std::byte> data, bool eightByteAligned) {
+    auto isPrintable = [](std::byte b) {
+        auto c = std::to_integer<uint8_t>(b);
+        return c >= 0x20 && c < 0x7F;
+    };
+
+    size_t printable = 0;
+    while (printable < data.size() && isPrintable(data[printable])) {
+        printable++;
+    }
+    if (printable >= 4 && (printable == data.size() || std::to_integer<uint8_t>(data[printable]) == 0)) {
+        auto size = static_cast<uint32_t>(std::min(printable + 1, data.size()));
+        return {GuessKind::String, (size + 3) & ~3u};
+    }
+
+    auto plausible = [](double value) {
+        double magnitude = std::abs(value);
+        return std::isfinite(value) && magnitude >= 1e-4 && magnitude <= 1e7;
+    };
+
+    if (data.size() >= 8 && eightByteAligned) {
+        uint64_t word;
+        std::memcpy(&word, data.data(), sizeof(word));
+        if (word == 0) {
+            return {GuessKind::Zero, 8};
+        }
+        if (word >= 0x10000 && word < MaxUserAddress && (word & 3) == 0) {
+            return {GuessKind::Pointer, 8};
+        }
+        double asDouble;
+        std::memcpy(&asDouble, data.data(), sizeof(asDouble));
+        if (plausible(asDouble)) {
+            return {GuessKind::Double, 8};
+        }
+    }
+
+    if (data.size() >= 4) {
+        uint32_t word;
+        std::memcpy(&word, data.data(), sizeof(word));
+        if (word == 0) {
+            return {GuessKind::Zero, 4};
+        }
+        float asFloat;
+        std::memcpy(&asFloat, data.data(), sizeof(asFloat));
+        if (plausible(asFloat)) {
+            return {GuessKind::Float, 4};
+        }
+        return {GuessKind::Integer, 4};
+    }
+
+    return {GuessKind::Integer, static_cast<uint32_t>(data.size())};
+}
+
+export constexpr FieldType GuessedFieldType(GuessKind kind) {
+    switch (kind) {
+        case GuessKind::Pointer:
+            return FieldType::Pointer;
+        case GuessKind::Float:
+            return FieldType::Float;
+        case GuessKind::Double:
+            return FieldType::Double;
+        case GuessKind::String:
+            return FieldType::Char;
+        default:
+            return FieldType::Int32;
+    }
+}
@@ -0,0 +1,263 @@
+module Engine.DumpSource;
+
+DumpSource::DumpSource(MappedFile file, std::vector<Segment> segments)
+    : m_File(std::move(file)), m_Segments(std::move(segments)) {
+    std::ranges::sort(m_Segments, {}, &Segment::Address);
+    uint64_t end = 0;
+    std::erase_if(m_Segments, [&end](const Segment &segment) {
+        // A segment running past the end of the address space would wrap end around and let
+        // the segments after it overlap.
+        if (segment.Size == 0 || segment.Address < end || segment.Size > ~uint64_t{0} - segment.Address) {
+            return true;
+        }
+        end = segment.Address + segment.Size;
+        return false;
+    });
+}
+
+const DumpSource::Segment *DumpSource::Find(uint64_t address) const {
+    auto it = std::ranges::upper_bound(m_Segments, address, {}, &Segment::Address);
+    if (it == m_Segments.begin()) {
+        return nullptr;
+    }
+    --it;
+    return address - it->Address < it->Size ? &*it : nullptr;
+}
+
+std::span<const std::byte> DumpSource::View(uint64_t address, size_t size) const {
+    const Segment *segment = Find(address);
+    if (segment == nullptr) {
+        return {};
+    }
+    uint64_t offset = address - segment->Address;
+    return m_File.GetData().subspan(segment->FileOffset + offset, std::min<uint64_t>(size, segment->Size - offset));
+}
+
+// Continues into the next segment when they are adjacent, like a live read across regions.
+size_t DumpSource::Read(uint64_t address, std::span<std::byte> buffer) const {
+    size_t copied = 0;
+    while (copied < buffer.size()) {
+        auto view = View(address + copied, buffer.size() - copied);
+        if (view.empty()) {
+            break;
+        }
+        std::ranges::copy(view, buffer.begin() + static_cast<ptrdiff_t>(copied));
+        copied += view.size();
+    }
+    return copied;
+}
+
+std::vector<MemoryRegion> DumpSource::QueryRegions() const {
+    std::vector<MemoryRegion> regions;
+    regions.reserve(m_Segments.size());
+    for (const auto &segment: m_Segments) {
+        regions.push_back({segment.Address, segment.Size, segment.Access});
+    }
+    return regions;
+}
+
+template<typename T>
+static std::optional<T> ReadStruct(std::span<const std::byte> data, uint64_t offset) {
+    if (offset > data.size() || data.size() - offset < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+static bool FitsInFile(std::span<const std::byte> data, uint64_t offset, uint64_t size) {
+    return offset <= data.size() && size <= data.size() - offset;
+}
+
+// Only the fields this reader uses are named, the layouts match the ELF and minidump specs.
+struct Elf64Header {
+    std::array<uint8_t, 16> Ident;
+    uint16_t Type;
+    uint16_t Machine;
+    uint32_t Version;
+    uint64_t Entry;
+    uint64_t ProgramHeaderOffset;
+    uint64_t SectionHeaderOffset;
+    uint32_t Flags;
+    uint16_t HeaderSize;
+    uint16_t ProgramHeaderSize;
+    uint16_t ProgramHeaderCount;
+    uint16_t SectionHeaderSize;
+    uint16_t SectionHeaderCount;
+    uint16_t SectionNameIndex;
+};
+
+struct Elf64ProgramHeader {
+    uint32_t Type;
+    uint32_t Flags;
+    uint64_t Offset;
+    uint64_t VirtualAddress;
+    uint64_t PhysicalAddress;
+    uint64_t FileSize;
+    uint64_t MemorySize;
+    uint64_t Alignment;
+};
+
+constexpr uint16_t ElfTypeCore = 4;
+constexpr uint32_t ElfSegmentLoad = 1;
+constexpr uint32_t ElfFlagExecute = 1;
+constexpr uint32_t ElfFlagWrite = 2;
+constexpr uint32_t ElfFlagRead = 4;
+
+std::expected<std::shared_ptr<MemorySource>, std::string> OpenElfCore(const std::filesystem::path &path) {
+    auto file = MappedFile::Open(path);
+    if (!file) {
+        return std::unexpected("cannot open " + path.string());
+    }
+    auto data = file->GetData();
+
+    auto header = ReadStruct<Elf64Header>(data, 0);
+    if (!header || header->Ident[0] != 0x7F || header->Ident[1] != 'E' || header->Ident[2] != 'L' ||
+        header->Ident[3] != 'F') {
+        return std::unexpected("not an ELF file");
+    }
+    if (header->Ident[4] != 2 || header->Ident[5] != 1) {
+        return std::unexpected("only 64 bit little endian cores are supported");
+    }
+    if (header->Type != ElfTypeCore) {
+        return std::unexpected("not a core file");
+    }
+    if (header->ProgramHeaderSize < sizeof(Elf64ProgramHeader)) {
+        return std::unexpected("bad program header size");
+    }
+
+    std::vector<DumpSource::Segment> segments;
+    for (uint32_t i = 0; i < header->ProgramHeaderCount; i++) {
+        auto segment = ReadStruct<Elf64ProgramHeader>(
+            data, header->ProgramHeaderOffset + uint64_t{i} * header->ProgramHeaderSize);
+        if (!segment) {
+            return std::unexpected("truncated program headers");
+        }
+        // Segments the dumper left out (unreadable or file backed) have a FileSize of 0.
+        if (segment->Type != ElfSegmentLoad || (segment->Flags & ElfFlagRead) == 0 || segment->FileSize == 0 ||
+            !FitsInFile(data, segment->Offset, segment->FileSize)) {
+            continue;
+        }
+        uint32_t access = RegionAccess::Read;
+        access |= segment->Flags & ElfFlagWrite ? RegionAccess::Write : 0;
+        access |= segment->Flags & ElfFlagExecute ? RegionAccess::Execute : 0;
+        segments.push_back({
+            segment->VirtualAddress, std::min(segment->FileSize, segment->MemorySize), segment->Offset, access
+        });
+    }
+    return std::make_shared<DumpSource>(std::move(*file), std::move(segments));
+}
+
+#pragma pack(push, 4)
+struct MinidumpHeader {
+    uint32_t Signature;
+    uint32_t Version;
+    uint32_t StreamCount;
+    uint32_t StreamDirectoryRva;
+    uint32_t CheckSum;
+    uint32_t TimeDateStamp;
+    uint64_t Flags;
+};
+
+struct MinidumpDirectory {
+    uint32_t StreamType;
+    uint32_t DataSize;
+    uint32_t Rva;
+};
+
+struct MinidumpMemoryDescriptor {
+    uint64_t StartOfMemoryRange;
+    uint32_t DataSize;
+    uint32_t Rva;
+};
+
+struct MinidumpMemoryDescriptor64 {
+    uint64_t StartOfMemoryRange;
+    uint64_t DataSize;
+};
+#pragma pack(pop)
+
+constexpr uint32_t MinidumpSignature = 0x504D444D; // "MDMP"
+constexpr uint32_t MinidumpMemoryListStream = 5;
+constexpr uint32_t MinidumpMemory64ListStream = 9;
+
+std::expected<std::shared_ptr<MemorySource>, std::string> OpenMinidump(const std::filesystem::path &path) {
+    auto file = MappedFile::Open(path);
+    if (!file) {
+        return std::unexpected("cannot open " + path.string());
+    }
+    auto data = file->GetData();
+
+    auto header = ReadStruct<MinidumpHeader>(data, 0);
+    if (!header || header->Signature != MinidumpSignature) {
+        return std::unexpected("not a minidump");
+    }
+
+    // Minidumps do not record protections with the memory lists, everything is read/write.
+    constexpr uint32_t access = RegionAccess::Read | RegionAccess::Write;
+    std::vector<DumpSource::Segment> segments;
+    for (uint32_t i = 0; i < header->StreamCount; i++) {
+        auto directory = ReadStruct<MinidumpDirectory>(
+            data, header->StreamDirectoryRva + uint64_t{i} * sizeof(MinidumpDirectory));
+        if (!directory) {
+            return std::unexpected("truncated stream directory");
+        }
+
+        if (directory->StreamType == MinidumpMemory64ListStream) {
+            auto count = ReadStruct<uint64_t>(data, directory->Rva);
+            auto baseRva = ReadStruct<uint64_t>(data, directory->Rva + sizeof(uint64_t));
+            if (!count || !baseRva) {
+                return std::unexpected("truncated memory list");
+            }
+            // The ranges' bytes follow each other from baseRva on.
+            uint64_t rva = *baseRva;
+            for (uint64_t range = 0; range < *count; range++) {
+                auto descriptor = ReadStruct<MinidumpMemoryDescriptor64>(
+                    data, directory->Rva + 2 * sizeof(uint64_t) + range * sizeof(MinidumpMemoryDescriptor64));
+                if (!descriptor || !FitsInFile(data, rva, descriptor->DataSize)) {
+                    return std::unexpected("truncated memory list");
+                }
+                segments.push_back({descriptor->StartOfMemoryRange, descriptor->DataSize, rva, access});
+                rva += descriptor->DataSize;
+            }
+        } else if (directory->StreamType == MinidumpMemoryListStream) {
+            auto count = ReadStruct<uint32_t>(data, directory->Rva);
+            if (!count) {
+                return std::unexpected("truncated memory list");
+            }
+            for (uint32_t range = 0; range < *count; range++) {
+                auto descriptor = ReadStruct<MinidumpMemoryDescriptor>(
+                    data, directory->Rva + sizeof(uint32_t) + uint64_t{range} * sizeof(MinidumpMemoryDescriptor));
+                if (!descriptor || !FitsInFile(data, descriptor->Rva, descriptor->DataSize)) {
+                    return std::unexpected("truncated memory list");
+                }
+                segments.push_back({descriptor->StartOfMemoryRange, descriptor->DataSize, descriptor->Rva, access});
+            }
+        }
+    }
+    return std::make_shared<DumpSource>(std::move(*file), std::move(segments));
+}
+
+std::expected<std::shared_ptr<MemorySource>, std::string> OpenRawDump(const std::filesystem::path &path,
+                                                                    uint64_t baseAddress) {
+    auto file = MappedFile::Open(path);
+    if (!file) {
+        return std::unexpected("cannot open " + path.string());
+    }
+    uint64_t size = file->GetData().size();
+    std::vector<DumpSource::Segment> segments{{baseAddress, size, 0, RegionAccess::Read | RegionAccess::Write}};
+    return std::make_shared<DumpSource>(std::move(*file), std::move(segments));
+}
+
+std::expected<std::shared_ptr<MemorySource>, std::string> OpenDump(const std::filesystem::path &path) {
+    std::array<char, 4> magic{};
+    std::ifstream(path, std::ios::binary).read(magic.data(), magic.size());
+    if (magic == std::array<char, 4>{'\x7F', 'E', 'L', 'F'}) {
+        return OpenElfCore(path);
+    }
+    if (magic == std::array<char, 4>{'M', 'D', 'M', 'P'}) {
+        return OpenMinidump(path);
+    }
+    return std::unexpected("unknown dump format, raw dumps need a base address");
+}
@@ -0,0 +1,47 @@
+export module Engine.DumpSource;
+
+import std;
+import Engine.MappedFile;
+export import Engine.ProcessMemory;
+
+// Memory of a process captured in a file, mapped read only. Regions are views into the
+// mapping, so scans read them in place at page cache speed and Read is a memcpy.
+export class DumpSource final : public MemorySource {
+public:
+    struct Segment {
+        uint64_t Address;
+        uint64_t Size; // bytes present in the file, anything past them reads as missing
+        uint64_t FileOffset;
+        uint32_t Access; // RegionAccess flags
+    };
+
+    // Segments are sorted by address, overlapping ones and ones wrapping around the end of the
+    // address space are dropped.
+    DumpSource(MappedFile file, std::vector<Segment> segments);
+
+    size_t Read(uint64_t address, std::span<std::byte> buffer) const override;
+
+    [[nodiscard]] std::vector<MemoryRegion> QueryRegions() const override;
+
+    [[nodiscard]] std::span<const std::byte> View(uint64_t address, size_t size) const override;
+
+private:
+    [[nodiscard]] const Segment *Find(uint64_t address) const;
+
+    MappedFile m_File;
+    std::vector<Segment> m_Segments;
+};
+
+// ELF core file, PT_LOAD segments become regions. gcore and the kernel both write these.
+export std::expected<std::shared_ptr<MemorySource>, std::string> OpenElfCore(const std::filesystem::path &path);
+
+// Windows minidump, from the Memory64List stream of full dumps or the MemoryList stream of
+// smaller ones.
+export std::expected<std::shared_ptr<MemorySource>, std::string> OpenMinidump(const std::filesystem::path &path);
+
+// The whole file as one region starting at baseAddress.
+export std::expected<std::shared_ptr<MemorySource>, std::string> OpenRawDump(const std::filesystem::path &path,
+                                                                           uint64_t baseAddress);
+
+// ELF core or minidump, told apart by their magic.
+export std::expected<std::shared_ptr<MemorySource>, std::string> OpenDump(const std::filesystem::path &path);
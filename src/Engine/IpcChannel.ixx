@@ -0,0 +1,395 @@
+module;
+
+#ifndef _WIN32
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+export module Engine.IpcChannel;
+
+import std;
+
+// Framed messages over a local stream socket, optionally carrying a file descriptor. Only
+// implemented on POSIX systems, on Windows nothing connects.
+
+export struct IpcHeader {
+    uint32_t Type;
+    uint32_t RequestId; // replies echo the request's
+    uint32_t Status; // 0 on success, replies only
+    uint32_t PayloadSize;
+};
+
+export constexpr uint32_t MaxIpcPayloadSize = 64 * 1024 * 1024;
+
+export class UniqueFd {
+public:
+    UniqueFd() = default;
+
+    explicit UniqueFd(int fd) : m_Fd(fd) {
+    }
+
+    UniqueFd(const UniqueFd &) = delete;
+
+    UniqueFd &operator=(const UniqueFd &) = delete;
+
+    UniqueFd(UniqueFd &&other) noexcept : m_Fd(std::exchange(other.m_Fd, -1)) {
+    }
+
+    UniqueFd &operator=(UniqueFd &&other) noexcept {
+        if (this != &other) {
+            Reset(std::exchange(other.m_Fd, -1));
+        }
+        return *this;
+    }
+
+    ~UniqueFd() {
+        Reset();
+    }
+
+    [[nodiscard]] int Get() const { return m_Fd; }
+
+    explicit operator bool() const { return m_Fd >= 0; }
+
+    void Reset(int fd = -1) {
+#ifndef _WIN32
+        if (m_Fd >= 0) {
+            close(m_Fd);
+        }
+#endif
+        m_Fd = fd;
+    }
+
+private:
+    int m_Fd = -1;
+};
+
+export struct IpcMessage {
+    IpcHeader Header{};
+    std::vector<std::byte> Payload;
+    UniqueFd Fd;
+};
+
+export class IpcChannel {
+public:
+    explicit IpcChannel(UniqueFd socket) : m_Socket(std::move(socket)) {
+    }
+
+    static std::optional<IpcChannel> Connect(const std::filesystem::path &path) {
+#ifndef _WIN32
+        sockaddr_un address{};
+        std::string pathText = path.string();
+        if (pathText.size() >= sizeof(address.sun_path)) {
+            return std::nullopt;
+        }
+        address.sun_family = AF_UNIX;
+        std::ranges::copy(pathText, address.sun_path);
+        UniqueFd socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!socket || connect(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+            return std::nullopt;
+        }
+        return IpcChannel(std::move(socket));
+#else
+        return std::nullopt;
+#endif
+    }
+
+    // Not thread safe, one sender at a time.
+    bool Send(const IpcHeader &header, std::span<const std::byte> payload, int passFd = -1) const {
+#ifndef _WIN32
+        IpcHeader framed = header;
+        framed.PayloadSize = static_cast<uint32_t>(payload.size());
+        iovec parts[2]{
+            {const_cast<IpcHeader *>(&framed), sizeof(framed)},
+            {const_cast<std::byte *>(payload.data()), payload.size()},
+        };
+        alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int))> control{};
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = payload.empty() ? 1 : 2;
+        if (passFd >= 0) {
+            message.msg_control = control.data();
+            message.msg_controllen = control.size();
+            cmsghdr *fdMessage = CMSG_FIRSTHDR(&message);
+            fdMessage->cmsg_level = SOL_SOCKET;
+            fdMessage->cmsg_type = SCM_RIGHTS;
+            fdMessage->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(fdMessage), &passFd, sizeof(int));
+        }
+
+        // The descriptor travels with the first byte, the rest goes out as the socket takes it.
+        size_t total = sizeof(framed) + payload.size();
+        ssize_t sent = sendmsg(m_Socket.Get(), &message, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        for (size_t done = static_cast<size_t>(sent); done < total; done += static_cast<size_t>(sent)) {
+            const std::byte *from = done < sizeof(framed)
+                                        ? reinterpret_cast<const std::byte *>(&framed) + done
+                                        : payload.data() + (done - sizeof(framed));
+            size_t size = done < sizeof(framed) ? sizeof(framed) - done : total - done;
+            sent = ::send(m_Socket.Get(), from, size, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Blocks for the next message, nullopt once the other side closed or sent garbage.
+    std::optional<IpcMessage> Receive() const {
+#ifndef _WIN32
+        IpcMessage result;
+        alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int))> control{};
+        iovec part{&result.Header, sizeof(result.Header)};
+        msghdr message{};
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        message.msg_control = control.data();
+        message.msg_controllen = control.size();
+        ssize_t received = recvmsg(m_Socket.Get(), &message, MSG_CMSG_CLOEXEC);
+        if (received <= 0) {
+            return std::nullopt;
+        }
+        for (cmsghdr *fdMessage = CMSG_FIRSTHDR(&message); fdMessage != nullptr;
+             fdMessage = CMSG_NXTHDR(&message, fdMessage)) {
+            if (fdMessage->cmsg_level == SOL_SOCKET && fdMessage->cmsg_type == SCM_RIGHTS) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(fdMessage), sizeof(int));
+                result.Fd = UniqueFd(fd);
+            }
+        }
+
+        auto header = std::as_writable_bytes(std::span(&result.Header, 1));
+        if (!ReceiveAll(header.subspan(static_cast<size_t>(received))) ||
+            result.Header.PayloadSize > MaxIpcPayloadSize) {
+            return std::nullopt;
+        }
+        result.Payload.resize(result.Header.PayloadSize);
+        if (!ReceiveAll(result.Payload)) {
+            return std::nullopt;
+        }
+        return result;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    // Makes a Receive blocked on another thread return.
+    void Shutdown() const {
+#ifndef _WIN32
+        shutdown(m_Socket.Get(), SHUT_RDWR);
+#endif
+    }
+
+private:
+    bool ReceiveAll(std::span<std::byte> buffer) const {
+#ifndef _WIN32
+        while (!buffer.empty()) {
+            ssize_t received = recv(m_Socket.Get(), buffer.data(), buffer.size(), 0);
+            if (received <= 0) {
+                return false;
+            }
+            buffer = buffer.subspan(static_cast<size_t>(received));
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    UniqueFd m_Socket;
+};
+
+// The user who started this process, also when it runs through sudo, so a server started with
+// sudo serves the UI of whoever started it.
+export uint32_t GetInvokingUser() {
+#ifndef _WIN32
+    if (const char *sudoUser = getenv("SUDO_UID"); sudoUser != nullptr && geteuid() == 0) {
+        uint32_t user = 0;
+        std::string_view text = sudoUser;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), user);
+        if (error == std::errc{} && end == text.data() + text.size()) {
+            return user;
+        }
+    }
+    return static_cast<uint32_t>(getuid());
+#else
+    return 0;
+#endif
+}
+
+export class IpcListener {
+public:
+    // Replaces a stale socket file at path. Only allowedUser and the user the listener runs as
+    // may connect, the server can read and write any process it can attach to: the socket file
+    // is given to allowedUser with mode 0600, and Accept checks each client's credentials too.
+    static std::optional<IpcListener> Listen(const std::filesystem::path &path, uint32_t allowedUser) {
+#ifndef _WIN32
+        sockaddr_un address{};
+        std::string pathText = path.string();
+        if (pathText.size() >= sizeof(address.sun_path)) {
+            return std::nullopt;
+        }
+        address.sun_family = AF_UNIX;
+        std::ranges::copy(pathText, address.sun_path);
+        unlink(pathText.c_str());
+
+        UniqueFd socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!socket || bind(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+            chmod(pathText.c_str(), 0600) != 0 || listen(socket.Get(), 16) != 0) {
+            return std::nullopt;
+        }
+        if (allowedUser != geteuid() && chown(pathText.c_str(), static_cast<uid_t>(allowedUser), -1) != 0) {
+            return std::nullopt;
+        }
+        return IpcListener(std::move(socket), allowedUser);
+#else
+        return std::nullopt;
+#endif
+    }
+
+    // Blocks for the next client, nullopt once the listener is shut down. Clients of other
+    // users are disconnected right away.
+    std::optional<IpcChannel> Accept() const {
+#ifndef _WIN32
+        while (true) {
+            UniqueFd client(accept4(m_Socket.Get(), nullptr, nullptr, SOCK_CLOEXEC));
+            if (client) {
+                auto user = GetPeerUser(client.Get());
+                if (user && (*user == m_AllowedUser || *user == geteuid())) {
+                    return IpcChannel(std::move(client));
+                }
+                continue;
+            }
+            if (errno != EINTR && errno != ECONNABORTED) {
+                return std::nullopt;
+            }
+        }
+#else
+        return std::nullopt;
+#endif
+    }
+
+private:
+    IpcListener(UniqueFd socket, uint32_t allowedUser) : m_Socket(std::move(socket)), m_AllowedUser(allowedUser) {
+    }
+
+#ifndef _WIN32
+    // The user of the process that connected, as the kernel recorded it at connect time.
+    static std::optional<uint32_t> GetPeerUser(int socket) {
+#ifdef SO_PEERCRED
+        ucred credentials{};
+        socklen_t size = sizeof(credentials);
+        if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(credentials.uid);
+#else
+        uid_t user;
+        gid_t group;
+        if (getpeereid(socket, &user, &group) != 0) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(user);
+#endif
+    }
+#endif
+
+    UniqueFd m_Socket;
+    uint32_t m_AllowedUser = 0;
+};
+
+// Anonymous shared memory holding a copy of bytes, to pass along with a message. The receiver
+// maps it read only, a large payload then crosses without going through the socket.
+export UniqueFd CreateSharedBytes(std::span<const std::byte> bytes) {
+#ifndef _WIN32
+    UniqueFd fd(memfd_create("easy-reverse-results", MFD_CLOEXEC));
+    if (!fd || ftruncate(fd.Get(), static_cast<off_t>(std::max<size_t>(bytes.size(), 1))) != 0) {
+        return {};
+    }
+    if (!bytes.empty()) {
+        void *memory = mmap(nullptr, bytes.size(), PROT_WRITE, MAP_SHARED, fd.Get(), 0);
+        if (memory == MAP_FAILED) {
+            return {};
+        }
+        std::memcpy(memory, bytes.data(), bytes.size());
+        munmap(memory, bytes.size());
+    }
+    return fd;
+#else
+    return {};
+#endif
+}
+
+// Read only mapping of a descriptor received with CreateSharedBytes.
+export class SharedMapping {
+public:
+    SharedMapping() = default;
+
+    SharedMapping(const SharedMapping &) = delete;
+
+    SharedMapping &operator=(const SharedMapping &) = delete;
+
+    SharedMapping(SharedMapping &&other) noexcept
+        : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)) {
+    }
+
+    SharedMapping &operator=(SharedMapping &&other) noexcept {
+        if (this != &other) {
+            Unmap();
+            m_Data = std::exchange(other.m_Data, nullptr);
+            m_Size = std::exchange(other.m_Size, 0);
+        }
+        return *this;
+    }
+
+    ~SharedMapping() {
+        Unmap();
+    }
+
+    static std::optional<SharedMapping> Map(const UniqueFd &fd, size_t size) {
+        SharedMapping mapping;
+        if (size == 0) {
+            return mapping;
+        }
+#ifndef _WIN32
+        struct stat info{};
+        if (!fd || fstat(fd.Get(), &info) != 0 || static_cast<size_t>(info.st_size) < size) {
+            return std::nullopt;
+        }
+        void *memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd.Get(), 0);
+        if (memory == MAP_FAILED) {
+            return std::nullopt;
+        }
+        mapping.m_Data = static_cast<const std::byte *>(memory);
+        mapping.m_Size = size;
+        return mapping;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    [[nodiscard]] std::span<const std::byte> GetData() const { return {m_Data, m_Size}; }
+
+private:
+    void Unmap() {
+#ifndef _WIN32
+        if (m_Data != nullptr) {
+            munmap(const_cast<std::byte *>(m_Data), m_Size);
+        }
+#endif
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    const std::byte *m_Data = nullptr;
+    size_t m_Size = 0;
+};
@@ -0,0 +1,111 @@
+module;
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module Engine.MappedFile;
+
+import std;
+
+#ifdef _WIN32
+import <windows.h>;
+#endif
+
+// Read only view of a whole file. Pages are faulted in on access, so opening is constant time
+// whatever the file size.
+export class MappedFile {
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)) {
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            Close();
+            m_Data = std::exchange(other.m_Data, nullptr);
+            m_Size = std::exchange(other.m_Size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        Close();
+    }
+
+    static std::optional<MappedFile> Open(const std::filesystem::path &path) {
+        MappedFile file;
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return std::nullopt;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+            CloseHandle(handle);
+            return std::nullopt;
+        }
+        HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(handle);
+        if (mapping == nullptr) {
+            return std::nullopt;
+        }
+        void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (data == nullptr) {
+            return std::nullopt;
+        }
+        file.m_Data = static_cast<const std::byte *>(data);
+        file.m_Size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return std::nullopt;
+        }
+        file.m_Data = static_cast<const std::byte *>(data);
+        file.m_Size = static_cast<size_t>(info.st_size);
+#endif
+        return file;
+    }
+
+    [[nodiscard]] std::span<const std::byte> GetData() const { return {m_Data, m_Size}; }
+
+    [[nodiscard]] bool IsOpen() const { return m_Data != nullptr; }
+
+private:
+    void Close() {
+        if (m_Data == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(m_Data);
+#else
+        munmap(const_cast<std::byte *>(m_Data), m_Size);
+#endif
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    const std::byte *m_Data = nullptr;
+    size_t m_Size = 0;
+};
@@ -0,0 +1,208 @@
+module Engine.PageCache;
+
+PageCache::PageCache(size_t capacityPages)
+    : m_Capacity(std::max<size_t>(capacityPages, 16)) {
+    m_Index.reserve(m_Capacity);
+    m_Reader = std::jthread([this](std::stop_token stopToken) { ReaderLoop(stopToken); });
+}
+
+PageCache::~PageCache() {
+    m_Reader.request_stop();
+    m_RequestCondition.notify_all();
+}
+
+void PageCache::SetProcess(std::shared_ptr<MemorySource> process) {
+    std::lock_guard lock(m_Mutex);
+    if (process == m_Process) {
+        return;
+    }
+
+    m_Process = std::move(process);
+    m_Generation++;
+    m_Pages.clear();
+    m_Index.clear();
+    m_UrgentRequests.clear();
+    m_PrefetchRequests.clear();
+}
+
+void PageCache::SetRefreshInterval(std::chrono::milliseconds interval) {
+    std::lock_guard lock(m_Mutex);
+    m_RefreshInterval = interval;
+}
+
+std::chrono::milliseconds PageCache::GetRefreshInterval() const {
+    std::lock_guard lock(m_Mutex);
+    return m_RefreshInterval;
+}
+
+void PageCache::Read(uint64_t address, std::span<std::byte> data, std::span<uint8_t> flags) {
+    std::ranges::fill(flags, uint8_t{0});
+
+    std::lock_guard lock(m_Mutex);
+    if (!m_Process) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    uint64_t end = address + data.size();
+    for (uint64_t pageAddress = address & ~(PageSize - 1); pageAddress < end; pageAddress += PageSize) {
+        bool created = false;
+        Page &page = *Touch(pageAddress, created);
+
+        if (page.State == PageState::Pending) {
+            m_Stats.Misses++;
+            Enqueue(page, true);
+            continue;
+        }
+
+        m_Stats.Hits++;
+        if (now - page.FetchedAt >= m_RefreshInterval) {
+            Enqueue(page, true);
+        }
+
+        if (page.State == PageState::Unreadable) {
+            continue;
+        }
+
+        uint64_t first = std::max(address, pageAddress);
+        uint64_t last = std::min(end, pageAddress + PageSize);
+        for (uint64_t byteAddress = first; byteAddress < last; byteAddress++) {
+            size_t pageOffset = byteAddress - pageAddress;
+            size_t outOffset = byteAddress - address;
+            data[outOffset] = page.Data[pageOffset];
+            flags[outOffset] = CachedByte::Valid | (page.Changed[pageOffset] ? CachedByte::Changed : 0);
+        }
+    }
+}
+
+void PageCache::Prefetch(uint64_t address, uint64_t size) {
+    std::lock_guard lock(m_Mutex);
+    if (!m_Process) {
+        return;
+    }
+
+    uint64_t end = std::min(address + size, MaxUserAddress);
+    for (uint64_t pageAddress = address & ~(PageSize - 1); pageAddress < end; pageAddress += PageSize) {
+        if (m_Index.contains(pageAddress)) {
+            continue;
+        }
+        bool created = false;
+        Enqueue(*Touch(pageAddress, created), false);
+    }
+
+    // Prefetching must not push out pages that are being shown, keep the backlog small. Dropped
+    // pages were never read, they leave the cache too, or Enqueue would take them for queued.
+    while (m_PrefetchRequests.size() > m_Capacity / 4) {
+        auto found = m_Index.find(m_PrefetchRequests.front());
+        m_PrefetchRequests.pop_front();
+        if (found == m_Index.end() || !found->second->Queued) {
+            continue;
+        }
+        if (found->second->State == PageState::Pending) {
+            m_Pages.erase(found->second);
+            m_Index.erase(found);
+        } else {
+            found->second->Queued = false;
+        }
+    }
+}
+
+PageCacheStats PageCache::GetStats() const {
+    std::lock_guard lock(m_Mutex);
+    PageCacheStats stats = m_Stats;
+    stats.CachedPages = m_Pages.size();
+    return stats;
+}
+
+PageCache::PageList::iterator PageCache::Touch(uint64_t pageAddress, bool &created) {
+    if (auto found = m_Index.find(pageAddress); found != m_Index.end()) {
+        m_Pages.splice(m_Pages.begin(), m_Pages, found->second);
+        created = false;
+        return found->second;
+    }
+
+    created = true;
+    if (m_Pages.size() >= m_Capacity) {
+        // Reuse the least recently used node instead of allocating a new one.
+        auto victim = std::prev(m_Pages.end());
+        m_Index.erase(victim->Address);
+        m_Pages.splice(m_Pages.begin(), m_Pages, victim);
+        m_Stats.Evictions++;
+    } else {
+        m_Pages.emplace_front();
+    }
+
+    Page &page = m_Pages.front();
+    page.Address = pageAddress;
+    page.State = PageState::Pending;
+    page.Queued = false;
+    page.Changed.reset();
+    m_Index.emplace(pageAddress, m_Pages.begin());
+    return m_Pages.begin();
+}
+
+void PageCache::Enqueue(Page &page, bool urgent) {
+    if (page.Queued) {
+        return;
+    }
+    page.Queued = true;
+    (urgent ? m_UrgentRequests : m_PrefetchRequests).push_back(page.Address);
+    m_RequestCondition.notify_one();
+}
+
+void PageCache::ReaderLoop(std::stop_token stopToken) {
+    std::array<std::byte, PageSize> buffer;
+
+    while (!stopToken.stop_requested()) {
+        uint64_t pageAddress;
+        uint64_t generation;
+        std::shared_ptr<MemorySource> process; {
+            std::unique_lock lock(m_Mutex);
+            if (!m_RequestCondition.wait(lock, stopToken, [this] {
+                return !m_UrgentRequests.empty() || !m_PrefetchRequests.empty();
+            })) {
+                return;
+            }
+
+            auto &queue = m_UrgentRequests.empty() ? m_PrefetchRequests : m_UrgentRequests;
+            pageAddress = queue.front();
+            queue.pop_front();
+
+            // The page may have been evicted since it was queued.
+            auto found = m_Index.find(pageAddress);
+            if (found == m_Index.end() || !found->second->Queued) {
+                continue;
+            }
+            generation = m_Generation;
+            process = m_Process;
+        }
+
+        size_t bytesRead = process->Read(pageAddress, buffer);
+
+        std::lock_guard lock(m_Mutex);
+        m_Stats.PageReads++;
+        m_Stats.BytesRead += bytesRead;
+
+        auto found = m_Index.find(pageAddress);
+        if (generation != m_Generation || found == m_Index.end()) {
+            continue;
+        }
+
+        Page &page = *found->second;
+        page.Queued = false;
+        page.FetchedAt = std::chrono::steady_clock::now();
+        if (bytesRead != PageSize) {
+            page.State = PageState::Unreadable;
+            page.Changed.reset();
+            continue;
+        }
+
+        if (page.State == PageState::Valid) {
+            for (size_t i = 0; i < PageSize; i++) {
+                page.Changed[i] = page.Data[i] != buffer[i];
+            }
+        }
+        page.Data = buffer;
+        page.State = PageState::Valid;
+    }
+}
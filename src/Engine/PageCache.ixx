@@ -0,0 +1,100 @@
+export module Engine.PageCache;
+
+import std;
+export import Engine.ProcessMemory;
+
+export namespace CachedByte {
+    constexpr uint8_t Valid = 1 << 0;
+    // Differs from the value seen by the previous refresh of its page.
+    constexpr uint8_t Changed = 1 << 1;
+}
+
+export struct PageCacheStats {
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t PageReads = 0;
+    uint64_t BytesRead = 0;
+    uint64_t Evictions = 0;
+    size_t CachedPages = 0;
+};
+
+// Page granular cache of a target's memory for views that show a small, moving window of it.
+// Lookups never block on the target: missing and stale pages are queued for a background reader,
+// which serves pages the view is showing before prefetched ones. Capacity is fixed and pages
+// are evicted least recently used first, so memory stays bounded however far the view scrolls.
+export class PageCache {
+public:
+    static constexpr uint64_t PageSize = 4096;
+
+    explicit PageCache(size_t capacityPages = 1024);
+
+    PageCache(const PageCache &) = delete;
+
+    PageCache &operator=(const PageCache &) = delete;
+
+    ~PageCache();
+
+    // Drops every cached page when the process changes.
+    void SetProcess(std::shared_ptr<MemorySource> process);
+
+    // Cached pages older than this are read again the next time they are looked up.
+    void SetRefreshInterval(std::chrono::milliseconds interval);
+
+    [[nodiscard]] std::chrono::milliseconds GetRefreshInterval() const;
+
+    // Copies [address, address + data.size()) out of the cache and fills flags with CachedByte
+    // bits. Bytes of pages not cached yet are left invalid, their pages are requested.
+    void Read(uint64_t address, std::span<std::byte> data, std::span<uint8_t> flags);
+
+    // Queues pages of the range that are not cached at low priority.
+    void Prefetch(uint64_t address, uint64_t size);
+
+    [[nodiscard]] PageCacheStats GetStats() const;
+
+private:
+    enum class PageState : uint8_t {
+        Pending,
+        Valid,
+        Unreadable
+    };
+
+    struct Page {
+        uint64_t Address = 0;
+        PageState State = PageState::Pending;
+        bool Queued = false;
+        std::chrono::steady_clock::time_point FetchedAt{};
+        std::array<std::byte, PageSize> Data{};
+        std::bitset<PageSize> Changed;
+    };
+
+    using PageList = std::list<Page>;
+
+    // Returns the page, creating a pending entry (evicting if needed) when it is not cached.
+    // Expects m_Mutex to be held.
+    PageList::iterator Touch(uint64_t pageAddress, bool &created);
+
+    void Enqueue(Page &page, bool urgent);
+
+    void ReaderLoop(std::stop_token stopToken);
+
+    size_t m_Capacity;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable_any m_RequestCondition;
+
+    std::shared_ptr<MemorySource> m_Process;
+    // Bumped by SetProcess, reads started for an older process are discarded.
+    uint64_t m_Generation = 0;
+    std::chrono::milliseconds m_RefreshInterval{250};
+
+    // Front is the most recently used page.
+    PageList m_Pages;
+    std::unordered_map<uint64_t, PageList::iterator> m_Index;
+
+    std::deque<uint64_t> m_UrgentRequests;
+    std::deque<uint64_t> m_PrefetchRequests;
+
+    PageCacheStats m_Stats;
+
+    std::jthread m_Reader;
+};
@@ -0,0 +1,98 @@
+export module Engine.PointerScan;
+
+import std;
+import Engine.ProcessMemory;
+import Engine.Session;
+
+// Base is the address of the first pointer. Each step reads a pointer and adds the next offset,
+// the last offset lands on the target: target = [[[Base] + Offsets[0]] + Offsets[1]] + ...
+export struct PointerPath {
+    uint64_t Base = 0;
+    std::vector<uint64_t> Offsets;
+};
+
+export struct PointerScanOptions {
+    uint32_t MaxDepth = 4;
+    uint64_t MaxOffset = 0x1000;
+    size_t MaxResults = 4096;
+};
+
+static bool InRegions(std::span<const MemoryRegion> regions, uint64_t address) {
+    auto it = std::ranges::upper_bound(regions, address, {}, &MemoryRegion::Base);
+    if (it == regions.begin()) {
+        return false;
+    }
+    --it;
+    return address - it->Base < it->Size;
+}
+
+// Every 8 byte aligned value inside regions that points into one of them, sorted by address.
+// Regions have to be sorted, as MemorySource::QueryRegions returns them.
+export std::vector<PointerMapRecord> BuildPointerMap(const MemorySource &process,
+                                                     std::span<const MemoryRegion> regions) {
+    constexpr uint64_t ChunkSize = 1024 * 1024;
+    std::vector<PointerMapRecord> map;
+    std::vector<std::byte> scratch;
+
+    const uint64_t lowest = regions.empty() ? 0 : regions.front().Base;
+    const uint64_t highest = regions.empty() ? 0 : regions.back().Base + regions.back().Size;
+    for (const auto &region: regions) {
+        for (uint64_t offset = 0; offset < region.Size; offset += ChunkSize) {
+            uint64_t size = std::min(ChunkSize, region.Size - offset);
+            auto bytes = process.Fetch(region.Base + offset, size, scratch);
+            for (size_t i = 0; i < bytes.size() / sizeof(uint64_t); i++) {
+                uint64_t value;
+                std::memcpy(&value, bytes.data() + i * sizeof(uint64_t), sizeof(value));
+                // Most values are rejected by the range check before the binary search.
+                if (value >= lowest && value < highest && InRegions(regions, value)) {
+                    map.push_back({region.Base + offset + i * sizeof(uint64_t), value});
+                }
+            }
+        }
+    }
+    return map;
+}
+
+// Walks backwards from target through map: pointers whose value lies at most MaxOffset below
+// the current address lead one level up. Paths end at pointers located inside roots, typically
+// the data sections of a module, which stay put across restarts.
+export std::vector<PointerPath> FindPointerPaths(std::span<const PointerMapRecord> map,
+                                                 std::span<const MemoryRegion> roots, uint64_t target,
+                                                 const PointerScanOptions &options) {
+    std::vector<PointerMapRecord> byTarget(map.begin(), map.end());
+    std::ranges::sort(byTarget, {}, &PointerMapRecord::Target);
+
+    std::vector<PointerPath> paths;
+    std::vector<uint64_t> offsets; // target first, reversed when a path is emitted
+
+    auto walk = [&](this auto &self, uint64_t address, uint32_t depth) -> void {
+        uint64_t low = address >= options.MaxOffset ? address - options.MaxOffset : 0;
+        auto first = std::ranges::lower_bound(byTarget, low, {}, &PointerMapRecord::Target);
+        auto last = std::ranges::upper_bound(byTarget, address, {}, &PointerMapRecord::Target);
+        // Closest pointers first, they are the likelier struct bases.
+        for (auto it = last; it != first && paths.size() < options.MaxResults;) {
+            --it;
+            offsets.push_back(address - it->Target);
+            if (InRegions(roots, it->Address)) {
+                paths.push_back({it->Address, {offsets.rbegin(), offsets.rend()}});
+            } else if (depth + 1 < options.MaxDepth) {
+                self(it->Address, depth + 1);
+            }
+            offsets.pop_back();
+        }
+    };
+    walk(target, 0);
+    return paths;
+}
+
+export std::optional<uint64_t> ResolvePointerPath(const MemorySource &process, const PointerPath &path) {
+    uint64_t address = path.Base;
+    for (uint64_t offset: path.Offsets) {
+        auto pointer = process.ReadValue<uint64_t>(address);
+        if (!pointer) {
+            return std::nullopt;
+        }
+        address = *pointer + offset;
+    }
+    return address;
+}
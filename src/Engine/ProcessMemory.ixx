@@ -0,0 +1,514 @@
+module;
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+export module Engine.ProcessMemory;
+
+import std;
+
+#ifdef _WIN32
+import <windows.h>;
+#endif
+
+// Highest user mode address on x86-64 Windows and Linux (47 bit canonical lower half).
+export constexpr uint64_t MaxUserAddress = 0x0000'8000'0000'0000ull;
+
+export namespace RegionAccess {
+    constexpr uint32_t Read = 1 << 0;
+    constexpr uint32_t Write = 1 << 1;
+    constexpr uint32_t Execute = 1 << 2;
+}
+
+export struct MemoryRegion {
+    uint64_t Base;
+    uint64_t Size;
+    uint32_t Access; // RegionAccess flags
+};
+
+// One entry of MemorySource::ReadBatch, Copied is filled in like the return value of Read.
+export struct BatchRead {
+    uint64_t Address;
+    std::span<std::byte> Buffer;
+    size_t Copied = 0;
+};
+
+// Reads that run while the caller works on the ones before. Submit starts a read, Wait blocks
+// until the oldest unfinished one is done and returns its byte count like Read does. Readers go
+// back to their source once released, which has to happen with nothing in flight.
+export class AsyncReader {
+public:
+    static constexpr size_t MaxDepth = 16;
+
+    virtual ~AsyncReader() = default;
+
+    // At most MaxDepth reads in flight, the buffer has to stay alive until its Wait.
+    virtual void Submit(uint64_t address, std::span<std::byte> buffer) = 0;
+
+    virtual size_t Wait() = 0;
+};
+
+// Something with an address space to scan: a live process or a dump file. Reads may be partial
+// when the range crosses into unmapped or protected pages, callers get the number of bytes
+// actually copied.
+export class MemorySource {
+public:
+    virtual ~MemorySource() = default;
+
+    virtual size_t Read(uint64_t address, std::span<std::byte> buffer) const = 0;
+
+    // Many small reads at once, for sources where handing them over together is cheaper than
+    // one call each.
+    virtual void ReadBatch(std::span<BatchRead> reads) const {
+        for (auto &read: reads) {
+            read.Copied = Read(read.Address, read.Buffer);
+        }
+    }
+
+    // Returns 0 for read only sources.
+    virtual size_t Write(uint64_t address, std::span<const std::byte> buffer) const {
+        return 0;
+    }
+
+    // Committed, readable regions in address order.
+    [[nodiscard]] virtual std::vector<MemoryRegion> QueryRegions() const = 0;
+
+    // Bytes at address without copying, for sources that have them mapped. Empty if the
+    // source cannot, otherwise up to size bytes, ending early at the end of a region.
+    [[nodiscard]] virtual std::span<const std::byte> View(uint64_t address, size_t size) const {
+        return {};
+    }
+
+    // 0 when there is no live process behind the source.
+    [[nodiscard]] virtual uint32_t GetProcessId() const { return 0; }
+
+    // nullptr for sources whose reads cannot overlap with the caller's work, read those with Read.
+    [[nodiscard]] virtual std::shared_ptr<AsyncReader> OpenAsyncReader() const { return nullptr; }
+
+    // View if possible, otherwise a Read into scratch. May be shorter than size, like Read.
+    std::span<const std::byte> Fetch(uint64_t address, size_t size, std::vector<std::byte> &scratch) const {
+        if (auto view = View(address, size); !view.empty()) {
+            return view;
+        }
+        scratch.resize(size);
+        return std::span<const std::byte>(scratch).first(Read(address, scratch));
+    }
+
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    std::optional<T> ReadValue(uint64_t address) const {
+        T value;
+        if (Read(address, std::as_writable_bytes(std::span{&value, 1})) != sizeof(T)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+};
+
+// Reads on a helper thread, one after the other, for sources that only read synchronously: the
+// copy then overlaps with the caller's work instead of running before it.
+class ThreadedReader final : public AsyncReader {
+public:
+    explicit ThreadedReader(const MemorySource &source) : m_Source(source) {
+        m_Thread = std::jthread([this](std::stop_token stop) { Run(stop); });
+    }
+
+    void Submit(uint64_t address, std::span<std::byte> buffer) override {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Reads.push_back({address, buffer});
+        }
+        m_Wake.notify_all();
+    }
+
+    size_t Wait() override {
+        std::unique_lock lock(m_Mutex);
+        m_Wake.wait(lock, [this] { return m_Finished > 0; });
+        size_t copied = m_Reads.front().Copied;
+        m_Reads.pop_front();
+        m_Finished--;
+        return copied;
+    }
+
+private:
+    void Run(std::stop_token stop) {
+        std::unique_lock lock(m_Mutex);
+        while (m_Wake.wait(lock, stop, [this] { return m_Finished < m_Reads.size(); })) {
+            // Wait only pops finished reads, so the reference stays valid while unlocked.
+            BatchRead &read = m_Reads[m_Finished];
+            lock.unlock();
+            read.Copied = m_Source.Read(read.Address, read.Buffer);
+            lock.lock();
+            m_Finished++;
+            m_Wake.notify_all();
+        }
+    }
+
+    const MemorySource &m_Source;
+    std::mutex m_Mutex;
+    std::condition_variable_any m_Wake;
+    std::deque<BatchRead> m_Reads; // in submission order, the first m_Finished of them done
+    size_t m_Finished = 0;
+    std::jthread m_Thread;
+};
+
+#ifndef _WIN32
+// io_uring reads of /proc/<pid>/mem. The kernel runs them on its own worker threads, so the
+// reads in flight copy side by side and all of them overlap with the caller's work. Readv
+// rather than read keeps kernels from 5.1 on working.
+class IoUringReader final : public AsyncReader {
+public:
+    // nullptr where io_uring is missing or not allowed, as in many containers.
+    static std::unique_ptr<IoUringReader> Create(uint32_t processId) {
+        int file = open(std::format("/proc/{}/mem", processId).c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) {
+            return nullptr;
+        }
+        io_uring_params params{};
+        int ring = static_cast<int>(syscall(__NR_io_uring_setup, MaxDepth, &params));
+        if (ring < 0) {
+            close(file);
+            return nullptr;
+        }
+        auto reader = std::unique_ptr<IoUringReader>(new IoUringReader(file, ring));
+        return reader->Map(params) ? std::move(reader) : nullptr;
+    }
+
+    IoUringReader(const IoUringReader &) = delete;
+
+    IoUringReader &operator=(const IoUringReader &) = delete;
+
+    ~IoUringReader() override {
+        if (m_Sqes != MAP_FAILED) {
+            munmap(m_Sqes, m_SqesSize);
+        }
+        if (m_CqRing != MAP_FAILED && m_CqRing != m_SqRing) {
+            munmap(m_CqRing, m_CqSize);
+        }
+        if (m_SqRing != MAP_FAILED) {
+            munmap(m_SqRing, m_SqSize);
+        }
+        close(m_Ring);
+        close(m_File);
+    }
+
+    void Submit(uint64_t address, std::span<std::byte> buffer) override {
+        uint64_t sequence = m_Submitted++;
+        Slot &slot = m_Slots[sequence % MaxDepth];
+        slot = {sequence, {buffer.data(), buffer.size()}};
+
+        io_uring_sqe entry{};
+        entry.opcode = IORING_OP_READV;
+        entry.fd = m_File;
+        entry.addr = reinterpret_cast<uint64_t>(&slot.Vector);
+        entry.len = 1;
+        entry.off = address;
+        entry.user_data = sequence;
+        if (!Push(entry)) {
+            // Never reached the kernel, so nothing writes the buffer: the read just failed.
+            slot.Done = true;
+        }
+    }
+
+    size_t Wait() override {
+        Slot &slot = m_Slots[m_Completed % MaxDepth];
+        bool cancelled = false;
+        while (!Reap(slot)) {
+            if (syscall(__NR_io_uring_enter, m_Ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                // The kernel may still be writing the buffer, so the read stays in flight until
+                // its completion shows up: have it cancelled and keep watching the ring.
+                if (!cancelled) {
+                    io_uring_sqe entry{};
+                    entry.opcode = IORING_OP_ASYNC_CANCEL;
+                    entry.addr = slot.Sequence;
+                    entry.user_data = CancelTag;
+                    cancelled = Push(entry);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        m_Completed++;
+        return slot.Result;
+    }
+
+private:
+    // user_data of cancel requests, no read gets that far.
+    static constexpr uint64_t CancelTag = ~uint64_t{0};
+
+    struct Slot {
+        uint64_t Sequence = 0;
+        iovec Vector{};
+        size_t Result = 0;
+        bool Done = false;
+    };
+
+    IoUringReader(int file, int ring) : m_File(file), m_Ring(ring) {
+    }
+
+    bool Map(const io_uring_params &params) {
+        m_SqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_CqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            m_SqSize = m_CqSize = std::max(m_SqSize, m_CqSize);
+        }
+        constexpr int protection = PROT_READ | PROT_WRITE;
+        m_SqRing = mmap(nullptr, m_SqSize, protection, MAP_SHARED | MAP_POPULATE, m_Ring, IORING_OFF_SQ_RING);
+        m_CqRing = single ? m_SqRing : mmap(nullptr, m_CqSize, protection, MAP_SHARED | MAP_POPULATE, m_Ring,
+                                            IORING_OFF_CQ_RING);
+        m_Sqes = mmap(nullptr, m_SqesSize, protection, MAP_SHARED | MAP_POPULATE, m_Ring, IORING_OFF_SQES);
+        if (m_SqRing == MAP_FAILED || m_CqRing == MAP_FAILED || m_Sqes == MAP_FAILED) {
+            return false;
+        }
+
+        auto *sq = static_cast<std::byte *>(m_SqRing);
+        m_SqTail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+        m_SqMask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+        m_SqArray = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+        auto *cq = static_cast<std::byte *>(m_CqRing);
+        m_CqHead = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+        m_CqTail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+        m_CqMask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+        m_Cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queues entry and hands it to the kernel, false if the kernel did not take it.
+    bool Push(const io_uring_sqe &entry) {
+        uint32_t tail = *m_SqTail;
+        uint32_t index = tail & m_SqMask;
+        static_cast<io_uring_sqe *>(m_Sqes)[index] = entry;
+        m_SqArray[index] = index;
+        std::atomic_ref(*m_SqTail).store(tail + 1, std::memory_order_release);
+
+        long submitted;
+        do {
+            submitted = syscall(__NR_io_uring_enter, m_Ring, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && (errno == EINTR || errno == EAGAIN));
+        if (submitted < 1) {
+            std::atomic_ref(*m_SqTail).store(tail, std::memory_order_release);
+            return false;
+        }
+        return true;
+    }
+
+    // Takes every completion there is, completions come in any order. True once slot is done.
+    bool Reap(Slot &slot) {
+        uint32_t head = *m_CqHead;
+        uint32_t tail = std::atomic_ref(*m_CqTail).load(std::memory_order_acquire);
+        for (; head != tail; head++) {
+            const io_uring_cqe &entry = m_Cqes[head & m_CqMask];
+            Slot &finished = m_Slots[entry.user_data % MaxDepth];
+            if (finished.Sequence == entry.user_data) {
+                finished.Result = entry.res < 0 ? 0 : static_cast<size_t>(entry.res);
+                finished.Done = true;
+            }
+        }
+        std::atomic_ref(*m_CqHead).store(head, std::memory_order_release);
+        return slot.Done;
+    }
+
+    int m_File;
+    int m_Ring;
+    void *m_SqRing = MAP_FAILED;
+    void *m_CqRing = MAP_FAILED;
+    void *m_Sqes = MAP_FAILED;
+    size_t m_SqSize = 0;
+    size_t m_CqSize = 0;
+    size_t m_SqesSize = 0;
+    uint32_t *m_SqTail = nullptr;
+    uint32_t *m_SqArray = nullptr;
+    uint32_t m_SqMask = 0;
+    uint32_t *m_CqHead = nullptr;
+    uint32_t *m_CqTail = nullptr;
+    uint32_t m_CqMask = 0;
+    io_uring_cqe *m_Cqes = nullptr;
+
+    std::array<Slot, MaxDepth> m_Slots;
+    uint64_t m_Submitted = 0;
+    uint64_t m_Completed = 0;
+};
+#endif
+
+// Read and write access to another process' address space.
+export class ProcessMemory final : public MemorySource, public std::enable_shared_from_this<ProcessMemory> {
+public:
+    // Returns nullptr if the process does not exist or cannot be opened for reading.
+    static std::shared_ptr<ProcessMemory> Open(uint32_t processId) {
+#ifdef _WIN32
+        HANDLE handle = OpenProcess(PROCESS_VM_READ | PROCESS_VM_WRITE | PROCESS_VM_OPERATION |
+                                    PROCESS_QUERY_INFORMATION, FALSE, processId);
+        if (handle == nullptr) {
+            return nullptr;
+        }
+        return std::shared_ptr<ProcessMemory>(new ProcessMemory(processId, handle));
+#else
+        if (!std::filesystem::exists(std::format("/proc/{}/mem", processId))) {
+            return nullptr;
+        }
+        return std::shared_ptr<ProcessMemory>(new ProcessMemory(processId));
+#endif
+    }
+
+    ProcessMemory(const ProcessMemory &) = delete;
+
+    ProcessMemory &operator=(const ProcessMemory &) = delete;
+
+    ~ProcessMemory() override {
+        m_IdleReaders.clear();
+#ifdef _WIN32
+        CloseHandle(m_Handle);
+#endif
+    }
+
+    [[nodiscard]] uint32_t GetProcessId() const override { return m_ProcessId; }
+
+    // io_uring on Linux where the kernel allows it, a reader thread elsewhere; Windows has no
+    // overlapped ReadProcessMemory. Released readers are kept for the next caller, setting one up
+    // costs a ring or a thread. A reader keeps this alive, so it can be released after the last
+    // other reference to the process is gone.
+    [[nodiscard]] std::shared_ptr<AsyncReader> OpenAsyncReader() const override {
+        std::unique_ptr<AsyncReader> reader;
+        {
+            std::lock_guard lock(m_ReaderMutex);
+            if (!m_IdleReaders.empty()) {
+                reader = std::move(m_IdleReaders.back());
+                m_IdleReaders.pop_back();
+            }
+        }
+#ifndef _WIN32
+        if (!reader) {
+            reader = IoUringReader::Create(m_ProcessId);
+        }
+#endif
+        if (!reader) {
+            reader = std::make_unique<ThreadedReader>(*this);
+        }
+        return std::shared_ptr<AsyncReader>(reader.release(), [self = shared_from_this()](AsyncReader *released) {
+            std::lock_guard lock(self->m_ReaderMutex);
+            self->m_IdleReaders.emplace_back(released);
+        });
+    }
+
+    size_t Read(uint64_t address, std::span<std::byte> buffer) const override {
+        if (buffer.empty()) {
+            return 0;
+        }
+#ifdef _WIN32
+        SIZE_T bytesRead = 0;
+        ReadProcessMemory(m_Handle, reinterpret_cast<LPCVOID>(address), buffer.data(), buffer.size(), &bytesRead);
+        return bytesRead;
+#else
+        iovec local{buffer.data(), buffer.size()};
+        iovec remote{reinterpret_cast<void *>(address), buffer.size()};
+        ssize_t bytesRead = process_vm_readv(static_cast<pid_t>(m_ProcessId), &local, 1, &remote, 1, 0);
+        return bytesRead < 0 ? 0 : static_cast<size_t>(bytesRead);
+#endif
+    }
+
+    size_t Write(uint64_t address, std::span<const std::byte> buffer) const override {
+        if (buffer.empty()) {
+            return 0;
+        }
+#ifdef _WIN32
+        SIZE_T bytesWritten = 0;
+        WriteProcessMemory(m_Handle, reinterpret_cast<LPVOID>(address), buffer.data(), buffer.size(), &bytesWritten);
+        return bytesWritten;
+#else
+        iovec local{const_cast<std::byte *>(buffer.data()), buffer.size()};
+        iovec remote{reinterpret_cast<void *>(address), buffer.size()};
+        ssize_t bytesWritten = process_vm_writev(static_cast<pid_t>(m_ProcessId), &local, 1, &remote, 1, 0);
+        return bytesWritten < 0 ? 0 : static_cast<size_t>(bytesWritten);
+#endif
+    }
+
+    [[nodiscard]] std::vector<MemoryRegion> QueryRegions() const override {
+        std::vector<MemoryRegion> regions;
+#ifdef _WIN32
+        MEMORY_BASIC_INFORMATION info;
+        uint64_t address = 0;
+        while (address < MaxUserAddress &&
+               VirtualQueryEx(m_Handle, reinterpret_cast<LPCVOID>(address), &info, sizeof(info)) == sizeof(info)) {
+            address = reinterpret_cast<uint64_t>(info.BaseAddress) + info.RegionSize;
+            if (info.State != MEM_COMMIT || (info.Protect & (PAGE_NOACCESS | PAGE_GUARD)) != 0) {
+                continue;
+            }
+            uint32_t access = RegionAccess::Read;
+            if (info.Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) {
+                access |= RegionAccess::Write;
+            }
+            if (info.Protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) {
+                access |= RegionAccess::Execute;
+            }
+            regions.push_back({reinterpret_cast<uint64_t>(info.BaseAddress), info.RegionSize, access});
+        }
+#else
+        // start-end perms offset dev inode path
+        std::ifstream maps(std::format("/proc/{}/maps", m_ProcessId));
+        std::string line;
+        while (std::getline(maps, line)) {
+            uint64_t start = 0;
+            uint64_t end = 0;
+            auto dash = line.find('-');
+            auto space = line.find(' ');
+            if (dash == std::string::npos || space == std::string::npos || space + 4 > line.size()) {
+                continue;
+            }
+            std::from_chars(line.data(), line.data() + dash, start, 16);
+            std::from_chars(line.data() + dash + 1, line.data() + space, end, 16);
+            std::string_view perms(line.data() + space + 1, 3);
+            if (perms[0] != 'r' || end <= start || start >= MaxUserAddress) {
+                continue;
+            }
+            uint32_t access = RegionAccess::Read;
+            access |= perms[1] == 'w' ? RegionAccess::Write : 0;
+            access |= perms[2] == 'x' ? RegionAccess::Execute : 0;
+            regions.push_back({start, end - start, access});
+        }
+#endif
+        return regions;
+    }
+
+private:
+#ifdef _WIN32
+    ProcessMemory(uint32_t processId, HANDLE handle) : m_ProcessId(processId), m_Handle(handle) {
+    }
+
+    uint32_t m_ProcessId;
+    HANDLE m_Handle;
+#else
+    explicit ProcessMemory(uint32_t processId) : m_ProcessId(processId) {
+    }
+
+    uint32_t m_ProcessId;
+#endif
+
+    mutable std::mutex m_ReaderMutex;
+    mutable std::vector<std::unique_ptr<AsyncReader>> m_IdleReaders;
+};
+
+// The process or dump the UI is looking at, shared between panels. Readers hold on to the
+// pointer returned by Get for as long as they use it, so attaching elsewhere never pulls it
+// from under them.
+export class TargetProcess {
+public:
+    [[nodiscard]] std::shared_ptr<MemorySource> Get() const {
+        return m_Process.load();
+    }
+
+    void Set(std::shared_ptr<MemorySource> process) {
+        m_Process.store(std::move(process));
+    }
+
+private:
+    std::atomic<std::shared_ptr<MemorySource>> m_Process;
+};
@@ -0,0 +1,240 @@
+export module Engine.ScanClient;
+
+import std;
+import Engine.IpcChannel;
+export import Engine.ProcessMemory;
+import Engine.Scanner;
+import Engine.ScanProtocol;
+import Engine.Session;
+
+export struct RemoteScanState {
+    bool Running = false;
+    float Progress = 1.0f;
+    ScanValueType Type = ScanValueType::Int32;
+    bool HasResults = false;
+    uint64_t ResultCount = 0;
+    uint64_t ResultGeneration = 0;
+};
+
+// Scan results mapped from the server's shared memory, read in place.
+export class RemoteResults {
+public:
+    RemoteResults(SharedMapping mapping, ScanValueType type, uint64_t generation)
+        : m_Mapping(std::move(mapping)), m_Type(type), m_Generation(generation) {
+    }
+
+    [[nodiscard]] std::span<const ScanResultRecord> Get() const {
+        auto bytes = m_Mapping.GetData();
+        return {reinterpret_cast<const ScanResultRecord *>(bytes.data()), bytes.size() / sizeof(ScanResultRecord)};
+    }
+
+    [[nodiscard]] ScanValueType GetType() const { return m_Type; }
+
+    [[nodiscard]] uint64_t GetGeneration() const { return m_Generation; }
+
+private:
+    SharedMapping m_Mapping;
+    ScanValueType m_Type;
+    uint64_t m_Generation;
+};
+
+// Connection to a scan server. Requests may be sent from any thread and are pipelined: Send
+// returns at once with a future, a receiver thread fulfils them as the replies come in.
+export class ScanClient {
+public:
+    static std::shared_ptr<ScanClient> Connect(const std::filesystem::path &path) {
+        auto channel = IpcChannel::Connect(path);
+        if (!channel) {
+            return nullptr;
+        }
+        return std::shared_ptr<ScanClient>(new ScanClient(std::move(*channel)));
+    }
+
+    ScanClient(const ScanClient &) = delete;
+
+    ScanClient &operator=(const ScanClient &) = delete;
+
+    ~ScanClient() {
+        m_Channel.Shutdown();
+        m_Receiver.join();
+    }
+
+    // False once the server went away, every reply then comes back failed.
+    [[nodiscard]] bool IsConnected() const { return m_Connected; }
+
+    std::future<IpcMessage> Send(ScanMessage type, std::span<const std::byte> payload) {
+        std::promise<IpcMessage> promise;
+        auto future = promise.get_future();
+        std::lock_guard sendLock(m_SendMutex);
+        uint32_t id = m_NextRequestId++; {
+            std::lock_guard lock(m_PendingMutex);
+            if (!m_Connected) {
+                promise.set_value(Failed(static_cast<uint32_t>(type), id));
+                return future;
+            }
+            m_Pending.emplace(id, std::move(promise));
+        }
+        if (!m_Channel.Send({static_cast<uint32_t>(type), id, 0, 0}, payload)) {
+            // The receiver fails whatever is still pending once it sees the socket close.
+            m_Channel.Shutdown();
+        }
+        return future;
+    }
+
+    std::optional<uint32_t> Attach(uint32_t processId) {
+        auto reply = Send(ScanMessage::Attach, AsPayload(AttachPayload{processId})).get();
+        auto target = FromPayload<TargetPayload>(reply.Payload);
+        if (reply.Header.Status != ScanStatusOk || !target) {
+            return std::nullopt;
+        }
+        return target->TargetId;
+    }
+
+    void Detach(uint32_t targetId) {
+        Send(ScanMessage::Detach, AsPayload(TargetPayload{targetId})).wait();
+    }
+
+    bool StartScan(uint32_t targetId, const ScanRequest &request) {
+        StartScanPayload payload{
+            targetId, static_cast<uint32_t>(request.Type), static_cast<uint32_t>(request.Compare), 0, request.Value
+        };
+        return Send(ScanMessage::StartScan, AsPayload(payload)).get().Header.Status == ScanStatusOk;
+    }
+
+    void ResetScan(uint32_t targetId) {
+        Send(ScanMessage::ResetScan, AsPayload(TargetPayload{targetId})).wait();
+    }
+
+    std::future<IpcMessage> RequestScanState(uint32_t targetId) {
+        return Send(ScanMessage::GetScanState, AsPayload(TargetPayload{targetId}));
+    }
+
+    static std::optional<RemoteScanState> ParseScanState(const IpcMessage &reply) {
+        auto payload = FromPayload<ScanStatePayload>(reply.Payload);
+        if (reply.Header.Status != ScanStatusOk || !payload) {
+            return std::nullopt;
+        }
+        return RemoteScanState{
+            payload->Running != 0, payload->Progress, static_cast<ScanValueType>(payload->Type),
+            payload->HasResults != 0, payload->ResultCount, payload->ResultGeneration
+        };
+    }
+
+    std::future<IpcMessage> RequestResults(uint32_t targetId) {
+        return Send(ScanMessage::GetResults, AsPayload(TargetPayload{targetId}));
+    }
+
+    static std::shared_ptr<const RemoteResults> ParseResults(const IpcMessage &reply) {
+        auto payload = FromPayload<ResultsPayload>(reply.Payload);
+        if (reply.Header.Status != ScanStatusOk || !payload) {
+            return nullptr;
+        }
+        auto mapping = SharedMapping::Map(reply.Fd, payload->Count * sizeof(ScanResultRecord));
+        if (!mapping) {
+            return nullptr;
+        }
+        return std::make_shared<const RemoteResults>(std::move(*mapping), static_cast<ScanValueType>(payload->Type),
+                                                     payload->Generation);
+    }
+
+private:
+    explicit ScanClient(IpcChannel channel) : m_Channel(std::move(channel)) {
+        m_Receiver = std::thread([this] { Receive(); });
+    }
+
+    static IpcMessage Failed(uint32_t type, uint32_t id) {
+        IpcMessage message;
+        message.Header = {type, id, ScanStatusFailed, 0};
+        return message;
+    }
+
+    void Receive() {
+        while (auto reply = m_Channel.Receive()) {
+            std::lock_guard lock(m_PendingMutex);
+            auto it = m_Pending.find(reply->Header.RequestId);
+            if (it != m_Pending.end()) {
+                it->second.set_value(std::move(*reply));
+                m_Pending.erase(it);
+            }
+        }
+
+        std::lock_guard lock(m_PendingMutex);
+        m_Connected = false;
+        for (auto &[id, promise]: m_Pending) {
+            promise.set_value(Failed(0, id));
+        }
+        m_Pending.clear();
+    }
+
+    IpcChannel m_Channel;
+
+    std::mutex m_SendMutex;
+    uint32_t m_NextRequestId = 1;
+
+    std::mutex m_PendingMutex;
+    std::unordered_map<uint32_t, std::promise<IpcMessage>> m_Pending;
+    std::atomic<bool> m_Connected = true;
+
+    std::thread m_Receiver;
+};
+
+// A target attached by the server, read and written through it. Batched reads go out
+// back to back before the first reply is awaited.
+export class RemoteSource final : public MemorySource {
+public:
+    RemoteSource(std::shared_ptr<ScanClient> client, uint32_t targetId, uint32_t processId)
+        : m_Client(std::move(client)), m_TargetId(targetId), m_ProcessId(processId) {
+    }
+
+    [[nodiscard]] uint32_t GetTargetId() const { return m_TargetId; }
+
+    [[nodiscard]] const std::shared_ptr<ScanClient> &GetClient() const { return m_Client; }
+
+    [[nodiscard]] uint32_t GetProcessId() const override { return m_ProcessId; }
+
+    size_t Read(uint64_t address, std::span<std::byte> buffer) const override {
+        BatchRead read{address, buffer};
+        ReadBatch(std::span(&read, 1));
+        return read.Copied;
+    }
+
+    void ReadBatch(std::span<BatchRead> reads) const override {
+        std::vector<std::future<IpcMessage>> replies;
+        replies.reserve(reads.size());
+        for (const auto &read: reads) {
+            ReadPayload payload{
+                m_TargetId, static_cast<uint32_t>(std::min<size_t>(read.Buffer.size(), MaxRemoteReadSize)),
+                read.Address
+            };
+            replies.push_back(m_Client->Send(ScanMessage::Read, AsPayload(payload)));
+        }
+        for (size_t i = 0; i < reads.size(); i++) {
+            IpcMessage reply = replies[i].get();
+            size_t size = std::min(reply.Payload.size(), reads[i].Buffer.size());
+            reads[i].Copied = reply.Header.Status == ScanStatusOk ? size : 0;
+            std::memcpy(reads[i].Buffer.data(), reply.Payload.data(), reads[i].Copied);
+        }
+    }
+
+    size_t Write(uint64_t address, std::span<const std::byte> buffer) const override {
+        std::vector<std::byte> payload(sizeof(WritePayload));
+        WritePayload header{m_TargetId, 0, address};
+        std::memcpy(payload.data(), &header, sizeof(header));
+        payload.insert(payload.end(), buffer.begin(), buffer.end());
+        IpcMessage reply = m_Client->Send(ScanMessage::Write, payload).get();
+        auto written = FromPayload<uint64_t>(reply.Payload);
+        return reply.Header.Status == ScanStatusOk && written ? static_cast<size_t>(*written) : 0;
+    }
+
+    [[nodiscard]] std::vector<MemoryRegion> QueryRegions() const override {
+        IpcMessage reply = m_Client->Send(ScanMessage::QueryRegions, AsPayload(TargetPayload{m_TargetId})).get();
+        std::vector<MemoryRegion> regions(reply.Payload.size() / sizeof(MemoryRegion));
+        std::memcpy(regions.data(), reply.Payload.data(), regions.size() * sizeof(MemoryRegion));
+        return regions;
+    }
+
+private:
+    std::shared_ptr<ScanClient> m_Client;
+    uint32_t m_TargetId;
+    uint32_t m_ProcessId;
+};
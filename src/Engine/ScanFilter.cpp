@@ -0,0 +1,757 @@
+module Engine.Scanner;
+
+// Each register holds one value per lane of a block, nodes are registers one to one.
+constexpr size_t MaxRegisters = 32;
+constexpr size_t MaxNesting = 16;
+// Fields stay this close to the value, so next scans can keep reading runs of results at once.
+constexpr int64_t MaxFieldOffset = 4096;
+
+enum class FilterOp : uint8_t {
+    Field, // the Type at Offset from the value, a scalar
+    Old,
+    Constant,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Negate,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    And
+};
+
+static bool IsCompare(FilterOp op) {
+    return op >= FilterOp::Equal && op <= FilterOp::GreaterEqual;
+}
+
+// The same comparison with its operands swapped.
+static FilterOp Mirror(FilterOp op) {
+    switch (op) {
+        case FilterOp::Less:
+            return FilterOp::Greater;
+        case FilterOp::LessEqual:
+            return FilterOp::GreaterEqual;
+        case FilterOp::Greater:
+            return FilterOp::Less;
+        case FilterOp::GreaterEqual:
+            return FilterOp::LessEqual;
+        default:
+            return op;
+    }
+}
+
+// Operands come before the nodes using them, so the node list doubles as the bytecode: node i
+// writes register i from the registers Left and Right.
+struct FilterNode {
+    FilterOp Op;
+    ValueType Type = ValueType::UInt8;
+    int32_t Offset = 0;
+    // Constants are kept in both forms, filters on integers compute in int64.
+    double Number = 0;
+    int64_t Integer = 0;
+    uint8_t Left = 0;
+    uint8_t Right = 0;
+};
+
+// field <Compare> Scale * old + Bias
+struct LinearCondition {
+    FilterOp Compare;
+    ValueType Type;
+    int32_t Offset;
+    double Scale;
+    double Bias;
+    int64_t IntegerScale;
+    int64_t IntegerBias;
+};
+
+struct FilterProgram {
+    ScanValueType Type;
+    // Computes in double rather than int64.
+    bool Floating = false;
+    bool UsesOld = false;
+    uint64_t Lead = 0;
+    uint64_t Extent = 0;
+    // Set when every condition is linear, the code is not run then.
+    bool Specialized = false;
+    std::vector<LinearCondition> Conditions;
+    std::vector<FilterNode> Code;
+};
+
+// Integer math wraps instead of overflowing, and dividing by zero gives zero.
+template<typename C>
+static C Add(C left, C right) {
+    if constexpr (std::is_integral_v<C>) {
+        return static_cast<C>(static_cast<uint64_t>(left) + static_cast<uint64_t>(right));
+    } else {
+        return left + right;
+    }
+}
+
+template<typename C>
+static C Subtract(C left, C right) {
+    if constexpr (std::is_integral_v<C>) {
+        return static_cast<C>(static_cast<uint64_t>(left) - static_cast<uint64_t>(right));
+    } else {
+        return left - right;
+    }
+}
+
+template<typename C>
+static C Multiply(C left, C right) {
+    if constexpr (std::is_integral_v<C>) {
+        return static_cast<C>(static_cast<uint64_t>(left) * static_cast<uint64_t>(right));
+    } else {
+        return left * right;
+    }
+}
+
+template<typename C>
+static C Divide(C left, C right) {
+    if constexpr (std::is_integral_v<C>) {
+        if (right == 0) {
+            return 0;
+        }
+        if (right == -1) {
+            return Subtract<C>(0, left);
+        }
+    }
+    return left / right;
+}
+
+template<FilterOp Op, typename C>
+static bool Compare(C left, C right) {
+    if constexpr (Op == FilterOp::Equal) {
+        return left == right;
+    } else if constexpr (Op == FilterOp::NotEqual) {
+        return left != right;
+    } else if constexpr (Op == FilterOp::Less) {
+        return left < right;
+    } else if constexpr (Op == FilterOp::LessEqual) {
+        return left <= right;
+    } else if constexpr (Op == FilterOp::Greater) {
+        return left > right;
+    } else {
+        return left >= right;
+    }
+}
+
+// Recursive descent over the text, appending nodes as it goes:
+//     filter    = condition { ("and" | ",") condition }
+//     condition = sum ( ("==" | "!=" | "<" | "<=" | ">" | ">=") sum | "between" sum "and" sum )
+//     sum       = product { ("+" | "-") product }
+//     product   = unary { ("*" | "/") unary }
+//     unary     = "-" unary | primary
+//     primary   = number | "value" | "old" | type "at" offset | "(" sum ")"
+struct FilterParser {
+    std::string_view Text;
+    ScanValueType Type;
+    size_t Position = 0;
+    size_t Nesting = 0;
+    bool SawFraction = false;
+    std::vector<FilterNode> Nodes;
+    std::string Error;
+
+    std::nullopt_t Fail(std::string_view message) {
+        if (Error.empty()) {
+            Error = std::format("{} at column {}", message, Position + 1);
+        }
+        return std::nullopt;
+    }
+
+    void SkipSpaces() {
+        while (Position < Text.size() && std::isspace(static_cast<unsigned char>(Text[Position]))) {
+            Position++;
+        }
+    }
+
+    bool Accept(std::string_view token) {
+        SkipSpaces();
+        if (Text.substr(Position).starts_with(token)) {
+            Position += token.size();
+            return true;
+        }
+        return false;
+    }
+
+    std::string_view PeekWord() {
+        SkipSpaces();
+        size_t end = Position;
+        while (end < Text.size() && (std::isalnum(static_cast<unsigned char>(Text[end])) || Text[end] == '_')) {
+            end++;
+        }
+        return Text.substr(Position, end - Position);
+    }
+
+    bool AcceptWord(std::string_view word) {
+        if (PeekWord() != word) {
+            return false;
+        }
+        Position += word.size();
+        return true;
+    }
+
+    std::optional<uint8_t> Emit(FilterNode node) {
+        if (Nodes.size() >= MaxRegisters) {
+            return Fail("filter too long");
+        }
+        Nodes.push_back(node);
+        return static_cast<uint8_t>(Nodes.size() - 1);
+    }
+
+    // Folds arithmetic on constants right away, so "old*(100-10)/100" costs a multiply and a divide.
+    std::optional<uint8_t> Emit(FilterOp op, uint8_t left, uint8_t right = 0) {
+        size_t size = Nodes.size();
+        bool constantOperands = Nodes[left].Op == FilterOp::Constant &&
+                                (op == FilterOp::Negate || Nodes[right].Op == FilterOp::Constant);
+        bool lastNodes = op == FilterOp::Negate ? left == size - 1 : left == size - 2 && right == size - 1;
+        if (constantOperands && lastNodes && !IsCompare(op) && op != FilterOp::And) {
+            FilterNode a = Nodes[left];
+            FilterNode b = Nodes[right];
+            FilterNode folded{FilterOp::Constant};
+            switch (op) {
+                case FilterOp::Add:
+                    folded.Number = a.Number + b.Number;
+                    folded.Integer = Add(a.Integer, b.Integer);
+                    break;
+                case FilterOp::Subtract:
+                    folded.Number = a.Number - b.Number;
+                    folded.Integer = Subtract(a.Integer, b.Integer);
+                    break;
+                case FilterOp::Multiply:
+                    folded.Number = a.Number * b.Number;
+                    folded.Integer = Multiply(a.Integer, b.Integer);
+                    break;
+                case FilterOp::Divide:
+                    folded.Number = a.Number / b.Number;
+                    folded.Integer = Divide(a.Integer, b.Integer);
+                    break;
+                default:
+                    folded.Number = -a.Number;
+                    folded.Integer = Subtract<int64_t>(0, a.Integer);
+                    break;
+            }
+            Nodes.resize(op == FilterOp::Negate ? size - 1 : size - 2);
+            return Emit(folded);
+        }
+        return Emit({.Op = op, .Left = left, .Right = right});
+    }
+
+    std::optional<uint8_t> ParseFilter() {
+        auto result = ParseCondition();
+        while (result && (AcceptWord("and") || Accept(","))) {
+            auto next = ParseCondition();
+            if (!next) {
+                return std::nullopt;
+            }
+            result = Emit(FilterOp::And, *result, *next);
+        }
+        return result;
+    }
+
+    std::optional<uint8_t> ParseCondition() {
+        auto left = ParseSum();
+        if (!left) {
+            return std::nullopt;
+        }
+        if (AcceptWord("between")) {
+            auto low = ParseSum();
+            if (!low) {
+                return std::nullopt;
+            }
+            if (!AcceptWord("and")) {
+                return Fail("expected 'and'");
+            }
+            auto high = ParseSum();
+            if (!high) {
+                return std::nullopt;
+            }
+            auto above = Emit(FilterOp::GreaterEqual, *left, *low);
+            auto below = above ? Emit(FilterOp::LessEqual, *left, *high) : std::nullopt;
+            return below ? Emit(FilterOp::And, *above, *below) : std::nullopt;
+        }
+
+        // Longer tokens first, "<=" before "<".
+        constexpr std::pair<std::string_view, FilterOp> compares[] = {
+            {"==", FilterOp::Equal}, {"!=", FilterOp::NotEqual}, {"<=", FilterOp::LessEqual},
+            {">=", FilterOp::GreaterEqual}, {"<", FilterOp::Less}, {">", FilterOp::Greater},
+            {"=", FilterOp::Equal}
+        };
+        for (auto [token, op]: compares) {
+            if (Accept(token)) {
+                auto right = ParseSum();
+                return right ? Emit(op, *left, *right) : std::nullopt;
+            }
+        }
+        return Fail("expected a comparison or 'between'");
+    }
+
+    std::optional<uint8_t> ParseSum() {
+        auto result = ParseProduct();
+        while (result) {
+            FilterOp op;
+            if (Accept("+")) {
+                op = FilterOp::Add;
+            } else if (Accept("-")) {
+                op = FilterOp::Subtract;
+            } else {
+                break;
+            }
+            auto right = ParseProduct();
+            if (!right) {
+                return std::nullopt;
+            }
+            result = Emit(op, *result, *right);
+        }
+        return result;
+    }
+
+    std::optional<uint8_t> ParseProduct() {
+        auto result = ParseUnary();
+        while (result) {
+            FilterOp op;
+            if (Accept("*")) {
+                op = FilterOp::Multiply;
+            } else if (Accept("/")) {
+                op = FilterOp::Divide;
+            } else {
+                break;
+            }
+            auto right = ParseUnary();
+            if (!right) {
+                return std::nullopt;
+            }
+            result = Emit(op, *result, *right);
+        }
+        return result;
+    }
+
+    std::optional<uint8_t> ParseUnary() {
+        if (Accept("-")) {
+            auto operand = ParseUnary();
+            return operand ? Emit(FilterOp::Negate, *operand) : std::nullopt;
+        }
+        return ParsePrimary();
+    }
+
+    std::optional<uint8_t> ParsePrimary() {
+        if (Accept("(")) {
+            if (++Nesting > MaxNesting) {
+                return Fail("nested too deeply");
+            }
+            auto result = ParseSum();
+            if (result && !Accept(")")) {
+                return Fail("expected ')'");
+            }
+            Nesting--;
+            return result;
+        }
+
+        std::string_view word = PeekWord();
+        if (word.empty()) {
+            return Fail(Position < Text.size() ? std::format("unexpected '{}'", Text[Position]) : "unexpected end");
+        }
+        if (std::isdigit(static_cast<unsigned char>(word[0]))) {
+            return ParseNumber();
+        }
+        Position += word.size();
+        if (word == "value") {
+            return Emit({.Op = FilterOp::Field, .Type = Type});
+        }
+        if (word == "old") {
+            return Emit({.Op = FilterOp::Old});
+        }
+
+        auto type = word == "byte" ? std::optional(ValueType::UInt8) : FindValueType(word);
+        if (!type || !IsScalarType(*type)) {
+            Position -= word.size();
+            return Fail(std::format("unknown name '{}'", word));
+        }
+        if (!AcceptWord("at")) {
+            return Fail("expected 'at'");
+        }
+        bool negative = Accept("-");
+        if (!negative) {
+            Accept("+");
+        }
+        auto offset = PeekWord();
+        if (offset.empty() || !std::isdigit(static_cast<unsigned char>(offset[0]))) {
+            return Fail("expected an offset");
+        }
+        auto node = ParseNumber();
+        if (!node) {
+            return std::nullopt;
+        }
+        FilterNode &field = Nodes[*node];
+        if (field.Integer != field.Number || field.Integer > MaxFieldOffset) {
+            return Fail("offset has to be a whole number up to 4096");
+        }
+        field = {
+            .Op = FilterOp::Field, .Type = *type,
+            .Offset = static_cast<int32_t>(negative ? -field.Integer : field.Integer)
+        };
+        return node;
+    }
+
+    // Decimal with an optional fraction, or hex with 0x.
+    std::optional<uint8_t> ParseNumber() {
+        std::string_view rest = Text.substr(Position);
+        FilterNode node{FilterOp::Constant};
+        if (rest.starts_with("0x") || rest.starts_with("0X")) {
+            uint64_t value = 0;
+            auto [end, error] = std::from_chars(rest.data() + 2, rest.data() + rest.size(), value, 16);
+            if (error != std::errc{} || end == rest.data() + 2) {
+                return Fail("bad hex number");
+            }
+            node.Integer = static_cast<int64_t>(value);
+            node.Number = static_cast<double>(value);
+            Position += static_cast<size_t>(end - rest.data());
+        } else {
+            auto [end, error] = std::from_chars(rest.data(), rest.data() + rest.size(), node.Number,
+                                                std::chars_format::fixed);
+            if (error != std::errc{}) {
+                return Fail("bad number");
+            }
+            if (node.Number != std::trunc(node.Number) || std::abs(node.Number) >= 9.2e18) {
+                SawFraction = true;
+            } else {
+                node.Integer = static_cast<int64_t>(node.Number);
+            }
+            Position += static_cast<size_t>(end - rest.data());
+        }
+        if (Position < Text.size() && std::isalnum(static_cast<unsigned char>(Text[Position]))) {
+            return Fail("bad number");
+        }
+        return Emit(node);
+    }
+};
+
+struct Linear {
+    double Scale;
+    double Bias;
+    int64_t IntegerScale;
+    int64_t IntegerBias;
+};
+
+// Node as Scale * old + Bias, nullopt if it is not that shape.
+static std::optional<Linear> ToLinear(std::span<const FilterNode> nodes, uint8_t index) {
+    const FilterNode &node = nodes[index];
+    switch (node.Op) {
+        case FilterOp::Old:
+            return Linear{1, 0, 1, 0};
+        case FilterOp::Constant:
+            return Linear{0, node.Number, 0, node.Integer};
+        case FilterOp::Negate: {
+            auto operand = ToLinear(nodes, node.Left);
+            if (!operand) {
+                return std::nullopt;
+            }
+            return Linear{
+                -operand->Scale, -operand->Bias, Subtract<int64_t>(0, operand->IntegerScale),
+                Subtract<int64_t>(0, operand->IntegerBias)
+            };
+        }
+        case FilterOp::Add:
+        case FilterOp::Subtract: {
+            auto left = ToLinear(nodes, node.Left);
+            auto right = ToLinear(nodes, node.Right);
+            if (!left || !right) {
+                return std::nullopt;
+            }
+            if (node.Op == FilterOp::Add) {
+                return Linear{
+                    left->Scale + right->Scale, left->Bias + right->Bias,
+                    Add(left->IntegerScale, right->IntegerScale), Add(left->IntegerBias, right->IntegerBias)
+                };
+            }
+            return Linear{
+                left->Scale - right->Scale, left->Bias - right->Bias,
+                Subtract(left->IntegerScale, right->IntegerScale), Subtract(left->IntegerBias, right->IntegerBias)
+            };
+        }
+        case FilterOp::Multiply: {
+            auto left = ToLinear(nodes, node.Left);
+            auto right = ToLinear(nodes, node.Right);
+            if (!left || !right) {
+                return std::nullopt;
+            }
+            // One side has to be a constant, old*old is not linear.
+            if (nodes[node.Right].Op != FilterOp::Constant) {
+                if (nodes[node.Left].Op != FilterOp::Constant) {
+                    return std::nullopt;
+                }
+                std::swap(left, right);
+            }
+            return Linear{
+                left->Scale * right->Bias, left->Bias * right->Bias,
+                Multiply(left->IntegerScale, right->IntegerBias), Multiply(left->IntegerBias, right->IntegerBias)
+            };
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+// Every condition of the And tree below index as field <op> Scale * old + Bias, false as soon
+// as one is not of that shape.
+static bool CollectLinear(std::span<const FilterNode> nodes, uint8_t index, std::vector<LinearCondition> &conditions) {
+    const FilterNode &node = nodes[index];
+    if (node.Op == FilterOp::And) {
+        return CollectLinear(nodes, node.Left, conditions) && CollectLinear(nodes, node.Right, conditions);
+    }
+    if (!IsCompare(node.Op)) {
+        return false;
+    }
+    FilterOp op = node.Op;
+    uint8_t field = node.Left;
+    uint8_t bound = node.Right;
+    if (nodes[field].Op != FilterOp::Field) {
+        std::swap(field, bound);
+        op = Mirror(op);
+    }
+    auto linear = nodes[field].Op == FilterOp::Field ? ToLinear(nodes, bound) : std::nullopt;
+    if (!linear) {
+        return false;
+    }
+    conditions.push_back({
+        op, nodes[field].Type, nodes[field].Offset, linear->Scale, linear->Bias, linear->IntegerScale,
+        linear->IntegerBias
+    });
+    return true;
+}
+
+std::expected<ScanFilter, std::string> ScanFilter::Compile(std::string_view text, ScanValueType type) {
+    if (!IsScalarType(type)) {
+        return std::unexpected(std::format("{} values cannot be filtered", GetValueTypeName(type)));
+    }
+    FilterParser parser{text, type};
+    auto result = parser.ParseFilter();
+    if (!result) {
+        return std::unexpected(std::move(parser.Error));
+    }
+    parser.SkipSpaces();
+    if (parser.Position != text.size()) {
+        parser.Fail(std::format("unexpected '{}'", text[parser.Position]));
+        return std::unexpected(std::move(parser.Error));
+    }
+
+    auto program = std::make_shared<FilterProgram>();
+    program->Type = type;
+    program->Floating = type == ScanValueType::Float || type == ScanValueType::Double || parser.SawFraction;
+    program->Extent = GetScanValueSize(type);
+    for (const auto &node: parser.Nodes) {
+        program->UsesOld |= node.Op == FilterOp::Old;
+        if (node.Op == FilterOp::Field) {
+            program->Floating |= node.Type == ValueType::Float || node.Type == ValueType::Double;
+            int64_t begin = node.Offset;
+            int64_t end = begin + static_cast<int64_t>(GetValueTypeSize(node.Type));
+            program->Lead = std::max(program->Lead, static_cast<uint64_t>(std::max<int64_t>(0, -begin)));
+            program->Extent = std::max(program->Extent, static_cast<uint64_t>(std::max<int64_t>(0, end)));
+        }
+    }
+    program->Specialized = CollectLinear(parser.Nodes, *result, program->Conditions);
+    if (!program->Specialized) {
+        program->Conditions.clear();
+    }
+    program->Code = std::move(parser.Nodes);
+
+    ScanFilter filter;
+    filter.m_Program = std::move(program);
+    return filter;
+}
+
+ScanValueType ScanFilter::GetType() const {
+    return m_Program->Type;
+}
+
+bool ScanFilter::UsesOld() const {
+    return m_Program->UsesOld;
+}
+
+uint64_t ScanFilter::GetLead() const {
+    return m_Program->Lead;
+}
+
+uint64_t ScanFilter::GetExtent() const {
+    return m_Program->Extent;
+}
+
+bool ScanFilter::IsSpecialized() const {
+    return m_Program->Specialized;
+}
+
+template<typename T, typename C>
+static void LoadLanes(std::span<const std::byte *const> values, int32_t offset, C *lanes) {
+    for (size_t i = 0; i < values.size(); i++) {
+        T value;
+        std::memcpy(&value, values[i] + offset, sizeof(T));
+        lanes[i] = static_cast<C>(value);
+    }
+}
+
+template<typename C>
+static void LoadField(ValueType type, std::span<const std::byte *const> values, int32_t offset, C *lanes) {
+    VisitScalarType(type, [&]<ValueType Type>() {
+        LoadLanes<typename ValueTypeTraits<Type>::Type>(values, offset, lanes);
+    });
+}
+
+template<typename C>
+static void DecodeOld(ScanValueType type, std::span<const uint64_t> old, C *lanes) {
+    VisitScalarType(type, [&]<ValueType Type>() {
+        for (size_t i = 0; i < old.size(); i++) {
+            lanes[i] = static_cast<C>(FromRaw<typename ValueTypeTraits<Type>::Type>(old[i]));
+        }
+    });
+}
+
+// The specialized kernel: one field type, one comparison, a loop over the block.
+template<typename T, typename C, FilterOp Op>
+static void LinearKernel(const LinearCondition &condition, std::span<const std::byte *const> values,
+                        const C *old, uint8_t *pass) {
+    C scale;
+    C bias;
+    if constexpr (std::is_integral_v<C>) {
+        scale = condition.IntegerScale;
+        bias = condition.IntegerBias;
+    } else {
+        scale = condition.Scale;
+        bias = condition.Bias;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        T field;
+        std::memcpy(&field, values[i] + condition.Offset, sizeof(T));
+        C bound = Add(Multiply(scale, old[i]), bias);
+        pass[i] &= static_cast<uint8_t>(Compare<Op>(static_cast<C>(field), bound));
+    }
+}
+
+template<typename T, typename C>
+static void SelectCompare(const LinearCondition &condition, std::span<const std::byte *const> values,
+                        const C *old, uint8_t *pass) {
+    switch (condition.Compare) {
+        case FilterOp::Equal:
+            return LinearKernel<T, C, FilterOp::Equal>(condition, values, old, pass);
+        case FilterOp::NotEqual:
+            return LinearKernel<T, C, FilterOp::NotEqual>(condition, values, old, pass);
+        case FilterOp::Less:
+            return LinearKernel<T, C, FilterOp::Less>(condition, values, old, pass);
+        case FilterOp::LessEqual:
+            return LinearKernel<T, C, FilterOp::LessEqual>(condition, values, old, pass);
+        case FilterOp::Greater:
+            return LinearKernel<T, C, FilterOp::Greater>(condition, values, old, pass);
+        default:
+            return LinearKernel<T, C, FilterOp::GreaterEqual>(condition, values, old, pass);
+    }
+}
+
+template<typename C>
+static void ApplyLinear(const LinearCondition &condition, std::span<const std::byte *const> values,
+                        const C *old, uint8_t *pass) {
+    VisitScalarType(condition.Type, [&]<ValueType Type>() {
+        SelectCompare<typename ValueTypeTraits<Type>::Type>(condition, values, old, pass);
+    });
+}
+
+template<typename C, typename F>
+static void ForLanes(size_t count, C *target, const C *left, const C *right, F &&operation) {
+    for (size_t i = 0; i < count; i++) {
+        target[i] = operation(left[i], right[i]);
+    }
+}
+
+// The bytecode: each node runs over the whole block before the next one starts.
+template<typename C>
+static void RunCode(std::span<const FilterNode> code, std::span<const std::byte *const> values, const C *old,
+                    uint8_t *pass) {
+    const size_t count = values.size();
+    std::array<std::array<C, ScanFilter::BlockSize>, MaxRegisters> registers;
+    for (size_t r = 0; r < code.size(); r++) {
+        const FilterNode &node = code[r];
+        C *target = registers[r].data();
+        const C *left = registers[node.Left].data();
+        const C *right = registers[node.Right].data();
+        switch (node.Op) {
+            case FilterOp::Field:
+                LoadField(node.Type, values, node.Offset, target);
+                break;
+            case FilterOp::Old:
+                std::copy_n(old, count, target);
+                break;
+            case FilterOp::Constant:
+                std::fill_n(target, count, std::is_integral_v<C> ? static_cast<C>(node.Integer)
+                                                                 : static_cast<C>(node.Number));
+                break;
+            case FilterOp::Add:
+                ForLanes(count, target, left, right, Add<C>);
+                break;
+            case FilterOp::Subtract:
+                ForLanes(count, target, left, right, Subtract<C>);
+                break;
+            case FilterOp::Multiply:
+                ForLanes(count, target, left, right, Multiply<C>);
+                break;
+            case FilterOp::Divide:
+                ForLanes(count, target, left, right, Divide<C>);
+                break;
+            case FilterOp::Negate:
+                ForLanes(count, target, left, left, [](C a, C) { return Subtract<C>(0, a); });
+                break;
+            case FilterOp::Equal:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(Compare<FilterOp::Equal>(a, b)); });
+                break;
+            case FilterOp::NotEqual:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(Compare<FilterOp::NotEqual>(a, b)); });
+                break;
+            case FilterOp::Less:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(Compare<FilterOp::Less>(a, b)); });
+                break;
+            case FilterOp::LessEqual:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(Compare<FilterOp::LessEqual>(a, b)); });
+                break;
+            case FilterOp::Greater:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(Compare<FilterOp::Greater>(a, b)); });
+                break;
+            case FilterOp::GreaterEqual:
+                ForLanes(count, target, left, right,
+                         [](C a, C b) { return C(Compare<FilterOp::GreaterEqual>(a, b)); });
+                break;
+            case FilterOp::And:
+                ForLanes(count, target, left, right, [](C a, C b) { return C(a != 0 && b != 0); });
+                break;
+        }
+    }
+    const C *result = registers[code.size() - 1].data();
+    for (size_t i = 0; i < count; i++) {
+        pass[i] = result[i] != 0;
+    }
+}
+
+template<typename C>
+static void Run(const FilterProgram &program, std::span<const std::byte *const> values,
+                std::span<const uint64_t> old, uint8_t *pass) {
+    std::array<C, ScanFilter::BlockSize> previous{};
+    if (program.UsesOld) {
+        DecodeOld(program.Type, old.first(values.size()), previous.data());
+    }
+    if (!program.Specialized) {
+        RunCode(std::span(program.Code), values, previous.data(), pass);
+        return;
+    }
+    std::fill_n(pass, values.size(), uint8_t{1});
+    for (const auto &condition: program.Conditions) {
+        ApplyLinear(condition, values, previous.data(), pass);
+    }
+}
+
+void ScanFilter::Evaluate(std::span<const std::byte *const> values, std::span<const uint64_t> old,
+                          std::span<uint8_t> pass) const {
+    if (m_Program->Floating) {
+        Run<double>(*m_Program, values, old, pass.data());
+    } else {
+        Run<int64_t>(*m_Program, values, old, pass.data());
+    }
+}
@@ -0,0 +1,86 @@
+export module Engine.ScanProtocol;
+
+import std;
+
+// Requests the scan server understands. Payloads are the plain structs below, replies carry
+// the request's type and id back with a status. Requests on one connection are answered in
+// order, so a client may send many before reading any reply.
+export enum class ScanMessage : uint32_t {
+    Attach = 1, // AttachPayload, replies with a TargetPayload
+    Detach, // TargetPayload
+    QueryRegions, // TargetPayload, replies with MemoryRegion[]
+    Read, // ReadPayload, replies with the readable prefix
+    Write, // WritePayload followed by the bytes, replies with a uint64_t count
+    StartScan, // StartScanPayload
+    GetScanState, // TargetPayload, replies with a ScanStatePayload
+    GetResults, // TargetPayload, replies with a ResultsPayload and a descriptor of the records
+    ResetScan, // TargetPayload
+};
+
+export constexpr uint32_t ScanStatusOk = 0;
+export constexpr uint32_t ScanStatusFailed = 1;
+
+// Reads above this are refused, the UI only reads what it displays.
+export constexpr uint32_t MaxRemoteReadSize = 16 * 1024 * 1024;
+
+export struct AttachPayload {
+    uint32_t ProcessId;
+};
+
+export struct TargetPayload {
+    uint32_t TargetId;
+};
+
+export struct ReadPayload {
+    uint32_t TargetId;
+    uint32_t Size;
+    uint64_t Address;
+};
+
+export struct WritePayload {
+    uint32_t TargetId;
+    uint32_t Reserved;
+    uint64_t Address;
+};
+
+export struct StartScanPayload {
+    uint32_t TargetId;
+    uint32_t Type; // ScanValueType
+    uint32_t Compare; // ScanCompare
+    uint32_t Reserved;
+    uint64_t Value;
+};
+
+export struct ScanStatePayload {
+    uint32_t Running;
+    float Progress;
+    uint32_t Type; // ScanValueType of the results
+    uint32_t HasResults;
+    uint64_t ResultCount;
+    uint64_t ResultGeneration; // changes whenever the results do
+};
+
+export struct ResultsPayload {
+    uint64_t Count; // ScanResultRecord entries in the passed descriptor
+    uint64_t Generation;
+    uint32_t Type;
+    uint32_t Reserved;
+};
+
+export template<typename T>
+    requires std::is_trivially_copyable_v<T>
+std::span<const std::byte> AsPayload(const T &value) {
+    return std::as_bytes(std::span(&value, 1));
+}
+
+// nullopt if payload is too short for T, trailing bytes are left to the caller.
+export template<typename T>
+    requires std::is_trivially_copyable_v<T>
+std::optional<T> FromPayload(std::span<const std::byte> payload) {
+    if (payload.size() < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, payload.data(), sizeof(T));
+    return value;
+}
@@ -0,0 +1,190 @@
+module Engine.ScanServer;
+
+template<typename T>
+static void Append(std::vector<std::byte> &payload, const T &value) {
+    auto bytes = AsPayload(value);
+    payload.insert(payload.end(), bytes.begin(), bytes.end());
+}
+
+ScanServer::ScanServer(IpcListener listener) : m_Listener(std::move(listener)), m_Targets(m_Pool) {
+}
+
+void ScanServer::Run() {
+    while (auto channel = m_Listener.Accept()) {
+        std::thread([this, channel = std::move(*channel)]() mutable { Serve(std::move(channel)); }).detach();
+    }
+}
+
+void ScanServer::Serve(IpcChannel channel) {
+    std::vector<uint32_t> attached;
+    while (auto request = channel.Receive()) {
+        Reply reply = Handle(*request, attached);
+        IpcHeader header{request->Header.Type, request->Header.RequestId, reply.Status, 0};
+        if (!channel.Send(header, reply.Payload, reply.Fd ? reply.Fd->Get() : -1)) {
+            break;
+        }
+    }
+
+    for (uint32_t id: attached) {
+        Release(id);
+    }
+}
+
+std::shared_ptr<AttachedTarget> ScanServer::Acquire(uint32_t processId, std::vector<uint32_t> &attached) {
+    // Under the lock, so the target cannot be released by another connection in between.
+    std::lock_guard lock(m_AttachMutex);
+    auto target = m_Targets.Attach(processId, std::format("pid {}", processId));
+    if (target && !std::ranges::contains(attached, target->GetId())) {
+        attached.push_back(target->GetId());
+        m_AttachCounts[target->GetId()]++;
+    }
+    return target;
+}
+
+void ScanServer::Release(uint32_t targetId) {
+    std::lock_guard attachLock(m_AttachMutex);
+    auto count = m_AttachCounts.find(targetId);
+    if (count == m_AttachCounts.end() || --count->second != 0) {
+        return;
+    }
+    m_AttachCounts.erase(count);
+    m_Targets.Detach(targetId);
+    std::lock_guard lock(m_Mutex);
+    m_Published.erase(targetId);
+}
+
+ScanServer::Reply ScanServer::Handle(const IpcMessage &request, std::vector<uint32_t> &attached) {
+    Reply reply;
+    reply.Status = ScanStatusFailed;
+    auto type = static_cast<ScanMessage>(request.Header.Type);
+
+    if (type == ScanMessage::Attach) {
+        auto payload = FromPayload<AttachPayload>(request.Payload);
+        auto target = payload ? Acquire(payload->ProcessId, attached) : nullptr;
+        if (target) {
+            Append(reply.Payload, TargetPayload{target->GetId()});
+            reply.Status = ScanStatusOk;
+        }
+        return reply;
+    }
+
+    // Every other request names a target first, one this connection attached.
+    auto targetPayload = FromPayload<TargetPayload>(request.Payload);
+    if (!targetPayload || !std::ranges::contains(attached, targetPayload->TargetId)) {
+        return reply;
+    }
+    auto target = m_Targets.Find(targetPayload->TargetId);
+    if (!target) {
+        return reply;
+    }
+    reply.Status = ScanStatusOk;
+
+    switch (type) {
+        case ScanMessage::Detach:
+            std::erase(attached, target->GetId());
+            Release(target->GetId());
+            break;
+        case ScanMessage::QueryRegions: {
+            auto regions = target->GetSource()->QueryRegions();
+            auto bytes = std::as_bytes(std::span(regions));
+            reply.Payload.assign(bytes.begin(), bytes.end());
+            break;
+        }
+        case ScanMessage::Read: {
+            auto payload = FromPayload<ReadPayload>(request.Payload);
+            if (!payload || payload->Size > MaxRemoteReadSize) {
+                reply.Status = ScanStatusFailed;
+                break;
+            }
+            reply.Payload.resize(payload->Size);
+            reply.Payload.resize(target->GetSource()->Read(payload->Address, reply.Payload));
+            break;
+        }
+        case ScanMessage::Write: {
+            auto payload = FromPayload<WritePayload>(request.Payload);
+            if (!payload) {
+                reply.Status = ScanStatusFailed;
+                break;
+            }
+            auto bytes = std::span(request.Payload).subspan(sizeof(WritePayload));
+            Append(reply.Payload, uint64_t{target->GetSource()->Write(payload->Address, bytes)});
+            break;
+        }
+        case ScanMessage::StartScan: {
+            auto payload = FromPayload<StartScanPayload>(request.Payload);
+            // Filters are compiled on this side only, a remote request cannot carry one.
+            bool valid = payload && payload->Compare < static_cast<uint32_t>(ScanCompare::Filter) &&
+                         payload->Type < ScalarValueTypeCount;
+            ScanRequest scan{};
+            if (valid) {
+                scan.Type = static_cast<ScanValueType>(payload->Type);
+                scan.Compare = static_cast<ScanCompare>(payload->Compare);
+                scan.Value = payload->Value;
+            }
+            reply.Status = valid && target->StartScan(scan) ? ScanStatusOk : ScanStatusFailed;
+            break;
+        }
+        case ScanMessage::GetScanState: {
+            target->Update(std::chrono::steady_clock::now());
+            auto activeScan = target->GetActiveScan();
+            PublishedResults published = Publish(*target);
+            ScanStatePayload state{};
+            state.Running = activeScan != nullptr;
+            state.Progress = activeScan ? activeScan->GetProgress() : 1.0f;
+            state.Type = static_cast<uint32_t>(target->GetResultType());
+            state.HasResults = published.Results != nullptr;
+            state.ResultCount = published.Results ? published.Results->size() : 0;
+            state.ResultGeneration = published.Generation;
+            Append(reply.Payload, state);
+            break;
+        }
+        case ScanMessage::GetResults: {
+            target->Update(std::chrono::steady_clock::now());
+            PublishedResults published = Publish(*target);
+            if (!published.Results) {
+                reply.Status = ScanStatusFailed;
+                break;
+            }
+            // Copied into shared memory once per generation, every later request passes the
+            // same descriptor again.
+            if (!published.Fd) {
+                auto bytes = std::as_bytes(std::span(*published.Results));
+                published.Fd = std::make_shared<UniqueFd>(CreateSharedBytes(bytes));
+                std::lock_guard lock(m_Mutex);
+                auto &entry = m_Published[target->GetId()];
+                if (entry.Generation == published.Generation) {
+                    entry.Fd = published.Fd;
+                }
+            }
+            if (!*published.Fd) {
+                reply.Status = ScanStatusFailed;
+                break;
+            }
+            Append(reply.Payload, ResultsPayload{
+                       published.Results->size(), published.Generation,
+                       static_cast<uint32_t>(target->GetResultType()), 0
+                   });
+            reply.Fd = published.Fd;
+            break;
+        }
+        case ScanMessage::ResetScan:
+            target->ResetScan();
+            break;
+        default:
+            reply.Status = ScanStatusFailed;
+            break;
+    }
+    return reply;
+}
+
+ScanServer::PublishedResults ScanServer::Publish(AttachedTarget &target) {
+    auto results = target.GetResults();
+    std::lock_guard lock(m_Mutex);
+    auto &entry = m_Published[target.GetId()];
+    if (entry.Results != results) {
+        entry.Results = std::move(results);
+        entry.Generation++;
+        entry.Fd.reset();
+    }
+    return entry;
+}
@@ -0,0 +1,65 @@
+export module Engine.ScanServer;
+
+import std;
+import Engine.IpcChannel;
+import Engine.ProcessMemory;
+import Engine.Scanner;
+import Engine.ScanProtocol;
+import Engine.Session;
+import Engine.Targets;
+import WorkerPool;
+
+// Runs attaching, reading and scanning on behalf of clients connected over a local socket,
+// so a UI can stay unprivileged and outlive a crash of the engine. Each connection is served
+// on a thread of its own and may only use targets it attached. Connections attaching the same
+// process share its target, which is detached once the last of them detached it or closed.
+export class ScanServer {
+public:
+    explicit ScanServer(IpcListener listener);
+
+    ScanServer(const ScanServer &) = delete;
+
+    ScanServer &operator=(const ScanServer &) = delete;
+
+    // Accepts connections until the listener fails. The server has to outlive its connection
+    // threads, in practice it lives as long as the process.
+    void Run();
+
+private:
+    // Last results handed out per target, shared with every GetResults until they change.
+    struct PublishedResults {
+        std::shared_ptr<const ScanResults> Results;
+        uint64_t Generation = 0;
+        std::shared_ptr<UniqueFd> Fd;
+    };
+
+    struct Reply {
+        uint32_t Status = ScanStatusOk;
+        std::vector<std::byte> Payload;
+        std::shared_ptr<UniqueFd> Fd; // passed along with the reply, stays open for later ones
+    };
+
+    void Serve(IpcChannel channel);
+
+    // attached holds the targets this connection attached, the ones it may use and has to
+    // release when it closes.
+    Reply Handle(const IpcMessage &request, std::vector<uint32_t> &attached);
+
+    std::shared_ptr<AttachedTarget> Acquire(uint32_t processId, std::vector<uint32_t> &attached);
+
+    void Release(uint32_t targetId);
+
+    PublishedResults Publish(AttachedTarget &target);
+
+    IpcListener m_Listener;
+    // Declared before the targets, whose queues live on it.
+    WorkerPool m_Pool;
+    TargetSet m_Targets;
+
+    // Connections holding each target, taken before m_Mutex.
+    std::mutex m_AttachMutex;
+    std::unordered_map<uint32_t, uint32_t> m_AttachCounts;
+
+    std::mutex m_Mutex;
+    std::unordered_map<uint32_t, PublishedResults> m_Published;
+};
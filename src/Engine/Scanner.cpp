@@ -0,0 +1,722 @@
+module Engine.Scanner;
+
+constexpr uint64_t FirstScanChunkSize = 1024 * 1024;
+constexpr size_t NextScanChunkResults = 16 * 1024;
+// Results closer than this are fetched with one read instead of one call each.
+constexpr uint64_t MaxReadGap = 4096;
+constexpr uint64_t MaxReadRun = 256 * 1024;
+// Chunks are read in slices this big when the source can keep reads in flight.
+constexpr size_t ReadSliceSize = 64 * 1024;
+
+static std::atomic<size_t> s_ScanReadDepth = 0;
+
+void SetScanReadDepth(size_t depth) {
+    s_ScanReadDepth = std::min(depth, AsyncReader::MaxDepth - 1);
+}
+
+size_t GetScanReadDepth() {
+    return s_ScanReadDepth;
+}
+
+template<ValueType Type, ScanCompare Compare>
+bool Passes(uint64_t current, uint64_t previous, uint64_t target) {
+    using T = typename ValueTypeTraits<Type>::Type;
+    T value = FromRaw<T>(current);
+    if constexpr (Compare == ScanCompare::Exact) {
+        return value == FromRaw<T>(target);
+    } else if constexpr (Compare == ScanCompare::Changed) {
+        return value != FromRaw<T>(previous);
+    } else if constexpr (Compare == ScanCompare::Unchanged) {
+        return value == FromRaw<T>(previous);
+    } else if constexpr (Compare == ScanCompare::Increased) {
+        return value > FromRaw<T>(previous);
+    } else if constexpr (Compare == ScanCompare::Decreased) {
+        return value < FromRaw<T>(previous);
+    } else {
+        return false; // filters go through a FilterBatch instead
+    }
+}
+
+// Calls visitor.template operator()<Type, Compare>() for the request. The scan loops live in
+// the visitor, so each type and compare pair gets its own loop without a switch inside.
+template<typename F>
+void VisitRequest(const ScanRequest &request, F &&visitor) {
+    VisitScalarType(request.Type, [&]<ValueType Type>() {
+        switch (request.Compare) {
+            case ScanCompare::Exact:
+                return visitor.template operator()<Type, ScanCompare::Exact>();
+            case ScanCompare::Changed:
+                return visitor.template operator()<Type, ScanCompare::Changed>();
+            case ScanCompare::Unchanged:
+                return visitor.template operator()<Type, ScanCompare::Unchanged>();
+            case ScanCompare::Increased:
+                return visitor.template operator()<Type, ScanCompare::Increased>();
+            case ScanCompare::Decreased:
+                return visitor.template operator()<Type, ScanCompare::Decreased>();
+            case ScanCompare::Filter:
+                return;
+        }
+    });
+}
+
+std::optional<BytePattern> ParsePattern(std::string_view text) {
+    BytePattern pattern;
+    size_t position = 0;
+    while (position < text.size()) {
+        if (text[position] == ' ') {
+            position++;
+            continue;
+        }
+        size_t end = std::min(text.find(' ', position), text.size());
+        std::string_view token = text.substr(position, end - position);
+        position = end;
+
+        if (token.find_first_not_of('?') == std::string_view::npos && token.size() <= 2) {
+            pattern.Bytes.push_back(std::byte{0});
+            pattern.Mask.push_back(std::byte{0});
+            continue;
+        }
+        uint8_t value = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value, 16);
+        if (ec != std::errc{} || ptr != token.data() + token.size() || token.size() > 2) {
+            return std::nullopt;
+        }
+        pattern.Bytes.push_back(std::byte{value});
+        pattern.Mask.push_back(std::byte{0xFF});
+    }
+
+    auto anchor = std::ranges::find(pattern.Mask, std::byte{0xFF});
+    if (anchor == pattern.Mask.end()) {
+        return std::nullopt; // wildcards only
+    }
+    pattern.AnchorOffset = static_cast<size_t>(anchor - pattern.Mask.begin());
+    return pattern;
+}
+
+BytePattern MakePattern(std::span<const std::byte> bytes) {
+    return {
+        .Bytes = std::vector(bytes.begin(), bytes.end()),
+        .Mask = std::vector(bytes.size(), std::byte{0xFF}),
+    };
+}
+
+std::optional<GroupScanRequest> ParseGroupScan(std::string_view text, uint32_t window, bool ordered) {
+    GroupScanRequest request{.Window = window, .Ordered = ordered};
+    for (auto part: std::views::split(text, ' ')) {
+        std::string_view token(part.begin(), part.end());
+        if (token.empty()) {
+            continue;
+        }
+        ScanValueType type = ScanValueType::Int32;
+        if (auto colon = token.find(':'); colon != std::string_view::npos) {
+            auto prefixType = FindValueType(token.substr(0, colon));
+            if (!prefixType || !IsScalarType(*prefixType)) {
+                return std::nullopt;
+            }
+            type = *prefixType;
+            token.remove_prefix(colon + 1);
+        }
+        auto value = ParseScanValue(token, type);
+        if (!value) {
+            return std::nullopt;
+        }
+        request.Values.push_back({type, *value});
+    }
+    if (request.Values.empty()) {
+        return std::nullopt;
+    }
+    return request;
+}
+
+void ScanJob::FinishChunk() {
+    if (m_FinishedChunks.fetch_add(1) + 1 != m_ChunkCount) {
+        return;
+    }
+
+    // Chunks were cut in address order, concatenating keeps the results sorted.
+    size_t total = 0;
+    for (const auto &chunk: m_ChunkResults) {
+        total += chunk.size();
+    }
+    auto results = std::make_shared<ScanResults>();
+    results->reserve(total);
+    for (auto &chunk: m_ChunkResults) {
+        results->insert(results->end(), chunk.begin(), chunk.end());
+        ScanResults().swap(chunk);
+    }
+    m_Results.store(std::move(results));
+}
+
+struct RegionChunk {
+    uint64_t Address;
+    uint64_t Size;
+    uint64_t ReadSize; // Size plus whatever of overlap stays inside the region
+    uint64_t Lead = 0; // bytes before Address read along, at most the requested lead
+};
+
+// Cuts regions into FirstScanChunkSize pieces. Matches may start near the end of a chunk and
+// run into the next one, so each chunk reads up to overlap bytes past its end, but never past
+// the end of its region: a read touching an unmapped page fails as a whole on Windows.
+// Group scans also look back, lead bytes before each chunk are read the same way.
+static std::vector<RegionChunk> SplitRegions(std::span<const MemoryRegion> regions, uint64_t overlap,
+                                             uint64_t lead = 0) {
+    std::vector<RegionChunk> chunks;
+    for (const auto &region: regions) {
+        for (uint64_t offset = 0; offset < region.Size; offset += FirstScanChunkSize) {
+            uint64_t size = std::min(FirstScanChunkSize, region.Size - offset);
+            uint64_t chunkLead = std::min(lead, offset);
+            chunks.push_back({
+                region.Base + offset, size, std::min(size + overlap, region.Size - offset) + chunkLead, chunkLead
+            });
+        }
+    }
+    return chunks;
+}
+
+// Page aligned memory chunks are read into, one per worker thread and reused by every chunk it
+// reads, so its pages are faulted in once rather than once per chunk.
+struct ReadBuffer {
+    static constexpr std::align_val_t Alignment{4096};
+
+    struct Free {
+        void operator()(std::byte *bytes) const { ::operator delete[](bytes, Alignment); }
+    };
+
+    std::unique_ptr<std::byte[], Free> Data;
+    size_t Capacity = 0;
+
+    std::span<std::byte> Get(size_t size) {
+        if (size > Capacity) {
+            Data.reset(static_cast<std::byte *>(::operator new[](size, Alignment)));
+            Capacity = size;
+        }
+        return {Data.get(), size};
+    }
+};
+
+// Reads size bytes at address and calls onBytes(bytes, last) with the bytes read so far each
+// time another slice arrived. The last call has every byte there is, which like with Fetch may
+// be fewer than size. Bytes stay where they are between calls and after the last one, until the
+// thread's next FetchPipelined. Sources with an AsyncReader keep the read depth of slices in
+// flight while onBytes compares the ones before, so a chunk costs the slower of copying and
+// comparing it instead of both. Mapped sources and ones without a reader get a single call.
+template<typename OnBytes>
+static void FetchPipelined(const MemorySource &process, uint64_t address, size_t size, OnBytes &&onBytes) {
+    if (auto view = process.View(address, size); !view.empty()) {
+        onBytes(view, true);
+        return;
+    }
+    thread_local ReadBuffer buffer;
+    std::span<std::byte> bytes = buffer.Get(size);
+    const size_t depth = s_ScanReadDepth.load(std::memory_order_relaxed);
+    auto reader = depth > 0 && size > ReadSliceSize ? process.OpenAsyncReader() : nullptr;
+    if (!reader) {
+        onBytes(std::span<const std::byte>(bytes).first(process.Read(address, bytes)), true);
+        return;
+    }
+
+    const size_t sliceCount = (size + ReadSliceSize - 1) / ReadSliceSize;
+    auto slice = [&](size_t index) {
+        return bytes.subspan(index * ReadSliceSize, std::min(ReadSliceSize, size - index * ReadSliceSize));
+    };
+    size_t submitted = 0;
+    size_t available = 0;
+    for (size_t finished = 0; finished < sliceCount; finished++) {
+        for (; submitted < sliceCount && submitted - finished <= depth; submitted++) {
+            reader->Submit(address + submitted * ReadSliceSize, slice(submitted));
+        }
+        size_t copied = reader->Wait();
+        available += copied;
+        // A short slice ends the chunk like a short Read, the slices after it are dropped once
+        // they landed, the buffer is reused by the next chunk.
+        bool last = finished + 1 == sliceCount || copied < slice(finished).size();
+        onBytes(std::span<const std::byte>(bytes).first(available), last);
+        if (last) {
+            for (finished++; finished < submitted; finished++) {
+                reader->Wait();
+            }
+            return;
+        }
+    }
+}
+
+// Candidates of a filtered scan, evaluated a block at a time. Values point into the buffer
+// they were read to, so the batch has to be flushed before that buffer is reused.
+struct FilterBatch {
+    const ScanFilter &Filter;
+    size_t ValueSize;
+    size_t Count = 0;
+    std::array<uint64_t, ScanFilter::BlockSize> Addresses;
+    std::array<const std::byte *, ScanFilter::BlockSize> Values;
+    std::array<uint64_t, ScanFilter::BlockSize> Old;
+    std::array<uint8_t, ScanFilter::BlockSize> Pass;
+
+    void Add(uint64_t address, const std::byte *value, uint64_t old, ScanResults &results) {
+        Addresses[Count] = address;
+        Values[Count] = value;
+        Old[Count] = old;
+        if (++Count == ScanFilter::BlockSize) {
+            Flush(results);
+        }
+    }
+
+    void Flush(ScanResults &results) {
+        Filter.Evaluate(std::span(Values).first(Count), std::span(Old).first(Count), Pass);
+        for (size_t i = 0; i < Count; i++) {
+            if (Pass[i]) {
+                uint64_t value = 0;
+                std::memcpy(&value, Values[i], ValueSize);
+                results.push_back({Addresses[i], value});
+            }
+        }
+        Count = 0;
+    }
+};
+
+// Bytes around each value a request reads, [-lead, extent): fields of a filter may lie on
+// either side of the value.
+static uint64_t GetLead(const ScanRequest &request) {
+    return request.Filter ? request.Filter->GetLead() : 0;
+}
+
+static uint64_t GetExtent(const ScanRequest &request) {
+    uint64_t size = GetScanValueSize(request.Type);
+    return request.Filter ? std::max(request.Filter->GetExtent(), size) : size;
+}
+
+std::shared_ptr<ScanJob> ScanJob::StartFirst(WorkerPool &pool, WorkerPool::QueueId queue,
+                                             std::shared_ptr<MemorySource> process,
+                                             std::span<const MemoryRegion> regions, const ScanRequest &request) {
+    auto chunks = IsScalarType(request.Type) ? SplitRegions(regions, GetExtent(request) - 1, GetLead(request))
+                                             : std::vector<RegionChunk>{};
+
+    auto job = std::make_shared<ScanJob>();
+    job->m_Request = request;
+    job->m_ChunkCount = chunks.size();
+    job->m_ChunkResults.resize(chunks.size());
+    if (chunks.empty()) {
+        job->m_Results.store(std::make_shared<ScanResults>());
+        return job;
+    }
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        pool.Submit(queue, [job, process, chunk = chunks[i], i] {
+            if (!job->m_Cancelled && job->m_Request.Filter) {
+                const size_t valueSize = GetScanValueSize(job->m_Request.Type);
+                const uint64_t lead = GetLead(job->m_Request);
+                const uint64_t extent = GetExtent(job->m_Request);
+                const uint64_t bufferAddress = chunk.Address - chunk.Lead;
+                auto &results = job->m_ChunkResults[i];
+                FilterBatch batch{*job->m_Request.Filter, valueSize};
+                // Values at the start of a region whose fields would reach before it are skipped.
+                const uint64_t end = chunk.Lead + chunk.Size;
+                size_t offset = chunk.Lead;
+                auto compare = [&](std::span<const std::byte> bytes, bool last) {
+                    for (; offset + extent <= bytes.size() && offset < end; offset += valueSize) {
+                        if (offset >= lead) {
+                            batch.Add(bufferAddress + offset, bytes.data() + offset, 0, results);
+                        }
+                    }
+                    if (last) {
+                        batch.Flush(results);
+                    }
+                };
+                FetchPipelined(*process, bufferAddress, chunk.ReadSize, compare);
+            } else if (!job->m_Cancelled) {
+                auto &results = job->m_ChunkResults[i];
+                VisitRequest(job->m_Request, [&]<ValueType Type, ScanCompare Compare>() {
+                    constexpr size_t valueSize = sizeof(typename ValueTypeTraits<Type>::Type);
+                    const uint64_t target = job->m_Request.Value;
+                    size_t offset = 0;
+                    auto compare = [&](std::span<const std::byte> bytes, bool) {
+                        for (; offset + valueSize <= bytes.size() && offset < chunk.Size; offset += valueSize) {
+                            uint64_t value = 0;
+                            std::memcpy(&value, bytes.data() + offset, valueSize);
+                            if (Passes<Type, Compare>(value, 0, target)) {
+                                results.push_back({chunk.Address + offset, value});
+                            }
+                        }
+                    };
+                    FetchPipelined(*process, chunk.Address, chunk.ReadSize, compare);
+                });
+            }
+            job->FinishChunk();
+        });
+    }
+    return job;
+}
+
+std::shared_ptr<ScanJob> ScanJob::StartPattern(WorkerPool &pool, WorkerPool::QueueId queue,
+                                               std::shared_ptr<MemorySource> process,
+                                               std::span<const MemoryRegion> regions, BytePattern pattern,
+                                               ScanValueType type) {
+    auto chunks = SplitRegions(regions, pattern.Bytes.size() - 1);
+
+    auto job = std::make_shared<ScanJob>();
+    job->m_Request.Type = type;
+    job->m_ChunkCount = chunks.size();
+    job->m_ChunkResults.resize(chunks.size());
+    if (chunks.empty() || pattern.Bytes.empty()) {
+        job->m_ChunkCount = 0;
+        job->m_Results.store(std::make_shared<ScanResults>());
+        return job;
+    }
+
+    auto sharedPattern = std::make_shared<const BytePattern>(std::move(pattern));
+    for (size_t i = 0; i < chunks.size(); i++) {
+        pool.Submit(queue, [job, process, sharedPattern, chunk = chunks[i], i] {
+            if (!job->m_Cancelled) {
+                const size_t length = sharedPattern->Bytes.size();
+                const size_t valueReach = length < 8 ? 8 - length : 0;
+                auto &results = job->m_ChunkResults[i];
+                // Matches starting before searched were reported already. Until the last slice
+                // a match also needs the 8 bytes of its value there.
+                size_t searched = 0;
+                auto search = [&](std::span<const std::byte> bytes, bool last) {
+                    size_t searchEnd = last ? bytes.size() : bytes.size() - std::min(bytes.size(), valueReach);
+                    if (searchEnd < searched + length) {
+                        return;
+                    }
+                    FindPattern(bytes.subspan(searched, searchEnd - searched), *sharedPattern, [&](size_t offset) {
+                        offset += searched;
+                        if (offset < chunk.Size) {
+                            uint64_t value = 0;
+                            std::memcpy(&value, bytes.data() + offset, std::min<size_t>(8, bytes.size() - offset));
+                            results.push_back({chunk.Address + offset, value});
+                        }
+                    });
+                    searched = searchEnd - length + 1;
+                };
+                FetchPipelined(*process, chunk.Address, chunk.ReadSize, search);
+            }
+            job->FinishChunk();
+        });
+    }
+    return job;
+}
+
+// Higher is rarer. Zero and 0xFF bytes are what most memory is made of, so values with many
+// other bytes make the better anchor, and 8 byte values are rarer than 4 byte ones.
+static int AnchorScore(const GroupValue &value) {
+    size_t size = GetScanValueSize(value.Type);
+    int score = static_cast<int>(size);
+    for (size_t i = 0; i < size; i++) {
+        uint8_t byte = static_cast<uint8_t>(value.Value >> (i * 8));
+        score += byte != 0 && byte != 0xFF ? 4 : 0;
+    }
+    return score;
+}
+
+// Group values compare by their raw bytes, as the unsigned integer of their size.
+template<size_t Size>
+using UnsignedOfSize = std::conditional_t<Size == 1, uint8_t, std::conditional_t<Size == 2, uint16_t,
+                                          std::conditional_t<Size == 4, uint32_t, uint64_t>>>;
+
+// Offsets of every aligned occurrence of needle in bytes. Words are compared a block at a
+// time into a bit mask without branches, which the compiler turns into vector compares;
+// the scalar loop only runs over the set bits.
+template<typename T>
+static void FindAnchors(std::span<const std::byte> bytes, uint64_t bufferAddress, T needle,
+                        std::vector<size_t> &offsets) {
+    constexpr size_t Block = 64;
+    // First offset whose address is aligned to sizeof(T).
+    size_t start = static_cast<size_t>((sizeof(T) - bufferAddress % sizeof(T)) % sizeof(T));
+    if (bytes.size() < start + sizeof(T)) {
+        return;
+    }
+    size_t count = (bytes.size() - start) / sizeof(T);
+    const std::byte *base = bytes.data() + start;
+
+    std::array<T, Block> words;
+    for (size_t first = 0; first < count; first += Block) {
+        size_t n = std::min(Block, count - first);
+        std::memcpy(words.data(), base + first * sizeof(T), n * sizeof(T));
+        uint64_t mask = 0;
+        for (size_t i = 0; i < n; i++) {
+            mask |= static_cast<uint64_t>(words[i] == needle) << i;
+        }
+        while (mask != 0) {
+            size_t bit = static_cast<size_t>(std::countr_zero(mask));
+            offsets.push_back(start + (first + bit) * sizeof(T));
+            mask &= mask - 1;
+        }
+    }
+}
+
+static bool MatchesAt(std::span<const std::byte> bytes, size_t offset, const GroupValue &value) {
+    size_t size = GetScanValueSize(value.Type);
+    if (offset + size > bytes.size()) {
+        return false;
+    }
+    uint64_t raw = 0;
+    std::memcpy(&raw, bytes.data() + offset, size);
+    return raw == value.Value;
+}
+
+// Positions of every group value around an anchor hit, nullopt if one is missing.
+// Ordered groups take the nearest match of each value walking outwards from the anchor,
+// which gives the narrowest span there is, then check that span against the window.
+// Unordered groups try the matches near the anchor depth first until every value sits on
+// bytes of its own and the whole group fits into the window.
+static std::optional<std::vector<size_t>> MatchGroup(std::span<const std::byte> bytes, uint64_t bufferAddress,
+                                                     const GroupScanRequest &request, size_t anchorIndex,
+                                                     size_t anchorOffset) {
+    const auto &values = request.Values;
+    std::vector<size_t> offsets(values.size());
+    offsets[anchorIndex] = anchorOffset;
+    const size_t windowBegin = anchorOffset >= request.Window ? anchorOffset - request.Window : 0;
+    const size_t windowEnd = std::min<size_t>(anchorOffset + request.Window, bytes.size());
+
+    auto aligned = [&](size_t offset, size_t size) { return (bufferAddress + offset) % size == 0; };
+    auto find = [&](const GroupValue &value, size_t from, size_t to, bool backwards) -> std::optional<size_t> {
+        size_t size = GetScanValueSize(value.Type);
+        if (backwards) {
+            for (size_t offset = to; offset-- > from;) {
+                if (aligned(offset, size) && MatchesAt(bytes, offset, value)) {
+                    return offset;
+                }
+            }
+        } else {
+            for (size_t offset = from; offset < to; offset++) {
+                if (aligned(offset, size) && MatchesAt(bytes, offset, value)) {
+                    return offset;
+                }
+            }
+        }
+        return std::nullopt;
+    };
+
+    if (!request.Ordered) {
+        std::vector<std::vector<size_t>> candidates(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i == anchorIndex) {
+                continue;
+            }
+            size_t size = GetScanValueSize(values[i].Type);
+            for (size_t offset = windowBegin; offset < windowEnd; offset++) {
+                if (aligned(offset, size) && MatchesAt(bytes, offset, values[i])) {
+                    candidates[i].push_back(offset);
+                }
+            }
+            if (candidates[i].empty()) {
+                return std::nullopt;
+            }
+        }
+
+        // Values before i and the anchor are placed. Equal values are placed in increasing
+        // order only, which skips trying their permutations and reports a group the same way
+        // whichever of them the anchor hit was.
+        auto place = [&](this auto &self, size_t i, size_t spanBegin, size_t spanEnd) -> bool {
+            if (i == values.size()) {
+                return true;
+            }
+            if (i == anchorIndex) {
+                return self(i + 1, spanBegin, spanEnd);
+            }
+            size_t size = GetScanValueSize(values[i].Type);
+            for (size_t offset: candidates[i]) {
+                size_t begin = std::min(spanBegin, offset);
+                size_t end = std::max(spanEnd, offset + size);
+                if (end - begin > request.Window) {
+                    continue;
+                }
+                bool free = true;
+                for (size_t j = 0; j < values.size() && free; j++) {
+                    if (j >= i && j != anchorIndex) {
+                        continue;
+                    }
+                    size_t otherSize = GetScanValueSize(values[j].Type);
+                    bool overlaps = offset < offsets[j] + otherSize && offsets[j] < offset + size;
+                    bool equal = values[j].Type == values[i].Type && values[j].Value == values[i].Value;
+                    free = !overlaps && !(equal && (j < i) != (offsets[j] < offset));
+                }
+                if (free) {
+                    offsets[i] = offset;
+                    if (self(i + 1, begin, end)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+        size_t anchorSize = GetScanValueSize(values[anchorIndex].Type);
+        if (!place(0, anchorOffset, anchorOffset + anchorSize)) {
+            return std::nullopt;
+        }
+        return offsets;
+    }
+
+    for (size_t i = anchorIndex; i-- > 0;) {
+        // Has to end where the next value starts at the latest.
+        size_t size = GetScanValueSize(values[i].Type);
+        if (offsets[i + 1] < windowBegin + size) {
+            return std::nullopt;
+        }
+        auto offset = find(values[i], windowBegin, offsets[i + 1] - size + 1, true);
+        if (!offset) {
+            return std::nullopt;
+        }
+        offsets[i] = *offset;
+    }
+    for (size_t i = anchorIndex + 1; i < values.size(); i++) {
+        size_t from = offsets[i - 1] + GetScanValueSize(values[i - 1].Type);
+        auto offset = find(values[i], from, windowEnd, false);
+        if (!offset) {
+            return std::nullopt;
+        }
+        offsets[i] = *offset;
+    }
+    size_t spanEnd = offsets.back() + GetScanValueSize(values.back().Type);
+    if (spanEnd - offsets.front() > request.Window) {
+        return std::nullopt;
+    }
+    return offsets;
+}
+
+std::shared_ptr<ScanJob> ScanJob::StartGroup(WorkerPool &pool, WorkerPool::QueueId queue,
+                                             std::shared_ptr<MemorySource> process,
+                                             std::span<const MemoryRegion> regions, GroupScanRequest request) {
+    auto job = std::make_shared<ScanJob>();
+    if (request.Values.empty()) {
+        job->m_Results.store(std::make_shared<ScanResults>());
+        return job;
+    }
+    // Results narrow further like a scan for the first value.
+    job->m_Request = {.Type = request.Values[0].Type, .Compare = ScanCompare::Exact, .Value = request.Values[0].Value};
+
+    // A group spans at most Window bytes, so every value of a group keyed in a chunk lies within
+    // Window bytes either side of it, and so does every anchor hit that finds the group.
+    auto chunks = SplitRegions(regions, request.Window, request.Window);
+    job->m_ChunkCount = chunks.size();
+    job->m_ChunkResults.resize(chunks.size());
+    if (chunks.empty()) {
+        job->m_Results.store(std::make_shared<ScanResults>());
+        return job;
+    }
+
+    size_t anchorIndex = static_cast<size_t>(std::ranges::max_element(request.Values, {}, AnchorScore) -
+                                             request.Values.begin());
+    auto sharedRequest = std::make_shared<const GroupScanRequest>(std::move(request));
+    for (size_t i = 0; i < chunks.size(); i++) {
+        pool.Submit(queue, [job, process, sharedRequest, anchorIndex, chunk = chunks[i], i] {
+            if (!job->m_Cancelled) {
+                const GroupScanRequest &group = *sharedRequest;
+                const GroupValue &anchor = group.Values[anchorIndex];
+                const uint64_t bufferAddress = chunk.Address - chunk.Lead;
+                // Groups look both ways from their anchor, they are matched once the chunk is in.
+                std::span<const std::byte> bytes;
+                FetchPipelined(*process, bufferAddress, chunk.ReadSize,
+                               [&](std::span<const std::byte> read, bool last) { bytes = last ? read : bytes; });
+
+                std::vector<size_t> anchors;
+                VisitScalarType(anchor.Type, [&]<ValueType Type>() {
+                    using Word = UnsignedOfSize<sizeof(typename ValueTypeTraits<Type>::Type)>;
+                    FindAnchors(bytes, bufferAddress, FromRaw<Word>(anchor.Value), anchors);
+                });
+
+                auto &results = job->m_ChunkResults[i];
+                for (size_t anchorOffset: anchors) {
+                    auto offsets = MatchGroup(bytes, bufferAddress, group, anchorIndex, anchorOffset);
+                    // Keyed by the first value, which has to lie in this chunk so neighbours
+                    // reading the same bytes do not report the group twice.
+                    if (!offsets || (*offsets)[0] < chunk.Lead || (*offsets)[0] >= chunk.Lead + chunk.Size) {
+                        continue;
+                    }
+                    results.push_back({bufferAddress + (*offsets)[0], group.Values[0].Value});
+                }
+                // Several anchors may lead to the same group, and for unordered groups the
+                // first value does not have to come first in memory.
+                std::ranges::sort(results, {}, &ScanResultRecord::Address);
+                auto duplicates = std::ranges::unique(results, {}, &ScanResultRecord::Address);
+                results.erase(duplicates.begin(), duplicates.end());
+            }
+            job->FinishChunk();
+        });
+    }
+    return job;
+}
+
+// Reads the records in runs of nearby addresses and calls onValue with each record and its
+// value's bytes, readable from lead bytes before to extent bytes past the address. onRunEnd is
+// called after every run, before the buffer the bytes point into is reused.
+template<typename OnValue, typename OnRunEnd>
+static void ForEachRun(const MemorySource &process, std::span<const ScanResultRecord> records, uint64_t lead,
+                       uint64_t extent, OnValue &&onValue, OnRunEnd &&onRunEnd) {
+    std::vector<std::byte> scratch;
+    size_t first = 0;
+    while (first < records.size()) {
+        // Extend the run while the next address is close to the previous one.
+        size_t last = first;
+        while (last + 1 < records.size() &&
+               records[last + 1].Address - records[last].Address <= MaxReadGap &&
+               records[last + 1].Address + extent - records[first].Address <= MaxReadRun) {
+            last++;
+        }
+
+        uint64_t runStart = records[first].Address - std::min(lead, records[first].Address);
+        auto bytes = process.Fetch(runStart, records[last].Address + extent - runStart, scratch);
+        size_t r = first;
+        for (; r <= last; r++) {
+            uint64_t offset = records[r].Address - runStart;
+            if (offset < lead || offset + extent > bytes.size()) {
+                break;
+            }
+            onValue(records[r], bytes.data() + offset);
+        }
+        onRunEnd();
+        // A short read ends at an unmapped page or, for mapped dumps, at the end of a
+        // region. The rest of the run starts over, a record that cannot be read at
+        // all is dropped.
+        first = r == first ? r + 1 : r;
+    }
+}
+
+std::shared_ptr<ScanJob> ScanJob::StartNext(WorkerPool &pool, WorkerPool::QueueId queue,
+                                            std::shared_ptr<MemorySource> process,
+                                            std::shared_ptr<const ScanResults> previous,
+                                            const ScanRequest &request) {
+    auto job = std::make_shared<ScanJob>();
+    job->m_Request = request;
+    job->m_ChunkCount = (previous->size() + NextScanChunkResults - 1) / NextScanChunkResults;
+    job->m_ChunkResults.resize(job->m_ChunkCount);
+    if (job->m_ChunkCount == 0) {
+        job->m_Results.store(std::make_shared<ScanResults>());
+        return job;
+    }
+
+    for (size_t i = 0; i < job->m_ChunkCount; i++) {
+        pool.Submit(queue, [job, process, previous, i] {
+            if (!job->m_Cancelled) {
+                auto records = std::span(*previous).subspan(i * NextScanChunkResults);
+                records = records.first(std::min(records.size(), NextScanChunkResults));
+                auto &results = job->m_ChunkResults[i];
+                if (job->m_Request.Filter) {
+                    // Filters read their fields along, each run reaches from lead bytes before
+                    // its first value to extent bytes past its last one.
+                    FilterBatch batch{*job->m_Request.Filter, GetScanValueSize(job->m_Request.Type)};
+                    ForEachRun(*process, records, GetLead(job->m_Request), GetExtent(job->m_Request),
+                               [&](const ScanResultRecord &record, const std::byte *value) {
+                                   batch.Add(record.Address, value, record.Value, results);
+                               },
+                               [&] { batch.Flush(results); });
+                } else {
+                    VisitRequest(job->m_Request, [&]<ValueType Type, ScanCompare Compare>() {
+                        constexpr size_t valueSize = sizeof(typename ValueTypeTraits<Type>::Type);
+                        const uint64_t target = job->m_Request.Value;
+                        ForEachRun(*process, records, 0, valueSize,
+                                   [&](const ScanResultRecord &record, const std::byte *value) {
+                                       uint64_t current = 0;
+                                       std::memcpy(&current, value, valueSize);
+                                       if (Passes<Type, Compare>(current, record.Value, target)) {
+                                           results.push_back({record.Address, current});
+                                       }
+                                   },
+                                   [] {});
+                    });
+                }
+            }
+            job->FinishChunk();
+        });
+    }
+    return job;
+}
@@ -0,0 +1,209 @@
+export module Engine.Scanner;
+
+import std;
+import Engine.ProcessMemory;
+import Engine.Session;
+export import Engine.ValueTypes;
+import WorkerPool;
+
+// Scans take the scalar value types, strings and byte arrays go through pattern scans.
+export using ScanValueType = ValueType;
+
+export enum class ScanCompare : uint8_t {
+    Exact,
+    Changed,
+    Unchanged,
+    Increased,
+    Decreased,
+    Filter // ScanRequest::Filter decides
+};
+
+export constexpr size_t GetScanValueSize(ScanValueType type) {
+    return GetValueTypeSize(type);
+}
+
+export std::optional<uint64_t> ParseScanValue(std::string_view text, ScanValueType type) {
+    return ParseValue(text, type);
+}
+
+export std::string FormatScanValue(uint64_t raw, ScanValueType type) {
+    return FormatValue(raw, type);
+}
+
+// Byte signature such as "48 8B 05 ?? ?? ?? ?? C3", ?? matches any byte.
+export struct BytePattern {
+    std::vector<std::byte> Bytes;
+    std::vector<std::byte> Mask; // 0xFF for fixed bytes, 0 for wildcards
+    size_t AnchorOffset = 0; // first fixed byte, searched with memchr
+};
+
+export std::optional<BytePattern> ParsePattern(std::string_view text);
+
+// Matches bytes exactly, for strings and byte arrays without wildcards.
+export BytePattern MakePattern(std::span<const std::byte> bytes);
+
+// Calls onMatch with the offset of every match inside haystack.
+export template<typename F>
+void FindPattern(std::span<const std::byte> haystack, const BytePattern &pattern, F &&onMatch) {
+    const size_t length = pattern.Bytes.size();
+    if (haystack.size() < length) {
+        return;
+    }
+    const auto anchor = static_cast<int>(pattern.Bytes[pattern.AnchorOffset]);
+    const std::byte *begin = haystack.data() + pattern.AnchorOffset;
+    const std::byte *end = haystack.data() + (haystack.size() - length) + pattern.AnchorOffset + 1;
+
+    const std::byte *cursor = begin;
+    while (cursor < end) {
+        auto *hit = static_cast<const std::byte *>(std::memchr(cursor, anchor, static_cast<size_t>(end - cursor)));
+        if (hit == nullptr) {
+            return;
+        }
+        const std::byte *candidate = hit - pattern.AnchorOffset;
+        bool matches = true;
+        for (size_t i = 0; i < length; i++) {
+            if ((candidate[i] & pattern.Mask[i]) != pattern.Bytes[i]) {
+                matches = false;
+                break;
+            }
+        }
+        if (matches) {
+            onMatch(static_cast<size_t>(candidate - haystack.data()));
+        }
+        cursor = hit + 1;
+    }
+}
+
+// Compiled form of a ScanFilter, defined next to the compiler.
+struct FilterProgram;
+
+// A condition written by the user, compiled once per scan:
+//
+//     value between old*0.9 and old, u8 at +4 == 1
+//
+// value and old are the candidate's current and previous value, "<type> at <offset>" is a field
+// next to it, typed by a scalar's short name (i8 to u64, f32, f64, p32, p64, byte for u8).
+// Conditions are joined by "and" or commas and compare with == != < <= > >= or "between a and
+// b"; operands may use + - * / and parentheses. Conditions shaped "value or field <op> a*old + b"
+// run on kernels specialized for the field type and the comparison, anything else runs as
+// register bytecode. Either way a call handles a block of candidates, one condition or
+// instruction at a time across the whole block, so dispatch is paid per block and the inner
+// loops are plain array code.
+export class ScanFilter {
+public:
+    static constexpr size_t BlockSize = 256;
+
+    static std::expected<ScanFilter, std::string> Compile(std::string_view text, ScanValueType type);
+
+    [[nodiscard]] ScanValueType GetType() const;
+
+    // Filters using old need a previous scan.
+    [[nodiscard]] bool UsesOld() const;
+
+    // Bytes a candidate needs readable around its value: [-GetLead(), GetExtent()).
+    [[nodiscard]] uint64_t GetLead() const;
+
+    [[nodiscard]] uint64_t GetExtent() const;
+
+    // Every condition runs on a specialized kernel.
+    [[nodiscard]] bool IsSpecialized() const;
+
+    // pass[i] is set to whether the filter holds for the value at values[i], whose previous value
+    // is old[i]. At most BlockSize candidates, each readable as GetLead and GetExtent describe.
+    void Evaluate(std::span<const std::byte *const> values, std::span<const uint64_t> old,
+                  std::span<uint8_t> pass) const;
+
+private:
+    std::shared_ptr<const FilterProgram> m_Program;
+};
+
+export struct ScanRequest {
+    ScanValueType Type = ScanValueType::Int32;
+    ScanCompare Compare = ScanCompare::Exact;
+    uint64_t Value = 0; // for Exact
+    std::optional<ScanFilter> Filter; // for Filter, compiled for Type
+};
+
+export struct GroupValue {
+    ScanValueType Type = ScanValueType::Int32;
+    uint64_t Value = 0;
+};
+
+// Several values expected close together, like the fields of one struct. Ordered groups have
+// to appear in the given order, and the whole group has to fit into Window bytes.
+export struct GroupScanRequest {
+    std::vector<GroupValue> Values;
+    uint32_t Window = 64;
+    bool Ordered = true;
+};
+
+// Space separated values with an optional type prefix, "100 i32:50 f32:3.5". Int32 by default.
+export std::optional<GroupScanRequest> ParseGroupScan(std::string_view text, uint32_t window, bool ordered);
+
+export using ScanResults = std::vector<ScanResultRecord>;
+
+// Slices of a first, pattern or group scan chunk kept in flight while the ones before are
+// compared, for sources with an AsyncReader; at most AsyncReader::MaxDepth - 1. 0, the default,
+// reads each chunk whole before comparing it. Overlapping only pays off when the pool leaves
+// cores idle, ScanBench's first_scan_depth_* cases show whether it does. Applies to chunks
+// starting after the call.
+export void SetScanReadDepth(size_t depth);
+
+export size_t GetScanReadDepth();
+
+// A scan split into chunks on a WorkerPool queue. The results are published once the last
+// chunk finished, sorted by address.
+export class ScanJob {
+public:
+    [[nodiscard]] float GetProgress() const {
+        return m_ChunkCount == 0 ? 1.0f : static_cast<float>(m_FinishedChunks.load()) / m_ChunkCount;
+    }
+
+    [[nodiscard]] bool IsDone() const { return m_Results.load() != nullptr; }
+
+    // Remaining chunks return immediately, the results then hold what was found so far.
+    void Cancel() { m_Cancelled = true; }
+
+    [[nodiscard]] bool IsCancelled() const { return m_Cancelled; }
+
+    [[nodiscard]] std::shared_ptr<const ScanResults> GetResults() const { return m_Results.load(); }
+
+    [[nodiscard]] const ScanRequest &GetRequest() const { return m_Request; }
+
+    // Scans every region for values matching request, which has to be an Exact compare or a
+    // filter not using old.
+    static std::shared_ptr<ScanJob> StartFirst(WorkerPool &pool, WorkerPool::QueueId queue,
+                                               std::shared_ptr<MemorySource> process,
+                                               std::span<const MemoryRegion> regions, const ScanRequest &request);
+
+    // Finds every occurrence of pattern, Value holds the first 8 bytes of each match. The
+    // results are of type, String or Bytes, and do not narrow with StartNext.
+    static std::shared_ptr<ScanJob> StartPattern(WorkerPool &pool, WorkerPool::QueueId queue,
+                                                 std::shared_ptr<MemorySource> process,
+                                                 std::span<const MemoryRegion> regions, BytePattern pattern,
+                                                 ScanValueType type = ScanValueType::Bytes);
+
+    // One pass per chunk anchored on the rarest looking value of the group, the others are
+    // verified around each anchor hit. Results hold the first value of every group found and
+    // narrow with StartNext like those of a first scan for it.
+    static std::shared_ptr<ScanJob> StartGroup(WorkerPool &pool, WorkerPool::QueueId queue,
+                                               std::shared_ptr<MemorySource> process,
+                                               std::span<const MemoryRegion> regions, GroupScanRequest request);
+
+    // Re-reads the addresses of previous and keeps those whose value passes the compare.
+    static std::shared_ptr<ScanJob> StartNext(WorkerPool &pool, WorkerPool::QueueId queue,
+                                              std::shared_ptr<MemorySource> process,
+                                              std::shared_ptr<const ScanResults> previous,
+                                              const ScanRequest &request);
+
+private:
+    void FinishChunk();
+
+    ScanRequest m_Request;
+    std::vector<ScanResults> m_ChunkResults; // each chunk writes only its own slot
+    size_t m_ChunkCount = 0;
+    std::atomic<size_t> m_FinishedChunks = 0;
+    std::atomic<bool> m_Cancelled = false;
+    std::atomic<std::shared_ptr<const ScanResults>> m_Results;
+};
+
@@ -0,0 +1,175 @@
+module Engine.Session;
+
+uint64_t SessionChecksum(std::span<const std::byte> data) {
+    // Word at a time multiply-xorshift, fast enough to verify gigabytes on demand.
+    constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = 0xCBF29CE484222325ull ^ (data.size() * multiplier);
+
+    size_t words = data.size() / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i * sizeof(uint64_t), sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+
+    uint64_t tail = 0;
+    if (size_t remaining = data.size() % sizeof(uint64_t)) {
+        std::memcpy(&tail, data.data() + words * sizeof(uint64_t), remaining);
+    }
+    hash = (hash ^ tail) * multiplier;
+    return hash ^ (hash >> 32);
+}
+
+static uint64_t HeaderChecksum(SessionHeader header) {
+    header.HeaderChecksum = 0;
+    return SessionChecksum(std::as_bytes(std::span(&header, 1)));
+}
+
+SessionWriter::SessionWriter(const std::filesystem::path &path)
+    : m_File(path, std::ios::binary | std::ios::trunc) {
+    SessionHeader placeholder{};
+    m_File.write(reinterpret_cast<const char *>(&placeholder), sizeof(placeholder));
+    m_Position = sizeof(placeholder);
+}
+
+void SessionWriter::AddRawSection(SessionSectionKind kind, std::string_view name, std::span<const std::byte> data,
+                                  uint32_t elementSize) {
+    PadTo(SectionAlignment);
+
+    SessionSectionEntry entry{
+        .Kind = kind,
+        .ElementSize = elementSize,
+        .Offset = m_Position,
+        .Size = data.size(),
+        .Checksum = SessionChecksum(data),
+        .Name = {}
+    };
+    CopyToField(entry.Name, name);
+    m_Sections.push_back(entry);
+
+    m_File.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    m_Position += data.size();
+}
+
+bool SessionWriter::Finish() {
+    PadTo(alignof(SessionSectionEntry));
+    uint64_t indexOffset = m_Position;
+    auto index = std::as_bytes(std::span(m_Sections));
+    m_File.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(index.size()));
+
+    SessionHeader header{
+        .Magic = SessionMagic,
+        .Version = SessionVersion,
+        .SectionCount = static_cast<uint32_t>(m_Sections.size()),
+        .IndexOffset = indexOffset,
+        .IndexChecksum = SessionChecksum(index),
+        .HeaderChecksum = 0
+    };
+    header.HeaderChecksum = HeaderChecksum(header);
+
+    m_File.seekp(0);
+    m_File.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    m_File.close();
+    return !m_File.fail();
+}
+
+void SessionWriter::PadTo(uint64_t alignment) {
+    static constexpr std::array<char, SectionAlignment> zeros{};
+    uint64_t padding = (alignment - m_Position % alignment) % alignment;
+    m_File.write(zeros.data(), static_cast<std::streamsize>(padding));
+    m_Position += padding;
+}
+
+std::expected<SessionFile, std::string> SessionFile::Open(const std::filesystem::path &path) {
+    auto mapped = MappedFile::Open(path);
+    if (!mapped) {
+        return std::unexpected("cannot open " + path.string());
+    }
+
+    auto data = mapped->GetData();
+    if (data.size() < sizeof(SessionHeader)) {
+        return std::unexpected("file too small");
+    }
+
+    SessionHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.Magic != SessionMagic) {
+        return std::unexpected("not a session file");
+    }
+    if (header.Version != SessionVersion) {
+        return std::unexpected(std::format("unsupported session version {}", header.Version));
+    }
+    if (header.HeaderChecksum != HeaderChecksum(header)) {
+        return std::unexpected("corrupt header");
+    }
+
+    uint64_t indexSize = uint64_t{header.SectionCount} * sizeof(SessionSectionEntry);
+    if (header.IndexOffset % alignof(SessionSectionEntry) != 0 || header.IndexOffset > data.size() ||
+        indexSize > data.size() - header.IndexOffset) {
+        return std::unexpected("index out of bounds");
+    }
+    auto index = data.subspan(header.IndexOffset, indexSize);
+    if (header.IndexChecksum != SessionChecksum(index)) {
+        return std::unexpected("corrupt index");
+    }
+
+    SessionFile file;
+    file.m_Sections = {reinterpret_cast<const SessionSectionEntry *>(index.data()), header.SectionCount};
+    for (const auto &entry: file.m_Sections) {
+        // Get reinterprets section bytes as records, which needs them aligned. The writer aligns every
+        // section to SectionAlignment, anything else was not written by it.
+        if (entry.Offset % SectionAlignment != 0) {
+            return std::unexpected(std::format("section {} misaligned", FieldToString(entry.Name)));
+        }
+        if (entry.Offset > data.size() || entry.Size > data.size() - entry.Offset ||
+            (entry.ElementSize != 0 && entry.Size % entry.ElementSize != 0)) {
+            return std::unexpected(std::format("section {} out of bounds", FieldToString(entry.Name)));
+        }
+    }
+    file.m_File = std::move(*mapped);
+    return file;
+}
+
+const SessionSectionEntry *SessionFile::Find(SessionSectionKind kind, std::string_view name) const {
+    for (const auto &entry: m_Sections) {
+        if (entry.Kind == kind && FieldToString(entry.Name) == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool SessionFile::VerifySection(const SessionSectionEntry &entry) const {
+    return SessionChecksum(GetBytes(entry)) == entry.Checksum;
+}
+
+std::expected<void, std::string> SessionFile::VerifyAll() const {
+    for (const auto &entry: m_Sections) {
+        if (!VerifySection(entry)) {
+            return std::unexpected(std::format("section {} of kind {} is corrupt", FieldToString(entry.Name),
+                                               std::to_underlying(entry.Kind)));
+        }
+    }
+    return {};
+}
+
+ScanResultDiff DiffScanResults(std::span<const ScanResultRecord> before, std::span<const ScanResultRecord> after) {
+    ScanResultDiff diff;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < before.size() || j < after.size()) {
+        if (j == after.size() || (i < before.size() && before[i].Address < after[j].Address)) {
+            diff.Removed.push_back(before[i++].Address);
+        } else if (i == before.size() || after[j].Address < before[i].Address) {
+            diff.Added.push_back(after[j++].Address);
+        } else {
+            if (before[i].Value != after[j].Value) {
+                diff.Changed.push_back(after[j].Address);
+            }
+            i++;
+            j++;
+        }
+    }
+    return diff;
+}
@@ -0,0 +1,180 @@
+export module Engine.Session;
+
+import std;
+import Engine.MappedFile;
+
+// Session files are a header, sections aligned to SectionAlignment, and an index of section
+// entries at the end. Every section is an array of one of the trivially copyable record types
+// below, so an opened session hands out spans straight into the mapping without parsing.
+// Checksums cover the header, the index and every section. Only the first two are checked
+// on open, sections are verified on demand so opening stays O(sections). Readers call
+// VerifySection or VerifyAll before trusting a section's records.
+//
+// Records are written in a fixed order with zeroed padding, so two sessions with the same
+// content are byte identical and plain binary diffs stay small.
+
+export enum class SessionSectionKind : uint32_t {
+    Metadata = 1,
+    ScanResults = 2,
+    SnapshotRegions = 3,
+    SnapshotData = 4,
+    WatchList = 5,
+    PointerMap = 6,
+    // Symbol cache files, see Engine.Symbols.
+    SymbolTable = 7,
+    SymbolNames = 8,
+    WatchExpressions = 9
+};
+
+export struct SessionMetadata {
+    std::array<char, 256> GameName{};
+    std::array<char, 64> Address{};
+    uint32_t DataType = 0;
+    uint32_t ProcessId = 0;
+};
+
+// Sorted by address. Value holds the raw bytes, zero extended to 8.
+export struct ScanResultRecord {
+    uint64_t Address;
+    uint64_t Value;
+};
+
+// Region headers of a snapshot, the bytes live in the SnapshotData section of the same name.
+export struct SnapshotRegionRecord {
+    uint64_t Base;
+    uint64_t Size;
+    uint64_t DataOffset;
+};
+
+export namespace WatchFlags {
+    constexpr uint32_t Frozen = 1 << 0;
+}
+
+export struct WatchRecord {
+    uint64_t Address;
+    uint64_t FreezeValue;
+    uint32_t Type;
+    uint32_t Flags;
+    std::array<char, 48> Label{};
+};
+
+// Address expression of the watch at WatchIndex in the WatchList section, for watches that
+// follow a pointer chain instead of sitting at a fixed address.
+export struct WatchExpressionRecord {
+    uint32_t WatchIndex;
+    std::array<char, 124> Text{};
+};
+
+// Sorted by address, Target is the value the pointer held when the map was built.
+export struct PointerMapRecord {
+    uint64_t Address;
+    uint64_t Target;
+};
+
+export constexpr std::array<char, 8> SessionMagic{'E', 'R', 'S', 'E', 'S', 'S', 'N', '\0'};
+export constexpr uint32_t SessionVersion = 1;
+export constexpr uint64_t SectionAlignment = 4096;
+
+export struct SessionHeader {
+    std::array<char, 8> Magic;
+    uint32_t Version;
+    uint32_t SectionCount;
+    uint64_t IndexOffset;
+    uint64_t IndexChecksum;
+    uint64_t HeaderChecksum; // of the header with this field zeroed
+};
+
+export struct SessionSectionEntry {
+    SessionSectionKind Kind;
+    uint32_t ElementSize;
+    uint64_t Offset;
+    uint64_t Size;
+    uint64_t Checksum;
+    std::array<char, 32> Name;
+};
+
+export uint64_t SessionChecksum(std::span<const std::byte> data);
+
+export template<typename T>
+concept SessionRecord = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>;
+
+// Copies a string into a fixed size record field, truncating and always NUL terminating it.
+export template<size_t N>
+void CopyToField(std::array<char, N> &field, std::string_view text) {
+    field.fill('\0');
+    std::ranges::copy(text.substr(0, N - 1), field.begin());
+}
+
+export template<size_t N>
+std::string_view FieldToString(const std::array<char, N> &field) {
+    return {field.data(), std::ranges::find(field, '\0') - field.begin()};
+}
+
+// Streams sections to disk, nothing but the index is kept in memory.
+export class SessionWriter {
+public:
+    explicit SessionWriter(const std::filesystem::path &path);
+
+    template<SessionRecord T>
+    void AddSection(SessionSectionKind kind, std::string_view name, std::span<const T> records) {
+        AddRawSection(kind, name, std::as_bytes(records), sizeof(T));
+    }
+
+    void AddRawSection(SessionSectionKind kind, std::string_view name, std::span<const std::byte> data,
+                       uint32_t elementSize);
+
+    // Writes the index and the header. Returns false if any write failed.
+    bool Finish();
+
+private:
+    void PadTo(uint64_t alignment);
+
+    std::ofstream m_File;
+    uint64_t m_Position = 0;
+    std::vector<SessionSectionEntry> m_Sections;
+};
+
+export class SessionFile {
+public:
+    static std::expected<SessionFile, std::string> Open(const std::filesystem::path &path);
+
+    [[nodiscard]] std::span<const SessionSectionEntry> GetSections() const { return m_Sections; }
+
+    [[nodiscard]] const SessionSectionEntry *Find(SessionSectionKind kind, std::string_view name = {}) const;
+
+    // Records of a section, empty if it is missing or was written with a different record size.
+    template<SessionRecord T>
+    std::span<const T> Get(SessionSectionKind kind, std::string_view name = {}) const {
+        static_assert(alignof(T) <= SectionAlignment);
+        const SessionSectionEntry *entry = Find(kind, name);
+        if (entry == nullptr || entry->ElementSize != sizeof(T)) {
+            return {};
+        }
+        auto bytes = m_File.GetData().subspan(entry->Offset, entry->Size);
+        return {reinterpret_cast<const T *>(bytes.data()), bytes.size() / sizeof(T)};
+    }
+
+    [[nodiscard]] std::span<const std::byte> GetBytes(const SessionSectionEntry &entry) const {
+        return m_File.GetData().subspan(entry.Offset, entry.Size);
+    }
+
+    // Reads the whole section, O(size).
+    [[nodiscard]] bool VerifySection(const SessionSectionEntry &entry) const;
+
+    // Verifies every section, the error names the first one that does not match its checksum.
+    [[nodiscard]] std::expected<void, std::string> VerifyAll() const;
+
+private:
+    MappedFile m_File;
+    std::span<const SessionSectionEntry> m_Sections;
+};
+
+export struct ScanResultDiff {
+    std::vector<uint64_t> Added;
+    std::vector<uint64_t> Removed;
+    std::vector<uint64_t> Changed;
+};
+
+// Both inputs sorted by address, one merge pass.
+export ScanResultDiff DiffScanResults(std::span<const ScanResultRecord> before,
+                                      std::span<const ScanResultRecord> after);
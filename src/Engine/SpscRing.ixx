@@ -0,0 +1,51 @@
+export module Engine.SpscRing;
+
+import std;
+
+// Bounded lock-free queue for exactly one producer and one consumer thread. Capacity has to be
+// a power of two, indices run freely and are masked on access. Head and tail live on separate
+// cache lines together with a cached copy of the other side, so a push or pop normally touches
+// no cache line written by the other thread.
+export template<typename T, size_t Capacity>
+    requires (std::has_single_bit(Capacity) && std::is_trivially_copyable_v<T>)
+class SpscRing {
+public:
+    static constexpr size_t CacheLineSize = 64;
+
+    // Producer only. Returns false if the ring is full.
+    bool TryPush(const T &value) {
+        size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead == Capacity) {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead == Capacity) {
+                return false;
+            }
+        }
+        m_Items[tail & (Capacity - 1)] = value;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Pops up to out.size() items, returns how many were written.
+    size_t PopBulk(std::span<T> out) {
+        size_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_CachedTail == head) {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        }
+        size_t count = std::min(m_CachedTail - head, out.size());
+        for (size_t i = 0; i < count; i++) {
+            out[i] = m_Items[(head + i) & (Capacity - 1)];
+        }
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    alignas(CacheLineSize) std::atomic<size_t> m_Head{0};
+    size_t m_CachedTail = 0; // consumer's view of m_Tail
+
+    alignas(CacheLineSize) std::atomic<size_t> m_Tail{0};
+    size_t m_CachedHead = 0; // producer's view of m_Head
+
+    alignas(CacheLineSize) std::array<T, Capacity> m_Items{};
+};
@@ -0,0 +1,508 @@
+module;
+
+#ifdef _WIN32
+// tlhelp32.h needs windows.h included ahead of it, which importing it as a header unit does not do.
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <cxxabi.h>
+#endif
+
+module Engine.Symbols;
+
+import Engine.MappedFile;
+
+// Bumped whenever parsing changes what ends up in a cache file, so old files are not picked up.
+constexpr std::string_view SymbolCacheVersion = "v1";
+
+// The ELF and PE structures are read field by field at fixed offsets, so the same code parses
+// images of either kind whatever the host.
+template<typename T>
+static std::optional<T> ReadAt(std::span<const std::byte> data, uint64_t offset) {
+    if (offset > data.size() || data.size() - offset < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+// NUL terminated string at offset, empty if it runs off the end of data.
+static std::string_view ReadString(std::span<const std::byte> data, uint64_t offset) {
+    if (offset >= data.size()) {
+        return {};
+    }
+    auto text = reinterpret_cast<const char *>(data.data() + offset);
+    auto length = std::string_view(text, data.size() - offset).find('\0');
+    return length == std::string_view::npos ? std::string_view{} : std::string_view(text, length);
+}
+
+static bool HasMagic(std::span<const std::byte> data, std::string_view magic) {
+    return data.size() >= magic.size() && std::memcmp(data.data(), magic.data(), magic.size()) == 0;
+}
+
+static std::string ToHex(std::span<const std::byte> bytes) {
+    std::string text;
+    for (std::byte value: bytes) {
+        std::format_to(std::back_inserter(text), "{:02x}", static_cast<uint8_t>(value));
+    }
+    return text;
+}
+
+static std::string Demangle(std::string_view name) {
+#ifndef _WIN32
+    if (name.starts_with("_Z")) {
+        std::string mangled(name);
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+        if (status == 0 && demangled != nullptr) {
+            std::string result(demangled);
+            std::free(demangled);
+            return result;
+        }
+        std::free(demangled);
+    }
+#endif
+    return std::string(name);
+}
+
+struct ParsedSymbol {
+    uint64_t Offset;
+    uint32_t Size;
+    std::string Name;
+};
+
+struct ParsedImage {
+    std::string BuildId;
+    std::vector<ParsedSymbol> Symbols;
+};
+
+// Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr, Elf64_Sym and Elf64_Nhdr field offsets.
+namespace Elf {
+    constexpr uint32_t TypeLoad = 1;
+    constexpr uint32_t TypeNote = 4;
+    constexpr uint32_t SectionSymtab = 2;
+    constexpr uint32_t SectionNote = 7;
+    constexpr uint32_t SectionDynsym = 11;
+    constexpr uint32_t NoteGnuBuildId = 3;
+    constexpr uint16_t SectionReserved = 0xFF00;
+    constexpr uint8_t SymbolObject = 1;
+    constexpr uint8_t SymbolFunction = 2;
+    constexpr uint64_t ProgramHeaderSize = 56;
+    constexpr uint64_t SectionHeaderSize = 64;
+    constexpr uint64_t SymbolSize = 24;
+}
+
+// GNU build id from the notes in [offset, offset + size), empty if there is none. Sizes come
+// from the file, so bounds are checked by subtracting from end rather than adding to offset.
+static std::string FindElfBuildId(std::span<const std::byte> file, uint64_t offset, uint64_t size) {
+    if (offset > file.size()) {
+        return {};
+    }
+    uint64_t end = offset + std::min<uint64_t>(size, file.size() - offset);
+    while (offset <= end && end - offset >= 12) {
+        auto nameSize = ReadAt<uint32_t>(file, offset);
+        auto descSize = ReadAt<uint32_t>(file, offset + 4);
+        auto type = ReadAt<uint32_t>(file, offset + 8);
+        if (!nameSize || !descSize || !type) {
+            break;
+        }
+        uint64_t name = offset + 12;
+        uint64_t nameSpace = (*nameSize + 3ull) & ~3ull;
+        uint64_t descSpace = (*descSize + 3ull) & ~3ull;
+        if (nameSpace > end - name || descSpace > end - name - nameSpace) {
+            break;
+        }
+        uint64_t desc = name + nameSpace;
+        if (*type == Elf::NoteGnuBuildId && *nameSize == 4 && ReadString(file.subspan(name, 4), 0) == "GNU") {
+            return ToHex(file.subspan(desc, *descSize));
+        }
+        offset = desc + descSpace;
+    }
+    return {};
+}
+
+// Without readSymbols only the headers and notes are looked at, for the build id.
+static std::optional<ParsedImage> ParseElf(std::span<const std::byte> file, bool readSymbols) {
+    // 64-bit little endian only.
+    if (file.size() < 64 || !HasMagic(file, "\x7f" "ELF") ||
+        static_cast<uint8_t>(file[4]) != 2 || static_cast<uint8_t>(file[5]) != 1) {
+        return std::nullopt;
+    }
+    auto programOffset = *ReadAt<uint64_t>(file, 32);
+    auto sectionOffset = *ReadAt<uint64_t>(file, 40);
+    auto programCount = *ReadAt<uint16_t>(file, 56);
+    auto sectionCount = *ReadAt<uint16_t>(file, 60);
+
+    ParsedImage image;
+    // Symbol values are link time addresses; the module base is where the segment holding file
+    // offset 0 was mapped.
+    std::optional<uint64_t> imageAddress;
+    for (uint16_t i = 0; i < programCount; i++) {
+        uint64_t header = programOffset + i * Elf::ProgramHeaderSize;
+        auto type = ReadAt<uint32_t>(file, header);
+        auto offset = ReadAt<uint64_t>(file, header + 8);
+        auto address = ReadAt<uint64_t>(file, header + 16);
+        auto size = ReadAt<uint64_t>(file, header + 32);
+        if (!type || !offset || !address || !size) {
+            break;
+        }
+        if (*type == Elf::TypeLoad && !imageAddress) {
+            imageAddress = *address - *offset;
+        } else if (*type == Elf::TypeNote && image.BuildId.empty()) {
+            image.BuildId = FindElfBuildId(file, *offset, *size);
+        }
+    }
+
+    for (uint16_t i = 0; i < sectionCount; i++) {
+        uint64_t header = sectionOffset + i * Elf::SectionHeaderSize;
+        auto type = ReadAt<uint32_t>(file, header + 4);
+        auto offset = ReadAt<uint64_t>(file, header + 24);
+        auto size = ReadAt<uint64_t>(file, header + 32);
+        auto link = ReadAt<uint32_t>(file, header + 40);
+        if (!type || !offset || !size || !link) {
+            break;
+        }
+        if (*type == Elf::SectionNote && image.BuildId.empty()) {
+            image.BuildId = FindElfBuildId(file, *offset, *size);
+        }
+        if (!readSymbols || (*type != Elf::SectionSymtab && *type != Elf::SectionDynsym)) {
+            continue;
+        }
+        auto stringsOffset = ReadAt<uint64_t>(file, sectionOffset + *link * Elf::SectionHeaderSize + 24);
+        if (!stringsOffset) {
+            continue;
+        }
+        if (*offset > file.size()) {
+            continue;
+        }
+        uint64_t symbolsEnd = *offset + std::min<uint64_t>(*size, file.size() - *offset);
+        for (uint64_t symbol = *offset; symbolsEnd - symbol >= Elf::SymbolSize; symbol += Elf::SymbolSize) {
+            auto name = ReadAt<uint32_t>(file, symbol);
+            auto info = ReadAt<uint8_t>(file, symbol + 4);
+            auto sectionIndex = ReadAt<uint16_t>(file, symbol + 6);
+            auto value = ReadAt<uint64_t>(file, symbol + 8);
+            auto symbolSize = ReadAt<uint64_t>(file, symbol + 16);
+            if (!name || !info || !sectionIndex || !value || !symbolSize) {
+                break;
+            }
+            uint8_t kind = *info & 0xF;
+            // Undefined and absolute symbols have no address in the image.
+            if ((kind != Elf::SymbolFunction && kind != Elf::SymbolObject) || *sectionIndex == 0 ||
+                *sectionIndex >= Elf::SectionReserved || *value < imageAddress.value_or(0)) {
+                continue;
+            }
+            std::string_view text = ReadString(file, *stringsOffset + *name);
+            if (text.empty()) {
+                continue;
+            }
+            auto clampedSize = static_cast<uint32_t>(std::min<uint64_t>(*symbolSize, std::numeric_limits<uint32_t>::max()));
+            image.Symbols.push_back({*value - imageAddress.value_or(0), clampedSize, Demangle(text)});
+        }
+    }
+    return image;
+}
+
+namespace Pe {
+    constexpr uint16_t Magic32 = 0x10B;
+    constexpr uint16_t Magic64 = 0x20B;
+    constexpr uint32_t DirectoryExport = 0;
+    constexpr uint32_t DirectoryDebug = 6;
+    constexpr uint32_t DebugCodeView = 2;
+    constexpr uint64_t SectionHeaderSize = 40;
+    constexpr uint64_t DebugEntrySize = 28;
+}
+
+static std::optional<ParsedImage> ParsePe(std::span<const std::byte> file, bool readSymbols) {
+    if (file.size() < 64 || !HasMagic(file, "MZ")) {
+        return std::nullopt;
+    }
+    auto peOffset = *ReadAt<uint32_t>(file, 0x3C);
+    if (ReadAt<uint32_t>(file, peOffset) != 0x00004550) { // "PE\0\0"
+        return std::nullopt;
+    }
+    auto sectionCount = ReadAt<uint16_t>(file, peOffset + 6);
+    auto timeStamp = ReadAt<uint32_t>(file, peOffset + 8);
+    auto optionalSize = ReadAt<uint16_t>(file, peOffset + 20);
+    uint64_t optional = peOffset + 24;
+    auto magic = ReadAt<uint16_t>(file, optional);
+    auto imageSize = ReadAt<uint32_t>(file, optional + 56);
+    if (!sectionCount || !optionalSize || !magic || !imageSize || (*magic != Pe::Magic32 && *magic != Pe::Magic64)) {
+        return std::nullopt;
+    }
+    uint64_t directories = optional + (*magic == Pe::Magic64 ? 112 : 96);
+    uint32_t directoryCount = ReadAt<uint32_t>(file, directories - 4).value_or(0);
+    uint64_t sections = optional + *optionalSize;
+
+    // Section table lookup, the directories hold addresses in the loaded image.
+    auto toFileOffset = [&](uint32_t address) -> std::optional<uint64_t> {
+        for (uint16_t i = 0; i < *sectionCount; i++) {
+            uint64_t header = sections + i * Pe::SectionHeaderSize;
+            auto virtualSize = ReadAt<uint32_t>(file, header + 8);
+            auto virtualAddress = ReadAt<uint32_t>(file, header + 12);
+            auto rawSize = ReadAt<uint32_t>(file, header + 16);
+            auto rawOffset = ReadAt<uint32_t>(file, header + 20);
+            if (!virtualSize || !virtualAddress || !rawSize || !rawOffset) {
+                return std::nullopt;
+            }
+            if (address >= *virtualAddress && address - *virtualAddress < std::max(*virtualSize, *rawSize)) {
+                return *rawOffset + (address - *virtualAddress);
+            }
+        }
+        return std::nullopt;
+    };
+    auto directory = [&](uint32_t index) -> std::pair<uint32_t, uint32_t> {
+        if (index >= directoryCount) {
+            return {0, 0};
+        }
+        return {
+            ReadAt<uint32_t>(file, directories + index * 8).value_or(0),
+            ReadAt<uint32_t>(file, directories + index * 8 + 4).value_or(0)
+        };
+    };
+
+    ParsedImage image;
+    // The CodeView record names the PDB by GUID and age, which is what a build id is for PE.
+    auto [debugAddress, debugSize] = directory(Pe::DirectoryDebug);
+    if (auto debug = toFileOffset(debugAddress); debug && debugSize != 0) {
+        for (uint64_t entry = *debug; entry + Pe::DebugEntrySize <= *debug + debugSize; entry += Pe::DebugEntrySize) {
+            auto rawOffset = ReadAt<uint32_t>(file, entry + 24);
+            if (ReadAt<uint32_t>(file, entry + 12) == Pe::DebugCodeView && rawOffset &&
+                ReadAt<uint32_t>(file, *rawOffset) == 0x53445352 && // "RSDS"
+                uint64_t{*rawOffset} + 24 <= file.size()) {
+                image.BuildId = ToHex(file.subspan(*rawOffset + 4, 20));
+                break;
+            }
+        }
+    }
+    if (image.BuildId.empty() && timeStamp) {
+        image.BuildId = std::format("{:08x}{:08x}", *timeStamp, *imageSize);
+    }
+
+    auto [exportAddress, exportSize] = directory(Pe::DirectoryExport);
+    auto exports = toFileOffset(exportAddress);
+    if (!readSymbols || !exports || exportSize == 0) {
+        return image;
+    }
+    auto functionCount = ReadAt<uint32_t>(file, *exports + 20).value_or(0);
+    auto nameCount = ReadAt<uint32_t>(file, *exports + 24).value_or(0);
+    auto functions = toFileOffset(ReadAt<uint32_t>(file, *exports + 28).value_or(0));
+    auto names = toFileOffset(ReadAt<uint32_t>(file, *exports + 32).value_or(0));
+    auto ordinals = toFileOffset(ReadAt<uint32_t>(file, *exports + 36).value_or(0));
+    if (!functions || !names || !ordinals) {
+        return image;
+    }
+    for (uint32_t i = 0; i < nameCount; i++) {
+        auto nameAddress = ReadAt<uint32_t>(file, *names + i * 4ull);
+        auto ordinal = ReadAt<uint16_t>(file, *ordinals + i * 2ull);
+        if (!nameAddress || !ordinal || *ordinal >= functionCount) {
+            break;
+        }
+        auto address = ReadAt<uint32_t>(file, *functions + *ordinal * 4ull);
+        auto name = toFileOffset(*nameAddress);
+        // Forwarders point back into the export directory, at the name of the real export.
+        if (!address || !name || *address == 0 ||
+            (*address >= exportAddress && *address - exportAddress < exportSize)) {
+            continue;
+        }
+        std::string_view text = ReadString(file, *name);
+        if (!text.empty()) {
+            image.Symbols.push_back({*address, 0, std::string(text)});
+        }
+    }
+    return image;
+}
+
+// Files without a build id are keyed by path, size and modification time instead.
+static std::string GetFallbackKey(const std::filesystem::path &path) {
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    auto modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    auto text = std::format("{}|{}|{}", path.string(), size, modified);
+    return std::format("f{:016x}", SessionChecksum(std::as_bytes(std::span(text))));
+}
+
+std::vector<LoadedModule> EnumerateModules(uint32_t processId) {
+    std::vector<LoadedModule> modules;
+#ifdef _WIN32
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, processId);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return modules;
+    }
+    MODULEENTRY32W entry{};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Module32FirstW(snapshot, &entry); more; more = Module32NextW(snapshot, &entry)) {
+        std::filesystem::path path(entry.szExePath);
+        modules.push_back({
+            path.filename().string(), path, reinterpret_cast<uint64_t>(entry.modBaseAddr), entry.modBaseSize
+        });
+    }
+    CloseHandle(snapshot);
+#else
+    // start-end perms offset dev inode path, one line per mapping. An image is mapped in several
+    // pieces, its base is the piece at file offset 0.
+    std::ifstream maps(std::format("/proc/{}/maps", processId));
+    std::unordered_map<std::string, size_t> byPath;
+    std::string line;
+    while (std::getline(maps, line)) {
+        std::istringstream fields(line);
+        std::string range, perms, offsetText, device, inode, path;
+        fields >> range >> perms >> offsetText >> device >> inode;
+        std::getline(fields >> std::ws, path);
+        if (!path.starts_with('/')) {
+            continue;
+        }
+        if (path.ends_with(" (deleted)")) {
+            path.resize(path.size() - std::string_view(" (deleted)").size());
+        }
+        uint64_t start = 0;
+        uint64_t end = 0;
+        uint64_t offset = 0;
+        auto dash = range.find('-');
+        if (dash == std::string::npos) {
+            continue;
+        }
+        std::from_chars(range.data(), range.data() + dash, start, 16);
+        std::from_chars(range.data() + dash + 1, range.data() + range.size(), end, 16);
+        std::from_chars(offsetText.data(), offsetText.data() + offsetText.size(), offset, 16);
+
+        auto found = byPath.find(path);
+        if (found == byPath.end()) {
+            if (offset != 0) {
+                continue; // a data file mapped from the middle, not an image
+            }
+            byPath.emplace(path, modules.size());
+            std::filesystem::path filePath(path);
+            modules.push_back({filePath.filename().string(), filePath, start, end - start});
+        } else {
+            LoadedModule &module = modules[found->second];
+            module.Size = std::max(module.Size, end - module.Base);
+        }
+    }
+#endif
+    std::ranges::sort(modules, {}, &LoadedModule::Base);
+    return modules;
+}
+
+std::filesystem::path GetSymbolCacheDirectory() {
+    std::error_code error;
+    auto directory = std::filesystem::temp_directory_path(error) / "EasyReverse" / "symbols";
+    std::filesystem::create_directories(directory, error);
+    return directory;
+}
+
+std::shared_ptr<const ModuleSymbols> ModuleSymbols::Load(const std::filesystem::path &imagePath,
+                                                         const std::filesystem::path &cacheDirectory) {
+    auto file = MappedFile::Open(imagePath);
+    if (!file) {
+        return nullptr;
+    }
+    auto data = file->GetData();
+
+    // Finding the build id only touches the headers and notes, the symbol tables are not read
+    // unless the cache misses.
+    bool isElf = HasMagic(data, "\x7f" "ELF");
+    auto parse = [&](bool readSymbols) { return isElf ? ParseElf(data, readSymbols) : ParsePe(data, readSymbols); };
+    std::optional<ParsedImage> headers = parse(false);
+    if (!headers) {
+        return nullptr;
+    }
+    std::string buildId = headers->BuildId.empty() ? GetFallbackKey(imagePath) : headers->BuildId;
+
+    auto symbols = std::shared_ptr<ModuleSymbols>(new ModuleSymbols());
+    symbols->m_BuildId = buildId;
+    auto cachePath = cacheDirectory / std::format("{}-{}-{}.syms", isElf ? "elf" : "pe", buildId, SymbolCacheVersion);
+    // A corrupt cache is parsed again and overwritten.
+    if (auto cached = SessionFile::Open(cachePath); cached && cached->VerifyAll()) {
+        auto records = cached->Get<SymbolRecord>(SessionSectionKind::SymbolTable);
+        auto names = cached->Get<char>(SessionSectionKind::SymbolNames);
+        if (!names.empty() && names.back() == '\0') {
+            symbols->m_Cache = std::move(*cached);
+            symbols->m_Symbols = records;
+            symbols->m_Names = names;
+            return symbols;
+        }
+    }
+
+    std::optional<ParsedImage> image = parse(true);
+
+    // Sorted, one name per address. Where several share one, the sized one wins, then the one
+    // seen first, which puts .symtab names ahead of .dynsym aliases.
+    std::ranges::stable_sort(image->Symbols, [](const ParsedSymbol &a, const ParsedSymbol &b) {
+        return a.Offset != b.Offset ? a.Offset < b.Offset : a.Size > b.Size;
+    });
+    auto duplicates = std::ranges::unique(image->Symbols, {}, &ParsedSymbol::Offset);
+    image->Symbols.erase(duplicates.begin(), duplicates.end());
+
+    symbols->m_OwnedSymbols.reserve(image->Symbols.size());
+    for (const auto &symbol: image->Symbols) {
+        symbols->m_OwnedSymbols.push_back({
+            symbol.Offset, symbol.Size, static_cast<uint32_t>(symbols->m_OwnedNames.size())
+        });
+        symbols->m_OwnedNames.insert(symbols->m_OwnedNames.end(), symbol.Name.begin(), symbol.Name.end());
+        symbols->m_OwnedNames.push_back('\0');
+    }
+    symbols->m_OwnedNames.push_back('\0'); // never empty, so an empty image caches too
+    symbols->m_Symbols = symbols->m_OwnedSymbols;
+    symbols->m_Names = symbols->m_OwnedNames;
+
+    // Written aside and renamed, another attach loading the same image never sees half a file.
+    std::error_code error;
+    auto temporaryPath = cachePath;
+    temporaryPath += std::format(".{}", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    SessionWriter writer(temporaryPath);
+    writer.AddSection(SessionSectionKind::SymbolTable, {}, std::span<const SymbolRecord>(symbols->m_OwnedSymbols));
+    writer.AddSection(SessionSectionKind::SymbolNames, {}, std::span<const char>(symbols->m_OwnedNames));
+    if (writer.Finish()) {
+        std::filesystem::rename(temporaryPath, cachePath, error);
+    } else {
+        std::filesystem::remove(temporaryPath, error);
+    }
+    return symbols;
+}
+
+SymbolIndex::SymbolIndex(std::vector<Entry> entries) : m_Entries(std::move(entries)) {
+    std::ranges::sort(m_Entries, {}, [](const Entry &entry) { return entry.Module.Base; });
+}
+
+std::optional<ResolvedAddress> SymbolIndex::Resolve(uint64_t address) const {
+    auto it = std::ranges::upper_bound(m_Entries, address, {}, [](const Entry &entry) { return entry.Module.Base; });
+    if (it == m_Entries.begin()) {
+        return std::nullopt;
+    }
+    const Entry &entry = *--it;
+    uint64_t offset = address - entry.Module.Base;
+    if (offset >= entry.Module.Size) {
+        return std::nullopt;
+    }
+    ResolvedAddress resolved{&entry.Module, offset, {}, 0};
+    if (entry.Symbols) {
+        if (const SymbolRecord *symbol = entry.Symbols->Find(offset)) {
+            resolved.Symbol = entry.Symbols->GetName(*symbol);
+            resolved.SymbolOffset = offset - symbol->Offset;
+        }
+    }
+    return resolved;
+}
+
+std::string SymbolIndex::Format(uint64_t address) const {
+    auto resolved = Resolve(address);
+    if (!resolved) {
+        return {};
+    }
+    if (resolved->Symbol.empty()) {
+        return std::format("{}+0x{:X}", resolved->Module->Name, resolved->ModuleOffset);
+    }
+    if (resolved->SymbolOffset == 0) {
+        return std::string(resolved->Symbol);
+    }
+    return std::format("{}+0x{:X}", resolved->Symbol, resolved->SymbolOffset);
+}
+
+size_t SymbolIndex::GetSymbolCount() const {
+    size_t count = 0;
+    for (const auto &entry: m_Entries) {
+        count += entry.Symbols ? entry.Symbols->GetSymbols().size() : 0;
+    }
+    return count;
+}
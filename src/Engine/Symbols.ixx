@@ -0,0 +1,107 @@
+export module Engine.Symbols;
+
+import std;
+import Engine.Session;
+
+// Sorted by Offset, which is relative to the module base. Size is 0 where the image does not
+// say, PE exports for example, and the symbol then reaches up to the next one.
+export struct SymbolRecord {
+    uint64_t Offset;
+    uint32_t Size;
+    uint32_t NameOffset; // into the names blob, NUL terminated
+};
+
+export struct LoadedModule {
+    std::string Name;
+    std::filesystem::path Path;
+    uint64_t Base;
+    uint64_t Size;
+};
+
+// File backed images mapped into the process, sorted by base.
+export std::vector<LoadedModule> EnumerateModules(uint32_t processId);
+
+// Where parsed symbol tables are kept between runs.
+export std::filesystem::path GetSymbolCacheDirectory();
+
+// Symbols of one ELF or PE image: .symtab and .dynsym of an ELF, the export table of a PE.
+// Parsed tables are written to the cache directory as a session file named after the image's
+// build id (the GNU build id note, or the CodeView GUID and age), and later loads of the same
+// build map that file and use its records in place.
+export class ModuleSymbols {
+public:
+    // nullptr if the file is neither a 64-bit ELF nor a PE image.
+    static std::shared_ptr<const ModuleSymbols> Load(const std::filesystem::path &imagePath,
+                                                     const std::filesystem::path &cacheDirectory);
+
+    [[nodiscard]] std::span<const SymbolRecord> GetSymbols() const { return m_Symbols; }
+
+    [[nodiscard]] std::string_view GetName(const SymbolRecord &symbol) const {
+        if (symbol.NameOffset >= m_Names.size()) {
+            return {};
+        }
+        return {m_Names.data() + symbol.NameOffset};
+    }
+
+    // The symbol covering offset, nullptr if offset is before the first one or past the end of
+    // a symbol with a known size.
+    [[nodiscard]] const SymbolRecord *Find(uint64_t offset) const {
+        auto it = std::ranges::upper_bound(m_Symbols, offset, {}, &SymbolRecord::Offset);
+        if (it == m_Symbols.begin()) {
+            return nullptr;
+        }
+        --it;
+        if (it->Size != 0 && offset - it->Offset >= it->Size) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    [[nodiscard]] const std::string &GetBuildId() const { return m_BuildId; }
+
+    [[nodiscard]] bool IsFromCache() const { return m_Cache.has_value(); }
+
+private:
+    ModuleSymbols() = default;
+
+    std::string m_BuildId;
+    // Either owned, after parsing, or pointing into m_Cache.
+    std::vector<SymbolRecord> m_OwnedSymbols;
+    std::vector<char> m_OwnedNames;
+    std::optional<SessionFile> m_Cache;
+    std::span<const SymbolRecord> m_Symbols;
+    std::span<const char> m_Names;
+};
+
+export struct ResolvedAddress {
+    const LoadedModule *Module;
+    uint64_t ModuleOffset;
+    // Empty when the module has no symbol covering the address.
+    std::string_view Symbol;
+    uint64_t SymbolOffset;
+};
+
+// Modules of one process with their symbols, immutable once built. Lookups are a binary search
+// over the modules and one over the module's symbols.
+export class SymbolIndex {
+public:
+    struct Entry {
+        LoadedModule Module;
+        // nullptr while loading, or when the image could not be parsed.
+        std::shared_ptr<const ModuleSymbols> Symbols;
+    };
+
+    explicit SymbolIndex(std::vector<Entry> entries);
+
+    [[nodiscard]] std::optional<ResolvedAddress> Resolve(uint64_t address) const;
+
+    // "Player::health+0x10", "game.so+0x1A2B30" without a symbol, empty outside every module.
+    [[nodiscard]] std::string Format(uint64_t address) const;
+
+    [[nodiscard]] std::span<const Entry> GetModules() const { return m_Entries; }
+
+    [[nodiscard]] size_t GetSymbolCount() const;
+
+private:
+    std::vector<Entry> m_Entries;
+};
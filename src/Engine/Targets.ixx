@@ -0,0 +1,461 @@
+export module Engine.Targets;
+
+import std;
+import Engine.AddressExpression;
+import Engine.AgentMemory;
+import Engine.ProcessMemory;
+import Engine.Scanner;
+import Engine.Session;
+import Engine.Symbols;
+import WorkerPool;
+
+export struct WatchEntry {
+    WatchRecord Record; // the persisted part
+    // Set for watches on a pointer chain, Record.Address is then where it resolved last.
+    std::shared_ptr<const AddressExpression> Expression;
+    uint64_t CurrentValue = 0;
+    bool Readable = false;
+};
+
+// One attached process or opened dump with its own region map, scan results and watch list.
+// Work goes to a pair of queues on the shared pool: scans are Bulk, region refreshes and watch
+// polling are Interactive. Tasks keep the target alive, so it can be detached while they run.
+export class AttachedTarget : public std::enable_shared_from_this<AttachedTarget> {
+public:
+    AttachedTarget(WorkerPool &pool, uint32_t id, std::shared_ptr<MemorySource> source, std::string name)
+        : m_Pool(pool), m_Id(id), m_Source(std::move(source)), m_Name(std::move(name)),
+          m_InteractiveQueue(pool.AddQueue(WorkClass::Interactive)), m_BulkQueue(pool.AddQueue(WorkClass::Bulk)),
+          m_Resolver(std::make_shared<AddressResolver>(m_Source)) {
+    }
+
+    AttachedTarget(const AttachedTarget &) = delete;
+
+    AttachedTarget &operator=(const AttachedTarget &) = delete;
+
+    ~AttachedTarget() {
+        m_Pool.RemoveQueue(m_InteractiveQueue);
+        m_Pool.RemoveQueue(m_BulkQueue);
+    }
+
+    // Unique within its TargetSet, unlike the process id, which dumps do not have.
+    [[nodiscard]] uint32_t GetId() const { return m_Id; }
+
+    [[nodiscard]] const std::shared_ptr<MemorySource> &GetSource() const { return m_Source; }
+
+    [[nodiscard]] uint32_t GetProcessId() const { return m_Source->GetProcessId(); }
+
+    [[nodiscard]] const std::string &GetName() const { return m_Name; }
+
+    // Called once per frame: publishes finished scans and schedules the next watch poll.
+    // Pointers read for address expressions are shared until the next frame.
+    void Update(std::chrono::steady_clock::time_point now) {
+        m_Resolver->Refresh();
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan && m_ActiveScan->IsDone()) {
+            m_Results = m_ActiveScan->GetResults();
+            m_ResultType = m_ActiveScan->GetRequest().Type;
+            m_ActiveScan.reset();
+        }
+
+        if (!m_Watches.empty() && !m_PollPending && now - m_LastPoll >= m_PollInterval) {
+            m_PollPending = true;
+            m_LastPoll = now;
+            m_Pool.Submit(m_InteractiveQueue, [self = shared_from_this()] { self->PollWatches(); });
+        }
+    }
+
+    // Regions are captured by the first scan, later scans only revisit the results.
+    void RefreshRegions() {
+        m_Pool.Submit(m_InteractiveQueue, [self = shared_from_this()] {
+            auto regions = std::make_shared<const std::vector<MemoryRegion>>(self->m_Source->QueryRegions());
+            std::lock_guard lock(self->m_Mutex);
+            self->m_Regions = std::move(regions);
+        });
+    }
+
+    [[nodiscard]] std::shared_ptr<const std::vector<MemoryRegion>> GetRegions() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Regions;
+    }
+
+    // Lists the process' modules, then loads their symbols with one Bulk task per module. The
+    // index is published twice: with the modules alone right away, and complete once the last
+    // module is in. Dumps have no module list and get no index.
+    void LoadSymbols() {
+        if (GetProcessId() == 0) {
+            return;
+        }
+        m_Pool.Submit(m_InteractiveQueue, [self = shared_from_this()] {
+            auto load = std::make_shared<SymbolLoad>();
+            for (auto &module: EnumerateModules(self->GetProcessId())) {
+                load->Entries.push_back({std::move(module), nullptr});
+            }
+            load->Remaining = load->Entries.size();
+            self->PublishSymbols(std::make_shared<const SymbolIndex>(load->Entries));
+
+            auto cacheDirectory = GetSymbolCacheDirectory();
+            for (size_t i = 0; i < load->Entries.size(); i++) {
+                self->m_Pool.Submit(self->m_BulkQueue, [self, load, i, cacheDirectory] {
+                    auto symbols = ModuleSymbols::Load(load->Entries[i].Module.Path, cacheDirectory);
+                    std::lock_guard lock(load->Mutex);
+                    load->Entries[i].Symbols = std::move(symbols);
+                    if (--load->Remaining == 0) {
+                        self->PublishSymbols(std::make_shared<const SymbolIndex>(load->Entries));
+                    }
+                });
+            }
+        });
+    }
+
+    // nullptr until the module list is in.
+    [[nodiscard]] std::shared_ptr<const SymbolIndex> GetSymbols() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Symbols;
+    }
+
+    // Resolves address expressions against this target, see AddressResolver.
+    [[nodiscard]] const std::shared_ptr<AddressResolver> &GetResolver() const { return m_Resolver; }
+
+    // Runs a first scan over the regions if there are no results yet, a next scan otherwise.
+    // Returns false while another scan is running or if the request does not fit.
+    bool StartScan(const ScanRequest &request) {
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan) {
+            return false;
+        }
+        bool filter = request.Compare == ScanCompare::Filter;
+        if (!IsScalarType(request.Type) || filter != request.Filter.has_value() || (filter && request.Filter->GetType() != request.Type)) {
+            return false;
+        }
+        if (!m_Results) {
+            bool firstScan = request.Compare == ScanCompare::Exact || (filter && !request.Filter->UsesOld());
+            if (!firstScan || !m_Regions) {
+                return false;
+            }
+            m_ActiveScan = ScanJob::StartFirst(m_Pool, m_BulkQueue, m_Source, *m_Regions, request);
+        } else {
+            if (request.Type != m_ResultType) {
+                return false;
+            }
+            m_ActiveScan = ScanJob::StartNext(m_Pool, m_BulkQueue, m_Source, m_Results, request);
+        }
+        return true;
+    }
+
+    // Takes the place of a first scan, the results then narrow with StartScan.
+    bool StartGroupScan(GroupScanRequest request) {
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan || m_Results || !m_Regions) {
+            return false;
+        }
+        m_ActiveScan = ScanJob::StartGroup(m_Pool, m_BulkQueue, m_Source, *m_Regions, std::move(request));
+        return true;
+    }
+
+    // First scan for a string or byte array, the results cannot be narrowed further.
+    bool StartPatternScan(BytePattern pattern, ScanValueType type) {
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan || m_Results || !m_Regions) {
+            return false;
+        }
+        m_ActiveScan = ScanJob::StartPattern(m_Pool, m_BulkQueue, m_Source, *m_Regions, std::move(pattern), type);
+        return true;
+    }
+
+    void ResetScan() {
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan) {
+            m_ActiveScan->Cancel();
+            m_ActiveScan.reset();
+        }
+        m_Results.reset();
+    }
+
+    [[nodiscard]] std::shared_ptr<ScanJob> GetActiveScan() const {
+        std::lock_guard lock(m_Mutex);
+        return m_ActiveScan;
+    }
+
+    [[nodiscard]] std::shared_ptr<const ScanResults> GetResults() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Results;
+    }
+
+    [[nodiscard]] ScanValueType GetResultType() const {
+        std::lock_guard lock(m_Mutex);
+        return m_ResultType;
+    }
+
+    void AddWatch(uint64_t address, ScanValueType type, std::string_view label) {
+        std::lock_guard lock(m_Mutex);
+        WatchEntry &entry = m_Watches.emplace_back();
+        entry.Record.Address = address;
+        entry.Record.Type = static_cast<uint32_t>(type);
+        CopyToField(entry.Record.Label, label);
+    }
+
+    // A watch that resolves expression again on every poll.
+    void AddWatch(AddressExpression expression, ScanValueType type, std::string_view label) {
+        std::lock_guard lock(m_Mutex);
+        WatchEntry &entry = m_Watches.emplace_back();
+        entry.Record.Type = static_cast<uint32_t>(type);
+        CopyToField(entry.Record.Label, label);
+        entry.Expression = std::make_shared<const AddressExpression>(std::move(expression));
+    }
+
+    void RemoveWatch(size_t index) {
+        std::lock_guard lock(m_Mutex);
+        if (index < m_Watches.size()) {
+            m_Watches.erase(m_Watches.begin() + static_cast<ptrdiff_t>(index));
+        }
+    }
+
+    // Frozen entries get value written back on every poll.
+    void SetFrozen(size_t index, bool frozen, uint64_t value) {
+        std::lock_guard lock(m_Mutex);
+        if (index < m_Watches.size()) {
+            auto &record = m_Watches[index].Record;
+            record.Flags = frozen ? record.Flags | WatchFlags::Frozen : record.Flags & ~WatchFlags::Frozen;
+            record.FreezeValue = value;
+        }
+    }
+
+    [[nodiscard]] std::vector<WatchEntry> GetWatches() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Watches;
+    }
+
+    void SetPollInterval(std::chrono::milliseconds interval) {
+        std::lock_guard lock(m_Mutex);
+        m_PollInterval = interval;
+    }
+
+    void SaveSession(const std::filesystem::path &path, SessionMetadata metadata) const {
+        std::vector<WatchRecord> watches;
+        std::vector<WatchExpressionRecord> expressions;
+        std::shared_ptr<const ScanResults> results; {
+            std::lock_guard lock(m_Mutex);
+            for (const auto &entry: m_Watches) {
+                if (entry.Expression) {
+                    WatchExpressionRecord &record = expressions.emplace_back();
+                    record.WatchIndex = static_cast<uint32_t>(watches.size());
+                    CopyToField(record.Text, entry.Expression->GetText());
+                }
+                watches.push_back(entry.Record);
+            }
+            results = m_Results;
+            metadata.DataType = static_cast<uint32_t>(m_ResultType);
+        }
+        metadata.ProcessId = GetProcessId();
+
+        SessionWriter writer(path);
+        writer.AddSection(SessionSectionKind::Metadata, {}, std::span(&metadata, 1));
+        if (results) {
+            writer.AddSection(SessionSectionKind::ScanResults, {}, std::span(*results));
+        }
+        writer.AddSection(SessionSectionKind::WatchList, {}, std::span(watches));
+        if (!expressions.empty()) {
+            writer.AddSection(SessionSectionKind::WatchExpressions, {}, std::span(expressions));
+        }
+        writer.Finish();
+    }
+
+    // Replaces the results and watch list, the addresses are assumed to still be valid. A session
+    // with a corrupt section is rejected and leaves both as they were.
+    std::expected<void, std::string> LoadSession(const SessionFile &session) {
+        if (auto verified = session.VerifyAll(); !verified) {
+            return verified;
+        }
+        auto metadata = session.Get<SessionMetadata>(SessionSectionKind::Metadata);
+        auto results = session.Get<ScanResultRecord>(SessionSectionKind::ScanResults);
+        auto watches = session.Get<WatchRecord>(SessionSectionKind::WatchList);
+        auto expressions = session.Get<WatchExpressionRecord>(SessionSectionKind::WatchExpressions);
+
+        std::lock_guard lock(m_Mutex);
+        if (m_ActiveScan) {
+            m_ActiveScan->Cancel();
+            m_ActiveScan.reset();
+        }
+        if (session.Find(SessionSectionKind::ScanResults) != nullptr) {
+            m_Results = std::make_shared<const ScanResults>(results.begin(), results.end());
+            m_ResultType = metadata.empty() ? ScanValueType::Int32 : static_cast<ScanValueType>(metadata[0].DataType);
+        } else {
+            m_Results.reset();
+        }
+        m_Watches.clear();
+        for (const auto &record: watches) {
+            m_Watches.push_back({record, nullptr, 0, false});
+        }
+        for (const auto &record: expressions) {
+            auto expression = AddressExpression::Compile(FieldToString(record.Text));
+            if (record.WatchIndex < m_Watches.size() && expression) {
+                m_Watches[record.WatchIndex].Expression = std::make_shared<const AddressExpression>(std::move(*expression));
+            }
+        }
+        return {};
+    }
+
+    // Reads every watch once and rewrites the frozen ones. Update schedules this on the
+    // Interactive queue, calling it directly polls on the calling thread.
+    void PollWatches() {
+        std::vector<WatchRecord> records;
+        std::vector<std::shared_ptr<const AddressExpression>> expressions; {
+            std::lock_guard lock(m_Mutex);
+            for (const auto &entry: m_Watches) {
+                records.push_back(entry.Record);
+                expressions.push_back(entry.Expression);
+            }
+        }
+
+        // Every pointer chain in one pass, a batched read per level of dereference.
+        std::vector<const AddressExpression *> chains;
+        std::vector<size_t> chainWatches;
+        for (size_t i = 0; i < expressions.size(); i++) {
+            if (expressions[i]) {
+                chains.push_back(expressions[i].get());
+                chainWatches.push_back(i);
+            }
+        }
+        std::vector<std::optional<uint64_t>> resolved(chains.size());
+        m_Resolver->Resolve(chains, resolved);
+        std::vector<bool> unresolved(records.size());
+        for (size_t i = 0; i < chains.size(); i++) {
+            records[chainWatches[i]].Address = resolved[i].value_or(0);
+            unresolved[chainWatches[i]] = !resolved[i];
+        }
+
+        std::vector<uint64_t> values(records.size());
+        std::vector<BatchRead> reads;
+        for (size_t i = 0; i < records.size(); i++) {
+            const auto &record = records[i];
+            size_t size = unresolved[i] ? 0 : GetScanValueSize(static_cast<ScanValueType>(record.Type));
+            if ((record.Flags & WatchFlags::Frozen) && size != 0) {
+                m_Source->Write(record.Address, std::as_bytes(std::span(&record.FreezeValue, 1)).first(size));
+            }
+            reads.push_back({record.Address, std::as_writable_bytes(std::span(&values[i], 1)).first(size)});
+        }
+        m_Source->ReadBatch(reads);
+
+        // Entries may have been added or removed meanwhile, match them up by address, or by
+        // expression for the ones whose address moves.
+        std::lock_guard lock(m_Mutex);
+        for (auto &entry: m_Watches) {
+            for (size_t i = 0; i < records.size(); i++) {
+                bool same = entry.Expression ? entry.Expression == expressions[i]
+                                             : !expressions[i] && records[i].Address == entry.Record.Address;
+                if (same && records[i].Type == entry.Record.Type) {
+                    entry.Record.Address = records[i].Address;
+                    entry.Readable = !unresolved[i] && reads[i].Copied == reads[i].Buffer.size();
+                    entry.CurrentValue = entry.Readable ? values[i] : 0;
+                    break;
+                }
+            }
+        }
+        m_PollPending = false;
+    }
+
+private:
+    struct SymbolLoad {
+        std::mutex Mutex;
+        std::vector<SymbolIndex::Entry> Entries;
+        size_t Remaining = 0;
+    };
+
+    void PublishSymbols(std::shared_ptr<const SymbolIndex> symbols) {
+        m_Resolver->SetSymbols(symbols);
+        std::lock_guard lock(m_Mutex);
+        m_Symbols = std::move(symbols);
+    }
+
+    WorkerPool &m_Pool;
+    uint32_t m_Id;
+    std::shared_ptr<MemorySource> m_Source;
+    std::string m_Name;
+    WorkerPool::QueueId m_InteractiveQueue;
+    WorkerPool::QueueId m_BulkQueue;
+    std::shared_ptr<AddressResolver> m_Resolver;
+
+    mutable std::mutex m_Mutex;
+    std::shared_ptr<const std::vector<MemoryRegion>> m_Regions;
+    std::shared_ptr<const SymbolIndex> m_Symbols;
+    std::shared_ptr<ScanJob> m_ActiveScan;
+    std::shared_ptr<const ScanResults> m_Results;
+    ScanValueType m_ResultType = ScanValueType::Int32;
+    std::vector<WatchEntry> m_Watches;
+    std::chrono::milliseconds m_PollInterval{100};
+    std::chrono::steady_clock::time_point m_LastPoll{};
+    bool m_PollPending = false;
+};
+
+// Every attached process and opened dump, sharing the pool given at construction, which has to
+// outlive the set. Attaching may happen from any thread.
+export class TargetSet {
+public:
+    explicit TargetSet(WorkerPool &pool) : m_Pool(pool) {
+    }
+
+    // Returns the existing target if the process is attached already, nullptr if it cannot be
+    // opened. Goes through the in-process agent when the process runs one.
+    std::shared_ptr<AttachedTarget> Attach(uint32_t processId, std::string name) {
+        std::lock_guard lock(m_Mutex);
+        for (const auto &target: m_Targets) {
+            if (target->GetProcessId() == processId) {
+                return target;
+            }
+        }
+        std::shared_ptr<MemorySource> source = AgentMemory::Connect(processId);
+        if (!source) {
+            source = ProcessMemory::Open(processId);
+        }
+        if (!source) {
+            return nullptr;
+        }
+        return AddLocked(std::move(source), std::move(name));
+    }
+
+    // Any other source, such as a dump file.
+    std::shared_ptr<AttachedTarget> Add(std::shared_ptr<MemorySource> source, std::string name) {
+        std::lock_guard lock(m_Mutex);
+        return AddLocked(std::move(source), std::move(name));
+    }
+
+    [[nodiscard]] std::shared_ptr<AttachedTarget> Find(uint32_t id) const {
+        std::lock_guard lock(m_Mutex);
+        auto it = std::ranges::find(m_Targets, id, &AttachedTarget::GetId);
+        return it != m_Targets.end() ? *it : nullptr;
+    }
+
+    void Detach(uint32_t id) {
+        std::lock_guard lock(m_Mutex);
+        std::erase_if(m_Targets, [id](const auto &target) { return target->GetId() == id; });
+    }
+
+    [[nodiscard]] std::vector<std::shared_ptr<AttachedTarget>> GetTargets() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Targets;
+    }
+
+    // The resolver of the target reading through source, so panels resolving expressions share
+    // its pointer reads and module list. Sources focused without attaching get a resolver of
+    // their own, which knows no modules.
+    [[nodiscard]] std::shared_ptr<AddressResolver> GetResolver(const std::shared_ptr<MemorySource> &source) const {
+        std::lock_guard lock(m_Mutex);
+        auto it = std::ranges::find(m_Targets, source, &AttachedTarget::GetSource);
+        return it != m_Targets.end() ? (*it)->GetResolver() : std::make_shared<AddressResolver>(source);
+    }
+
+private:
+    std::shared_ptr<AttachedTarget> AddLocked(std::shared_ptr<MemorySource> source, std::string name) {
+        auto target = std::make_shared<AttachedTarget>(m_Pool, m_NextId++, std::move(source), std::move(name));
+        target->RefreshRegions();
+        target->LoadSymbols();
+        m_Targets.push_back(target);
+        return target;
+    }
+
+    WorkerPool &m_Pool;
+
+    mutable std::mutex m_Mutex;
+    std::vector<std::shared_ptr<AttachedTarget>> m_Targets;
+    uint32_t m_NextId = 1;
+};
@@ -0,0 +1,317 @@
+export module Engine.ValueRecorder;
+
+import std;
+export import Engine.ProcessMemory;
+import Engine.SpscRing;
+export import Engine.ValueTypes;
+
+export struct RecordedSample {
+    int64_t TimeNs;
+    double Value;
+};
+
+export struct SampleRange {
+    double Min = std::numeric_limits<double>::infinity();
+    double Max = -std::numeric_limits<double>::infinity();
+
+    [[nodiscard]] bool Empty() const { return Min > Max; }
+
+    void Add(double value) {
+        Min = std::min(Min, value);
+        Max = std::max(Max, value);
+    }
+
+    void Add(const SampleRange &other) {
+        Min = std::min(Min, other.Min);
+        Max = std::max(Max, other.Max);
+    }
+};
+
+// Bounded history of one series with a min/max pyramid for display. Level k keeps one range
+// per 2^k consecutive samples, so the range of any span of samples is combined from
+// O(log Capacity) entries, and drawing a window costs the same however much history it covers.
+export class ValueHistory {
+public:
+    static constexpr size_t Capacity = 1 << 16;
+    static constexpr size_t Levels = std::bit_width(Capacity); // level 0 is the raw samples
+
+    ValueHistory() {
+        for (size_t level = 1; level < Levels; level++) {
+            m_Pyramid[level].resize(Capacity >> level);
+        }
+    }
+
+    void Append(const RecordedSample &sample) {
+        size_t index = m_Count++;
+        m_Samples[index & (Capacity - 1)] = sample;
+
+        for (size_t level = 1; level < Levels; level++) {
+            SampleRange &range = m_Pyramid[level][(index >> level) & ((Capacity >> level) - 1)];
+            if ((index & ((size_t{1} << level) - 1)) == 0) {
+                range = SampleRange{};
+            }
+            range.Add(sample.Value);
+        }
+    }
+
+    [[nodiscard]] bool Empty() const { return m_Count == 0; }
+
+    [[nodiscard]] const RecordedSample &Latest() const { return m_Samples[(m_Count - 1) & (Capacity - 1)]; }
+
+    // Splits [startNs, endNs) into columns.size() equal slices and fills each with the range of
+    // the samples recorded during it. Slices without samples are left empty.
+    void Decimate(int64_t startNs, int64_t endNs, std::span<SampleRange> columns) const {
+        std::ranges::fill(columns, SampleRange{});
+        if (m_Count == 0 || columns.empty() || endNs <= startNs) {
+            return;
+        }
+
+        size_t first = LowerBound(startNs);
+        double sliceNs = static_cast<double>(endNs - startNs) / static_cast<double>(columns.size());
+        for (size_t column = 0; column < columns.size() && first < m_Count; column++) {
+            auto sliceEnd = startNs + static_cast<int64_t>(sliceNs * static_cast<double>(column + 1));
+            size_t last = LowerBound(sliceEnd, first);
+            if (last > first) {
+                columns[column] = Range(first, last);
+            }
+            first = last;
+        }
+    }
+
+private:
+    [[nodiscard]] size_t Oldest() const { return m_Count > Capacity ? m_Count - Capacity : 0; }
+
+    [[nodiscard]] int64_t TimeAt(size_t index) const { return m_Samples[index & (Capacity - 1)].TimeNs; }
+
+    // First retained sample index with TimeNs >= timeNs, timestamps are monotonic.
+    [[nodiscard]] size_t LowerBound(int64_t timeNs, size_t from = 0) const {
+        size_t low = std::max(from, Oldest());
+        size_t high = m_Count;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (TimeAt(middle) < timeNs) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // Range of samples [first, last), greedily taking the largest aligned block that fits.
+    [[nodiscard]] SampleRange Range(size_t first, size_t last) const {
+        SampleRange result;
+        while (first < last) {
+            size_t level = 0;
+            while (level + 1 < Levels) {
+                size_t size = size_t{1} << (level + 1);
+                if ((first & (size - 1)) != 0 || first + size > last) {
+                    break;
+                }
+                level++;
+            }
+
+            if (level == 0) {
+                result.Add(m_Samples[first & (Capacity - 1)].Value);
+            } else {
+                result.Add(m_Pyramid[level][(first >> level) & ((Capacity >> level) - 1)]);
+            }
+            first += size_t{1} << level;
+        }
+        return result;
+    }
+
+    std::vector<RecordedSample> m_Samples = std::vector<RecordedSample>(Capacity);
+    std::array<std::vector<SampleRange>, Levels> m_Pyramid;
+    size_t m_Count = 0;
+};
+
+// Samples values of the target on a background thread at a fixed rate. Every series gets its
+// own SPSC ring the sampler pushes into, Collect drains the rings into the bounded histories
+// on the UI thread. Samples are dropped, not blocked on, if the UI falls behind.
+export class ValueRecorder {
+public:
+    static constexpr size_t RingCapacity = 1 << 14;
+
+    struct Series {
+        uint32_t Id;
+        uint64_t Address;
+        ValueType Type;
+        ValueHistory History;
+        uint64_t DroppedSamples = 0;
+    };
+
+    explicit ValueRecorder(std::shared_ptr<TargetProcess> target)
+        : m_Target(std::move(target)), m_StartTime(std::chrono::steady_clock::now()) {
+        m_Channels.store(std::make_shared<const ChannelList>());
+        m_Thread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+    }
+
+    uint32_t AddSeries(uint64_t address, ValueType type) {
+        auto channel = std::make_shared<Channel>();
+        channel->Address = address;
+        channel->Type = type;
+
+        auto &series = m_Series.emplace_back(std::make_unique<SeriesState>());
+        series->Source = channel;
+        series->Data.Id = m_NextId++;
+        series->Data.Address = address;
+        series->Data.Type = type;
+
+        PublishChannels();
+        return series->Data.Id;
+    }
+
+    void RemoveSeries(uint32_t id) {
+        std::erase_if(m_Series, [id](const auto &series) { return series->Data.Id == id; });
+        PublishChannels();
+    }
+
+    void SetSampleRate(double hz) {
+        m_SamplePeriodNs.store(static_cast<int64_t>(1e9 / std::clamp(hz, 1.0, 20000.0)));
+    }
+
+    [[nodiscard]] double GetSampleRate() const {
+        return 1e9 / static_cast<double>(m_SamplePeriodNs.load());
+    }
+
+    // Nanoseconds since the recorder was created, the time base of every sample.
+    [[nodiscard]] int64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_StartTime).count();
+    }
+
+    // UI thread only.
+    void Collect() {
+        std::array<RecordedSample, 1024> batch;
+        for (auto &series: m_Series) {
+            size_t count;
+            while ((count = series->Source->Ring.PopBulk(batch)) > 0) {
+                for (size_t i = 0; i < count; i++) {
+                    series->Data.History.Append(batch[i]);
+                }
+            }
+            series->Data.DroppedSamples = series->Source->Dropped.load(std::memory_order_relaxed);
+        }
+    }
+
+    // UI thread only.
+    template<typename F>
+    void ForEachSeries(F &&func) const {
+        for (const auto &series: m_Series) {
+            func(std::as_const(series->Data));
+        }
+    }
+
+private:
+    struct Channel {
+        uint64_t Address = 0;
+        ValueType Type = ValueType::Int32;
+        SpscRing<RecordedSample, RingCapacity> Ring;
+        std::atomic<uint64_t> Dropped{0};
+    };
+
+    using ChannelList = std::vector<std::shared_ptr<Channel>>;
+
+    struct SeriesState {
+        std::shared_ptr<Channel> Source;
+        Series Data;
+    };
+
+    // The sampler thread picks up the new list on its next tick. A removed channel stays alive
+    // until the sampler let go of the old list, so it never pushes into a destroyed ring.
+    void PublishChannels() {
+        auto channels = std::make_shared<ChannelList>();
+        for (const auto &series: m_Series) {
+            channels->push_back(series->Source);
+        }
+        {
+            std::lock_guard lock(m_WakeMutex);
+            m_Channels.store(std::move(channels));
+        }
+        m_Wake.notify_all();
+    }
+
+    void Run(std::stop_token stopToken) {
+        // Every channel is read in one batch per tick, which the agent serves without a system
+        // call per value.
+        std::vector<std::array<std::byte, 8>> values;
+        std::vector<BatchRead> reads;
+
+        int64_t nextTick = Now();
+        while (!stopToken.stop_requested()) {
+            auto channels = m_Channels.load();
+            auto process = m_Target->Get();
+
+            // Nothing to sample: block until a series is added. Attaching is not announced, so
+            // without a process look again every IdlePollPeriod.
+            if (channels->empty() || !process) {
+                std::unique_lock lock(m_WakeMutex);
+                if (channels->empty()) {
+                    m_Wake.wait(lock, stopToken, [this] { return !m_Channels.load()->empty(); });
+                } else {
+                    m_Wake.wait_for(lock, stopToken, IdlePollPeriod, [] { return false; });
+                }
+                nextTick = Now();
+                continue;
+            }
+
+            values.resize(channels->size());
+            reads.clear();
+            for (size_t i = 0; i < channels->size(); i++) {
+                const auto &channel = (*channels)[i];
+                reads.push_back({channel->Address, std::span(values[i]).first(GetValueTypeSize(channel->Type))});
+            }
+
+            int64_t timeNs = Now();
+            process->ReadBatch(reads);
+            for (size_t i = 0; i < channels->size(); i++) {
+                const auto &channel = (*channels)[i];
+                if (reads[i].Copied != reads[i].Buffer.size()) {
+                    continue;
+                }
+                if (!channel->Ring.TryPush({timeNs, ValueToDouble(reads[i].Buffer, channel->Type)})) {
+                    channel->Dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            int64_t period = m_SamplePeriodNs.load();
+            nextTick += period;
+            int64_t now = Now();
+            if (nextTick < now) {
+                nextTick = now; // fell behind, do not try to catch up with a burst
+            }
+            WaitUntil(nextTick, stopToken);
+        }
+    }
+
+    // Sleeps overshoot by up to tens of microseconds, so the sleep ends a little early and only
+    // that last stretch is spent yielding.
+    void WaitUntil(int64_t timeNs, const std::stop_token &stopToken) const {
+        constexpr int64_t spinSlackNs = 200'000;
+        int64_t remaining = timeNs - Now();
+        if (remaining > spinSlackNs) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - spinSlackNs));
+        }
+        while (Now() < timeNs && !stopToken.stop_requested()) {
+            std::this_thread::yield();
+        }
+    }
+
+    static constexpr std::chrono::milliseconds IdlePollPeriod{100};
+
+    std::shared_ptr<TargetProcess> m_Target;
+    std::chrono::steady_clock::time_point m_StartTime;
+    std::atomic<int64_t> m_SamplePeriodNs{1'000'000};
+
+    std::atomic<std::shared_ptr<const ChannelList>> m_Channels;
+    // Wakes the idle sampler when channels are published.
+    std::mutex m_WakeMutex;
+    std::condition_variable_any m_Wake;
+
+    // UI thread only.
+    std::vector<std::unique_ptr<SeriesState>> m_Series;
+    uint32_t m_NextId = 1;
+
+    std::jthread m_Thread;
+};
@@ -0,0 +1,266 @@
+export module Engine.ValueTypes;
+
+import std;
+
+// Every type a value can be read, shown and scanned as. The first four keep the numbers that
+// sessions and the scan protocol store.
+export enum class ValueType : uint8_t {
+    Int32,
+    Int64,
+    Float,
+    Double,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    UInt32,
+    UInt64,
+    Pointer32,
+    Pointer64,
+    // Types below have no fixed size and no entry in the scalar tables.
+    String,
+    Bytes
+};
+
+export constexpr size_t ScalarValueTypeCount = static_cast<size_t>(ValueType::String);
+export constexpr size_t ValueTypeCount = static_cast<size_t>(ValueType::Bytes) + 1;
+
+export template<ValueType Type>
+struct ValueTypeTraits;
+
+// Integers parse in Base, or in hex with a 0x prefix.
+#define VALUE_TYPE_TRAITS(type, cppType, name, shortName, format, base) \
+    template<> struct ValueTypeTraits<ValueType::type> { \
+        using Type = cppType; \
+        static constexpr const char *Name = name; \
+        static constexpr const char *ShortName = shortName; \
+        static constexpr std::string_view Format = format; \
+        static constexpr int Base = base; \
+    };
+
+VALUE_TYPE_TRAITS(Int32, int32_t, "Int32", "i32", "{}", 10)
+VALUE_TYPE_TRAITS(Int64, int64_t, "Int64", "i64", "{}", 10)
+VALUE_TYPE_TRAITS(Float, float, "Float", "f32", "{}", 10)
+VALUE_TYPE_TRAITS(Double, double, "Double", "f64", "{}", 10)
+VALUE_TYPE_TRAITS(Int8, int8_t, "Int8", "i8", "{}", 10)
+VALUE_TYPE_TRAITS(UInt8, uint8_t, "UInt8", "u8", "{}", 10)
+VALUE_TYPE_TRAITS(Int16, int16_t, "Int16", "i16", "{}", 10)
+VALUE_TYPE_TRAITS(UInt16, uint16_t, "UInt16", "u16", "{}", 10)
+VALUE_TYPE_TRAITS(UInt32, uint32_t, "UInt32", "u32", "{}", 10)
+VALUE_TYPE_TRAITS(UInt64, uint64_t, "UInt64", "u64", "{}", 10)
+VALUE_TYPE_TRAITS(Pointer32, uint32_t, "Pointer32", "p32", "0x{:X}", 16)
+VALUE_TYPE_TRAITS(Pointer64, uint64_t, "Pointer64", "p64", "0x{:X}", 16)
+
+#undef VALUE_TYPE_TRAITS
+
+// A compile-time list of types, the scalar one below is what every per type table and kernel
+// is generated from.
+export template<ValueType... Types>
+struct ValueTypeList {
+};
+
+template<size_t... Indices>
+consteval auto MakeScalarList(std::index_sequence<Indices...>) {
+    return ValueTypeList<static_cast<ValueType>(Indices)...>{};
+}
+
+export using ScalarValueTypes = decltype(MakeScalarList(std::make_index_sequence<ScalarValueTypeCount>{}));
+
+// Calls visitor.template operator()<Type>() for the scalar type, so code inside the visitor is
+// compiled once per type and the type is switched on once per call rather than per value.
+// Does nothing for non-scalar types.
+export template<typename F>
+void VisitScalarType(ValueType type, F &&visitor) {
+    [&]<ValueType... Types>(ValueTypeList<Types...>) {
+        (void) ((type == Types && (visitor.template operator()<Types>(), true)) || ...);
+    }(ScalarValueTypes{});
+}
+
+// Values travel as their raw bytes zero extended to 64 bits, the layout ScanResultRecord stores.
+export template<typename T>
+uint64_t ToRaw(T value) {
+    uint64_t raw = 0;
+    std::memcpy(&raw, &value, sizeof(T));
+    return raw;
+}
+
+export template<typename T>
+T FromRaw(uint64_t raw) {
+    T value;
+    std::memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+template<ValueType Type>
+std::optional<uint64_t> ParseAs(std::string_view text) {
+    using Traits = ValueTypeTraits<Type>;
+    typename Traits::Type value{};
+    std::from_chars_result result;
+    if constexpr (std::is_floating_point_v<typename Traits::Type>) {
+        result = std::from_chars(text.data(), text.data() + text.size(), value);
+    } else {
+        int base = Traits::Base;
+        if (text.starts_with("0x") || text.starts_with("0X")) {
+            text.remove_prefix(2);
+            base = 16;
+        }
+        result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    }
+    if (result.ec != std::errc{} || result.ptr != text.data() + text.size() || text.empty()) {
+        return std::nullopt;
+    }
+    return ToRaw(value);
+}
+
+template<ValueType Type>
+std::string FormatAs(uint64_t raw) {
+    using Traits = ValueTypeTraits<Type>;
+    return std::format(Traits::Format, FromRaw<typename Traits::Type>(raw));
+}
+
+template<ValueType Type>
+double ConvertAs(const std::byte *data) {
+    typename ValueTypeTraits<Type>::Type value;
+    std::memcpy(&value, data, sizeof(value));
+    return static_cast<double>(value);
+}
+
+using ValueParser = std::optional<uint64_t> (*)(std::string_view text);
+using ValueFormatter = std::string (*)(uint64_t raw);
+using ValueConverter = double (*)(const std::byte *data);
+
+template<ValueType... Types>
+consteval auto MakeValueTypeTables(ValueTypeList<Types...>) {
+    struct Tables {
+        std::array<ValueParser, sizeof...(Types)> Parsers;
+        std::array<ValueFormatter, sizeof...(Types)> Formatters;
+        std::array<ValueConverter, sizeof...(Types)> Converters;
+        std::array<uint32_t, sizeof...(Types)> Sizes;
+    };
+    return Tables{
+        {&ParseAs<Types>...},
+        {&FormatAs<Types>...},
+        {&ConvertAs<Types>...},
+        {sizeof(typename ValueTypeTraits<Types>::Type)...}
+    };
+}
+
+constexpr auto ValueTypeTables = MakeValueTypeTables(ScalarValueTypes{});
+
+// Indexed by ValueType, for combos: the scalar types come first, so the first
+// ScalarValueTypeCount names are the ones scans take.
+export constexpr auto ValueTypeNames = []<ValueType... Types>(ValueTypeList<Types...>) {
+    return std::array<const char *, ValueTypeCount>{ValueTypeTraits<Types>::Name..., "String", "Bytes"};
+}(ScalarValueTypes{});
+
+// Short names as written in group scans and filters: "i32", "u8", "f64", "p64", "str", "bytes".
+constexpr auto ValueTypeShortNames = []<ValueType... Types>(ValueTypeList<Types...>) {
+    return std::array<std::string_view, ValueTypeCount>{ValueTypeTraits<Types>::ShortName..., "str", "bytes"};
+}(ScalarValueTypes{});
+
+export constexpr bool IsScalarType(ValueType type) {
+    return static_cast<size_t>(type) < ScalarValueTypeCount;
+}
+
+// 0 for strings and byte arrays.
+export constexpr size_t GetValueTypeSize(ValueType type) {
+    return IsScalarType(type) ? ValueTypeTables.Sizes[static_cast<size_t>(type)] : 0;
+}
+
+export constexpr const char *GetValueTypeName(ValueType type) {
+    return static_cast<size_t>(type) < ValueTypeCount ? ValueTypeNames[static_cast<size_t>(type)] : "?";
+}
+
+export std::optional<ValueType> FindValueType(std::string_view shortName) {
+    auto it = std::ranges::find(ValueTypeShortNames, shortName);
+    if (it == ValueTypeShortNames.end()) {
+        return std::nullopt;
+    }
+    return static_cast<ValueType>(it - ValueTypeShortNames.begin());
+}
+
+// Scalars only, nullopt for text that is not a whole value of the type.
+export std::optional<uint64_t> ParseValue(std::string_view text, ValueType type) {
+    if (!IsScalarType(type)) {
+        return std::nullopt;
+    }
+    return ValueTypeTables.Parsers[static_cast<size_t>(type)](text);
+}
+
+// Bytes of a value of any type: the text itself for strings, hex pairs like "DE AD BE EF" for
+// byte arrays.
+export std::optional<std::vector<std::byte>> ParseValueBytes(std::string_view text, ValueType type) {
+    std::vector<std::byte> bytes;
+    if (type == ValueType::String) {
+        bytes.resize(text.size());
+        std::memcpy(bytes.data(), text.data(), text.size());
+    } else if (type == ValueType::Bytes) {
+        for (size_t i = 0; i < text.size();) {
+            if (text[i] == ' ') {
+                i++;
+                continue;
+            }
+            uint8_t byte = 0;
+            if (i + 2 > text.size()) {
+                return std::nullopt;
+            }
+            auto [end, error] = std::from_chars(text.data() + i, text.data() + i + 2, byte, 16);
+            if (error != std::errc{} || end != text.data() + i + 2) {
+                return std::nullopt;
+            }
+            bytes.push_back(std::byte{byte});
+            i += 2;
+        }
+    } else {
+        auto raw = ParseValue(text, type);
+        if (!raw) {
+            return std::nullopt;
+        }
+        bytes.resize(GetValueTypeSize(type));
+        std::memcpy(bytes.data(), &*raw, bytes.size());
+    }
+    if (bytes.empty()) {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+// Strings end at the first NUL, unprintable characters show as '.'.
+export std::string FormatValueBytes(std::span<const std::byte> bytes, ValueType type) {
+    if (IsScalarType(type)) {
+        if (bytes.size() < GetValueTypeSize(type)) {
+            return {};
+        }
+        uint64_t raw = 0;
+        std::memcpy(&raw, bytes.data(), GetValueTypeSize(type));
+        return ValueTypeTables.Formatters[static_cast<size_t>(type)](raw);
+    }
+    std::string text;
+    for (std::byte byte: bytes) {
+        auto c = std::to_integer<uint8_t>(byte);
+        if (type == ValueType::Bytes) {
+            std::format_to(std::back_inserter(text), "{}{:02X}", text.empty() ? "" : " ", c);
+        } else if (c == 0) {
+            break;
+        } else {
+            text.push_back(c >= 0x20 && c < 0x7F ? static_cast<char>(c) : '.');
+        }
+    }
+    return text;
+}
+
+// Strings and byte arrays show the (up to) 8 bytes raw holds.
+export std::string FormatValue(uint64_t raw, ValueType type) {
+    if (IsScalarType(type)) {
+        return ValueTypeTables.Formatters[static_cast<size_t>(type)](raw);
+    }
+    return FormatValueBytes(std::as_bytes(std::span(&raw, 1)), type);
+}
+
+// For plotting, data must hold GetValueTypeSize bytes. 0 for non-scalar types.
+export double ValueToDouble(std::span<const std::byte> data, ValueType type) {
+    if (!IsScalarType(type) || data.size() < GetValueTypeSize(type)) {
+        return 0.0;
+    }
+    return ValueTypeTables.Converters[static_cast<size_t>(type)](data.data());
+}
@@ -0,0 +1,411 @@
+module;
+
+#ifndef _WIN32
+#include <errno.h>
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#endif
+
+module Engine.Watchpoints;
+
+#ifdef _WIN32
+import <windows.h>;
+#endif
+
+// DR7 holds a local and a global enable bit per slot in its low byte, and the access kind (R/W)
+// and length (LEN) of slot i in bits 16 + 4i to 19 + 4i.
+static uint64_t SlotEnableBits(size_t slot) {
+    return 0b11ull << (slot * 2);
+}
+
+static uint64_t SlotConditionBits(size_t slot) {
+    return 0b1111ull << (16 + slot * 4);
+}
+
+uint64_t EncodeDebugControlSlot(uint64_t control, size_t slot, const WatchpointSpec &spec) {
+    uint64_t access = spec.Kind == WatchpointKind::Write ? 0b01 : 0b11;
+    uint64_t length = spec.Length == 1 ? 0b00 : spec.Length == 2 ? 0b01 : spec.Length == 8 ? 0b10 : 0b11;
+    control = ReleaseDebugControlSlot(control, slot);
+    control |= 1ull << (slot * 2);
+    control |= (access | length << 2) << (16 + slot * 4);
+    return control;
+}
+
+uint64_t ReleaseDebugControlSlot(uint64_t control, size_t slot) {
+    return control & ~(SlotEnableBits(slot) | SlotConditionBits(slot));
+}
+
+uint64_t BuildDebugControl(std::span<const WatchpointSpec> specs) {
+    uint64_t control = 0;
+    for (size_t i = 0; i < specs.size(); i++) {
+        control = EncodeDebugControlSlot(control, i, specs[i]);
+    }
+    return control;
+}
+
+// DR6 has B0 to B3 in its low bits. The processor sets the bit of a slot whose condition was
+// met even when the slot is not enabled, so only the armed ones count.
+uint32_t DecodeDebugStatus(uint64_t status, size_t slotCount) {
+    uint32_t armed = static_cast<uint32_t>((1u << std::min(slotCount, MaxWatchpoints)) - 1);
+    return static_cast<uint32_t>(status) & armed;
+}
+
+std::expected<std::unique_ptr<WatchpointSession>, std::string> WatchpointSession::Start(
+    uint32_t processId, std::span<const WatchpointSpec> specs) {
+    if (specs.empty() || specs.size() > MaxWatchpoints) {
+        return std::unexpected(std::format("between 1 and {} watchpoints", MaxWatchpoints));
+    }
+    for (const auto &spec: specs) {
+        if (!std::has_single_bit(spec.Length) || spec.Length > 8 || spec.Address % spec.Length != 0) {
+            return std::unexpected(std::format("{:X} is not aligned to its length {}", spec.Address, spec.Length));
+        }
+    }
+#if defined(__x86_64__) || defined(_M_X64)
+    std::unique_ptr<WatchpointSession> session(new WatchpointSession(processId, specs));
+    std::promise<std::optional<std::string>> attached;
+    auto result = attached.get_future();
+    session->m_Thread = std::thread([self = session.get(), attached = std::move(attached)]() mutable {
+        self->Run(attached);
+    });
+    if (auto error = result.get()) {
+        session->m_Thread.join();
+        return std::unexpected(std::move(*error));
+    }
+    return session;
+#else
+    return std::unexpected("hardware watchpoints need x86-64");
+#endif
+}
+
+WatchpointSession::WatchpointSession(uint32_t processId, std::span<const WatchpointSpec> specs)
+    : m_ProcessId(processId), m_Specs(specs.begin(), specs.end()) {
+}
+
+WatchpointSession::~WatchpointSession() {
+    m_Stopping = true;
+#ifndef _WIN32
+    // The debugger thread blocks in waitpid, the signal wakes it. It swallows the SIGSTOP and
+    // detaches, so the target never sees it.
+    if (m_Running) {
+        kill(static_cast<pid_t>(m_ProcessId), SIGSTOP);
+    }
+#endif
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+#ifdef _WIN32
+
+static bool ArmThread(HANDLE thread, std::span<const WatchpointSpec> specs, uint64_t control) {
+    CONTEXT context{};
+    context.ContextFlags = CONTEXT_DEBUG_REGISTERS;
+    if (!GetThreadContext(thread, &context)) {
+        return false;
+    }
+    DWORD64 *addresses[] = {&context.Dr0, &context.Dr1, &context.Dr2, &context.Dr3};
+    for (size_t i = 0; i < specs.size(); i++) {
+        *addresses[i] = specs[i].Address;
+    }
+    context.Dr7 = control;
+    return SetThreadContext(thread, &context);
+}
+
+// Releases the first slotCount slots, whatever else the thread has in DR7 stays.
+static void DisarmThread(HANDLE thread, size_t slotCount) {
+    CONTEXT context{};
+    context.ContextFlags = CONTEXT_DEBUG_REGISTERS;
+    if (!GetThreadContext(thread, &context)) {
+        return;
+    }
+    for (size_t slot = 0; slot < slotCount; slot++) {
+        context.Dr7 = ReleaseDebugControlSlot(context.Dr7, slot);
+    }
+    SetThreadContext(thread, &context);
+}
+
+void WatchpointSession::Run(std::promise<std::optional<std::string>> &attached) {
+    if (!DebugActiveProcess(m_ProcessId)) {
+        m_Running = false;
+        attached.set_value(std::format("cannot debug {}, error {}", m_ProcessId, GetLastError()));
+        return;
+    }
+    DebugSetProcessKillOnExit(FALSE);
+
+    const uint64_t control = BuildDebugControl(m_Specs);
+    std::unordered_map<DWORD, HANDLE> threads;
+    bool reported = false;
+    bool exited = false;
+
+    // Every thread shows up as a create event first, the breakpoint the system injects into
+    // the process afterwards ends the attach.
+    DEBUG_EVENT event{};
+    while (!exited && !m_Stopping) {
+        if (!WaitForDebugEvent(&event, 50)) {
+            continue;
+        }
+        DWORD continueStatus = DBG_CONTINUE;
+        switch (event.dwDebugEventCode) {
+            case CREATE_PROCESS_DEBUG_EVENT:
+                if (event.u.CreateProcessInfo.hFile != nullptr) {
+                    CloseHandle(event.u.CreateProcessInfo.hFile);
+                }
+                threads[event.dwThreadId] = event.u.CreateProcessInfo.hThread;
+                ArmThread(event.u.CreateProcessInfo.hThread, m_Specs, control);
+                break;
+            case CREATE_THREAD_DEBUG_EVENT:
+                threads[event.dwThreadId] = event.u.CreateThread.hThread;
+                ArmThread(event.u.CreateThread.hThread, m_Specs, control);
+                break;
+            case EXIT_THREAD_DEBUG_EVENT:
+                threads.erase(event.dwThreadId);
+                break;
+            case EXIT_PROCESS_DEBUG_EVENT:
+                exited = true;
+                break;
+            case LOAD_DLL_DEBUG_EVENT:
+                if (event.u.LoadDll.hFile != nullptr) {
+                    CloseHandle(event.u.LoadDll.hFile);
+                }
+                break;
+            case EXCEPTION_DEBUG_EVENT: {
+                DWORD code = event.u.Exception.ExceptionRecord.ExceptionCode;
+                auto thread = threads.find(event.dwThreadId);
+                CONTEXT context{};
+                context.ContextFlags = CONTEXT_DEBUG_REGISTERS | CONTEXT_CONTROL;
+                if (code == EXCEPTION_BREAKPOINT && !reported) {
+                    reported = true;
+                    attached.set_value(std::nullopt);
+                } else if (code == EXCEPTION_SINGLE_STEP && thread != threads.end() &&
+                           GetThreadContext(thread->second, &context) &&
+                           DecodeDebugStatus(context.Dr6, m_Specs.size()) != 0) {
+                    uint32_t hitSlots = DecodeDebugStatus(context.Dr6, m_Specs.size());
+                    for (size_t i = 0; i < m_Specs.size(); i++) {
+                        if (hitSlots & (1u << i)) {
+                            m_Hits[i].Record(context.Rip);
+                        }
+                    }
+                    context.ContextFlags = CONTEXT_DEBUG_REGISTERS;
+                    context.Dr6 = 0;
+                    SetThreadContext(thread->second, &context);
+                } else {
+                    continueStatus = DBG_EXCEPTION_NOT_HANDLED;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        ContinueDebugEvent(event.dwProcessId, event.dwThreadId, continueStatus);
+    }
+
+    if (!exited) {
+        for (const auto &[id, thread]: threads) {
+            SuspendThread(thread);
+            DisarmThread(thread, m_Specs.size());
+            ResumeThread(thread);
+        }
+        DebugActiveProcessStop(m_ProcessId);
+    }
+    m_Running = false;
+    if (!reported) {
+        attached.set_value(std::format("process {} exited", m_ProcessId));
+    }
+}
+
+#else
+
+static size_t DebugRegisterOffset(size_t index) {
+    return offsetof(struct user, u_debugreg) + index * sizeof(unsigned long);
+}
+
+static bool PokeDebugRegister(pid_t thread, size_t index, uint64_t value) {
+    auto offset = DebugRegisterOffset(index);
+    return ptrace(PTRACE_POKEUSER, thread, reinterpret_cast<void *>(offset), reinterpret_cast<void *>(value)) == 0;
+}
+
+static uint64_t PeekUser(pid_t thread, size_t offset) {
+    return static_cast<uint64_t>(ptrace(PTRACE_PEEKUSER, thread, reinterpret_cast<void *>(offset), nullptr));
+}
+
+static bool ArmThread(pid_t thread, std::span<const WatchpointSpec> specs, uint64_t control) {
+    for (size_t i = 0; i < specs.size(); i++) {
+        if (!PokeDebugRegister(thread, i, specs[i].Address)) {
+            return false;
+        }
+    }
+    return PokeDebugRegister(thread, 7, control);
+}
+
+// Releases the first slotCount slots, whatever else the thread has in DR7 stays.
+static void DisarmThread(pid_t thread, size_t slotCount) {
+    uint64_t control = PeekUser(thread, DebugRegisterOffset(7));
+    for (size_t slot = 0; slot < slotCount; slot++) {
+        control = ReleaseDebugControlSlot(control, slot);
+    }
+    PokeDebugRegister(thread, 7, control);
+}
+
+// Next stop or exit of one of threads. Only those are reaped: other children of the UI and the
+// threads other sessions trace are left to whoever waits for them. Peeking at any child without
+// reaping it is the only way to block on a set of them, so while someone else's child sits
+// unreaped, this polls the traced threads every millisecond instead.
+static pid_t WaitForThreads(const std::unordered_set<pid_t> &threads, int &status) {
+    while (true) {
+        siginfo_t info{};
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOWAIT | __WALL) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (threads.contains(info.si_pid)) {
+            pid_t thread = waitpid(info.si_pid, &status, __WALL);
+            if (thread >= 0 || errno != EINTR) {
+                return thread;
+            }
+            continue;
+        }
+        for (pid_t thread: threads) {
+            if (waitpid(thread, &status, WNOHANG | __WALL) == thread) {
+                return thread;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static std::vector<pid_t> ListThreads(uint32_t processId) {
+    std::vector<pid_t> threads;
+    std::error_code error;
+    for (const auto &entry: std::filesystem::directory_iterator(std::format("/proc/{}/task", processId), error)) {
+        std::string name = entry.path().filename().string();
+        pid_t thread = 0;
+        if (std::from_chars(name.data(), name.data() + name.size(), thread).ec == std::errc{}) {
+            threads.push_back(thread);
+        }
+    }
+    return threads;
+}
+
+// Every thread is seized and interrupted, and armed at its first stop. Threads started later
+// are traced through PTRACE_O_TRACECLONE and armed the same way. Anything else that stops a
+// thread is passed straight on, which also means the target cannot be job-control stopped
+// while watched.
+void WatchpointSession::Run(std::promise<std::optional<std::string>> &attached) {
+    const uint64_t control = BuildDebugControl(m_Specs);
+
+    std::unordered_set<pid_t> threads;
+    for (bool found = true; found;) {
+        found = false;
+        for (pid_t thread: ListThreads(m_ProcessId)) {
+            if (!threads.contains(thread) && ptrace(PTRACE_SEIZE, thread, nullptr, PTRACE_O_TRACECLONE) == 0) {
+                ptrace(PTRACE_INTERRUPT, thread, nullptr, nullptr);
+                threads.insert(thread);
+                found = true;
+            }
+        }
+    }
+    if (threads.empty()) {
+        m_Running = false;
+        attached.set_value(std::format("cannot trace {}: {} (see /proc/sys/kernel/yama/ptrace_scope)",
+                                       m_ProcessId, strerror(errno)));
+        return;
+    }
+
+    std::unordered_set<pid_t> armed;
+    std::optional<std::string> error;
+    bool reported = false;
+    auto reportOnceArmed = [&] {
+        if (!reported && armed.size() == threads.size()) {
+            reported = true;
+            m_Running = !error;
+            attached.set_value(error);
+        }
+    };
+    while (!threads.empty()) {
+        int status = 0;
+        pid_t thread = WaitForThreads(threads, status);
+        if (thread < 0) {
+            break;
+        }
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            threads.erase(thread);
+            armed.erase(thread);
+            if (!threads.empty()) {
+                reportOnceArmed();
+            }
+            continue;
+        }
+        if (!WIFSTOPPED(status)) {
+            continue;
+        }
+
+        threads.insert(thread);
+        if (!armed.contains(thread)) {
+            armed.insert(thread);
+            if (!ArmThread(thread, m_Specs, control) && !error) {
+                error = std::format("cannot set the debug registers: {}", strerror(errno));
+            }
+            reportOnceArmed();
+        }
+
+        int signal = WSTOPSIG(status);
+        bool eventStop = (status >> 16) != 0; // clone, interrupt and new thread stops
+        int deliver = eventStop ? 0 : signal;
+        // The new thread is only waited for once it is known, its first stop may come before this.
+        unsigned long clone = 0;
+        if ((status >> 16) == PTRACE_EVENT_CLONE && ptrace(PTRACE_GETEVENTMSG, thread, nullptr, &clone) == 0) {
+            threads.insert(static_cast<pid_t>(clone));
+        }
+        if (!eventStop && signal == SIGTRAP) {
+            uint32_t hitSlots = DecodeDebugStatus(PeekUser(thread, DebugRegisterOffset(6)), m_Specs.size());
+            if (hitSlots != 0) {
+                uint64_t instruction = PeekUser(thread, offsetof(struct user, regs) +
+                                                       offsetof(struct user_regs_struct, rip));
+                for (size_t i = 0; i < m_Specs.size(); i++) {
+                    if (hitSlots & (1u << i)) {
+                        m_Hits[i].Record(instruction);
+                    }
+                }
+                PokeDebugRegister(thread, 6, 0);
+                deliver = 0;
+            }
+        }
+
+        // Detach at the SIGSTOP the destructor sends, or at once if arming failed.
+        bool wake = !eventStop && signal == SIGSTOP && m_Stopping;
+        if (wake || error) {
+            for (pid_t other: threads) {
+                int otherDeliver = 0;
+                if (other != thread) {
+                    ptrace(PTRACE_INTERRUPT, other, nullptr, nullptr);
+                    int otherStatus = 0;
+                    if (waitpid(other, &otherStatus, __WALL) != other || !WIFSTOPPED(otherStatus)) {
+                        continue;
+                    }
+                    int otherSignal = WSTOPSIG(otherStatus);
+                    if ((otherStatus >> 16) == 0 && otherSignal != SIGTRAP && otherSignal != SIGSTOP) {
+                        otherDeliver = otherSignal;
+                    }
+                }
+                DisarmThread(other, m_Specs.size());
+                ptrace(PTRACE_DETACH, other, nullptr, reinterpret_cast<void *>(static_cast<intptr_t>(
+                           other == thread && !wake ? deliver : otherDeliver)));
+            }
+            break;
+        }
+        ptrace(PTRACE_CONT, thread, nullptr, reinterpret_cast<void *>(static_cast<intptr_t>(deliver)));
+    }
+
+    m_Running = false;
+    if (!reported) {
+        attached.set_value(error ? error : std::format("process {} exited", m_ProcessId));
+    }
+}
+
+#endif
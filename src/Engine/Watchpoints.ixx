@@ -0,0 +1,135 @@
+export module Engine.Watchpoints;
+
+import std;
+
+// Hardware watchpoints through the x86 debug registers: up to four addresses, each trapping
+// every instruction that writes (or reads or writes) it, in every thread of the target.
+
+export enum class WatchpointKind : uint8_t {
+    Write,
+    Access, // read or write
+};
+
+export struct WatchpointSpec {
+    uint64_t Address = 0;
+    uint8_t Length = 4; // 1, 2, 4 or 8, Address aligned to it
+    WatchpointKind Kind = WatchpointKind::Write;
+};
+
+export constexpr size_t MaxWatchpoints = 4;
+
+// DR7 with the local enable, access kind and length of slot set for spec, replacing whatever
+// the slot held. Slot is the debug register (DR0 to DR3) that holds spec's address.
+export uint64_t EncodeDebugControlSlot(uint64_t control, size_t slot, const WatchpointSpec &spec);
+
+// DR7 with every bit of slot cleared, the other slots untouched.
+export uint64_t ReleaseDebugControlSlot(uint64_t control, size_t slot);
+
+// DR7 arming specs in order, spec i in slot i.
+export uint64_t BuildDebugControl(std::span<const WatchpointSpec> specs);
+
+// Bit i set for each of the first slotCount slots DR6 reports as hit.
+export uint32_t DecodeDebugStatus(uint64_t status, size_t slotCount);
+
+export struct HitCount {
+    uint64_t InstructionAddress;
+    uint64_t Count;
+};
+
+// Instruction address to hit count, written by the debugger thread and read by the UI without
+// locks. Open addressing with linear probing, entries are never removed, addresses arriving
+// once the table is full only count as dropped.
+export class HitCounterTable {
+public:
+    static constexpr size_t Capacity = 4096;
+
+    void Record(uint64_t address) {
+        m_Total.fetch_add(1, std::memory_order_relaxed);
+        size_t start = static_cast<size_t>(address * 0x9E3779B97F4A7C15ull >> 52);
+        for (size_t probe = 0; probe < Capacity; probe++) {
+            Entry &entry = m_Entries[(start + probe) & (Capacity - 1)];
+            uint64_t key = entry.Address.load(std::memory_order_acquire);
+            if (key == 0) {
+                // Count before publishing the key, so a reader never sees an entry at 0.
+                entry.Count.store(1, std::memory_order_relaxed);
+                entry.Address.store(address, std::memory_order_release);
+                return;
+            }
+            if (key == address) {
+                entry.Count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Highest counts first.
+    [[nodiscard]] std::vector<HitCount> Snapshot() const {
+        std::vector<HitCount> hits;
+        for (const auto &entry: m_Entries) {
+            uint64_t address = entry.Address.load(std::memory_order_acquire);
+            if (address != 0) {
+                hits.push_back({address, entry.Count.load(std::memory_order_relaxed)});
+            }
+        }
+        std::ranges::sort(hits, std::greater{}, &HitCount::Count);
+        return hits;
+    }
+
+    [[nodiscard]] uint64_t GetTotal() const { return m_Total.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] uint64_t GetDropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> Address{0};
+        std::atomic<uint64_t> Count{0};
+    };
+
+    std::array<Entry, Capacity> m_Entries;
+    std::atomic<uint64_t> m_Total{0};
+    std::atomic<uint64_t> m_Dropped{0};
+};
+
+// Debugs the target from a thread of its own for as long as it exists, only handling the
+// watchpoint traps and passing every other event straight on. A hit stops the hitting thread
+// for one trap round trip: the debugger reads the instruction pointer, bumps a counter and
+// resumes it.
+//
+// Data watchpoints trap after the instruction completed, so the recorded address is that of
+// the instruction following the access.
+export class WatchpointSession {
+public:
+    // Attaches and arms specs in every thread, blocks until that is done or failed.
+    static std::expected<std::unique_ptr<WatchpointSession>, std::string> Start(
+        uint32_t processId, std::span<const WatchpointSpec> specs);
+
+    WatchpointSession(const WatchpointSession &) = delete;
+
+    WatchpointSession &operator=(const WatchpointSession &) = delete;
+
+    // Disarms and detaches, the target keeps running.
+    ~WatchpointSession();
+
+    [[nodiscard]] uint32_t GetProcessId() const { return m_ProcessId; }
+
+    [[nodiscard]] std::span<const WatchpointSpec> GetSpecs() const { return m_Specs; }
+
+    [[nodiscard]] const HitCounterTable &GetHits(size_t slot) const { return m_Hits[slot]; }
+
+    // False once the target exited or the debugger gave up.
+    [[nodiscard]] bool IsRunning() const { return m_Running; }
+
+private:
+    WatchpointSession(uint32_t processId, std::span<const WatchpointSpec> specs);
+
+    // Debugger thread body, reports the attach outcome through attached.
+    void Run(std::promise<std::optional<std::string>> &attached);
+
+    uint32_t m_ProcessId;
+    std::vector<WatchpointSpec> m_Specs;
+    std::array<HitCounterTable, MaxWatchpoints> m_Hits;
+    std::atomic<bool> m_Running = true;
+    std::atomic<bool> m_Stopping = false;
+    std::thread m_Thread;
+};
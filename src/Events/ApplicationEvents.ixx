@@ -65,3 +65,27 @@ public:
     EVENT_CLASS_CATEGORY(EventCategory::EventCategoryApplication)
     EVENT_CLASS_TYPE(AppRender)
 };
+
+// Posted from worker threads to tell layers that background work finished, e.g. a scan.
+// Code identifies what happened, Payload carries a small result such as a match count.
+export class AppNotificationEvent : public Event {
+public:
+    AppNotificationEvent(uint32_t code, uint64_t payload = 0)
+        : m_Code(code), m_Payload(payload) {}
+
+    [[nodiscard]] uint32_t GetCode() const { return m_Code; }
+    [[nodiscard]] uint64_t GetPayload() const { return m_Payload; }
+
+    [[nodiscard]] virtual std::string ToString() const override {
+        std::ostringstream oss;
+        oss << "AppNotificationEvent: " << m_Code << ", " << m_Payload;
+        return oss.str();
+    }
+
+    EVENT_CLASS_CATEGORY(EventCategory::EventCategoryApplication)
+    EVENT_CLASS_TYPE(AppNotification)
+
+private:
+    uint32_t m_Code;
+    uint64_t m_Payload;
+};
@@ -0,0 +1,262 @@
+export module Events.Compact;
+
+export import Event.AllEvents;
+import std.compat;
+
+// Plain, trivially copyable event payloads. Together with CompactEvent they are an
+// alternative to the polymorphic Event classes for hot paths: no vtable, no allocation
+// when formatting, and dispatch through a table indexed by the variant alternative.
+export namespace EventData {
+    struct WindowClose {
+    };
+
+    struct WindowResize {
+        uint32_t Width;
+        uint32_t Height;
+    };
+
+    struct AppNotification {
+        uint32_t Code;
+        uint64_t Payload;
+    };
+
+    struct KeyPressed {
+        Key::KeyCode KeyCode;
+        bool IsRepeat;
+    };
+
+    struct KeyReleased {
+        Key::KeyCode KeyCode;
+    };
+
+    struct KeyTyped {
+        Key::KeyCode KeyCode;
+    };
+
+    struct MouseButtonPressed {
+        Mouse::MouseCode Button;
+    };
+
+    struct MouseButtonReleased {
+        Mouse::MouseCode Button;
+    };
+
+    struct MouseMoved {
+        float X;
+        float Y;
+    };
+
+    struct MouseScrolled {
+        float XOffset;
+        float YOffset;
+    };
+}
+
+export using CompactEvent = std::variant<
+    EventData::WindowClose,
+    EventData::WindowResize,
+    EventData::AppNotification,
+    EventData::KeyPressed,
+    EventData::KeyReleased,
+    EventData::KeyTyped,
+    EventData::MouseButtonPressed,
+    EventData::MouseButtonReleased,
+    EventData::MouseMoved,
+    EventData::MouseScrolled
+>;
+
+constexpr size_t CompactEventAlternatives = std::variant_size_v<CompactEvent>;
+
+template<typename T>
+struct CompactEventTraits;
+
+#define COMPACT_EVENT_TRAITS(name, category) \
+    template<> struct CompactEventTraits<EventData::name> { \
+        static constexpr EventType Type = EventType::name; \
+        static constexpr uint8_t CategoryFlags = static_cast<uint8_t>(category); \
+        static constexpr const char *Name = #name; \
+    };
+
+COMPACT_EVENT_TRAITS(WindowClose, EventCategory::EventCategoryApplication)
+COMPACT_EVENT_TRAITS(WindowResize, EventCategory::EventCategoryApplication)
+COMPACT_EVENT_TRAITS(AppNotification, EventCategory::EventCategoryApplication)
+COMPACT_EVENT_TRAITS(KeyPressed, EventCategory::EventCategoryInput | EventCategory::EventCategoryKeyboard)
+COMPACT_EVENT_TRAITS(KeyReleased, EventCategory::EventCategoryInput | EventCategory::EventCategoryKeyboard)
+COMPACT_EVENT_TRAITS(KeyTyped, EventCategory::EventCategoryInput | EventCategory::EventCategoryKeyboard)
+COMPACT_EVENT_TRAITS(MouseButtonPressed, EventCategory::EventCategoryInput | EventCategory::EventCategoryMouse |
+                     EventCategory::EventCategoryMouseButton)
+COMPACT_EVENT_TRAITS(MouseButtonReleased, EventCategory::EventCategoryInput | EventCategory::EventCategoryMouse |
+                     EventCategory::EventCategoryMouseButton)
+COMPACT_EVENT_TRAITS(MouseMoved, EventCategory::EventCategoryInput | EventCategory::EventCategoryMouse)
+COMPACT_EVENT_TRAITS(MouseScrolled, EventCategory::EventCategoryInput | EventCategory::EventCategoryMouse)
+
+#undef COMPACT_EVENT_TRAITS
+
+template<template<typename> typename Getter, size_t... Indices>
+consteval auto MakeTraitTable(std::index_sequence<Indices...>) {
+    return std::array{Getter<std::variant_alternative_t<Indices, CompactEvent> >::Value...};
+}
+
+template<typename T>
+struct TypeGetter {
+    static constexpr EventType Value = CompactEventTraits<T>::Type;
+};
+
+template<typename T>
+struct CategoryGetter {
+    static constexpr uint8_t Value = CompactEventTraits<T>::CategoryFlags;
+};
+
+template<typename T>
+struct NameGetter {
+    static constexpr const char *Value = CompactEventTraits<T>::Name;
+};
+
+constexpr auto CompactEventTypes = MakeTraitTable<TypeGetter>(std::make_index_sequence<CompactEventAlternatives>{});
+constexpr auto CompactEventCategoryFlags = MakeTraitTable<CategoryGetter>(std::make_index_sequence<CompactEventAlternatives>{});
+constexpr auto CompactEventNames = MakeTraitTable<NameGetter>(std::make_index_sequence<CompactEventAlternatives>{});
+
+export constexpr EventType GetEventType(const CompactEvent &event) {
+    return CompactEventTypes[event.index()];
+}
+
+export constexpr const char *GetEventName(const CompactEvent &event) {
+    return CompactEventNames[event.index()];
+}
+
+export constexpr bool IsInCategory(const CompactEvent &event, EventCategory category) {
+    return CompactEventCategoryFlags[event.index()] & static_cast<uint8_t>(category);
+}
+
+// Calls the handler overload matching the event through a table built at compile time,
+// one indirect call per event. Alternatives the handler has no overload for return false.
+//
+//     struct MyHandler {
+//         bool operator()(const EventData::KeyPressed &e) { ... }
+//     };
+//     StaticEventDispatcher<MyHandler>::Dispatch(handler, event);
+export template<typename Handler>
+class StaticEventDispatcher {
+public:
+    static bool Dispatch(Handler &handler, const CompactEvent &event) {
+        return s_Table[event.index()](handler, event);
+    }
+
+private:
+    using Entry = bool(*)(Handler &, const CompactEvent &);
+
+    template<size_t Index>
+    static bool Invoke(Handler &handler, const CompactEvent &event) {
+        using T = std::variant_alternative_t<Index, CompactEvent>;
+        if constexpr (std::invocable<Handler &, const T &>) {
+            return static_cast<bool>(handler(*std::get_if<Index>(&event)));
+        } else {
+            return false;
+        }
+    }
+
+    template<size_t... Indices>
+    static consteval std::array<Entry, sizeof...(Indices)> MakeTable(std::index_sequence<Indices...>) {
+        return {&Invoke<Indices>...};
+    }
+
+    static constexpr std::array<Entry, CompactEventAlternatives> s_Table =
+            MakeTable(std::make_index_sequence<CompactEventAlternatives>{});
+};
+
+// Formats the event like Event::ToString, without allocating.
+export template<std::output_iterator<char> Out>
+Out FormatTo(Out out, const CompactEvent &event) {
+    return std::visit([out]<typename T>(const T &e) {
+        using namespace EventData;
+        if constexpr (std::same_as<T, WindowResize>) {
+            return std::format_to(out, "WindowResizeEvent: {}, {}", e.Width, e.Height);
+        } else if constexpr (std::same_as<T, AppNotification>) {
+            return std::format_to(out, "AppNotificationEvent: {}, {}", e.Code, e.Payload);
+        } else if constexpr (std::same_as<T, KeyPressed>) {
+            return std::format_to(out, "KeyPressedEvent: {} ({})", e.KeyCode, e.IsRepeat ? "repeat" : "not repeat");
+        } else if constexpr (std::same_as<T, KeyReleased>) {
+            return std::format_to(out, "KeyReleasedEvent: {}", e.KeyCode);
+        } else if constexpr (std::same_as<T, KeyTyped>) {
+            return std::format_to(out, "KeyTypedEvent: {}", static_cast<char>(e.KeyCode));
+        } else if constexpr (std::same_as<T, MouseButtonPressed>) {
+            return std::format_to(out, "MouseButtonPressedEvent: {}", e.Button);
+        } else if constexpr (std::same_as<T, MouseButtonReleased>) {
+            return std::format_to(out, "MouseButtonReleasedEvent: {}", e.Button);
+        } else if constexpr (std::same_as<T, MouseMoved>) {
+            return std::format_to(out, "MouseMovedEvent: {}, {}", e.X, e.Y);
+        } else if constexpr (std::same_as<T, MouseScrolled>) {
+            return std::format_to(out, "MouseScrolledEvent: {}, {}", e.XOffset, e.YOffset);
+        } else {
+            return std::format_to(out, "{}Event", CompactEventTraits<T>::Name);
+        }
+    }, event);
+}
+
+// Formats into a caller provided buffer, truncating if it is too small.
+export std::string_view FormatTo(std::span<char> buffer, const CompactEvent &event) {
+    struct TruncatingIterator {
+        using difference_type = std::ptrdiff_t;
+
+        std::span<char> *Buffer;
+        size_t *Written;
+
+        TruncatingIterator &operator*() { return *this; }
+        TruncatingIterator &operator++() { return *this; }
+        TruncatingIterator operator++(int) { return *this; }
+
+        TruncatingIterator &operator=(char c) {
+            if (*Written < Buffer->size()) {
+                (*Buffer)[*Written] = c;
+            }
+            ++*Written;
+            return *this;
+        }
+    };
+
+    size_t written = 0;
+    FormatTo(TruncatingIterator{&buffer, &written}, event);
+    return {buffer.data(), std::min(written, buffer.size())};
+}
+
+// Converts from the polymorphic representation, e.g. for events coming out of the EventQueue.
+export CompactEvent ToCompactEvent(const Event &event) {
+    switch (event.GetEventType()) {
+        case EventType::WindowResize: {
+            const auto &e = static_cast<const WindowResizeEvent &>(event);
+            return EventData::WindowResize{e.GetWidth(), e.GetHeight()};
+        }
+        case EventType::AppNotification: {
+            const auto &e = static_cast<const AppNotificationEvent &>(event);
+            return EventData::AppNotification{e.GetCode(), e.GetPayload()};
+        }
+        case EventType::KeyPressed: {
+            const auto &e = static_cast<const KeyPressedEvent &>(event);
+            return EventData::KeyPressed{e.GetKeyCode(), e.IsRepeat()};
+        }
+        case EventType::KeyReleased:
+            return EventData::KeyReleased{static_cast<const KeyReleasedEvent &>(event).GetKeyCode()};
+        case EventType::KeyTyped:
+            return EventData::KeyTyped{static_cast<const KeyTypedEvent &>(event).GetKeyCode()};
+        case EventType::MouseButtonPressed:
+            return EventData::MouseButtonPressed{
+                static_cast<const MouseButtonPressedEvent &>(event).GetMouseButton()
+            };
+        case EventType::MouseButtonReleased:
+            return EventData::MouseButtonReleased{
+                static_cast<const MouseButtonReleasedEvent &>(event).GetMouseButton()
+            };
+        case EventType::MouseMoved: {
+            const auto &e = static_cast<const MouseMovedEvent &>(event);
+            return EventData::MouseMoved{e.GetX(), e.GetY()};
+        }
+        case EventType::MouseScrolled: {
+            const auto &e = static_cast<const MouseScrolledEvent &>(event);
+            return EventData::MouseScrolled{e.GetXOffset(), e.GetYOffset()};
+        }
+        case EventType::WindowClose:
+            return EventData::WindowClose{};
+        default:
+            throw std::runtime_error(std::string("No compact representation for ") + event.GetName());
+    }
+}
@@ -6,7 +6,7 @@ import std.compat;
 export enum class EventType : uint8_t {
     None = 0,
     WindowClose, WindowResize, WindowFocus, WindowLostFocus, WindowMoved,
-    AppTick, AppUpdate, AppRender,
+    AppTick, AppUpdate, AppRender, AppNotification,
     KeyPressed, KeyReleased, KeyTyped,
     MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled
 };
@@ -0,0 +1,101 @@
+export module Events.EventQueue;
+
+export import Event.AllEvents;
+import std.compat;
+
+// Events are stored by value, the variant is as large as the largest event class.
+// The first alternative has to be default constructible.
+export using QueuedEvent = std::variant<
+    WindowCloseEvent,
+    WindowResizeEvent,
+    AppNotificationEvent,
+    KeyPressedEvent,
+    KeyReleasedEvent,
+    KeyTypedEvent,
+    MouseButtonPressedEvent,
+    MouseButtonReleasedEvent,
+    MouseMovedEvent,
+    MouseScrolledEvent
+>;
+
+// Fixed capacity ring buffer of events collected between frames and dispatched once per frame.
+// Posting is safe from any thread. Consecutive mouse moves, scrolls and resizes are merged
+// into the newest queued event of the same kind, so a high rate mouse costs one dispatch per frame.
+export template<size_t Capacity>
+class EventQueue {
+public:
+    // Returns false if the queue is full and the event was dropped.
+    bool Post(const QueuedEvent &event) {
+        std::lock_guard lock(m_Mutex);
+
+        if (m_Count > 0 && TryCoalesce(m_Events[(m_Head + m_Count - 1) % Capacity], event)) {
+            return true;
+        }
+
+        if (m_Count == Capacity) {
+            m_DroppedCount++;
+            return false;
+        }
+
+        m_Events[(m_Head + m_Count) % Capacity] = event;
+        m_Count++;
+        return true;
+    }
+
+    // Moves every queued event out and calls func on each of them in posting order.
+    // Events posted while draining are kept for the next call.
+    template<typename F>
+        requires std::invocable<F &, const Event &>
+    void Drain(F &&func) {
+        size_t count; {
+            std::lock_guard lock(m_Mutex);
+            count = m_Count;
+            for (size_t i = 0; i < count; i++) {
+                m_Draining[i] = std::move(m_Events[(m_Head + i) % Capacity]);
+            }
+            m_Head = (m_Head + count) % Capacity;
+            m_Count = 0;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            std::visit([&func](const Event &event) { func(event); }, m_Draining[i]);
+        }
+    }
+
+    [[nodiscard]] size_t GetDroppedCount() const {
+        std::lock_guard lock(m_Mutex);
+        return m_DroppedCount;
+    }
+
+private:
+    static bool TryCoalesce(QueuedEvent &tail, const QueuedEvent &event) {
+        if (tail.index() != event.index()) {
+            return false;
+        }
+
+        if (std::holds_alternative<MouseMovedEvent>(event) || std::holds_alternative<WindowResizeEvent>(event)) {
+            tail = event; // only the latest position / size matters
+            return true;
+        }
+
+        if (auto *scroll = std::get_if<MouseScrolledEvent>(&event)) {
+            auto &tailScroll = std::get<MouseScrolledEvent>(tail);
+            tail = MouseScrolledEvent{
+                tailScroll.GetXOffset() + scroll->GetXOffset(),
+                tailScroll.GetYOffset() + scroll->GetYOffset()
+            };
+            return true;
+        }
+
+        return false;
+    }
+
+    mutable std::mutex m_Mutex;
+    std::array<QueuedEvent, Capacity> m_Events{};
+    size_t m_Head = 0;
+    size_t m_Count = 0;
+    size_t m_DroppedCount = 0;
+
+    // Only touched by the draining thread.
+    std::array<QueuedEvent, Capacity> m_Draining{};
+};
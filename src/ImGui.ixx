@@ -2,7 +2,9 @@ export module ImGui;
 
 export import "vendor/ImGuiHeader.h";
 import "vulkan/vulkan.hpp";
+import std;
 
+// Small pool for the sets the ImGui backend allocates itself (font atlas).
 vk::DescriptorPool g_ImDescriptorPool{nullptr};
 vk::Device g_ImguiLogicalDevice{nullptr};
 
@@ -29,11 +31,155 @@ void DestroyImGuiDescriptorPool(vk::Device device) {
     }
 }
 
+export struct ImGuiTextureStats {
+    uint32_t PoolCount = 0;
+    uint32_t LiveTextureCount = 0;
+    uint32_t FreeSetCount = 0;
+};
+
+// Descriptor sets for textures shown with ImGui::Image. Pools are chained when they run out and
+// every set of a new pool is allocated up front, so a texture only costs a free list pop and
+// a descriptor write. Removed sets are rewritten on reuse instead of freed, pools never need
+// eFreeDescriptorSet. The set layout is defined exactly like the backend's own, which makes
+// the sets compatible with its pipeline layout.
+class ImGuiTextureAllocator {
+public:
+    static constexpr uint32_t SetsPerPool = 256;
+    // Free sets kept available at the start of each frame.
+    static constexpr uint32_t FrameReserve = 32;
+
+    void Init(vk::Device device) {
+        m_Device = device;
+
+        vk::DescriptorSetLayoutBinding binding{
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eFragment
+        };
+
+        vk::DescriptorSetLayoutCreateInfo layoutInfo{
+            .bindingCount = 1,
+            .pBindings = &binding
+        };
+
+        m_SetLayout = device.createDescriptorSetLayout(layoutInfo).value;
+        Grow();
+    }
+
+    void Destroy() {
+        std::lock_guard lock(m_Mutex);
+        for (auto pool: m_Pools) {
+            m_Device.destroyDescriptorPool(pool);
+        }
+        m_Pools.clear();
+        m_FreeSets.clear();
+        m_LiveCount = 0;
+
+        if (m_SetLayout) {
+            m_Device.destroyDescriptorSetLayout(m_SetLayout);
+            m_SetLayout = nullptr;
+        }
+        m_Device = nullptr;
+    }
+
+    // Called once per frame before layers update, moves pool creation off the path that adds textures.
+    void PrepareFrame() {
+        std::lock_guard lock(m_Mutex);
+        if (m_FreeSets.size() < FrameReserve) {
+            Grow();
+        }
+    }
+
+    vk::DescriptorSet Add(vk::Sampler sampler, vk::ImageView imageView, vk::ImageLayout imageLayout) {
+        std::lock_guard lock(m_Mutex);
+        if (m_FreeSets.empty()) {
+            // More textures than the frame reserve were added in a single frame.
+            Grow();
+        }
+
+        vk::DescriptorSet set = m_FreeSets.back();
+        m_FreeSets.pop_back();
+        m_LiveCount++;
+
+        vk::DescriptorImageInfo imageInfo{
+            .sampler = sampler,
+            .imageView = imageView,
+            .imageLayout = imageLayout
+        };
+
+        vk::WriteDescriptorSet write{
+            .dstSet = set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+            .pImageInfo = &imageInfo
+        };
+
+        m_Device.updateDescriptorSets(write, {});
+        return set;
+    }
+
+    // The set must no longer be referenced by frames in flight, retire it through the deletion queue.
+    void Remove(vk::DescriptorSet set) {
+        std::lock_guard lock(m_Mutex);
+        m_FreeSets.push_back(set);
+        m_LiveCount--;
+    }
+
+    ImGuiTextureStats GetStats() const {
+        std::lock_guard lock(m_Mutex);
+        return {
+            .PoolCount = static_cast<uint32_t>(m_Pools.size()),
+            .LiveTextureCount = m_LiveCount,
+            .FreeSetCount = static_cast<uint32_t>(m_FreeSets.size())
+        };
+    }
+
+private:
+    void Grow() {
+        vk::DescriptorPoolSize poolSize{
+            .type = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount = SetsPerPool
+        };
+
+        vk::DescriptorPoolCreateInfo poolInfo{
+            .maxSets = SetsPerPool,
+            .poolSizeCount = 1,
+            .pPoolSizes = &poolSize
+        };
+
+        vk::DescriptorPool pool = m_Device.createDescriptorPool(poolInfo).value;
+        m_Pools.push_back(pool);
+
+        std::vector<vk::DescriptorSetLayout> layouts(SetsPerPool, m_SetLayout);
+        vk::DescriptorSetAllocateInfo allocInfo{
+            .descriptorPool = pool,
+            .descriptorSetCount = SetsPerPool,
+            .pSetLayouts = layouts.data()
+        };
+
+        auto sets = m_Device.allocateDescriptorSets(allocInfo).value;
+        m_FreeSets.insert(m_FreeSets.end(), sets.rbegin(), sets.rend());
+    }
+
+    vk::Device m_Device{nullptr};
+    vk::DescriptorSetLayout m_SetLayout{nullptr};
+
+    mutable std::mutex m_Mutex;
+    std::vector<vk::DescriptorPool> m_Pools;
+    std::vector<vk::DescriptorSet> m_FreeSets;
+    uint32_t m_LiveCount = 0;
+};
+
+ImGuiTextureAllocator g_ImGuiTextures;
+
 export void InitImGuiForMyProgram(uint32_t apiVersion,
     vk::Instance instance, vk::PhysicalDevice physicalDevice,
     vk::Device device, uint32_t queueFamily, vk::Queue queue,
     vk::RenderPass renderPass, uint32_t minImageCount, uint32_t imageCount) {
     InitImGuiDescriptorPool(device);
+    g_ImGuiTextures.Init(device);
     g_ImguiLogicalDevice = device;
 
     ImGui_ImplVulkan_InitInfo info{};
@@ -53,6 +199,26 @@ export void InitImGuiForMyProgram(uint32_t apiVersion,
 
 export void ShutdownImGuiForMyProgram() {
     ImGui_ImplVulkan_Shutdown();
+    g_ImGuiTextures.Destroy();
     DestroyImGuiDescriptorPool(g_ImguiLogicalDevice);
     g_ImguiLogicalDevice = nullptr;
-}
\ No newline at end of file
+}
+
+// Replacements for ImGui_ImplVulkan_AddTexture / RemoveTexture backed by the growable allocator.
+export ImTextureID AddImGuiTexture(vk::Sampler sampler, vk::ImageView imageView,
+                                   vk::ImageLayout imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal) {
+    VkDescriptorSet set = g_ImGuiTextures.Add(sampler, imageView, imageLayout);
+    return reinterpret_cast<ImTextureID>(set);
+}
+
+export void RemoveImGuiTexture(ImTextureID texture) {
+    g_ImGuiTextures.Remove(reinterpret_cast<VkDescriptorSet>(texture));
+}
+
+export void PrepareImGuiTextures() {
+    g_ImGuiTextures.PrepareFrame();
+}
+
+export ImGuiTextureStats GetImGuiTextureStats() {
+    return g_ImGuiTextures.GetStats();
+}
@@ -0,0 +1,246 @@
+export module Layers.Disassembly;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.DisassemblyCache;
+
+// x86-64 disassembly of the target starting at m_Top, one instruction per row.
+//
+// Rows have no fixed address, so instead of a clipper over the address space the view keeps
+// the address of its first row and moves it by instructions: forward by following the decoded
+// lines into the next page, backward by asking the cache for the line before a known boundary.
+// Pages are decoded once through a DisassemblyCache and drawn from it every frame.
+export class DisassemblyLayer : public IUpdatableLayer {
+public:
+    static constexpr uint64_t PageSize = DisassemblyCache::PageSize;
+    // Instruction bytes shown before the text, longer instructions are cut short.
+    static constexpr size_t ShownBytes = 8;
+    static constexpr int WheelLines = 3;
+
+    explicit DisassemblyLayer(std::shared_ptr<TargetProcess> target) : m_Target(std::move(target)) {
+    }
+
+    void GoTo(uint64_t address) {
+        m_Top = std::min(address, MaxUserAddress - 1);
+    }
+
+    void OnUpdate() override {
+        auto process = m_Target->Get();
+        if (process != m_Process) {
+            m_Process = process;
+            m_Memory.SetProcess(process);
+            m_Cache.Clear();
+            m_History.clear();
+        }
+
+        ImGui::Begin("Disassembly");
+        DrawToolbar();
+        DrawRows();
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    struct Row {
+        const DisassembledPage *Page;
+        size_t Line;
+    };
+
+    void DrawToolbar() {
+        ImGui::BeginDisabled(m_History.empty());
+        if (ImGui::Button("<")) {
+            m_Top = m_History.back();
+            m_History.pop_back();
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+        if (ImGui::InputText("##GoTo", &m_GoToText, ImGuiInputTextFlags_CharsHexadecimal |
+                                                     ImGuiInputTextFlags_EnterReturnsTrue)) {
+            uint64_t address = 0;
+            auto [ptr, ec] = std::from_chars(m_GoToText.data(), m_GoToText.data() + m_GoToText.size(), address, 16);
+            if (ec == std::errc{}) {
+                m_History.push_back(m_Top);
+                GoTo(address);
+            }
+        }
+        ImGui::SameLine();
+        ImGui::TextUnformatted("Go to");
+
+        auto stats = m_Cache.GetStats();
+        ImGui::SameLine();
+        ImGui::TextDisabled("%zu pages decoded, %llu decodes, %llu hits", stats.CachedPages,
+                            static_cast<unsigned long long>(stats.Decodes),
+                            static_cast<unsigned long long>(stats.Hits));
+    }
+
+    void DrawRows() {
+        if (!ImGui::BeginChild("##DisassemblyRows", ImVec2(0, 0), ImGuiChildFlags_None,
+                               ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse |
+                               ImGuiWindowFlags_NoNav)) {
+            ImGui::EndChild();
+            return;
+        }
+
+        float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+        auto visibleRows = static_cast<size_t>(ImGui::GetContentRegionAvail().y / lineHeight) + 1;
+        GatherRows(visibleRows);
+        if (m_Rows.empty()) {
+            ImGui::TextDisabled("%016llX  not readable, or not read yet", static_cast<unsigned long long>(m_Top));
+        }
+
+        float hexDigitWidth = ImGui::CalcTextSize("0").x;
+        float spaceWidth = ImGui::CalcTextSize(" ").x;
+        float bytesOffset = hexDigitWidth * 16 + spaceWidth * 3;
+        float textOffset = bytesOffset + (hexDigitWidth * 2 + spaceWidth) * ShownBytes + spaceWidth * 2;
+
+        ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+        ImU32 disabledColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+        ImU32 branchColor = IM_COL32(110, 170, 255, 255);
+        ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+        std::optional<uint64_t> follow;
+        for (size_t i = 0; i < m_Rows.size(); i++) {
+            const DisassembledLine &line = m_Rows[i].Page->Lines[m_Rows[i].Line];
+            ImVec2 pos = ImGui::GetCursorScreenPos();
+
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::Selectable("##Row", false, ImGuiSelectableFlags_AllowDoubleClick,
+                              ImVec2(0, ImGui::GetTextLineHeight()));
+            if (line.BranchTarget && ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                follow = line.BranchTarget;
+            }
+            ImGui::PopID();
+
+            std::array<char, ShownBytes * 3 + 4> text;
+            auto end = std::format_to_n(text.data(), text.size(), "{:016X}", line.Address).out;
+            drawList->AddText(pos, disabledColor, text.data(), end);
+
+            auto bytes = m_Rows[i].Page->GetBytes(line);
+            char *out = text.data();
+            for (size_t b = 0; b < std::min(bytes.size(), ShownBytes); b++) {
+                out = std::format_to(out, "{:02X} ", static_cast<uint8_t>(bytes[b]));
+            }
+            if (bytes.size() > ShownBytes) {
+                out = std::format_to(out, "..");
+            }
+            drawList->AddText(ImVec2(pos.x + bytesOffset, pos.y), disabledColor, text.data(), out);
+
+            drawList->AddText(ImVec2(pos.x + textOffset, pos.y), line.BranchTarget ? branchColor : textColor,
+                              line.Text.data(), line.Text.data() + line.Text.size());
+        }
+
+        if (ImGui::IsWindowHovered()) {
+            float wheel = ImGui::GetIO().MouseWheel;
+            if (wheel != 0.0f) {
+                Scroll(-static_cast<int>(wheel * WheelLines));
+            }
+        }
+        if (ImGui::IsWindowFocused()) {
+            auto pageLines = static_cast<int>(std::max<size_t>(visibleRows, 2) - 1);
+            if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) {
+                Scroll(pageLines);
+            } else if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) {
+                Scroll(-pageLines);
+            } else if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
+                Scroll(1);
+            } else if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) {
+                Scroll(-1);
+            }
+        }
+        if (follow) {
+            m_History.push_back(m_Top);
+            GoTo(*follow);
+        }
+
+        // The page after the last row and the one before the first are where scrolling goes next.
+        if (!m_Rows.empty()) {
+            uint64_t first = m_Rows.front().Page->Address;
+            uint64_t last = m_Rows.back().Page->Address;
+            m_Memory.Prefetch(last + PageSize, PageSize);
+            if (first >= PageSize) {
+                m_Memory.Prefetch(first - PageSize, PageSize);
+            }
+        }
+
+        ImGui::EndChild();
+    }
+
+    // Fills m_Rows with up to count lines starting at m_Top, following each page into the next.
+    void GatherRows(size_t count) {
+        m_Rows.clear();
+        m_VisiblePages.clear();
+        uint64_t anchor = m_Top;
+        for (uint64_t page = m_Top & ~(PageSize - 1); m_Rows.size() < count && page < MaxUserAddress; page += PageSize) {
+            auto decoded = m_Cache.Get(m_Memory, page, anchor);
+            if (!decoded) {
+                break;
+            }
+            for (size_t line = decoded->FindBoundary(anchor).value_or(decoded->Lines.size());
+                 line < decoded->Lines.size() && m_Rows.size() < count; line++) {
+                m_Rows.push_back({decoded.get(), line});
+            }
+            anchor = decoded->End;
+            m_VisiblePages.push_back(std::move(decoded));
+        }
+    }
+
+    // Moves m_Top by lines instructions, stopping early where memory is not readable yet.
+    void Scroll(int lines) {
+        if (lines > 0) {
+            GatherRows(static_cast<size_t>(lines) + 1);
+            if (!m_Rows.empty()) {
+                const Row &row = m_Rows[std::min(static_cast<size_t>(lines), m_Rows.size() - 1)];
+                m_Top = row.Page->Lines[row.Line].Address;
+            }
+            return;
+        }
+        for (int i = 0; i < -lines; i++) {
+            auto previous = PreviousLine(m_Top);
+            if (!previous) {
+                break;
+            }
+            m_Top = *previous;
+        }
+    }
+
+    // Start of the instruction ending at address: from the page holding address when address
+    // is not its first line, otherwise from the page before, decoded to end exactly at address.
+    std::optional<uint64_t> PreviousLine(uint64_t address) {
+        uint64_t page = address & ~(PageSize - 1);
+        if (auto decoded = m_Cache.Get(m_Memory, page, address)) {
+            auto index = decoded->FindBoundary(address);
+            if (index && *index > 0) {
+                return decoded->Lines[*index - 1].Address;
+            }
+        }
+        if (page == 0 || address - page >= MaxInstructionLength) {
+            return std::nullopt;
+        }
+        auto previous = m_Cache.Get(m_Memory, page - PageSize, address);
+        if (!previous || previous->Lines.empty()) {
+            return std::nullopt;
+        }
+        return previous->Lines.back().Address;
+    }
+
+    std::shared_ptr<TargetProcess> m_Target;
+    std::shared_ptr<MemorySource> m_Process;
+    PageCache m_Memory;
+    DisassemblyCache m_Cache;
+
+    uint64_t m_Top = 0;
+    std::vector<uint64_t> m_History;
+    std::string m_GoToText;
+
+    // Rows drawn this frame, pointing into pages held by m_VisiblePages.
+    std::vector<Row> m_Rows;
+    std::vector<std::shared_ptr<const DisassembledPage>> m_VisiblePages;
+};
@@ -0,0 +1,262 @@
+export module Layers.Dissector;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.Dissector;
+
+constexpr std::string_view DefaultSchema =
+        "# struct <name> <size>, then <offset> <type> <name> per field\n"
+        "struct Root 0x100\n"
+        "    0x00 ptr vtable\n";
+
+// Shows memory at an address as a user defined struct. Every struct instance is fetched with
+// one read of its full size per frame, pointers are only followed while their tree node is
+// open, and arrays decode just the elements the clipper reports visible. Bytes not covered
+// by any field are shown with a guessed type.
+export class DissectorLayer : public IUpdatableLayer {
+public:
+    // Arrays longer than this are shown in a clipped child window.
+    static constexpr uint32_t ClipThreshold = 32;
+    static constexpr uint32_t MaxDepth = 16;
+
+    explicit DissectorLayer(std::shared_ptr<TargetProcess> target)
+        : m_Target(std::move(target)), m_SchemaText(DefaultSchema) {
+        ApplySchema();
+    }
+
+    void OnUpdate() override {
+        ImGui::Begin("Structure Dissector");
+
+        if (ImGui::CollapsingHeader("Layouts")) {
+            ImGui::InputTextMultiline("##Schema", &m_SchemaText,
+                                      ImVec2(-1.0f, ImGui::GetTextLineHeight() * 10));
+            if (ImGui::Button("Apply")) {
+                ApplySchema();
+            }
+            if (!m_SchemaError.empty()) {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_SchemaError.c_str());
+            }
+        }
+
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+        ImGui::InputText("Address", &m_AddressText, ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        if (ImGui::BeginCombo("Layout", m_Schema.Layouts.empty() ? "" : m_Schema.Layouts[m_RootLayout].Name.c_str())) {
+            for (uint32_t i = 0; i < m_Schema.Layouts.size(); i++) {
+                if (ImGui::Selectable(m_Schema.Layouts[i].Name.c_str(), i == m_RootLayout)) {
+                    m_RootLayout = i;
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        auto process = m_Target->Get();
+        uint64_t address = 0;
+        std::from_chars(m_AddressText.data(), m_AddressText.data() + m_AddressText.size(), address, 16);
+        if (process && address != 0 && m_RootLayout < m_Schema.Layouts.size()) {
+            ImGui::BeginChild("##Tree");
+            DrawPointee(*process, m_RootLayout, address, 0);
+            ImGui::EndChild();
+        }
+
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void ApplySchema() {
+        auto schema = ParseSchema(m_SchemaText);
+        if (!schema) {
+            m_SchemaError = schema.error();
+            return;
+        }
+        m_Schema = std::move(*schema);
+        m_SchemaError.clear();
+        m_RootLayout = std::min<uint32_t>(m_RootLayout, std::max<size_t>(m_Schema.Layouts.size(), 1) - 1);
+    }
+
+    // Reads a whole struct at address in one go and draws its fields.
+    void DrawPointee(const MemorySource &process, uint32_t layoutIndex, uint64_t address, uint32_t depth) {
+        if (depth >= MaxDepth) {
+            ImGui::TextDisabled("(too deep)");
+            return;
+        }
+
+        const StructLayout &layout = m_Schema.Layouts[layoutIndex];
+        auto &buffer = m_ReadBuffers[depth];
+        buffer.resize(layout.Size);
+        if (process.Read(address, buffer) != buffer.size()) {
+            ImGui::TextDisabled("%016llX: unreadable", static_cast<unsigned long long>(address));
+            return;
+        }
+        DrawStruct(process, layout, address, buffer, depth);
+    }
+
+    void DrawStruct(const MemorySource &process, const StructLayout &layout, uint64_t address,
+                    std::span<const std::byte> bytes, uint32_t depth) {
+        uint32_t cursor = 0;
+        for (const auto &field: layout.Fields) {
+            if (field.Offset > cursor) {
+                DrawGuesses(address, bytes, cursor, field.Offset);
+            }
+            DrawField(process, field, address, bytes, depth);
+            cursor = std::max(cursor, field.Offset + GetFieldSize(m_Schema, field));
+        }
+        if (cursor < layout.Size) {
+            DrawGuesses(address, bytes, cursor, layout.Size);
+        }
+    }
+
+    void DrawField(const MemorySource &process, const FieldDef &field, uint64_t address,
+                   std::span<const std::byte> bytes, uint32_t depth) {
+        std::span<const std::byte> fieldBytes = bytes.subspan(field.Offset, GetFieldSize(m_Schema, field));
+        uint64_t fieldAddress = address + field.Offset;
+        ImGui::PushID(static_cast<int>(field.Offset));
+
+        if (field.Type == FieldType::Char) {
+            auto text = std::string_view(reinterpret_cast<const char *>(fieldBytes.data()), fieldBytes.size());
+            text = text.substr(0, text.find('\0'));
+            ImGui::Text("+%04X char[%u] %s = \"%.*s\"", field.Offset, field.Count, field.Name.c_str(),
+                        static_cast<int>(text.size()), text.data());
+        } else if (field.Count == 1) {
+            DrawElement(process, field, fieldAddress, fieldBytes, depth, field.Name.c_str(), field.Offset);
+        } else {
+            std::string label = std::format("+{:04X} {}[{}] {}", field.Offset, TypeLabel(field), field.Count,
+                                            field.Name);
+            if (ImGui::TreeNode(label.c_str())) {
+                DrawArray(process, field, fieldAddress, fieldBytes, depth);
+                ImGui::TreePop();
+            }
+        }
+
+        ImGui::PopID();
+    }
+
+    // Only the elements inside the clipper's range are decoded.
+    void DrawArray(const MemorySource &process, const FieldDef &field, uint64_t address,
+                   std::span<const std::byte> bytes, uint32_t depth) {
+        uint32_t elementSize = GetFieldSize(m_Schema, field) / field.Count;
+        auto drawElement = [&](uint32_t index) {
+            ImGui::PushID(static_cast<int>(index));
+            std::string name = std::format("[{}]", index);
+            DrawElement(process, field, address + index * elementSize,
+                        bytes.subspan(size_t{index} * elementSize, elementSize), depth, name.c_str(),
+                        index * elementSize);
+            ImGui::PopID();
+        };
+
+        if (field.Count <= ClipThreshold) {
+            for (uint32_t i = 0; i < field.Count; i++) {
+                drawElement(i);
+            }
+            return;
+        }
+
+        float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+        if (ImGui::BeginChild("##Elements", ImVec2(0, lineHeight * ClipThreshold / 2), ImGuiChildFlags_Border)) {
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(field.Count), lineHeight);
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    drawElement(static_cast<uint32_t>(i));
+                }
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    void DrawElement(const MemorySource &process, const FieldDef &field, uint64_t address,
+                     std::span<const std::byte> bytes, uint32_t depth, const char *name, uint32_t offset) {
+        if (field.Type == FieldType::Struct) {
+            std::string label = std::format("+{:04X} {} {}", offset, TypeLabel(field), name);
+            if (ImGui::TreeNode(label.c_str())) {
+                DrawStruct(process, m_Schema.Layouts[*field.Layout], address, bytes, depth);
+                ImGui::TreePop();
+            }
+            return;
+        }
+
+        std::array<char, 64> text;
+        std::string_view value = DecodeScalar(field.Type, bytes, text);
+
+        if (field.Type == FieldType::Pointer && field.Layout) {
+            std::string label = std::format("+{:04X} {} {} = {}", offset, TypeLabel(field), name, value);
+            if (ImGui::TreeNode(label.c_str())) {
+                uint64_t pointee;
+                std::memcpy(&pointee, bytes.data(), sizeof(pointee));
+                DrawPointee(process, *field.Layout, pointee, depth + 1);
+                ImGui::TreePop();
+            }
+            return;
+        }
+
+        ImGui::Text("+%04X %s %s = %.*s", offset, GetFieldTypeName(field.Type), name,
+                    static_cast<int>(value.size()), value.data());
+    }
+
+    // Unnamed bytes in [begin, end), guessed in 4 or 8 byte steps.
+    void DrawGuesses(uint64_t address, std::span<const std::byte> bytes, uint32_t begin, uint32_t end) {
+        uint32_t offset = begin;
+        while (offset < end && (offset & 3) != 0) {
+            offset++; // padding up to the next guessable position
+        }
+
+        while (offset < end) {
+            FieldGuess guess = GuessField(bytes.subspan(offset, end - offset), ((address + offset) & 7) == 0);
+            guess.Size = std::min(guess.Size, end - offset);
+
+            if (guess.Kind == GuessKind::Zero) {
+                // Collapse runs of zeros into one line.
+                uint32_t runEnd = offset + guess.Size;
+                while (runEnd + 4 <= end && std::ranges::all_of(bytes.subspan(runEnd, 4),
+                                                                [](std::byte b) { return b == std::byte{0}; })) {
+                    runEnd += 4;
+                }
+                ImGui::TextDisabled("+%04X %u zero bytes", offset, runEnd - offset);
+                offset = runEnd;
+                continue;
+            }
+
+            if (guess.Kind == GuessKind::String) {
+                auto text = std::string_view(reinterpret_cast<const char *>(bytes.data() + offset), guess.Size);
+                text = text.substr(0, text.find('\0'));
+                ImGui::TextDisabled("+%04X string? \"%.*s\"", offset, static_cast<int>(text.size()), text.data());
+            } else {
+                FieldType type = GuessedFieldType(guess.Kind);
+                std::array<char, 64> text;
+                std::string_view value = DecodeScalar(type, bytes.subspan(offset, guess.Size), text);
+                ImGui::TextDisabled("+%04X %s? %.*s", offset, GetFieldTypeName(type),
+                                    static_cast<int>(value.size()), value.data());
+            }
+            offset += std::max(guess.Size, 4u);
+        }
+    }
+
+    std::string TypeLabel(const FieldDef &field) const {
+        if (field.Layout) {
+            const std::string &name = m_Schema.Layouts[*field.Layout].Name;
+            return field.Type == FieldType::Pointer ? name + "*" : name;
+        }
+        return GetFieldTypeName(field.Type);
+    }
+
+    std::shared_ptr<TargetProcess> m_Target;
+
+    std::string m_SchemaText;
+    std::string m_SchemaError;
+    DissectorSchema m_Schema;
+    uint32_t m_RootLayout = 0;
+    std::string m_AddressText;
+
+    // One buffer per pointer depth, reused every frame.
+    std::array<std::vector<std::byte>, MaxDepth> m_ReadBuffers;
+};
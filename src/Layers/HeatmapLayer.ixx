@@ -0,0 +1,284 @@
+export module Layers.Heatmap;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.ProcessMemory;
+import Render.MemoryHeatmap;
+
+// Reads a region of the target on its own thread and turns it into per cell statistics.
+// Results are triple buffered: the thread fills its back buffer, publishes it as the front
+// buffer, and the UI swaps the front buffer out whenever a newer pass was published.
+class RegionSampler {
+public:
+    static constexpr size_t MaxCells = 1 << 20;
+    static constexpr size_t ChunkSize = 1 << 20;
+
+    explicit RegionSampler(std::shared_ptr<TargetProcess> target) : m_Target(std::move(target)) {
+        m_Thread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+    }
+
+    ~RegionSampler() {
+        m_Thread.request_stop();
+        m_Condition.notify_all();
+    }
+
+    void Configure(uint64_t baseAddress, uint64_t size, uint32_t cellSize) {
+        std::lock_guard lock(m_Mutex);
+        m_BaseAddress = baseAddress;
+        m_CellSize = cellSize;
+        m_CellCount = static_cast<size_t>(std::min<uint64_t>((size + cellSize - 1) / cellSize, MaxCells));
+        m_ConfigVersion++;
+        m_Condition.notify_all();
+    }
+
+    void SetInterval(std::chrono::milliseconds interval) {
+        std::lock_guard lock(m_Mutex);
+        m_Interval = interval;
+    }
+
+    // Swaps the latest published pass into cells, returns false if there is nothing newer.
+    bool TakeLatest(std::vector<HeatmapCell> &cells, uint32_t &maxChangeCount) {
+        std::lock_guard lock(m_Mutex);
+        if (m_PublishedVersion == m_TakenVersion) {
+            return false;
+        }
+        m_TakenVersion = m_PublishedVersion;
+        cells.swap(m_Front);
+        maxChangeCount = m_FrontMaxChangeCount;
+        return true;
+    }
+
+private:
+    void Run(std::stop_token stopToken) {
+        std::vector<std::byte> chunk(ChunkSize);
+        std::vector<HeatmapCell> back;
+        std::vector<uint64_t> hashes;
+        std::vector<uint32_t> changeCounts;
+        uint64_t seenConfigVersion = 0;
+
+        while (!stopToken.stop_requested()) {
+            uint64_t baseAddress;
+            uint32_t cellSize;
+            size_t cellCount;
+            std::chrono::milliseconds interval; {
+                std::lock_guard lock(m_Mutex);
+                baseAddress = m_BaseAddress;
+                cellSize = m_CellSize;
+                cellCount = m_CellCount;
+                interval = m_Interval;
+                if (seenConfigVersion != m_ConfigVersion) {
+                    seenConfigVersion = m_ConfigVersion;
+                    hashes.assign(cellCount, 0);
+                    changeCounts.assign(cellCount, 0);
+                }
+            }
+
+            auto process = m_Target->Get();
+            auto passStart = std::chrono::steady_clock::now();
+            if (process && cellCount > 0) {
+                back.resize(cellCount);
+                uint32_t maxChangeCount = SamplePass(*process, baseAddress, cellSize, chunk, back, hashes,
+                                                     changeCounts);
+
+                std::lock_guard lock(m_Mutex);
+                if (seenConfigVersion == m_ConfigVersion) {
+                    back.swap(m_Front);
+                    m_FrontMaxChangeCount = maxChangeCount;
+                    m_PublishedVersion++;
+                }
+            }
+
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait_until(lock, stopToken, passStart + interval, [this, seenConfigVersion] {
+                return seenConfigVersion != m_ConfigVersion;
+            });
+        }
+    }
+
+    static uint32_t SamplePass(const MemorySource &process, uint64_t baseAddress, uint32_t cellSize,
+                               std::vector<std::byte> &chunk, std::vector<HeatmapCell> &cells,
+                               std::vector<uint64_t> &hashes, std::vector<uint32_t> &changeCounts) {
+        uint32_t maxChangeCount = 0;
+        size_t cellsPerChunk = std::max<size_t>(chunk.size() / cellSize, 1);
+        std::array<uint16_t, 256> histogram{};
+        double maxEntropy = std::log2(static_cast<double>(std::min<uint32_t>(cellSize, 256)));
+
+        for (size_t firstCell = 0; firstCell < cells.size(); firstCell += cellsPerChunk) {
+            size_t count = std::min(cellsPerChunk, cells.size() - firstCell);
+            uint64_t chunkAddress = baseAddress + firstCell * cellSize;
+            std::span<std::byte> data(chunk.data(), count * cellSize);
+
+            // A single unreadable page fails the whole read, fall back to one read per cell.
+            bool chunkReadable = process.Read(chunkAddress, data) == data.size();
+
+            for (size_t i = 0; i < count; i++) {
+                size_t index = firstCell + i;
+                std::span<std::byte> bytes = data.subspan(i * cellSize, cellSize);
+                HeatmapCell &cell = cells[index];
+
+                if (!chunkReadable && process.Read(chunkAddress + i * cellSize, bytes) != bytes.size()) {
+                    cell = HeatmapCell{.ChangeCount = changeCounts[index]};
+                    continue;
+                }
+
+                // Only the counters touched by this cell are cleared afterwards.
+                uint64_t hash = 14695981039346656037ull;
+                for (std::byte b: bytes) {
+                    histogram[static_cast<uint8_t>(b)]++;
+                    hash = (hash ^ static_cast<uint8_t>(b)) * 1099511628211ull;
+                }
+                double entropy = 0.0;
+                for (std::byte b: bytes) {
+                    uint16_t &n = histogram[static_cast<uint8_t>(b)];
+                    if (n != 0) {
+                        double p = static_cast<double>(n) / static_cast<double>(cellSize);
+                        entropy -= p * std::log2(p);
+                        n = 0;
+                    }
+                }
+
+                if (hashes[index] != 0 && hashes[index] != hash) {
+                    changeCounts[index]++;
+                }
+                hashes[index] = hash;
+                maxChangeCount = std::max(maxChangeCount, changeCounts[index]);
+
+                uint32_t firstWord = 0;
+                std::memcpy(&firstWord, bytes.data(), std::min<size_t>(sizeof(firstWord), bytes.size()));
+
+                cell = HeatmapCell{
+                    .Entropy = maxEntropy > 0.0 ? static_cast<float>(entropy / maxEntropy) : 0.0f,
+                    .ChangeCount = changeCounts[index],
+                    .FirstWord = firstWord,
+                    .Flags = HeatmapCellFlags::Readable
+                };
+            }
+        }
+
+        return maxChangeCount;
+    }
+
+    std::shared_ptr<TargetProcess> m_Target;
+
+    std::mutex m_Mutex;
+    std::condition_variable_any m_Condition;
+    uint64_t m_BaseAddress = 0;
+    uint32_t m_CellSize = 4096;
+    size_t m_CellCount = 0;
+    uint64_t m_ConfigVersion = 0;
+    std::chrono::milliseconds m_Interval{200};
+
+    std::vector<HeatmapCell> m_Front;
+    uint32_t m_FrontMaxChangeCount = 0;
+    uint64_t m_PublishedVersion = 0;
+    uint64_t m_TakenVersion = 0;
+
+    std::jthread m_Thread;
+};
+
+// Overview of a region of the target, one pixel per page or cache line.
+export class HeatmapLayer : public IUpdatableLayer {
+public:
+    HeatmapLayer(IBasicContext *context, std::shared_ptr<TargetProcess> target)
+        : m_Sampler(std::move(target)), m_Heatmap(context, 1, 1) {
+    }
+
+    void OnUpdate() override {
+        ImGui::Begin("Memory Heatmap");
+        DrawControls();
+
+        if (m_Sampler.TakeLatest(m_Cells, m_MaxChangeCount)) {
+            auto width = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(m_Cells.size()))));
+            width = std::max(width, 1u);
+            m_Heatmap.Resize(width, static_cast<uint32_t>((m_Cells.size() + width - 1) / width));
+            m_Dirty = true;
+        }
+
+        if (m_Dirty) {
+            m_Heatmap.Update(m_Cells, m_Mode, m_MaxChangeCount);
+            m_Dirty = false;
+        }
+
+        if (!m_Cells.empty()) {
+            DrawMap();
+        }
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void DrawControls() {
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+        ImGui::InputText("Base", &m_BaseText, ImGuiInputTextFlags_CharsHexadecimal);
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5);
+        ImGui::InputInt("Size (MiB)", &m_SizeMiB);
+        m_SizeMiB = std::clamp(m_SizeMiB, 1, 4096);
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::Combo("Cell", &m_CellSizeIndex, "Page\0Cache line\0");
+
+        ImGui::SameLine();
+        if (ImGui::Button("Apply")) {
+            uint64_t baseAddress = 0;
+            std::from_chars(m_BaseText.data(), m_BaseText.data() + m_BaseText.size(), baseAddress, 16);
+            m_CellSize = m_CellSizeIndex == 0 ? 4096 : 64;
+            m_BaseAddress = baseAddress & ~uint64_t{m_CellSize - 1};
+            m_Sampler.Configure(m_BaseAddress, static_cast<uint64_t>(m_SizeMiB) << 20, m_CellSize);
+        }
+
+        int mode = static_cast<int>(m_Mode);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        if (ImGui::Combo("Color", &mode, "Entropy\0Change frequency\0Value\0")) {
+            m_Mode = static_cast<HeatmapMode>(mode);
+            m_Dirty = true;
+        }
+    }
+
+    void DrawMap() {
+        auto [width, height] = m_Heatmap.GetExtent();
+        ImVec2 available = ImGui::GetContentRegionAvail();
+        float scale = std::max(std::min(available.x / static_cast<float>(width),
+                                        available.y / static_cast<float>(height)), 0.0f);
+        ImVec2 size(static_cast<float>(width) * scale, static_cast<float>(height) * scale);
+
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::Image(m_Heatmap.GetTextureID(), size);
+
+        if (ImGui::IsItemHovered() && scale > 0.0f) {
+            ImVec2 mouse = ImGui::GetMousePos();
+            auto x = static_cast<uint32_t>((mouse.x - origin.x) / scale);
+            auto y = static_cast<uint32_t>((mouse.y - origin.y) / scale);
+            size_t index = size_t{y} * width + x;
+            if (x < width && index < m_Cells.size()) {
+                const HeatmapCell &cell = m_Cells[index];
+                ImGui::SetTooltip("%016llX\nentropy %.2f, %u changes",
+                                  static_cast<unsigned long long>(m_BaseAddress + index * m_CellSize),
+                                  cell.Entropy, cell.ChangeCount);
+            }
+        }
+    }
+
+    RegionSampler m_Sampler;
+    MemoryHeatmap m_Heatmap;
+
+    std::vector<HeatmapCell> m_Cells;
+    uint32_t m_MaxChangeCount = 0;
+    HeatmapMode m_Mode = HeatmapMode::Entropy;
+    bool m_Dirty = false;
+
+    std::string m_BaseText;
+    int m_SizeMiB = 64;
+    int m_CellSizeIndex = 0;
+    uint64_t m_BaseAddress = 0;
+    uint32_t m_CellSize = 4096;
+};
@@ -0,0 +1,225 @@
+export module Layers.HexView;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.AddressExpression;
+import Engine.PageCache;
+import Engine.Targets;
+
+// Hex dump of the target process with an address column, 16 bytes per row and their ASCII.
+//
+// The address space has far more rows than a float scroll position can address, so the child
+// window scrolls over a window of WindowRows rows starting at m_BaseRow, and the window is
+// rebased whenever the scroll position gets close to one of its ends. Only the rows the
+// clipper reports visible are read, through a PageCache that prefetches in scroll direction.
+export class HexViewLayer : public IUpdatableLayer {
+public:
+    static constexpr uint64_t BytesPerRow = 16;
+    static constexpr uint64_t WindowRows = 1 << 16;
+    static constexpr uint64_t TotalRows = MaxUserAddress / BytesPerRow;
+    // Pages read ahead of the visible range in scroll direction.
+    static constexpr uint64_t PrefetchPages = 4;
+
+    HexViewLayer(std::shared_ptr<TargetProcess> target, std::shared_ptr<TargetSet> targets)
+        : m_Target(std::move(target)), m_Targets(std::move(targets)) {
+    }
+
+    // Scrolls so that address is the first visible row.
+    void GoTo(uint64_t address) {
+        uint64_t row = std::min(address, MaxUserAddress - 1) / BytesPerRow;
+        m_BaseRow = row > WindowRows / 2 ? std::min(row - WindowRows / 2, TotalRows - WindowRows) : 0;
+        m_PendingScrollRow = row - m_BaseRow;
+    }
+
+    void OnUpdate() override {
+        m_Cache.SetProcess(m_Target->Get());
+
+        ImGui::Begin("Memory View");
+        DrawToolbar();
+        DrawRows();
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void DrawToolbar() {
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+        if (ImGui::InputText("##GoTo", &m_GoToText, ImGuiInputTextFlags_EnterReturnsTrue)) {
+            GoTo(m_GoToText);
+        }
+        ImGui::SameLine();
+        ImGui::TextUnformatted("Go to");
+        if (!m_GoToError.empty()) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_GoToError.c_str());
+        }
+
+        ImGui::SameLine();
+        int refreshMs = static_cast<int>(m_Cache.GetRefreshInterval().count());
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        if (ImGui::SliderInt("Refresh (ms)", &refreshMs, 16, 2000)) {
+            m_Cache.SetRefreshInterval(std::chrono::milliseconds(refreshMs));
+        }
+
+        auto stats = m_Cache.GetStats();
+        ImGui::SameLine();
+        ImGui::TextDisabled("%zu pages cached, %llu page reads", stats.CachedPages,
+                            static_cast<unsigned long long>(stats.PageReads));
+    }
+
+    // Address expressions resolve through the focused target's resolver, sharing its reads.
+    void GoTo(std::string_view text) {
+        auto expression = AddressExpression::Compile(text);
+        if (!expression) {
+            m_GoToError = expression.error();
+            return;
+        }
+        auto address = m_Targets->GetResolver(m_Target->Get())->Resolve(*expression);
+        m_GoToError = address ? "" : "does not resolve";
+        if (address) {
+            GoTo(*address);
+        }
+    }
+
+    void DrawRows() {
+        if (!ImGui::BeginChild("##HexRows", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_NoNav)) {
+            ImGui::EndChild();
+            return;
+        }
+
+        float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+        if (m_PendingScrollRow) {
+            ImGui::SetScrollY(static_cast<float>(*m_PendingScrollRow) * lineHeight);
+            m_PendingScrollRow.reset();
+        }
+
+        float hexDigitWidth = ImGui::CalcTextSize("0").x;
+        float spaceWidth = ImGui::CalcTextSize(" ").x;
+        float addressWidth = hexDigitWidth * 16 + spaceWidth * 3;
+        float byteWidth = hexDigitWidth * 2 + spaceWidth;
+        float asciiOffset = addressWidth + byteWidth * BytesPerRow + spaceWidth * 2;
+
+        ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+        ImU32 disabledColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+        ImU32 changedColor = IM_COL32(255, 110, 90, 255);
+        ImU32 changedBackground = IM_COL32(255, 110, 90, 48);
+        ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+        uint64_t firstVisibleRow = 0;
+        uint64_t lastVisibleRow = 0;
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(WindowRows), lineHeight);
+        while (clipper.Step()) {
+            uint64_t firstRow = m_BaseRow + static_cast<uint64_t>(clipper.DisplayStart);
+            uint64_t rowCount = static_cast<uint64_t>(clipper.DisplayEnd - clipper.DisplayStart);
+            firstVisibleRow = firstRow;
+            lastVisibleRow = firstRow + rowCount;
+
+            m_Bytes.resize(rowCount * BytesPerRow);
+            m_Flags.resize(rowCount * BytesPerRow);
+            m_Cache.Read(firstRow * BytesPerRow, m_Bytes, m_Flags);
+
+            for (uint64_t i = 0; i < rowCount; i++) {
+                uint64_t address = (firstRow + i) * BytesPerRow;
+                ImVec2 pos = ImGui::GetCursorScreenPos();
+
+                std::array<char, 20> text;
+                auto end = std::format_to_n(text.data(), text.size(), "{:016X}", address).out;
+                drawList->AddText(pos, disabledColor, text.data(), end);
+
+                std::array<char, BytesPerRow> ascii;
+                for (uint64_t column = 0; column < BytesPerRow; column++) {
+                    size_t index = i * BytesPerRow + column;
+                    uint8_t flags = m_Flags[index];
+                    ImVec2 bytePos{pos.x + addressWidth + byteWidth * column, pos.y};
+                    auto value = static_cast<uint8_t>(m_Bytes[index]);
+
+                    if (!(flags & CachedByte::Valid)) {
+                        drawList->AddText(bytePos, disabledColor, "??");
+                        ascii[column] = ' ';
+                        continue;
+                    }
+
+                    constexpr char digits[] = "0123456789ABCDEF";
+                    char hex[2] = {digits[value >> 4], digits[value & 0xF]};
+                    if (flags & CachedByte::Changed) {
+                        drawList->AddRectFilled(bytePos, ImVec2(bytePos.x + hexDigitWidth * 2, bytePos.y + lineHeight),
+                                                changedBackground);
+                        drawList->AddText(bytePos, changedColor, hex, hex + 2);
+                    } else {
+                        drawList->AddText(bytePos, textColor, hex, hex + 2);
+                    }
+                    ascii[column] = value >= 0x20 && value < 0x7F ? static_cast<char>(value) : '.';
+                }
+                drawList->AddText(ImVec2(pos.x + asciiOffset, pos.y), textColor, ascii.data(),
+                                  ascii.data() + ascii.size());
+
+                ImGui::Dummy(ImVec2(asciiOffset + hexDigitWidth * BytesPerRow, ImGui::GetTextLineHeight()));
+            }
+        }
+        clipper.End();
+
+        float scrollY = ImGui::GetScrollY();
+        PrefetchAround(firstVisibleRow, lastVisibleRow, scrollY - m_LastScrollY);
+        m_LastScrollY = scrollY;
+
+        Rebase(scrollY, lineHeight);
+
+        ImGui::EndChild();
+    }
+
+    void PrefetchAround(uint64_t firstRow, uint64_t lastRow, float scrollDelta) {
+        if (lastRow <= firstRow) {
+            return;
+        }
+
+        constexpr uint64_t prefetchBytes = PrefetchPages * PageCache::PageSize;
+        uint64_t first = firstRow * BytesPerRow;
+        uint64_t last = lastRow * BytesPerRow;
+        if (scrollDelta < 0) {
+            m_Cache.Prefetch(first > prefetchBytes ? first - prefetchBytes : 0, std::min(first, prefetchBytes));
+        } else {
+            // Standing still counts as scrolling down, the next page is the most likely target.
+            m_Cache.Prefetch(last, scrollDelta > 0 ? prefetchBytes : PageCache::PageSize);
+        }
+    }
+
+    // Moves the virtual window by half its size when the view is within a quarter of its edges.
+    void Rebase(float scrollY, float lineHeight) {
+        auto scrollRow = static_cast<uint64_t>(scrollY / lineHeight);
+        int64_t shift = 0;
+        if (scrollRow < WindowRows / 4 && m_BaseRow > 0) {
+            shift = -static_cast<int64_t>(std::min(m_BaseRow, WindowRows / 2));
+        } else if (scrollRow > WindowRows * 3 / 4 && m_BaseRow + WindowRows < TotalRows) {
+            shift = static_cast<int64_t>(std::min(TotalRows - WindowRows - m_BaseRow, WindowRows / 2));
+        }
+
+        if (shift != 0) {
+            m_BaseRow += shift;
+            ImGui::SetScrollY(scrollY - static_cast<float>(shift) * lineHeight);
+            m_LastScrollY -= static_cast<float>(shift) * lineHeight;
+        }
+    }
+
+    std::shared_ptr<TargetProcess> m_Target;
+    std::shared_ptr<TargetSet> m_Targets;
+    PageCache m_Cache;
+
+    uint64_t m_BaseRow = 0;
+    std::optional<uint64_t> m_PendingScrollRow;
+    float m_LastScrollY = 0.0f;
+    std::string m_GoToText;
+    std::string m_GoToError;
+
+    // Bytes of the visible rows, reused every frame.
+    std::vector<std::byte> m_Bytes;
+    std::vector<uint8_t> m_Flags;
+};
@@ -0,0 +1,247 @@
+export module Layers.Server;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.IpcChannel;
+import Engine.ProcessMemory;
+import Engine.ScanClient;
+import Engine.Scanner;
+import Engine.Session;
+
+constexpr const char *RemoteCompareNames = "Exact\0Changed\0Unchanged\0Increased\0Decreased\0";
+
+// Rows whose values are re-read every frame, in one pipelined batch.
+constexpr int MaxRemoteLiveRows = 256;
+
+// Front end of a scan server (server/ServerMain.cpp). The scan runs in the server process, so
+// a large scan never stalls a frame and a crash while reading the target leaves the UI
+// running. The frame never waits on the server except for the visible rows' values: state
+// and results are requested ahead and picked up once they arrived.
+export class ServerLayer : public IUpdatableLayer {
+public:
+    explicit ServerLayer(std::shared_ptr<TargetProcess> focus) : m_Focus(std::move(focus)) {
+    }
+
+    void OnUpdate() override {
+        ImGui::Begin("Scan Server");
+        DrawConnection();
+        if (m_Client && m_Client->IsConnected()) {
+            DrawAttach();
+            if (m_Source) {
+                PollState();
+                DrawScanControls();
+                DrawResults();
+            }
+        }
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void DrawConnection() {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 12);
+        ImGui::InputText("##Socket", &m_SocketPath);
+        ImGui::SameLine();
+        if (!m_Client) {
+            if (ImGui::Button("Connect")) {
+                m_Client = ScanClient::Connect(m_SocketPath);
+                m_Status = m_Client ? "" : std::format("cannot connect to {}", m_SocketPath);
+            }
+        } else if (ImGui::Button("Disconnect")) {
+            Disconnect();
+            return;
+        }
+        if (m_Client && !m_Client->IsConnected()) {
+            Disconnect();
+            m_Status = "server went away";
+        }
+        if (!m_Status.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_Status.c_str());
+        }
+    }
+
+    void DrawAttach() {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::InputText("##Pid", &m_PidText, ImGuiInputTextFlags_CharsDecimal);
+        ImGui::SameLine();
+        if (ImGui::Button("Attach")) {
+            uint32_t pid = 0;
+            std::from_chars(m_PidText.data(), m_PidText.data() + m_PidText.size(), pid);
+            auto targetId = m_Client->Attach(pid);
+            if (targetId) {
+                DetachTarget();
+                m_Source = std::make_shared<RemoteSource>(m_Client, *targetId, pid);
+                m_Status.clear();
+            } else {
+                m_Status = std::format("the server cannot attach to {}", m_PidText);
+            }
+        }
+        if (m_Source) {
+            ImGui::SameLine();
+            ImGui::Text("pid %u", m_Source->GetProcessId());
+            ImGui::SameLine();
+            if (ImGui::Button("Focus")) {
+                m_Focus->Set(m_Source);
+            }
+        }
+    }
+
+    // Keeps one state request in flight, and one results request once the state shows new
+    // results.
+    void PollState() {
+        if (!m_PendingState.valid()) {
+            m_PendingState = m_Client->RequestScanState(m_Source->GetTargetId());
+        } else if (m_PendingState.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_State = ScanClient::ParseScanState(m_PendingState.get()).value_or(RemoteScanState{});
+        }
+
+        bool stale = m_State.HasResults && (!m_Results || m_Results->GetGeneration() != m_State.ResultGeneration);
+        if (!m_State.HasResults) {
+            m_Results.reset();
+        } else if (stale && !m_PendingResults.valid()) {
+            m_PendingResults = m_Client->RequestResults(m_Source->GetTargetId());
+        }
+        if (m_PendingResults.valid() &&
+            m_PendingResults.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_Results = ScanClient::ParseResults(m_PendingResults.get());
+        }
+    }
+
+    void DrawScanControls() {
+        bool hasResults = m_State.HasResults;
+        if (hasResults) {
+            m_Type = static_cast<int>(m_State.Type);
+        } else {
+            m_Compare = static_cast<int>(ScanCompare::Exact);
+        }
+        ImGui::BeginDisabled(hasResults);
+        // Remote scans take the scalar types, which come first in the names.
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::Combo("##Type", &m_Type, ValueTypeNames.data(), static_cast<int>(ScalarValueTypeCount));
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!hasResults);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::Combo("##Compare", &m_Compare, RemoteCompareNames);
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        ImGui::InputText("##Value", &m_ValueText);
+
+        ImGui::SameLine();
+        ImGui::BeginDisabled(m_State.Running);
+        if (ImGui::Button(hasResults ? "Next Scan" : "First Scan")) {
+            ScanRequest request{
+                .Type = static_cast<ScanValueType>(m_Type),
+                .Compare = static_cast<ScanCompare>(m_Compare),
+            };
+            auto value = ParseScanValue(m_ValueText, request.Type);
+            if (request.Compare == ScanCompare::Exact && !value) {
+                m_Status = "invalid value";
+            } else {
+                request.Value = value.value_or(0);
+                m_Status = m_Client->StartScan(m_Source->GetTargetId(), request) ? "" : "cannot start scan";
+            }
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Reset")) {
+            m_Client->ResetScan(m_Source->GetTargetId());
+            m_Results.reset();
+        }
+
+        if (m_State.Running) {
+            ImGui::ProgressBar(m_State.Progress, ImVec2(-1.0f, 0));
+        }
+    }
+
+    void DrawResults() {
+        if (!m_Results) {
+            return;
+        }
+        auto results = m_Results->Get();
+        ScanValueType type = m_Results->GetType();
+        ImGui::Text("%zu results", results.size());
+
+        float height = ImGui::GetTextLineHeightWithSpacing() * 12;
+        if (!ImGui::BeginTable("##RemoteResults", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg,
+                               ImVec2(0, height))) {
+            return;
+        }
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableHeadersRow();
+
+        size_t valueSize = GetScanValueSize(type);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(results.size()));
+        while (clipper.Step()) {
+            int first = clipper.DisplayStart;
+            int count = clipper.DisplayEnd - clipper.DisplayStart;
+            std::vector<uint64_t> values(static_cast<size_t>(count));
+            if (count <= MaxRemoteLiveRows) {
+                std::vector<BatchRead> reads;
+                for (int i = 0; i < count; i++) {
+                    values[i] = results[first + i].Value;
+                    reads.push_back({
+                        results[first + i].Address, std::as_writable_bytes(std::span(&values[i], 1)).first(valueSize)
+                    });
+                }
+                m_Source->ReadBatch(reads);
+            }
+
+            for (int i = 0; i < count; i++) {
+                const ScanResultRecord &record = results[first + i];
+                uint64_t value = count <= MaxRemoteLiveRows ? values[i] : record.Value;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%016llX", static_cast<unsigned long long>(record.Address));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(FormatScanValue(value, type).c_str());
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    void DetachTarget() {
+        if (m_Source && m_Client->IsConnected()) {
+            m_Client->Detach(m_Source->GetTargetId());
+        }
+        m_Source.reset();
+        m_Results.reset();
+        m_State = {};
+        // Replies to the old target are dropped unread.
+        m_PendingState = {};
+        m_PendingResults = {};
+    }
+
+    void Disconnect() {
+        DetachTarget();
+        m_Client.reset();
+    }
+
+    std::shared_ptr<TargetProcess> m_Focus;
+
+    std::string m_SocketPath = "/tmp/easy-reverse.sock";
+    std::string m_PidText;
+    std::string m_Status;
+    std::shared_ptr<ScanClient> m_Client;
+    std::shared_ptr<RemoteSource> m_Source;
+
+    int m_Type = 0;
+    int m_Compare = 0;
+    std::string m_ValueText;
+
+    RemoteScanState m_State;
+    std::shared_ptr<const RemoteResults> m_Results;
+    std::future<IpcMessage> m_PendingState;
+    std::future<IpcMessage> m_PendingResults;
+};
@@ -0,0 +1,429 @@
+export module Layers.Targets;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.AddressExpression;
+import Engine.DumpSource;
+import Engine.ProcessMemory;
+import Engine.Scanner;
+import Engine.Session;
+import Engine.Symbols;
+import Engine.Targets;
+
+constexpr const char *ScanCompareNames = "Exact\0Changed\0Unchanged\0Increased\0Decreased\0Filter\0";
+
+// Rows of the result table re-read every frame, further rows show the value of the last scan.
+constexpr int MaxLiveRows = 256;
+
+// One tab per attached process or opened dump, each with its own scan and watch list. Focusing
+// a tab points the memory panels at it.
+export class TargetsLayer : public IUpdatableLayer {
+public:
+    TargetsLayer(std::shared_ptr<TargetSet> targets, std::shared_ptr<TargetProcess> focus)
+        : m_Targets(std::move(targets)), m_Focus(std::move(focus)) {
+    }
+
+    void OnUpdate() override {
+        auto targets = m_Targets->GetTargets();
+        auto now = std::chrono::steady_clock::now();
+        for (const auto &target: targets) {
+            target->Update(now);
+        }
+
+        ImGui::Begin("Targets");
+        DrawAttach();
+
+        if (ImGui::BeginTabBar("##Targets")) {
+            for (const auto &target: targets) {
+                bool open = true;
+                std::string label = target->GetProcessId() != 0
+                                        ? std::format("{} ({})###{}", target->GetName(), target->GetProcessId(),
+                                                      target->GetId())
+                                        : std::format("{}###{}", target->GetName(), target->GetId());
+                if (ImGui::BeginTabItem(label.c_str(), &open)) {
+                    DrawTarget(*target, m_States[target->GetId()]);
+                    ImGui::EndTabItem();
+                }
+                if (!open) {
+                    m_States.erase(target->GetId());
+                    m_Targets->Detach(target->GetId());
+                }
+            }
+            ImGui::EndTabBar();
+        }
+
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    // Per tab input state.
+    struct TargetState {
+        int Type = 0;
+        int Compare = 0;
+        std::string ValueText;
+        bool Group = false;
+        int Window = 64;
+        bool Ordered = true;
+        std::string SessionPath = "session.ers";
+        std::string WatchExpressionText;
+        std::string Status;
+    };
+
+    void DrawAttach() {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::InputText("##Pid", &m_PidText, ImGuiInputTextFlags_CharsDecimal);
+        ImGui::SameLine();
+        if (ImGui::Button("Attach")) {
+            uint32_t pid = 0;
+            auto [ptr, ec] = std::from_chars(m_PidText.data(), m_PidText.data() + m_PidText.size(), pid);
+            if (ec != std::errc{} || !m_Targets->Attach(pid, std::format("pid {}", pid))) {
+                m_AttachError = std::format("cannot attach to {}", m_PidText);
+            } else {
+                m_AttachError.clear();
+            }
+        }
+
+        // Core files and minidumps are recognized by their header, anything else is a raw dump
+        // and needs the address its first byte was read from.
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 12);
+        ImGui::InputTextWithHint("##DumpPath", "dump file", &m_DumpPath);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        ImGui::InputTextWithHint("##RawBase", "raw base (hex)", &m_RawBaseText, ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::SameLine();
+        if (ImGui::Button("Open Dump")) {
+            OpenDumpFile();
+        }
+
+        if (!m_AttachError.empty()) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_AttachError.c_str());
+        }
+    }
+
+    void OpenDumpFile() {
+        std::filesystem::path path = m_DumpPath;
+        uint64_t base = 0;
+        auto [ptr, ec] = std::from_chars(m_RawBaseText.data(), m_RawBaseText.data() + m_RawBaseText.size(), base, 16);
+        auto source = ec == std::errc{} ? OpenRawDump(path, base) : OpenDump(path);
+        if (!source) {
+            m_AttachError = source.error();
+            return;
+        }
+        m_Targets->Add(std::move(*source), path.filename().string());
+        m_AttachError.clear();
+    }
+
+    void DrawTarget(AttachedTarget &target, TargetState &state) {
+        if (ImGui::Button("Focus")) {
+            m_Focus->Set(target.GetSource());
+        }
+        ImGui::SameLine();
+        auto regions = target.GetRegions();
+        ImGui::Text("%zu regions", regions ? regions->size() : size_t{0});
+        ImGui::SameLine();
+        if (ImGui::Button("Refresh")) {
+            target.RefreshRegions();
+        }
+        if (auto symbols = target.GetSymbols()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%zu modules, %zu symbols", symbols->GetModules().size(), symbols->GetSymbolCount());
+        }
+
+        DrawScanControls(target, state);
+        DrawResults(target);
+        DrawWatches(target, state);
+        DrawSession(target, state);
+    }
+
+    void DrawScanControls(AttachedTarget &target, TargetState &state) {
+        auto results = target.GetResults();
+        auto activeScan = target.GetActiveScan();
+
+        // The value type is fixed once there are results.
+        if (results) {
+            state.Type = static_cast<int>(target.GetResultType());
+        }
+        ImGui::BeginDisabled(results != nullptr);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::Combo("##Type", &state.Type, ValueTypeNames.data(), static_cast<int>(ValueTypeNames.size()));
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+        ImGui::Combo("##Compare", &state.Compare, ScanCompareNames);
+        // Comparing against old needs a previous scan, a first scan is Exact or a filter.
+        if (!results && state.Compare != static_cast<int>(ScanCompare::Filter)) {
+            state.Compare = static_cast<int>(ScanCompare::Exact);
+        }
+        ImGui::SameLine();
+        bool group = state.Group && !results;
+        bool filter = state.Compare == static_cast<int>(ScanCompare::Filter) && !group;
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * (group || filter ? 14 : 8));
+        bool bytes = state.Type == static_cast<int>(ScanValueType::Bytes) && !group;
+        ImGui::InputTextWithHint("##Value", group    ? "100 i32:50 f32:3.5"
+                                            : filter ? "value between old*0.9 and old, u8 at +4 == 1"
+                                            : bytes  ? "48 8B 05 ?? ?? ?? ?? C3"
+                                                     : "",
+                                 &state.ValueText);
+
+        ImGui::SameLine();
+        ImGui::BeginDisabled(activeScan != nullptr);
+        if (ImGui::Button(results ? "Next Scan" : group ? "Group Scan" : "First Scan")) {
+            if (group) {
+                auto request = ParseGroupScan(state.ValueText, static_cast<uint32_t>(state.Window), state.Ordered);
+                if (!request) {
+                    state.Status = "invalid group";
+                } else {
+                    state.Status = target.StartGroupScan(std::move(*request)) ? "" : "cannot start scan";
+                }
+            } else {
+                StartScan(target, state);
+            }
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Reset")) {
+            target.ResetScan();
+        }
+
+        // A group of values close together, the first value's matches go on to the next scans.
+        if (!results) {
+            ImGui::Checkbox("Group", &state.Group);
+            if (state.Group) {
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+                ImGui::InputInt("Window", &state.Window, 8, 64);
+                state.Window = std::clamp(state.Window, 1, 4096);
+                ImGui::SameLine();
+                ImGui::Checkbox("Ordered", &state.Ordered);
+            }
+        }
+
+        if (activeScan) {
+            ImGui::ProgressBar(activeScan->GetProgress(), ImVec2(-ImGui::GetFontSize() * 5, 0));
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                activeScan->Cancel();
+            }
+        }
+        if (!state.Status.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", state.Status.c_str());
+        }
+    }
+
+    static void StartScan(AttachedTarget &target, TargetState &state) {
+        ScanRequest request{
+            .Type = static_cast<ScanValueType>(state.Type),
+            .Compare = static_cast<ScanCompare>(state.Compare),
+        };
+        // Strings and byte arrays are searched for as they are, whatever the compare.
+        if (!IsScalarType(request.Type)) {
+            std::optional<BytePattern> pattern;
+            if (request.Type == ScanValueType::Bytes) {
+                pattern = ParsePattern(state.ValueText);
+            } else if (auto bytes = ParseValueBytes(state.ValueText, request.Type)) {
+                pattern = MakePattern(*bytes);
+            }
+            if (!pattern) {
+                state.Status = "invalid value";
+            } else {
+                state.Status = target.StartPatternScan(std::move(*pattern), request.Type) ? "" : "cannot start scan";
+            }
+            return;
+        }
+        if (request.Compare == ScanCompare::Filter) {
+            auto filter = ScanFilter::Compile(state.ValueText, request.Type);
+            if (!filter) {
+                state.Status = filter.error();
+                return;
+            }
+            request.Filter = std::move(*filter);
+            if (request.Filter->UsesOld() && !target.GetResults()) {
+                state.Status = "old needs a previous scan";
+                return;
+            }
+        }
+        auto value = ParseScanValue(state.ValueText, request.Type);
+        if (request.Compare == ScanCompare::Exact && !value) {
+            state.Status = "invalid value";
+        } else {
+            request.Value = value.value_or(0);
+            state.Status = target.StartScan(request) ? "" : "cannot start scan";
+        }
+    }
+
+    void DrawResults(AttachedTarget &target) {
+        auto results = target.GetResults();
+        if (!results) {
+            return;
+        }
+        ScanValueType type = target.GetResultType();
+        ImGui::Text("%zu results", results->size());
+
+        float height = ImGui::GetTextLineHeightWithSpacing() * 12;
+        if (!ImGui::BeginTable("##Results", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg,
+                               ImVec2(0, height))) {
+            return;
+        }
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Location");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("##Watch", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        const auto &process = *target.GetSource();
+        auto symbols = target.GetSymbols();
+        // Strings and byte arrays show as many bytes as the results keep.
+        size_t valueSize = IsScalarType(type) ? GetScanValueSize(type) : sizeof(uint64_t);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(results->size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const ScanResultRecord &record = (*results)[row];
+                uint64_t value = record.Value;
+                if (clipper.DisplayEnd - clipper.DisplayStart <= MaxLiveRows) {
+                    process.Read(record.Address, std::as_writable_bytes(std::span(&value, 1)).first(valueSize));
+                }
+
+                ImGui::TableNextRow();
+                ImGui::PushID(row);
+                ImGui::TableNextColumn();
+                ImGui::Text("%016llX", static_cast<unsigned long long>(record.Address));
+                ImGui::TableNextColumn();
+                DrawLocation(symbols.get(), record.Address);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(FormatScanValue(value, type).c_str());
+                ImGui::TableNextColumn();
+                if (IsScalarType(type) && ImGui::SmallButton("Watch")) {
+                    target.AddWatch(record.Address, type, {});
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    void DrawWatches(AttachedTarget &target, TargetState &state) {
+        // Pointer chains such as [[game.so+1A2B30]+20]+8, of the type selected for scans.
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 16);
+        bool add = ImGui::InputText("##WatchExpression", &state.WatchExpressionText,
+                                    ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::SameLine();
+        add = ImGui::Button("Watch Expression") || add;
+        if (add) {
+            auto expression = AddressExpression::Compile(state.WatchExpressionText);
+            if (!IsScalarType(static_cast<ScanValueType>(state.Type))) {
+                state.Status = "watches need a scalar type";
+            } else if (expression) {
+                target.AddWatch(std::move(*expression), static_cast<ScanValueType>(state.Type), {});
+                state.Status.clear();
+            } else {
+                state.Status = expression.error();
+            }
+        }
+
+        auto watches = target.GetWatches();
+        if (watches.empty()) {
+            return;
+        }
+        if (!ImGui::BeginTable("##Watches", 6, ImGuiTableFlags_RowBg)) {
+            return;
+        }
+        ImGui::TableSetupColumn("Label");
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Location");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Freeze", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("##Remove", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        auto symbols = target.GetSymbols();
+        std::optional<size_t> removed;
+        for (size_t i = 0; i < watches.size(); i++) {
+            const WatchEntry &entry = watches[i];
+            auto type = static_cast<ScanValueType>(entry.Record.Type);
+
+            ImGui::TableNextRow();
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TableNextColumn();
+            std::string_view label = FieldToString(entry.Record.Label);
+            ImGui::TextUnformatted(label.data(), label.data() + label.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%016llX", static_cast<unsigned long long>(entry.Record.Address));
+            ImGui::TableNextColumn();
+            if (entry.Expression) {
+                ImGui::TextUnformatted(entry.Expression->GetText().c_str());
+            } else {
+                DrawLocation(symbols.get(), entry.Record.Address);
+            }
+            ImGui::TableNextColumn();
+            if (entry.Readable) {
+                ImGui::TextUnformatted(FormatScanValue(entry.CurrentValue, type).c_str());
+            } else {
+                ImGui::TextDisabled("??");
+            }
+            ImGui::TableNextColumn();
+            bool frozen = (entry.Record.Flags & WatchFlags::Frozen) != 0;
+            if (ImGui::Checkbox("##Frozen", &frozen)) {
+                target.SetFrozen(i, frozen, entry.CurrentValue);
+            }
+            ImGui::TableNextColumn();
+            if (ImGui::SmallButton("X")) {
+                removed = i;
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+
+        if (removed) {
+            target.RemoveWatch(*removed);
+        }
+    }
+
+    // module+offset or symbol+offset, blank outside every module or while the index loads.
+    static void DrawLocation(const SymbolIndex *symbols, uint64_t address) {
+        if (symbols == nullptr) {
+            return;
+        }
+        std::string location = symbols->Format(address);
+        ImGui::TextUnformatted(location.data(), location.data() + location.size());
+    }
+
+    void DrawSession(AttachedTarget &target, TargetState &state) {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 12);
+        ImGui::InputText("##SessionPath", &state.SessionPath);
+        ImGui::SameLine();
+        if (ImGui::Button("Save Session")) {
+            SessionMetadata metadata{};
+            CopyToField(metadata.GameName, target.GetName());
+            target.SaveSession(state.SessionPath, metadata);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Session")) {
+            auto session = SessionFile::Open(state.SessionPath);
+            if (!session) {
+                state.Status = session.error();
+            } else if (auto loaded = target.LoadSession(*session); !loaded) {
+                state.Status = loaded.error();
+            }
+        }
+    }
+
+    std::shared_ptr<TargetSet> m_Targets;
+    std::shared_ptr<TargetProcess> m_Focus;
+
+    std::string m_PidText;
+    std::string m_DumpPath;
+    std::string m_RawBaseText;
+    std::string m_AttachError;
+    std::unordered_map<uint32_t, TargetState> m_States;
+};
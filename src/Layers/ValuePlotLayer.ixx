@@ -0,0 +1,199 @@
+export module Layers.ValuePlot;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.ValueRecorder;
+import Render.LinePlot;
+
+constexpr std::array<std::array<float, 4>, 6> SeriesColors{{
+    {0.35f, 0.75f, 1.00f, 1.0f},
+    {1.00f, 0.60f, 0.25f, 1.0f},
+    {0.45f, 0.90f, 0.45f, 1.0f},
+    {0.95f, 0.40f, 0.55f, 1.0f},
+    {0.80f, 0.70f, 1.00f, 1.0f},
+    {0.95f, 0.90f, 0.40f, 1.0f},
+}};
+
+// Records selected addresses at a high rate and plots the last few seconds of each. Every pixel
+// column is reduced to the min and max of the samples it covers, drawn as a vertical stroke of
+// one line strip, so spikes stay visible however many samples fall into a column.
+export class ValuePlotLayer : public IUpdatableLayer {
+public:
+    ValuePlotLayer(IBasicContext *context, std::shared_ptr<TargetProcess> target)
+        : m_Recorder(std::move(target)), m_Plot(context, 1, 1) {
+        m_Recorder.SetSampleRate(1000.0);
+    }
+
+    void OnUpdate() override {
+        m_Recorder.Collect();
+
+        ImGui::Begin("Value History");
+        DrawControls();
+        DrawSeriesList();
+        DrawPlot();
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void DrawControls() {
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+        ImGui::InputText("##Address", &m_AddressText, ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5);
+        ImGui::Combo("##Type", &m_TypeIndex, ValueTypeNames.data(), static_cast<int>(ScalarValueTypeCount));
+        ImGui::SameLine();
+        if (ImGui::Button("Record")) {
+            uint64_t address = 0;
+            auto [ptr, ec] = std::from_chars(m_AddressText.data(), m_AddressText.data() + m_AddressText.size(),
+                                             address, 16);
+            if (ec == std::errc{}) {
+                m_Recorder.AddSeries(address, static_cast<ValueType>(m_TypeIndex));
+            }
+        }
+
+        float rate = static_cast<float>(m_Recorder.GetSampleRate());
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        if (ImGui::SliderFloat("Rate (Hz)", &rate, 10.0f, 10000.0f, "%.0f", ImGuiSliderFlags_Logarithmic)) {
+            m_Recorder.SetSampleRate(rate);
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
+        ImGui::SliderFloat("Window (s)", &m_WindowSeconds, 0.1f, 60.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+    }
+
+    void DrawSeriesList() {
+        std::optional<uint32_t> removed;
+        size_t index = 0;
+        m_Recorder.ForEachSeries([&](const ValueRecorder::Series &series) {
+            const auto &color = SeriesColors[index++ % SeriesColors.size()];
+            ImGui::PushID(static_cast<int>(series.Id));
+            ImGui::ColorButton("##Color", ImVec4(color[0], color[1], color[2], color[3]),
+                               ImGuiColorEditFlags_NoTooltip);
+            ImGui::SameLine();
+            if (series.History.Empty()) {
+                ImGui::Text("%016llX  -", static_cast<unsigned long long>(series.Address));
+            } else {
+                ImGui::Text("%016llX  %.6g", static_cast<unsigned long long>(series.Address),
+                            series.History.Latest().Value);
+            }
+            if (series.DroppedSamples > 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%llu dropped)", static_cast<unsigned long long>(series.DroppedSamples));
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Remove")) {
+                removed = series.Id;
+            }
+            ImGui::PopID();
+        });
+
+        if (removed) {
+            m_Recorder.RemoveSeries(*removed);
+        }
+    }
+
+    void DrawPlot() {
+        ImVec2 available = ImGui::GetContentRegionAvail();
+        if (available.x < 2.0f || available.y < 2.0f) {
+            return;
+        }
+
+        auto width = static_cast<uint32_t>(available.x);
+        auto height = static_cast<uint32_t>(available.y);
+        m_Plot.Resize(width, height);
+
+        int64_t endNs = m_Recorder.Now();
+        int64_t startNs = endNs - static_cast<int64_t>(m_WindowSeconds * 1e9);
+
+        // Decimate every series first, all of them share one vertical scale.
+        m_Columns.resize(size_t{width} * CountSeries());
+        SampleRange total;
+        size_t seriesIndex = 0;
+        m_Recorder.ForEachSeries([&](const ValueRecorder::Series &series) {
+            std::span columns(m_Columns.data() + seriesIndex++ * width, width);
+            series.History.Decimate(startNs, endNs, columns);
+            for (const auto &column: columns) {
+                if (!column.Empty()) {
+                    total.Add(column);
+                }
+            }
+        });
+
+        m_Points.clear();
+        m_Series.clear();
+        if (!total.Empty()) {
+            double span = total.Max - total.Min;
+            double padding = span > 0.0 ? span * 0.05 : std::max(std::abs(total.Max) * 0.05, 1.0);
+            double low = total.Min - padding;
+            double high = total.Max + padding;
+            auto toY = [low, high](double value) {
+                return static_cast<float>(1.0 - 2.0 * (value - low) / (high - low));
+            };
+
+            m_Points.reserve(m_Columns.size() * 2);
+            for (size_t s = 0; s < seriesIndex; s++) {
+                size_t first = m_Points.size();
+                for (uint32_t x = 0; x < width; x++) {
+                    const SampleRange &column = m_Columns[s * width + x];
+                    if (column.Empty()) {
+                        continue;
+                    }
+                    float px = (static_cast<float>(x) + 0.5f) / static_cast<float>(width) * 2.0f - 1.0f;
+                    m_Points.push_back({px, toY(column.Min)});
+                    m_Points.push_back({px, toY(column.Max)});
+                }
+                m_SeriesRanges.push_back({first, m_Points.size() - first});
+            }
+
+            // Spans are built after all points were appended, the vector may have reallocated.
+            for (size_t s = 0; s < m_SeriesRanges.size(); s++) {
+                auto [first, count] = m_SeriesRanges[s];
+                m_Series.push_back({
+                    std::span<const PlotPoint>(m_Points.data() + first, count),
+                    SeriesColors[s % SeriesColors.size()]
+                });
+            }
+            m_SeriesRanges.clear();
+
+            m_VisibleRange = SampleRange{low, high};
+        }
+
+        m_Plot.Draw(m_Series);
+        ImGui::Image(m_Plot.GetTextureID(), ImVec2(static_cast<float>(m_Plot.GetExtent().width),
+                                                   static_cast<float>(m_Plot.GetExtent().height)));
+
+        if (ImGui::IsItemHovered() && !m_VisibleRange.Empty()) {
+            float t = (ImGui::GetMousePos().y - ImGui::GetItemRectMin().y) / ImGui::GetItemRectSize().y;
+            ImGui::SetTooltip("%.6g\n%.6g .. %.6g", m_VisibleRange.Max - t * (m_VisibleRange.Max - m_VisibleRange.Min),
+                              m_VisibleRange.Min, m_VisibleRange.Max);
+        }
+    }
+
+    size_t CountSeries() const {
+        size_t count = 0;
+        m_Recorder.ForEachSeries([&count](const ValueRecorder::Series &) { count++; });
+        return count;
+    }
+
+    ValueRecorder m_Recorder;
+    LinePlot m_Plot;
+
+    std::string m_AddressText;
+    int m_TypeIndex = 0;
+    float m_WindowSeconds = 5.0f;
+    SampleRange m_VisibleRange;
+
+    // Scratch buffers reused every frame.
+    std::vector<SampleRange> m_Columns;
+    std::vector<PlotPoint> m_Points;
+    std::vector<std::pair<size_t, size_t>> m_SeriesRanges;
+    std::vector<PlotSeries> m_Series;
+};
@@ -0,0 +1,157 @@
+export module Layers.Watchpoints;
+
+import std;
+import ImGui;
+import vulkan_hpp;
+import BasicContext;
+import Engine.ProcessMemory;
+import Engine.Watchpoints;
+
+constexpr const char *WatchpointLengthNames = "1\0" "2\0" "4\0" "8\0";
+constexpr const char *WatchpointKindNames = "Write\0Access\0";
+
+// "Find what writes / accesses this address": collects up to four watchpoints, then arms them
+// all at once in the focused process. Changing the set means stopping and starting again.
+export class WatchpointsLayer : public IUpdatableLayer {
+public:
+    explicit WatchpointsLayer(std::shared_ptr<TargetProcess> focus) : m_Focus(std::move(focus)) {
+    }
+
+    void OnUpdate() override {
+        ImGui::Begin("Watchpoints");
+        if (m_Session) {
+            DrawSession();
+        } else {
+            DrawPending();
+        }
+        if (!m_Status.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_Status.c_str());
+        }
+        ImGui::End();
+    }
+
+    void OnSubmitCommandBuffer(vk::CommandBuffer commandBuffer) override {}
+
+    bool OnEvent(const Event *event) override {
+        return false;
+    }
+
+private:
+    void DrawPending() {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 9);
+        ImGui::InputText("##Address", &m_AddressText, ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 3);
+        ImGui::Combo("##Length", &m_Length, WatchpointLengthNames);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5);
+        ImGui::Combo("##Kind", &m_Kind, WatchpointKindNames);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(m_Pending.size() >= MaxWatchpoints);
+        if (ImGui::Button("Add")) {
+            uint64_t address = 0;
+            auto [end, error] = std::from_chars(m_AddressText.data(), m_AddressText.data() + m_AddressText.size(),
+                                                address, 16);
+            if (error != std::errc{} || m_AddressText.empty()) {
+                m_Status = "invalid address";
+            } else {
+                m_Pending.push_back({
+                    address, static_cast<uint8_t>(1u << m_Length), static_cast<WatchpointKind>(m_Kind)
+                });
+                m_Status.clear();
+            }
+        }
+        ImGui::EndDisabled();
+
+        for (size_t i = 0; i < m_Pending.size(); i++) {
+            ImGui::PushID(static_cast<int>(i));
+            if (ImGui::SmallButton("x")) {
+                m_Pending.erase(m_Pending.begin() + static_cast<ptrdiff_t>(i));
+                ImGui::PopID();
+                break;
+            }
+            ImGui::SameLine();
+            DrawSpec(m_Pending[i]);
+            ImGui::PopID();
+        }
+
+        auto process = m_Focus->Get();
+        uint32_t processId = process ? process->GetProcessId() : 0;
+        ImGui::BeginDisabled(m_Pending.empty() || processId == 0);
+        if (ImGui::Button("Start")) {
+            auto session = WatchpointSession::Start(processId, m_Pending);
+            if (session) {
+                m_Session = std::move(*session);
+                m_Status.clear();
+            } else {
+                m_Status = session.error();
+            }
+        }
+        ImGui::EndDisabled();
+        if (processId == 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("focus a live process first");
+        }
+    }
+
+    void DrawSession() {
+        ImGui::Text("pid %u", m_Session->GetProcessId());
+        ImGui::SameLine();
+        if (ImGui::Button("Stop")) {
+            m_Session.reset();
+            return;
+        }
+        if (!m_Session->IsRunning()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("process exited");
+        }
+
+        auto specs = m_Session->GetSpecs();
+        for (size_t slot = 0; slot < specs.size(); slot++) {
+            const HitCounterTable &hits = m_Session->GetHits(slot);
+            ImGui::PushID(static_cast<int>(slot));
+            ImGui::Separator();
+            DrawSpec(specs[slot]);
+            ImGui::SameLine();
+            ImGui::Text("%llu hits", static_cast<unsigned long long>(hits.GetTotal()));
+            if (hits.GetDropped() != 0) {
+                ImGui::SameLine();
+                ImGui::Text("(%llu past the table)", static_cast<unsigned long long>(hits.GetDropped()));
+            }
+
+            auto counts = hits.Snapshot();
+            float height = ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(std::min<size_t>(counts.size(), 8) + 1);
+            if (!counts.empty() && ImGui::BeginTable("##Hits", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg,
+                                                     ImVec2(0, height))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("After instruction");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableHeadersRow();
+                for (const auto &hit: counts) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%016llX", static_cast<unsigned long long>(hit.InstructionAddress));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(hit.Count));
+                }
+                ImGui::EndTable();
+            }
+            ImGui::PopID();
+        }
+    }
+
+    static void DrawSpec(const WatchpointSpec &spec) {
+        ImGui::Text("%016llX  %u bytes  %s", static_cast<unsigned long long>(spec.Address), spec.Length,
+                    spec.Kind == WatchpointKind::Write ? "write" : "access");
+    }
+
+    std::shared_ptr<TargetProcess> m_Focus;
+
+    std::string m_AddressText;
+    int m_Length = 2;
+    int m_Kind = 0;
+    std::vector<WatchpointSpec> m_Pending;
+    std::string m_Status;
+
+    std::unique_ptr<WatchpointSession> m_Session;
+};
@@ -3,6 +3,16 @@ import BasicContext;
 import Application;
 import vulkan_hpp;
 import ApplicationLayers;
+import Layers.HexView;
+import Layers.Heatmap;
+import Layers.ValuePlot;
+import Layers.Dissector;
+import Layers.Targets;
+import Layers.Server;
+import Layers.Watchpoints;
+import Layers.Disassembly;
+import Engine.ProcessMemory;
+import Engine.Targets;
 import Platform.WindowsUtils;
 import std.compat;
 
@@ -39,7 +49,17 @@ int main() {
     io.Fonts->Build();
 
     basicContext->EmplaceLayer<BackGroundLayer>();
-    basicContext->EmplaceLayer<AppUiLayer>();
+    auto target = std::make_shared<TargetProcess>();
+    auto targets = std::make_shared<TargetSet>(basicContext->GetWorkerPool());
+    basicContext->EmplaceLayer<AppUiLayer>(target, targets);
+    basicContext->EmplaceLayer<TargetsLayer>(targets, target);
+    basicContext->EmplaceLayer<ServerLayer>(target);
+    basicContext->EmplaceLayer<HexViewLayer>(target, targets);
+    basicContext->EmplaceLayer<HeatmapLayer>(basicContext.get(), target);
+    basicContext->EmplaceLayer<ValuePlotLayer>(basicContext.get(), target);
+    basicContext->EmplaceLayer<DissectorLayer>(target);
+    basicContext->EmplaceLayer<WatchpointsLayer>(target);
+    basicContext->EmplaceLayer<DisassemblyLayer>(target);
 
     basicContext->SetClearColor(vk::ClearColorValue(std::array<float, 4>{0.2f, 0.2f, 0.2f, 1.0f}));
 
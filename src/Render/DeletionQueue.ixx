@@ -0,0 +1,163 @@
+export module Render.DeletionQueue;
+
+import std;
+import vulkan_hpp;
+import Render.MemoryAllocator;
+
+// One vector per handle type, cleared in declaration order, so dependent objects
+// (framebuffers, views) are destroyed before what they reference (images, memory).
+template<typename... Handles>
+struct RetiredHandleLists {
+    std::tuple<std::vector<Handles>...> Lists;
+
+    template<typename T>
+    static constexpr bool Contains = (std::same_as<T, Handles> || ...);
+
+    template<typename T>
+    std::vector<T> &Get() {
+        return std::get<std::vector<T>>(Lists);
+    }
+
+    [[nodiscard]] bool Empty() const {
+        return std::apply([](const auto &... lists) { return (lists.empty() && ...); }, Lists);
+    }
+
+    void Clear() {
+        std::apply([](auto &... lists) { (lists.clear(), ...); }, Lists);
+    }
+
+    // Appends every handle to other and leaves the lists empty with their capacity.
+    void MoveTo(RetiredHandleLists &other) {
+        auto move = [](auto &from, auto &to) {
+            to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+            from.clear();
+        };
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (move(std::get<I>(Lists), std::get<I>(other.Lists)), ...);
+        }(std::index_sequence_for<Handles...>{});
+    }
+};
+
+using RetiredHandles = RetiredHandleLists<
+    vk::raii::CommandBuffer,
+    vk::raii::Framebuffer,
+    vk::raii::Pipeline,
+    vk::raii::PipelineLayout,
+    vk::raii::DescriptorSetLayout,
+    vk::raii::RenderPass,
+    vk::raii::DescriptorPool,
+    vk::raii::Sampler,
+    vk::raii::ImageView,
+    vk::raii::Image,
+    vk::raii::Buffer,
+    vk::raii::DeviceMemory,
+    GpuAllocation
+>;
+
+export template<typename T>
+concept RetirableHandle = RetiredHandles::Contains<T>;
+
+// Keeps GPU objects alive until the frames that may still reference them finished.
+// Objects are retired into the bucket of the frame slot being built, tagged with the
+// timeline value that frame signals, and destroyed once the timeline reached it.
+// Buckets keep their capacity, so steady state retirement does not allocate.
+// Released objects are moved out under the lock and destroyed after it, so callbacks
+// may retire more objects, those land in the current bucket.
+export class DeletionQueue {
+public:
+    explicit DeletionQueue(size_t slotCount) : m_Buckets(slotCount) {
+    }
+
+    DeletionQueue(const DeletionQueue &) = delete;
+
+    DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+    ~DeletionQueue() {
+        Flush();
+    }
+
+    template<RetirableHandle T>
+    void Retire(T &&handle) {
+        if constexpr (std::same_as<T, GpuAllocation>) {
+            if (!handle) {
+                return;
+            }
+        } else if (!*handle) {
+            return;
+        }
+        std::lock_guard lock(m_Mutex);
+        m_Buckets[m_CurrentSlot].Handles.template Get<T>().push_back(std::move(handle));
+    }
+
+    // Callbacks run before the handles of the same bucket are destroyed.
+    void Retire(std::move_only_function<void()> callback) {
+        std::lock_guard lock(m_Mutex);
+        m_Buckets[m_CurrentSlot].Callbacks.push_back(std::move(callback));
+    }
+
+    // Called when the frame slot starts being built. Releases every bucket whose frame
+    // finished, then makes slot the destination of further retirements.
+    void BeginFrame(size_t slot, uint64_t frameTimelineValue, uint64_t completedTimelineValue) { {
+            std::lock_guard lock(m_Mutex);
+            for (auto &bucket: m_Buckets) {
+                if (bucket.TimelineValue <= completedTimelineValue) {
+                    bucket.MoveTo(m_Released);
+                }
+            }
+
+            m_CurrentSlot = slot;
+            auto &current = m_Buckets[slot];
+            current.TimelineValue = std::max(current.TimelineValue, frameTimelineValue);
+        }
+        m_Released.Release();
+    }
+
+    // Destroys everything immediately, the device has to be idle. Goes on until callbacks
+    // stop retiring more.
+    void Flush() {
+        while (true) { {
+                std::lock_guard lock(m_Mutex);
+                for (auto &bucket: m_Buckets) {
+                    bucket.MoveTo(m_Released);
+                }
+            }
+            if (m_Released.Empty()) {
+                return;
+            }
+            m_Released.Release();
+        }
+    }
+
+private:
+    struct Bucket {
+        uint64_t TimelineValue = 0;
+        std::vector<std::move_only_function<void()>> Callbacks;
+        RetiredHandles Handles;
+
+        [[nodiscard]] bool Empty() const {
+            return Callbacks.empty() && Handles.Empty();
+        }
+
+        void MoveTo(Bucket &other) {
+            std::ranges::move(Callbacks, std::back_inserter(other.Callbacks));
+            Callbacks.clear();
+            Handles.MoveTo(other.Handles);
+        }
+
+        void Release() {
+            for (auto &callback: Callbacks) {
+                callback();
+            }
+            Callbacks.clear();
+            Handles.Clear();
+        }
+    };
+
+    std::mutex m_Mutex;
+    std::vector<Bucket> m_Buckets;
+    size_t m_CurrentSlot = 0;
+
+    // What BeginFrame and Flush took out of the buckets, released outside the lock. Only the
+    // thread building frames touches it, and it keeps its capacity like the buckets do.
+    Bucket m_Released;
+};
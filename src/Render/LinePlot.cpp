@@ -0,0 +1,395 @@
+module Render.LinePlot;
+
+import Render.Shader;
+
+LinePlot::LinePlot(IBasicContext *context, uint32_t width, uint32_t height)
+    : m_Ctx(context), m_Extent{std::max(width, 1u), std::max(height, 1u)} {
+    Build();
+}
+
+LinePlot::~LinePlot() {
+    RetireResources();
+}
+
+void LinePlot::Resize(uint32_t width, uint32_t height) {
+    width = std::max(width, 1u);
+    height = std::max(height, 1u);
+    if (width != m_Extent.width || height != m_Extent.height) {
+        m_Extent = vk::Extent2D{width, height};
+        m_NeedsRebuild = true;
+    }
+}
+
+void LinePlot::Draw(std::span<const PlotSeries> series) {
+    if (m_NeedsRebuild) {
+        RetireResources();
+        Build();
+        m_NeedsRebuild = false;
+    }
+
+    size_t pointCount = 0;
+    for (const auto &s: series) {
+        pointCount += s.Points.size();
+    }
+
+    UploadSlot *slot = AcquireUploadSlot(std::max<vk::DeviceSize>(pointCount * sizeof(PlotPoint),
+                                                                  sizeof(PlotPoint)));
+    if (slot == nullptr) {
+        return; // every slot is still read by a frame in flight, keep showing the previous plot
+    }
+
+    auto *points = static_cast<PlotPoint *>(slot->Buffer.Allocation.GetMappedData());
+    for (const auto &s: series) {
+        points = std::ranges::copy(s.Points, points).out;
+    }
+
+    vk::CommandBuffer commandBuffer = m_Ctx->AllocateFrameCommandBuffer();
+    RecordCommandBuffer(commandBuffer, *slot, series);
+    slot->LastUseValue = m_Ctx->SubmitBeforeFrame(commandBuffer);
+}
+
+void LinePlot::Build() {
+    CreateImageAndView();
+    CreateRenderPass();
+    CreateGraphicsPipeline();
+    CreateFramebuffer();
+    m_TextureID = AddImGuiTexture(*m_Ctx->GetSampler(), *m_ImageView);
+}
+
+void LinePlot::RetireResources() {
+    auto &deletionQueue = m_Ctx->GetDeletionQueue();
+
+    if (m_TextureID) {
+        deletionQueue.Retire([texture = m_TextureID] {
+            RemoveImGuiTexture(texture);
+        });
+        m_TextureID = {};
+    }
+
+    for (auto &slot: m_UploadSlots) {
+        deletionQueue.Retire(std::move(slot.Buffer.Buffer));
+        deletionQueue.Retire(std::move(slot.Buffer.Allocation));
+    }
+    m_UploadSlots.clear();
+
+    deletionQueue.Retire(std::move(m_Framebuffer));
+    deletionQueue.Retire(std::move(m_GraphicsPipeline));
+    deletionQueue.Retire(std::move(m_PipelineLayout));
+    deletionQueue.Retire(std::move(m_RenderPass));
+    deletionQueue.Retire(std::move(m_ImageView));
+    deletionQueue.Retire(std::move(m_Image));
+    deletionQueue.Retire(std::move(m_ImageAllocation));
+}
+
+void LinePlot::CreateImageAndView() {
+    vk::ImageCreateInfo imageInfo{
+        .imageType = vk::ImageType::e2D,
+        .format = vk::Format::eR8G8B8A8Unorm,
+        .extent = {
+            .width = m_Extent.width,
+            .height = m_Extent.height,
+            .depth = 1
+        },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = vk::SampleCountFlagBits::e1,
+        .tiling = vk::ImageTiling::eOptimal,
+        .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .initialLayout = vk::ImageLayout::eUndefined
+    };
+
+    auto [image, allocation] = m_Ctx->GetMemoryAllocator().CreateImage(imageInfo,
+                                                                        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    m_Image = std::move(image);
+    m_ImageAllocation = std::move(allocation);
+
+    vk::ImageViewCreateInfo viewInfo{
+        .image = *m_Image,
+        .viewType = vk::ImageViewType::e2D,
+        .format = vk::Format::eR8G8B8A8Unorm,
+        .subresourceRange = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    m_ImageView = m_Ctx->GetLogicalDevice().createImageView(viewInfo).value();
+}
+
+void LinePlot::CreateRenderPass() {
+    vk::AttachmentDescription colorAttachment{
+        .format = vk::Format::eR8G8B8A8Unorm,
+        .samples = vk::SampleCountFlagBits::e1,
+        .loadOp = vk::AttachmentLoadOp::eClear,
+        .storeOp = vk::AttachmentStoreOp::eStore,
+        .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
+        .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
+        .initialLayout = vk::ImageLayout::eUndefined,
+        .finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+    };
+
+    vk::AttachmentReference colorAttachmentRef{
+        .attachment = 0,
+        .layout = vk::ImageLayout::eColorAttachmentOptimal
+    };
+
+    vk::SubpassDescription subpass{
+        .pipelineBindPoint = vk::PipelineBindPoint::eGraphics,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachmentRef
+    };
+
+    // Same as ImGuiImageRenderTarget: order against previous frames sampling the image and
+    // make the result visible to the frame that samples it next.
+    vk::SubpassDependency dependencies[] = {
+        {
+            .srcSubpass = vk::SubpassExternal,
+            .dstSubpass = 0,
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                            vk::PipelineStageFlagBits::eFragmentShader,
+            .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite
+        },
+        {
+            .srcSubpass = 0,
+            .dstSubpass = vk::SubpassExternal,
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStageMask = vk::PipelineStageFlagBits::eFragmentShader,
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead
+        }
+    };
+
+    vk::RenderPassCreateInfo renderPassInfo{
+        .attachmentCount = 1,
+        .pAttachments = &colorAttachment,
+        .subpassCount = 1,
+        .pSubpasses = &subpass,
+        .dependencyCount = 2,
+        .pDependencies = dependencies
+    };
+
+    m_RenderPass = m_Ctx->GetLogicalDevice().createRenderPass(renderPassInfo).value();
+}
+
+void LinePlot::CreateGraphicsPipeline() {
+    auto &device = m_Ctx->GetLogicalDevice();
+    vk::raii::ShaderModule vertShaderModule = LoadShaderModule(device, "shaders/line_plot.vert.spv");
+    vk::raii::ShaderModule fragShaderModule = LoadShaderModule(device, "shaders/line_plot.frag.spv");
+
+    std::array shaderStages{
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eVertex,
+            .module = *vertShaderModule,
+            .pName = "main"
+        },
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eFragment,
+            .module = *fragShaderModule,
+            .pName = "main"
+        }
+    };
+
+    vk::VertexInputBindingDescription binding{
+        .binding = 0,
+        .stride = sizeof(PlotPoint),
+        .inputRate = vk::VertexInputRate::eVertex
+    };
+
+    vk::VertexInputAttributeDescription attribute{
+        .location = 0,
+        .binding = 0,
+        .format = vk::Format::eR32G32Sfloat,
+        .offset = 0
+    };
+
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = &binding,
+        .vertexAttributeDescriptionCount = 1,
+        .pVertexAttributeDescriptions = &attribute
+    };
+
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
+        .topology = vk::PrimitiveTopology::eLineStrip,
+        .primitiveRestartEnable = vk::False
+    };
+
+    std::array dynamicStates = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor
+    };
+
+    vk::PipelineDynamicStateCreateInfo dynamicState{
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    vk::PipelineViewportStateCreateInfo viewportState{
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer{
+        .depthClampEnable = vk::False,
+        .rasterizerDiscardEnable = vk::False,
+        .polygonMode = vk::PolygonMode::eFill,
+        .cullMode = vk::CullModeFlagBits::eNone,
+        .frontFace = vk::FrontFace::eClockwise,
+        .depthBiasEnable = vk::False,
+        .lineWidth = 1.0f // wide lines are an optional feature
+    };
+
+    vk::PipelineMultisampleStateCreateInfo multisampling{
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+        .sampleShadingEnable = vk::False
+    };
+
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment{
+        .blendEnable = vk::True,
+        .srcColorBlendFactor = vk::BlendFactor::eSrcAlpha,
+        .dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+        .colorBlendOp = vk::BlendOp::eAdd,
+        .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+        .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+        .alphaBlendOp = vk::BlendOp::eAdd,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+    };
+
+    vk::PipelineColorBlendStateCreateInfo colorBlending{
+        .logicOpEnable = vk::False,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment
+    };
+
+    vk::PushConstantRange pushConstantRange{
+        .stageFlags = vk::ShaderStageFlagBits::eFragment,
+        .offset = 0,
+        .size = sizeof(std::array<float, 4>)
+    };
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo{
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+    m_PipelineLayout = device.createPipelineLayout(pipelineLayoutInfo).value();
+
+    vk::GraphicsPipelineCreateInfo pipelineInfo{
+        .stageCount = static_cast<uint32_t>(shaderStages.size()),
+        .pStages = shaderStages.data(),
+        .pVertexInputState = &vertexInputInfo,
+        .pInputAssemblyState = &inputAssembly,
+        .pViewportState = &viewportState,
+        .pRasterizationState = &rasterizer,
+        .pMultisampleState = &multisampling,
+        .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicState,
+        .layout = *m_PipelineLayout,
+        .renderPass = *m_RenderPass,
+        .subpass = 0
+    };
+    m_GraphicsPipeline = device.createGraphicsPipeline(nullptr, pipelineInfo).value();
+}
+
+void LinePlot::CreateFramebuffer() {
+    vk::ImageView attachments[] = {*m_ImageView};
+
+    vk::FramebufferCreateInfo framebufferInfo{
+        .renderPass = *m_RenderPass,
+        .attachmentCount = 1,
+        .pAttachments = attachments,
+        .width = m_Extent.width,
+        .height = m_Extent.height,
+        .layers = 1
+    };
+
+    m_Framebuffer = m_Ctx->GetLogicalDevice().createFramebuffer(framebufferInfo).value();
+}
+
+LinePlot::UploadSlot *LinePlot::AcquireUploadSlot(vk::DeviceSize size) {
+    UploadSlot *slot = nullptr;
+    for (auto &candidate: m_UploadSlots) {
+        if (m_Ctx->IsTimelineValueReached(candidate.LastUseValue)) {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    if (slot == nullptr) {
+        if (m_UploadSlots.size() == MaxUploadSlots) {
+            return nullptr;
+        }
+        slot = &m_UploadSlots.emplace_back();
+    }
+
+    if (slot->Capacity < size) {
+        auto &deletionQueue = m_Ctx->GetDeletionQueue();
+        deletionQueue.Retire(std::move(slot->Buffer.Buffer));
+        deletionQueue.Retire(std::move(slot->Buffer.Allocation));
+
+        slot->Capacity = std::bit_ceil(size);
+        slot->Buffer = m_Ctx->GetMemoryAllocator().CreateBuffer(
+            slot->Capacity, vk::BufferUsageFlagBits::eVertexBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    }
+
+    return slot;
+}
+
+void LinePlot::RecordCommandBuffer(vk::CommandBuffer commandBuffer, const UploadSlot &slot,
+                                   std::span<const PlotSeries> series) {
+    vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    };
+    commandBuffer.begin(beginInfo);
+
+    vk::RenderPassBeginInfo renderPassInfo{
+        .renderPass = *m_RenderPass,
+        .framebuffer = *m_Framebuffer,
+        .renderArea = vk::Rect2D{
+            .offset = {0, 0},
+            .extent = m_Extent
+        },
+        .clearValueCount = 1,
+        .pClearValues = &m_ClearColor
+    };
+
+    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_GraphicsPipeline);
+
+    vk::Viewport viewport{
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(m_Extent.width),
+        .height = static_cast<float>(m_Extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vk::Rect2D scissor{
+        .offset = {0, 0},
+        .extent = m_Extent
+    };
+    commandBuffer.setViewport(0, viewport);
+    commandBuffer.setScissor(0, scissor);
+    commandBuffer.bindVertexBuffers(0, *slot.Buffer.Buffer, vk::DeviceSize{0});
+
+    uint32_t firstVertex = 0;
+    for (const auto &s: series) {
+        auto count = static_cast<uint32_t>(s.Points.size());
+        if (count >= 2) {
+            commandBuffer.pushConstants<std::array<float, 4>>(*m_PipelineLayout, vk::ShaderStageFlagBits::eFragment,
+                                                              0, s.Color);
+            commandBuffer.draw(count, 1, firstVertex, 0);
+        }
+        firstVertex += count;
+    }
+
+    commandBuffer.endRenderPass();
+    commandBuffer.end();
+}
@@ -0,0 +1,86 @@
+export module Render.LinePlot;
+
+import std;
+import vulkan_hpp;
+import ImGui;
+import BasicContext;
+
+// Point in normalized device coordinates, (-1, -1) is the top left corner of the plot.
+export struct PlotPoint {
+    float X;
+    float Y;
+};
+
+export struct PlotSeries {
+    std::span<const PlotPoint> Points; // drawn as one line strip
+    std::array<float, 4> Color;
+};
+
+// Offscreen line renderer shown with ImGui::Image, set up like ImGuiImageRenderTarget but with a
+// line strip pipeline fed from a host visible vertex buffer. The CPU only produces a couple of
+// points per pixel column, so the cost of a plot does not depend on how much data it summarizes.
+export class LinePlot {
+public:
+    LinePlot(IBasicContext *context, uint32_t width, uint32_t height);
+
+    LinePlot(const LinePlot &) = delete;
+
+    LinePlot &operator=(const LinePlot &) = delete;
+
+    ~LinePlot();
+
+    // Takes effect on the next Draw.
+    void Resize(uint32_t width, uint32_t height);
+
+    // Uploads the points and records the pass for this frame.
+    void Draw(std::span<const PlotSeries> series);
+
+    [[nodiscard]] ImTextureID GetTextureID() const { return m_TextureID; }
+
+    [[nodiscard]] vk::Extent2D GetExtent() const { return m_Extent; }
+
+    vk::ClearValue m_ClearColor{
+        vk::ClearColorValue(std::array<float, 4>{0.08f, 0.08f, 0.09f, 1.0f})
+    };
+
+private:
+    static constexpr uint32_t MaxUploadSlots = 4;
+
+    struct UploadSlot {
+        GpuBuffer Buffer;
+        vk::DeviceSize Capacity = 0;
+        uint64_t LastUseValue = 0;
+    };
+
+    void Build();
+
+    void RetireResources();
+
+    void CreateImageAndView();
+
+    void CreateRenderPass();
+
+    void CreateGraphicsPipeline();
+
+    void CreateFramebuffer();
+
+    UploadSlot *AcquireUploadSlot(vk::DeviceSize size);
+
+    void RecordCommandBuffer(vk::CommandBuffer commandBuffer, const UploadSlot &slot,
+                             std::span<const PlotSeries> series);
+
+    IBasicContext *m_Ctx;
+    vk::Extent2D m_Extent;
+    bool m_NeedsRebuild = false;
+
+    vk::raii::Image m_Image{nullptr};
+    GpuAllocation m_ImageAllocation;
+    vk::raii::ImageView m_ImageView{nullptr};
+    vk::raii::RenderPass m_RenderPass{nullptr};
+    vk::raii::PipelineLayout m_PipelineLayout{nullptr};
+    vk::raii::Pipeline m_GraphicsPipeline{nullptr};
+    vk::raii::Framebuffer m_Framebuffer{nullptr};
+    ImTextureID m_TextureID{};
+
+    std::vector<UploadSlot> m_UploadSlots;
+};
@@ -0,0 +1,370 @@
+module Render.MemoryAllocator;
+
+GpuAllocation::GpuAllocation(GpuAllocation &&other) noexcept
+    : m_Allocator(std::exchange(other.m_Allocator, nullptr)),
+      m_Block(std::exchange(other.m_Block, nullptr)),
+      m_Offset(std::exchange(other.m_Offset, 0)),
+      m_Size(std::exchange(other.m_Size, 0)),
+      m_Order(std::exchange(other.m_Order, 0)) {
+}
+
+GpuAllocation &GpuAllocation::operator=(GpuAllocation &&other) noexcept {
+    if (this != &other) {
+        Reset();
+        m_Allocator = std::exchange(other.m_Allocator, nullptr);
+        m_Block = std::exchange(other.m_Block, nullptr);
+        m_Offset = std::exchange(other.m_Offset, 0);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Order = std::exchange(other.m_Order, 0);
+    }
+    return *this;
+}
+
+GpuAllocation::~GpuAllocation() {
+    Reset();
+}
+
+vk::DeviceMemory GpuAllocation::GetMemory() const {
+    return m_Block ? *m_Block->Memory : vk::DeviceMemory{};
+}
+
+void *GpuAllocation::GetMappedData() const {
+    if (!m_Block || !m_Block->MappedData) {
+        return nullptr;
+    }
+    return static_cast<std::byte *>(m_Block->MappedData) + m_Offset;
+}
+
+void GpuAllocation::Reset() {
+    if (m_Block) {
+        m_Allocator->Free(*this);
+        m_Allocator = nullptr;
+        m_Block = nullptr;
+        m_Offset = 0;
+        m_Size = 0;
+        m_Order = 0;
+    }
+}
+
+GpuMemoryAllocator::GpuMemoryAllocator(const vk::raii::PhysicalDevice &physicalDevice, const vk::raii::Device &device,
+                                       vk::DeviceSize preferredBlockSize)
+    : m_Device(device),
+      m_MemoryProperties(physicalDevice.getMemoryProperties()),
+      m_PreferredBlockSize(std::bit_ceil(preferredBlockSize)) {
+}
+
+std::optional<uint32_t> GpuMemoryAllocator::FindMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required,
+                                                           vk::MemoryPropertyFlags preferred) const {
+    std::optional<uint32_t> fallback;
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+        auto flags = m_MemoryProperties.memoryTypes[i].propertyFlags;
+        if (!(typeBits & (1u << i)) || (flags & required) != required) {
+            continue;
+        }
+        if ((flags & preferred) == preferred) {
+            return i;
+        }
+        if (!fallback) {
+            fallback = i;
+        }
+    }
+    return fallback;
+}
+
+uint32_t GpuMemoryAllocator::OrderForSize(vk::DeviceSize size) {
+    vk::DeviceSize rounded = std::bit_ceil(std::max(size, MinAllocationSize));
+    return static_cast<uint32_t>(std::countr_zero(rounded / MinAllocationSize));
+}
+
+vk::DeviceSize GpuMemoryAllocator::BlockSizeForType(uint32_t memoryTypeIndex) const {
+    // Small heaps (e.g. 256 MiB BAR memory) get proportionally smaller blocks.
+    uint32_t heapIndex = m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    vk::DeviceSize heapSize = m_MemoryProperties.memoryHeaps[heapIndex].size;
+    vk::DeviceSize heapLimited = std::bit_floor(std::max(heapSize / 8, MinAllocationSize));
+    return std::min(m_PreferredBlockSize, heapLimited);
+}
+
+std::unique_ptr<MemoryBlock> GpuMemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, GpuResourceKind kind,
+                                                             vk::DeviceSize size, bool dedicated,
+                                                             const vk::MemoryDedicatedAllocateInfo *dedicatedInfo) {
+    vk::MemoryAllocateInfo allocInfo{
+        .pNext = dedicatedInfo,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryTypeIndex
+    };
+
+    auto memory = m_Device.allocateMemory(allocInfo);
+    if (!memory.has_value()) {
+        return nullptr;
+    }
+
+    auto block = std::make_unique<MemoryBlock>();
+    block->Memory = std::move(memory.value());
+    block->Size = size;
+    block->MemoryTypeIndex = memoryTypeIndex;
+    block->Kind = kind;
+    block->Dedicated = dedicated;
+
+    if (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+        block->MappedData = block->Memory.mapMemory(0, vk::WholeSize);
+    }
+
+    if (!dedicated) {
+        uint32_t maxOrder = OrderForSize(size);
+        block->FreeLists.resize(maxOrder + 1);
+        block->FreeLists[maxOrder].insert(0);
+    }
+
+    return block;
+}
+
+std::optional<vk::DeviceSize> GpuMemoryAllocator::AllocateFromBlock(MemoryBlock &block, uint32_t order) {
+    uint32_t available = order;
+    while (available < block.FreeLists.size() && block.FreeLists[available].empty()) {
+        available++;
+    }
+    if (available >= block.FreeLists.size()) {
+        return std::nullopt;
+    }
+
+    auto &freeList = block.FreeLists[available];
+    vk::DeviceSize offset = *freeList.begin();
+    freeList.erase(freeList.begin());
+
+    // Split down to the requested order, keeping the upper halves free.
+    while (available > order) {
+        available--;
+        block.FreeLists[available].insert(offset + (MinAllocationSize << available));
+    }
+
+    block.UsedBytes += MinAllocationSize << order;
+    block.AllocationCount++;
+    return offset;
+}
+
+GpuAllocation GpuMemoryAllocator::Allocate(const vk::MemoryRequirements &requirements,
+                                           vk::MemoryPropertyFlags required, GpuResourceKind kind, bool dedicated,
+                                           const vk::MemoryDedicatedAllocateInfo *dedicatedInfo) {
+    auto memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, required);
+    if (!memoryTypeIndex) {
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    vk::DeviceSize blockSize = BlockSizeForType(*memoryTypeIndex);
+    vk::DeviceSize needed = std::max(requirements.size, requirements.alignment);
+
+    GpuAllocation allocation;
+    allocation.m_Allocator = this;
+
+    std::lock_guard lock(m_Mutex);
+
+    if (dedicated || needed > blockSize / 2) {
+        auto block = CreateBlock(*memoryTypeIndex, kind, requirements.size, true, dedicatedInfo);
+        if (!block) {
+            throw std::runtime_error("failed to allocate dedicated device memory!");
+        }
+        block->UsedBytes = requirements.size;
+        block->AllocationCount = 1;
+
+        allocation.m_Block = block.get();
+        allocation.m_Size = requirements.size;
+        m_DedicatedBlocks.push_back(std::move(block));
+        return allocation;
+    }
+
+    uint32_t order = OrderForSize(needed);
+    auto &pool = m_Pools[*memoryTypeIndex][static_cast<size_t>(kind)];
+
+    for (auto &block: pool.Blocks) {
+        if (auto offset = AllocateFromBlock(*block, order)) {
+            allocation.m_Block = block.get();
+            allocation.m_Offset = *offset;
+            allocation.m_Size = requirements.size;
+            allocation.m_Order = order;
+            return allocation;
+        }
+    }
+
+    auto block = CreateBlock(*memoryTypeIndex, kind, blockSize, false, nullptr);
+    if (!block) {
+        throw std::runtime_error("failed to allocate device memory block!");
+    }
+
+    auto offset = AllocateFromBlock(*block, order);
+    allocation.m_Block = block.get();
+    allocation.m_Offset = offset.value();
+    allocation.m_Size = requirements.size;
+    allocation.m_Order = order;
+    pool.Blocks.push_back(std::move(block));
+    return allocation;
+}
+
+void GpuMemoryAllocator::Free(GpuAllocation &allocation) {
+    std::lock_guard lock(m_Mutex);
+    MemoryBlock *block = allocation.m_Block;
+
+    if (block->Dedicated) {
+        std::erase_if(m_DedicatedBlocks, [block](const auto &dedicatedBlock) {
+            return dedicatedBlock.get() == block;
+        });
+        return;
+    }
+
+    uint32_t order = allocation.m_Order;
+    vk::DeviceSize offset = allocation.m_Offset;
+    block->UsedBytes -= MinAllocationSize << order;
+    block->AllocationCount--;
+
+    // Merge with the buddy as long as it is free as well.
+    while (order + 1 < block->FreeLists.size()) {
+        vk::DeviceSize buddy = offset ^ (MinAllocationSize << order);
+        auto &freeList = block->FreeLists[order];
+        auto it = freeList.find(buddy);
+        if (it == freeList.end()) {
+            break;
+        }
+        freeList.erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+    block->FreeLists[order].insert(offset);
+
+    // Keep one empty block per pool around to absorb allocate/free churn.
+    if (block->AllocationCount == 0) {
+        auto &pool = m_Pools[block->MemoryTypeIndex][static_cast<size_t>(block->Kind)];
+        size_t emptyBlocks = std::ranges::count_if(pool.Blocks, [](const auto &poolBlock) {
+            return poolBlock->AllocationCount == 0;
+        });
+        if (emptyBlocks > 1) {
+            std::erase_if(pool.Blocks, [block](const auto &poolBlock) {
+                return poolBlock.get() == block;
+            });
+        }
+    }
+}
+
+GpuAllocation GpuMemoryAllocator::AllocateForImage(const vk::raii::Image &image, vk::MemoryPropertyFlags required) {
+    vk::ImageMemoryRequirementsInfo2 requirementsInfo{
+        .pNext = nullptr,
+        .image = *image
+    };
+
+    auto requirementsChain = m_Device.getImageMemoryRequirements2<
+        vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirementsInfo);
+    const auto &requirements = requirementsChain.get<vk::MemoryRequirements2>().memoryRequirements;
+    const auto &dedicatedRequirements = requirementsChain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicatedInfo{
+        .pNext = nullptr,
+        .image = *image,
+        .buffer = nullptr
+    };
+
+    bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    GpuAllocation allocation = Allocate(requirements, required, GpuResourceKind::Optimal, dedicated,
+                                        dedicated ? &dedicatedInfo : nullptr);
+
+    vk::BindImageMemoryInfo bindInfo{
+        .pNext = nullptr,
+        .image = *image,
+        .memory = allocation.GetMemory(),
+        .memoryOffset = allocation.GetOffset()
+    };
+
+    m_Device.bindImageMemory2(bindInfo);
+    return allocation;
+}
+
+GpuAllocation GpuMemoryAllocator::AllocateForBuffer(const vk::raii::Buffer &buffer, vk::MemoryPropertyFlags required) {
+    vk::BufferMemoryRequirementsInfo2 requirementsInfo{
+        .pNext = nullptr,
+        .buffer = *buffer
+    };
+
+    auto requirementsChain = m_Device.getBufferMemoryRequirements2<
+        vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirementsInfo);
+    const auto &requirements = requirementsChain.get<vk::MemoryRequirements2>().memoryRequirements;
+    const auto &dedicatedRequirements = requirementsChain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicatedInfo{
+        .pNext = nullptr,
+        .image = nullptr,
+        .buffer = *buffer
+    };
+
+    bool dedicated = dedicatedRequirements.requiresDedicatedAllocation;
+    GpuAllocation allocation = Allocate(requirements, required, GpuResourceKind::Linear, dedicated,
+                                        dedicated ? &dedicatedInfo : nullptr);
+
+    vk::BindBufferMemoryInfo bindInfo{
+        .pNext = nullptr,
+        .buffer = *buffer,
+        .memory = allocation.GetMemory(),
+        .memoryOffset = allocation.GetOffset()
+    };
+
+    m_Device.bindBufferMemory2(bindInfo);
+    return allocation;
+}
+
+GpuImage GpuMemoryAllocator::CreateImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required) {
+    GpuImage result;
+    result.Image = m_Device.createImage(createInfo).value();
+    result.Allocation = AllocateForImage(result.Image, required);
+    return result;
+}
+
+GpuBuffer GpuMemoryAllocator::CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage,
+                                           vk::MemoryPropertyFlags required) {
+    vk::BufferCreateInfo bufferInfo{
+        .pNext = nullptr,
+        .flags = {},
+        .size = size,
+        .usage = usage,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = nullptr
+    };
+
+    GpuBuffer result;
+    result.Buffer = m_Device.createBuffer(bufferInfo).value();
+    result.Allocation = AllocateForBuffer(result.Buffer, required);
+    return result;
+}
+
+GpuBuffer GpuMemoryAllocator::CreateStagingBuffer(vk::DeviceSize size) {
+    return CreateBuffer(size, vk::BufferUsageFlagBits::eTransferSrc,
+                        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+GpuMemoryStats GpuMemoryAllocator::GetStats() const {
+    GpuMemoryStats stats;
+
+    auto accumulate = [&stats](const MemoryBlock &block) {
+        for (auto *typeStats: {&stats.MemoryTypes[block.MemoryTypeIndex], &stats.Total}) {
+            if (block.Dedicated) {
+                typeStats->DedicatedAllocationCount++;
+            } else {
+                typeStats->BlockCount++;
+            }
+            typeStats->AllocationCount += block.AllocationCount;
+            typeStats->ReservedBytes += block.Size;
+            typeStats->UsedBytes += block.UsedBytes;
+        }
+        stats.DeviceMemoryObjectCount++;
+    };
+
+    std::lock_guard lock(m_Mutex);
+    for (const auto &typePools: m_Pools) {
+        for (const auto &pool: typePools) {
+            for (const auto &block: pool.Blocks) {
+                accumulate(*block);
+            }
+        }
+    }
+    for (const auto &block: m_DedicatedBlocks) {
+        accumulate(*block);
+    }
+
+    return stats;
+}
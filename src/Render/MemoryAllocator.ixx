@@ -0,0 +1,159 @@
+export module Render.MemoryAllocator;
+
+import std;
+import vulkan_hpp;
+
+class GpuMemoryAllocator;
+struct MemoryBlock;
+
+// Resources that may share a block. Linear (buffers) and optimal (images) resources live in
+// separate blocks so bufferImageGranularity never has to be considered while sub-allocating.
+export enum class GpuResourceKind : uint8_t {
+    Linear = 0,
+    Optimal = 1
+};
+
+// Sub-allocated range of device memory, returned to its block on destruction.
+export class GpuAllocation {
+public:
+    GpuAllocation() = default;
+
+    GpuAllocation(const GpuAllocation &) = delete;
+
+    GpuAllocation &operator=(const GpuAllocation &) = delete;
+
+    GpuAllocation(GpuAllocation &&other) noexcept;
+
+    GpuAllocation &operator=(GpuAllocation &&other) noexcept;
+
+    ~GpuAllocation();
+
+    explicit operator bool() const { return m_Block != nullptr; }
+
+    [[nodiscard]] vk::DeviceMemory GetMemory() const;
+
+    [[nodiscard]] vk::DeviceSize GetOffset() const { return m_Offset; }
+
+    [[nodiscard]] vk::DeviceSize GetSize() const { return m_Size; }
+
+    // Persistently mapped pointer for host visible memory, nullptr otherwise.
+    [[nodiscard]] void *GetMappedData() const;
+
+    void Reset();
+
+private:
+    friend class GpuMemoryAllocator;
+
+    GpuMemoryAllocator *m_Allocator = nullptr;
+    MemoryBlock *m_Block = nullptr;
+    vk::DeviceSize m_Offset = 0;
+    vk::DeviceSize m_Size = 0;
+    uint32_t m_Order = 0;
+};
+
+export struct GpuBuffer {
+    vk::raii::Buffer Buffer{nullptr};
+    GpuAllocation Allocation;
+};
+
+export struct GpuImage {
+    vk::raii::Image Image{nullptr};
+    GpuAllocation Allocation;
+};
+
+export struct GpuMemoryTypeStats {
+    uint32_t BlockCount = 0;
+    uint32_t DedicatedAllocationCount = 0;
+    uint32_t AllocationCount = 0;
+    vk::DeviceSize ReservedBytes = 0; // vkAllocateMemory'd
+    vk::DeviceSize UsedBytes = 0; // handed out, including buddy rounding
+};
+
+export struct GpuMemoryStats {
+    std::array<GpuMemoryTypeStats, vk::MaxMemoryTypes> MemoryTypes{};
+    GpuMemoryTypeStats Total{};
+    uint32_t DeviceMemoryObjectCount = 0;
+};
+
+// One vk::DeviceMemory, either split with a buddy scheme or backing a single dedicated resource.
+struct MemoryBlock {
+    vk::raii::DeviceMemory Memory{nullptr};
+    void *MappedData = nullptr;
+    vk::DeviceSize Size = 0;
+    uint32_t MemoryTypeIndex = 0;
+    GpuResourceKind Kind = GpuResourceKind::Linear;
+    bool Dedicated = false;
+
+    // FreeLists[order] holds offsets of free ranges of MinAllocationSize << order bytes.
+    std::vector<std::set<vk::DeviceSize>> FreeLists;
+    vk::DeviceSize UsedBytes = 0;
+    uint32_t AllocationCount = 0;
+};
+
+// Owns device memory for render targets and buffers. Small resources are sub-allocated from
+// large per memory type blocks with a buddy allocator, large resources and those the driver
+// asks for get dedicated allocations. Memory properties are queried once on construction.
+export class GpuMemoryAllocator {
+public:
+    static constexpr vk::DeviceSize MinAllocationSize = 256;
+    static constexpr vk::DeviceSize DefaultBlockSize = 64ull * 1024 * 1024;
+
+    GpuMemoryAllocator(const vk::raii::PhysicalDevice &physicalDevice, const vk::raii::Device &device,
+                       vk::DeviceSize preferredBlockSize = DefaultBlockSize);
+
+    GpuMemoryAllocator(const GpuMemoryAllocator &) = delete;
+
+    GpuMemoryAllocator &operator=(const GpuMemoryAllocator &) = delete;
+
+    [[nodiscard]] const vk::PhysicalDeviceMemoryProperties &GetMemoryProperties() const { return m_MemoryProperties; }
+
+    // Picks the first type allowed by typeBits that has every required flag, favouring types
+    // that also have the preferred flags.
+    [[nodiscard]] std::optional<uint32_t> FindMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required,
+                                                         vk::MemoryPropertyFlags preferred = {}) const;
+
+    GpuAllocation Allocate(const vk::MemoryRequirements &requirements, vk::MemoryPropertyFlags required,
+                           GpuResourceKind kind, bool dedicated = false,
+                           const vk::MemoryDedicatedAllocateInfo *dedicatedInfo = nullptr);
+
+    // Allocates and binds memory for an existing image or buffer.
+    GpuAllocation AllocateForImage(const vk::raii::Image &image, vk::MemoryPropertyFlags required);
+
+    GpuAllocation AllocateForBuffer(const vk::raii::Buffer &buffer, vk::MemoryPropertyFlags required);
+
+    GpuImage CreateImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required);
+
+    GpuBuffer CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags required);
+
+    // Host visible, coherent and persistently mapped, for uploads.
+    GpuBuffer CreateStagingBuffer(vk::DeviceSize size);
+
+    [[nodiscard]] GpuMemoryStats GetStats() const;
+
+private:
+    friend class GpuAllocation;
+
+    struct Pool {
+        std::vector<std::unique_ptr<MemoryBlock>> Blocks;
+    };
+
+    static uint32_t OrderForSize(vk::DeviceSize size);
+
+    std::unique_ptr<MemoryBlock> CreateBlock(uint32_t memoryTypeIndex, GpuResourceKind kind, vk::DeviceSize size,
+                                             bool dedicated, const vk::MemoryDedicatedAllocateInfo *dedicatedInfo);
+
+    static std::optional<vk::DeviceSize> AllocateFromBlock(MemoryBlock &block, uint32_t order);
+
+    void Free(GpuAllocation &allocation);
+
+    vk::DeviceSize BlockSizeForType(uint32_t memoryTypeIndex) const;
+
+    const vk::raii::Device &m_Device;
+    vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
+    vk::DeviceSize m_PreferredBlockSize;
+
+    mutable std::mutex m_Mutex;
+    // [memory type][resource kind]
+    std::array<std::array<Pool, 2>, vk::MaxMemoryTypes> m_Pools;
+    std::vector<std::unique_ptr<MemoryBlock>> m_DedicatedBlocks;
+};
@@ -0,0 +1,329 @@
+module Render.MemoryHeatmap;
+
+import Render.Shader;
+
+MemoryHeatmap::MemoryHeatmap(IBasicContext *context, uint32_t width, uint32_t height)
+    : m_Ctx(context), m_Extent{std::max(width, 1u), std::max(height, 1u)} {
+    CreatePipeline();
+
+    vk::SamplerCreateInfo samplerInfo{
+        .magFilter = vk::Filter::eNearest, // keep cells crisp when the panel is larger than the map
+        .minFilter = vk::Filter::eNearest,
+        .mipmapMode = vk::SamplerMipmapMode::eNearest,
+        .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+        .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+        .addressModeW = vk::SamplerAddressMode::eClampToEdge,
+        .maxLod = 0.0f
+    };
+    m_Sampler = m_Ctx->GetLogicalDevice().createSampler(samplerInfo).value();
+
+    Build();
+}
+
+MemoryHeatmap::~MemoryHeatmap() {
+    RetireResources();
+
+    auto &deletionQueue = m_Ctx->GetDeletionQueue();
+    deletionQueue.Retire(std::move(m_Pipeline));
+    deletionQueue.Retire(std::move(m_PipelineLayout));
+    deletionQueue.Retire(std::move(m_DescriptorSetLayout));
+    deletionQueue.Retire(std::move(m_Sampler));
+}
+
+void MemoryHeatmap::Resize(uint32_t width, uint32_t height) {
+    width = std::max(width, 1u);
+    height = std::max(height, 1u);
+    if (width != m_Extent.width || height != m_Extent.height) {
+        m_Extent = vk::Extent2D{width, height};
+        m_NeedsRebuild = true;
+    }
+}
+
+void MemoryHeatmap::Update(std::span<const HeatmapCell> cells, HeatmapMode mode, uint32_t maxChangeCount) {
+    if (m_NeedsRebuild) {
+        RetireResources();
+        Build();
+        m_NeedsRebuild = false;
+    }
+
+    size_t cellCount = std::min<size_t>(cells.size(), size_t{m_Extent.width} * m_Extent.height);
+    UploadSlot *slot = AcquireUploadSlot(std::max<vk::DeviceSize>(cellCount * sizeof(HeatmapCell),
+                                                                  sizeof(HeatmapCell)));
+    if (slot == nullptr) {
+        return; // every slot is still read by a frame in flight, keep showing the previous map
+    }
+
+    std::memcpy(slot->Buffer.Allocation.GetMappedData(), cells.data(), cellCount * sizeof(HeatmapCell));
+
+    PushConstants params{
+        .CellCount = static_cast<uint32_t>(cellCount),
+        .Width = m_Extent.width,
+        .Mode = static_cast<uint32_t>(mode),
+        .MaxChangeCount = maxChangeCount
+    };
+
+    vk::CommandBuffer commandBuffer = m_Ctx->AllocateFrameCommandBuffer();
+    RecordCommandBuffer(commandBuffer, *slot, params);
+    slot->LastUseValue = m_Ctx->SubmitBeforeFrame(commandBuffer);
+}
+
+void MemoryHeatmap::Build() {
+    CreateImageAndView();
+    CreateDescriptorPool();
+    m_TextureID = AddImGuiTexture(*m_Sampler, *m_ImageView);
+}
+
+void MemoryHeatmap::RetireResources() {
+    auto &deletionQueue = m_Ctx->GetDeletionQueue();
+
+    if (m_TextureID) {
+        deletionQueue.Retire([texture = m_TextureID] {
+            RemoveImGuiTexture(texture);
+        });
+        m_TextureID = {};
+    }
+
+    for (auto &slot: m_UploadSlots) {
+        deletionQueue.Retire(std::move(slot.Buffer.Buffer));
+        deletionQueue.Retire(std::move(slot.Buffer.Allocation));
+    }
+    m_UploadSlots.clear();
+
+    // Frees the slots' descriptor sets with it.
+    deletionQueue.Retire(std::move(m_DescriptorPool));
+    deletionQueue.Retire(std::move(m_ImageView));
+    deletionQueue.Retire(std::move(m_Image));
+    deletionQueue.Retire(std::move(m_ImageAllocation));
+    m_ImageLayout = vk::ImageLayout::eUndefined;
+}
+
+void MemoryHeatmap::CreateImageAndView() {
+    vk::ImageCreateInfo imageInfo{
+        .imageType = vk::ImageType::e2D,
+        .format = vk::Format::eR8G8B8A8Unorm, // storage image support is mandatory for this format
+        .extent = {
+            .width = m_Extent.width,
+            .height = m_Extent.height,
+            .depth = 1
+        },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = vk::SampleCountFlagBits::e1,
+        .tiling = vk::ImageTiling::eOptimal,
+        .usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .initialLayout = vk::ImageLayout::eUndefined
+    };
+
+    auto [image, allocation] = m_Ctx->GetMemoryAllocator().CreateImage(imageInfo,
+                                                                        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    m_Image = std::move(image);
+    m_ImageAllocation = std::move(allocation);
+
+    vk::ImageViewCreateInfo viewInfo{
+        .image = *m_Image,
+        .viewType = vk::ImageViewType::e2D,
+        .format = vk::Format::eR8G8B8A8Unorm,
+        .subresourceRange = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    m_ImageView = m_Ctx->GetLogicalDevice().createImageView(viewInfo).value();
+}
+
+void MemoryHeatmap::CreatePipeline() {
+    auto &device = m_Ctx->GetLogicalDevice();
+
+    std::array bindings{
+        vk::DescriptorSetLayoutBinding{
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute
+        },
+        vk::DescriptorSetLayoutBinding{
+            .binding = 1,
+            .descriptorType = vk::DescriptorType::eStorageImage,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute
+        }
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo{
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+    m_DescriptorSetLayout = device.createDescriptorSetLayout(layoutInfo).value();
+
+    vk::PushConstantRange pushConstantRange{
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = sizeof(PushConstants)
+    };
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo{
+        .setLayoutCount = 1,
+        .pSetLayouts = &*m_DescriptorSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+    m_PipelineLayout = device.createPipelineLayout(pipelineLayoutInfo).value();
+
+    vk::raii::ShaderModule shaderModule = LoadShaderModule(device, "shaders/memory_heatmap.comp.spv");
+
+    vk::ComputePipelineCreateInfo pipelineInfo{
+        .stage = {
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = *shaderModule,
+            .pName = "main"
+        },
+        .layout = *m_PipelineLayout
+    };
+    m_Pipeline = device.createComputePipeline(nullptr, pipelineInfo).value();
+}
+
+void MemoryHeatmap::CreateDescriptorPool() {
+    std::array poolSizes{
+        vk::DescriptorPoolSize{
+            .type = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = MaxUploadSlots
+        },
+        vk::DescriptorPoolSize{
+            .type = vk::DescriptorType::eStorageImage,
+            .descriptorCount = MaxUploadSlots
+        }
+    };
+
+    vk::DescriptorPoolCreateInfo poolInfo{
+        .maxSets = MaxUploadSlots,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    };
+    m_DescriptorPool = m_Ctx->GetLogicalDevice().createDescriptorPool(poolInfo).value();
+}
+
+MemoryHeatmap::UploadSlot *MemoryHeatmap::AcquireUploadSlot(vk::DeviceSize size) {
+    UploadSlot *slot = nullptr;
+    for (auto &candidate: m_UploadSlots) {
+        if (m_Ctx->IsTimelineValueReached(candidate.LastUseValue)) {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    vk::Device device = *m_Ctx->GetLogicalDevice();
+    if (slot == nullptr) {
+        if (m_UploadSlots.size() == MaxUploadSlots) {
+            return nullptr;
+        }
+
+        slot = &m_UploadSlots.emplace_back();
+        vk::DescriptorSetAllocateInfo allocInfo{
+            .descriptorPool = *m_DescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &*m_DescriptorSetLayout
+        };
+        slot->DescriptorSet = device.allocateDescriptorSets(allocInfo).value.front();
+
+        vk::DescriptorImageInfo imageInfo{
+            .imageView = *m_ImageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+        };
+        vk::WriteDescriptorSet imageWrite{
+            .dstSet = slot->DescriptorSet,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageImage,
+            .pImageInfo = &imageInfo
+        };
+        device.updateDescriptorSets(imageWrite, {});
+    }
+
+    if (slot->Capacity < size) {
+        // The slot is idle, its old buffer only has to outlive frames that are already done.
+        auto &deletionQueue = m_Ctx->GetDeletionQueue();
+        deletionQueue.Retire(std::move(slot->Buffer.Buffer));
+        deletionQueue.Retire(std::move(slot->Buffer.Allocation));
+
+        slot->Capacity = std::bit_ceil(size);
+        slot->Buffer = m_Ctx->GetMemoryAllocator().CreateBuffer(
+            slot->Capacity, vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        vk::DescriptorBufferInfo bufferInfo{
+            .buffer = *slot->Buffer.Buffer,
+            .offset = 0,
+            .range = slot->Capacity
+        };
+        vk::WriteDescriptorSet bufferWrite{
+            .dstSet = slot->DescriptorSet,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfo
+        };
+        device.updateDescriptorSets(bufferWrite, {});
+    }
+
+    return slot;
+}
+
+void MemoryHeatmap::RecordCommandBuffer(vk::CommandBuffer commandBuffer, const UploadSlot &slot,
+                                        const PushConstants &params) {
+    vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    };
+    commandBuffer.begin(beginInfo);
+
+    vk::ImageSubresourceRange range{
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1
+    };
+
+    // Previous frames sample the image in their fragment shaders, wait for them before writing.
+    vk::ImageMemoryBarrier2 toGeneral{
+        .srcStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+        .srcAccessMask = {},
+        .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .oldLayout = m_ImageLayout,
+        .newLayout = vk::ImageLayout::eGeneral,
+        .image = *m_Image,
+        .subresourceRange = range
+    };
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo{
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &toGeneral
+    });
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *m_Pipeline);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *m_PipelineLayout, 0, slot.DescriptorSet, {});
+    commandBuffer.pushConstants<PushConstants>(*m_PipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, params);
+    commandBuffer.dispatch((m_Extent.width + 15) / 16, (m_Extent.height + 15) / 16, 1);
+
+    vk::ImageMemoryBarrier2 toShaderRead{
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead,
+        .oldLayout = vk::ImageLayout::eGeneral,
+        .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .image = *m_Image,
+        .subresourceRange = range
+    };
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo{
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &toShaderRead
+    });
+    m_ImageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    commandBuffer.end();
+}
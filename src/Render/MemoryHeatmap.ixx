@@ -0,0 +1,98 @@
+export module Render.MemoryHeatmap;
+
+import std;
+import vulkan_hpp;
+import ImGui;
+import BasicContext;
+
+export enum class HeatmapMode : uint32_t {
+    Entropy = 0,
+    ChangeFrequency = 1,
+    Value = 2
+};
+
+// Layout matches struct Cell in shaders/memory_heatmap.comp.
+export struct HeatmapCell {
+    float Entropy = 0.0f;
+    uint32_t ChangeCount = 0;
+    uint32_t FirstWord = 0;
+    uint32_t Flags = 0;
+};
+
+export namespace HeatmapCellFlags {
+    constexpr uint32_t Readable = 1 << 0;
+}
+
+// Texture with one pixel per memory cell, colored by a compute shader from per cell statistics.
+// The cells are copied into a persistently mapped storage buffer and the dispatch is submitted
+// ahead of the frame that samples the texture, so the CPU cost is a memcpy however many cells.
+export class MemoryHeatmap {
+public:
+    MemoryHeatmap(IBasicContext *context, uint32_t width, uint32_t height);
+
+    MemoryHeatmap(const MemoryHeatmap &) = delete;
+
+    MemoryHeatmap &operator=(const MemoryHeatmap &) = delete;
+
+    ~MemoryHeatmap();
+
+    // Takes effect on the next Update.
+    void Resize(uint32_t width, uint32_t height);
+
+    // Uploads cells (row major, width cells per row) and records the compute pass for this frame.
+    void Update(std::span<const HeatmapCell> cells, HeatmapMode mode, uint32_t maxChangeCount);
+
+    [[nodiscard]] ImTextureID GetTextureID() const { return m_TextureID; }
+
+    [[nodiscard]] vk::Extent2D GetExtent() const { return m_Extent; }
+
+private:
+    // Upload buffers are reused once the frame that read them finished.
+    static constexpr uint32_t MaxUploadSlots = 4;
+
+    struct UploadSlot {
+        GpuBuffer Buffer;
+        vk::DeviceSize Capacity = 0;
+        vk::DescriptorSet DescriptorSet{nullptr};
+        uint64_t LastUseValue = 0;
+    };
+
+    struct PushConstants {
+        uint32_t CellCount;
+        uint32_t Width;
+        uint32_t Mode;
+        uint32_t MaxChangeCount;
+    };
+
+    void Build();
+
+    void RetireResources();
+
+    void CreateImageAndView();
+
+    void CreatePipeline();
+
+    void CreateDescriptorPool();
+
+    UploadSlot *AcquireUploadSlot(vk::DeviceSize size);
+
+    void RecordCommandBuffer(vk::CommandBuffer commandBuffer, const UploadSlot &slot, const PushConstants &params);
+
+    IBasicContext *m_Ctx;
+    vk::Extent2D m_Extent;
+    bool m_NeedsRebuild = false;
+
+    vk::raii::Image m_Image{nullptr};
+    GpuAllocation m_ImageAllocation;
+    vk::raii::ImageView m_ImageView{nullptr};
+    vk::ImageLayout m_ImageLayout = vk::ImageLayout::eUndefined;
+    vk::raii::Sampler m_Sampler{nullptr};
+    ImTextureID m_TextureID{};
+
+    vk::raii::DescriptorSetLayout m_DescriptorSetLayout{nullptr};
+    vk::raii::PipelineLayout m_PipelineLayout{nullptr};
+    vk::raii::Pipeline m_Pipeline{nullptr};
+    vk::raii::DescriptorPool m_DescriptorPool{nullptr};
+
+    std::vector<UploadSlot> m_UploadSlots;
+};
@@ -0,0 +1,17 @@
+export module Render.Shader;
+
+import std;
+import vulkan_hpp;
+import Util;
+
+// Loads a compiled SPIR-V file, paths are relative to the working directory like "shaders/x.spv".
+export vk::raii::ShaderModule LoadShaderModule(const vk::raii::Device &device, const std::filesystem::path &path) {
+    std::vector<char> code = ReadFileBin(path);
+
+    vk::ShaderModuleCreateInfo createInfo{
+        .codeSize = code.size(),
+        .pCode = reinterpret_cast<const uint32_t *>(code.data())
+    };
+
+    return device.createShaderModule(createInfo).value();
+}
@@ -0,0 +1,247 @@
+export module WorkerPool;
+
+import std;
+
+export enum class WorkClass : uint8_t {
+    Interactive, // short, latency sensitive: watch polling, single reads
+    Bulk // long running work split into chunks: scans
+};
+
+// Fixed-size pool of worker threads shared by the renderer and the memory engine.
+// Thread index 0 always refers to the thread that created the pool (the UI thread),
+// workers are numbered 1..GetWorkerCount(), so per-thread resources can be kept
+// in a flat array of GetThreadCount() entries. Every other thread is ForeignThread and
+// has no slot there.
+//
+// Besides the pool wide queue behind Submit and ParallelFor, work can go to queues made with
+// AddQueue, usually one Interactive and one Bulk queue per attached target. Workers take one
+// task at a time: pool wide tasks first, then Interactive queues, then Bulk ones, going round
+// robin within each class, so a target with a huge scan queued gets the same share of the pool
+// as one with a small scan, and nobody's polling waits behind more than the chunks currently
+// running.
+export class WorkerPool {
+public:
+    using QueueId = uint32_t;
+    using Task = std::move_only_function<void()>;
+
+    static constexpr size_t ForeignThread = ~size_t{0};
+
+    explicit WorkerPool(size_t workerCount = DefaultWorkerCount()) : m_OwnerThread(std::this_thread::get_id()) {
+        m_Workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++) {
+            m_Workers.emplace_back([this, threadIndex = i + 1](std::stop_token stopToken) {
+                WorkerLoop(stopToken, threadIndex);
+            });
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool() {
+        for (auto &worker: m_Workers) {
+            worker.request_stop();
+        }
+        m_Condition.notify_all();
+        m_Workers.clear();
+
+        // Dropped tasks may own the last reference to whoever owns a queue, and that owner
+        // calls RemoveQueue, so they are destroyed outside the lock and outside the queues.
+        std::deque<Task> pendingTasks;
+        std::array<ClassQueues, 2> pendingClasses; {
+            std::lock_guard lock(m_Mutex);
+            pendingTasks.swap(m_Tasks);
+            pendingClasses.swap(m_Classes);
+        }
+    }
+
+    static size_t DefaultWorkerCount() {
+        auto hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    [[nodiscard]] size_t GetWorkerCount() const { return m_Workers.size(); }
+
+    [[nodiscard]] size_t GetThreadCount() const { return m_Workers.size() + 1; }
+
+    // Index of the calling thread inside this pool: 0 for the thread that created it, 1.. for its
+    // workers, ForeignThread for anything else, including workers of another pool.
+    [[nodiscard]] size_t GetThreadIndex() const {
+        if (s_Pool == this) {
+            return s_ThreadIndex;
+        }
+        return std::this_thread::get_id() == m_OwnerThread ? 0 : ForeignThread;
+    }
+
+    template<typename F>
+    auto Submit(F &&func) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        std::packaged_task<Result()> task(std::forward<F>(func));
+        auto future = task.get_future();
+        Enqueue(std::move(task));
+        return future;
+    }
+
+    // Runs func(index, threadIndex) for every index in [0, count). The calling thread
+    // takes part in the work, with ForeignThread as its index when it is not one of the pool's,
+    // and the call returns once every index has been processed.
+    // Helpers that only start once the caller has taken the last index, for example because
+    // the workers were busy with scan chunks, are not waited for.
+    template<typename F>
+        requires std::invocable<F &, size_t, size_t>
+    void ParallelFor(size_t count, F &&func) {
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || m_Workers.empty()) {
+            for (size_t i = 0; i < count; i++) {
+                func(i, GetThreadIndex());
+            }
+            return;
+        }
+
+        // Shared, a late helper may still look at it after the call returned.
+        struct Progress {
+            std::atomic<size_t> NextIndex{0};
+            std::atomic<size_t> Finished{0};
+        };
+        auto progress = std::make_shared<Progress>();
+        size_t helperCount = std::min(count - 1, m_Workers.size());
+
+        auto drain = [this, progress, count, body = &func] {
+            size_t threadIndex = GetThreadIndex();
+            for (size_t i = progress->NextIndex.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = progress->NextIndex.fetch_add(1, std::memory_order_relaxed)) {
+                (*body)(i, threadIndex);
+                if (progress->Finished.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                    progress->Finished.notify_all();
+                }
+            }
+        };
+
+        for (size_t i = 0; i < helperCount; i++) {
+            Enqueue(drain);
+        }
+
+        drain();
+        for (size_t finished = progress->Finished.load(std::memory_order_acquire); finished < count;
+             finished = progress->Finished.load(std::memory_order_acquire)) {
+            progress->Finished.wait(finished, std::memory_order_acquire);
+        }
+    }
+
+    QueueId AddQueue(WorkClass workClass) {
+        std::lock_guard lock(m_Mutex);
+        QueueId id = m_NextQueueId++;
+        m_Classes[static_cast<size_t>(workClass)].Queues.push_back({id, {}});
+        return id;
+    }
+
+    // Drops tasks that did not start yet, running ones finish normally.
+    void RemoveQueue(QueueId id) {
+        std::lock_guard lock(m_Mutex);
+        for (auto &workClass: m_Classes) {
+            std::erase_if(workClass.Queues, [id](const Queue &queue) { return queue.Id == id; });
+            workClass.Next = 0;
+        }
+    }
+
+    // Does nothing once the queue was removed.
+    void Submit(QueueId id, Task task) { {
+            std::lock_guard lock(m_Mutex);
+            Queue *queue = FindQueue(id);
+            if (queue == nullptr) {
+                return;
+            }
+            queue->Tasks.push_back(std::move(task));
+        }
+        m_Condition.notify_one();
+    }
+
+    [[nodiscard]] size_t GetPendingCount(QueueId id) const {
+        std::lock_guard lock(m_Mutex);
+        const Queue *queue = FindQueue(id);
+        return queue != nullptr ? queue->Tasks.size() : 0;
+    }
+
+private:
+    struct Queue {
+        QueueId Id;
+        std::deque<Task> Tasks;
+    };
+
+    // A deque, growing a vector would copy queues whose move may throw, and tasks are move only.
+    struct ClassQueues {
+        std::deque<Queue> Queues;
+        size_t Next = 0; // round robin cursor
+    };
+
+    void Enqueue(Task task) { {
+            std::lock_guard lock(m_Mutex);
+            m_Tasks.push_back(std::move(task));
+        }
+        m_Condition.notify_one();
+    }
+
+    auto *FindQueue(this auto &self, QueueId id) {
+        for (auto &workClass: self.m_Classes) {
+            for (auto &queue: workClass.Queues) {
+                if (queue.Id == id) {
+                    return &queue;
+                }
+            }
+        }
+        return static_cast<decltype(&self.m_Classes[0].Queues[0])>(nullptr);
+    }
+
+    std::optional<Task> TakeTask() {
+        if (!m_Tasks.empty()) {
+            Task task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+            return task;
+        }
+        for (auto &workClass: m_Classes) {
+            size_t count = workClass.Queues.size();
+            for (size_t i = 0; i < count; i++) {
+                Queue &queue = workClass.Queues[(workClass.Next + i) % count];
+                if (!queue.Tasks.empty()) {
+                    workClass.Next = (workClass.Next + i + 1) % count;
+                    Task task = std::move(queue.Tasks.front());
+                    queue.Tasks.pop_front();
+                    return task;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    void WorkerLoop(std::stop_token stopToken, size_t threadIndex) {
+        s_Pool = this;
+        s_ThreadIndex = threadIndex;
+        while (true) {
+            std::optional<Task> task; {
+                std::unique_lock lock(m_Mutex);
+                m_Condition.wait(lock, stopToken, [&] { return (task = TakeTask()).has_value(); });
+                if (!task) {
+                    return; // stop requested
+                }
+            }
+            (*task)();
+        }
+    }
+
+    inline static thread_local const WorkerPool *s_Pool = nullptr;
+    inline static thread_local size_t s_ThreadIndex = 0;
+
+    std::thread::id m_OwnerThread;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable_any m_Condition;
+    std::deque<Task> m_Tasks;
+    std::array<ClassQueues, 2> m_Classes;
+    QueueId m_NextQueueId = 1;
+
+    // Last member, joined before the queues go away.
+    std::vector<std::jthread> m_Workers;
+};
@@ -0,0 +1,24 @@
+export module Tests.Check;
+
+import std;
+
+// Tests are plain executables. A failed check prints where it failed and the remaining checks
+// still run, main returns TestResult() so the test fails if any of them did.
+
+int g_FailedChecks = 0;
+
+export void Check(bool condition, std::string_view what,
+                  std::source_location where = std::source_location::current()) {
+    if (!condition) {
+        g_FailedChecks++;
+        std::println(std::cerr, "{}:{}: check failed: {}", where.file_name(), where.line(), what);
+    }
+}
+
+export int TestResult() {
+    if (g_FailedChecks != 0) {
+        std::println(std::cerr, "{} checks failed", g_FailedChecks);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Decodes known encodings and checks their length, text and branch target: legacy opcodes under
+// the 66, F2, F3 and REX prefixes, the 0F 38 and 0F 3A maps, two and three byte VEX, EVEX,
+// RIP-relative operands, and instructions cut short by the end of the readable bytes.
+
+import std;
+import Engine.Disassembler;
+import Tests.Check;
+
+constexpr uint64_t Address = 0x401000;
+
+struct DecodeCase {
+    std::string_view Bytes; // hex, spaces ignored
+    uint8_t Length;
+    std::string_view Text;
+    std::optional<uint64_t> BranchTarget = std::nullopt;
+};
+
+constexpr DecodeCase Cases[] = {
+    // Legacy opcodes and their prefixes.
+    {"C3", 1, "ret"},
+    {"90", 1, "nop"},
+    {"F3 90", 2, "pause"},
+    {"48 89 E5", 3, "mov rbp, rsp"},
+    {"66 89 C8", 3, "mov ax, cx"},
+    {"41 50", 2, "push r8"},
+    {"41 90", 2, "xchg r8d, eax"},
+    {"48 B8 88 77 66 55 44 33 22 11", 10, "mov rax, 0x1122334455667788"},
+    {"66 B8 34 12", 4, "mov ax, 0x1234"},
+    {"48 83 EC 28", 4, "sub rsp, 0x28"},
+    {"48 83 C4 F8", 4, "add rsp, -0x8"},
+    {"F3 48 AB", 3, "rep stosq"},
+    {"F2 AE", 2, "repne scasb"},
+    {"F0 48 0F B1 0A", 5, "lock cmpxchg qword ptr [rdx], rcx"},
+    {"8B 44 8D 10", 4, "mov eax, dword ptr [rbp+rcx*4+0x10]"},
+    {"64 48 8B 04 25 28 00 00 00", 9, "mov rax, qword ptr fs:[0x28]"},
+    {"66 0F EF C1", 4, "pxor xmm0, xmm1"},
+    {"0F EF C1", 3, "pxor mm0, mm1"},
+    {"F3 0F 10 44 24 08", 6, "movss xmm0, [rsp+0x8]"},
+    {"F2 0F 58 C1", 4, "addsd xmm0, xmm1"},
+    {"F3 0F 1E FA", 4, "endbr64"},
+    {"0F 0B", 2, "ud2"},
+    // Branches, relative to the end of the instruction.
+    {"E8 FB 0F 00 00", 5, "call 0x402000", 0x402000},
+    {"EB FE", 2, "jmp 0x401000", 0x401000},
+    {"0F 85 FA FF FF FF", 6, "jne 0x401000", 0x401000},
+    // 0F 38 and 0F 3A.
+    {"66 0F 38 00 C1", 5, "pshufb xmm0, xmm1"},
+    {"66 0F 38 30 C1", 5, "pmovzxbw xmm0, xmm1"},
+    {"66 0F 3A 0F C1 08", 6, "palignr xmm0, xmm1, 0x8"},
+    {"66 0F 3A 16 C0 01", 6, "pextrd eax, xmm0, 0x1"},
+    // Two byte VEX.
+    {"C5 F8 77", 3, "vzeroupper"},
+    {"C5 FC 77", 3, "vzeroall"},
+    {"C5 F1 EF C2", 4, "vpxor xmm0, xmm1, xmm2"},
+    {"C5 F5 EF C2", 4, "vpxor ymm0, ymm1, ymm2"},
+    {"C5 FC 5A C1", 4, "vcvtps2pd ymm0, xmm1"},
+    {"C5 FD 5A C1", 4, "vcvtpd2ps xmm0, ymm1"},
+    // Three byte VEX, with the 128-bit operands of lane and broadcast instructions.
+    {"C4 E3 7D 18 C1 01", 6, "vinsertf128 ymm0, ymm0, xmm1, 0x1"},
+    {"C4 E3 7D 19 C1 01", 6, "vextractf128 xmm1, ymm0, 0x1"},
+    {"C4 E2 7D 18 C1", 5, "vbroadcastss ymm0, xmm1"},
+    {"C4 E2 7D 30 C1", 5, "vpmovzxbw ymm0, xmm1"},
+    {"C4 C1 7C 28 C0", 5, "vmovaps ymm0, ymm8"},
+    // EVEX, length only and no operands.
+    {"62 F1 7C 48 10 C1", 6, "vmovups {evex}"},
+    {"62 F1 7C 48 10 40 01", 7, "vmovups {evex}"},
+    {"62 F1 7C 48 10 84 24 00 01 00 00", 11, "vmovups {evex}"},
+    // RIP-relative, from the end of the instruction including any immediate after the disp32.
+    {"48 8B 05 10 00 00 00", 7, "mov rax, qword ptr [0x401017]"},
+    {"48 8D 0D F0 FF FF FF", 7, "lea rcx, [0x400FF7]"},
+    {"C7 05 10 00 00 00 01 00 00 00", 10, "mov dword ptr [0x40101A], 0x1"},
+    {"80 3D 10 00 00 00 00", 7, "cmp byte ptr [0x401017], 0x0"},
+    {"C4 E2 79 18 05 F0 FF FF FF", 9, "vbroadcastss xmm0, [0x400FF9]"},
+    // Prefixes up to the 15 byte limit, and one past it.
+    {"66 66 66 66 66 66 66 66 66 66 66 66 66 66 90", 15, "nop"},
+    {"66 66 66 66 66 66 66 66 66 66 66 66 66 66 66 90", 0, ""},
+    // Invalid in 64-bit mode.
+    {"06", 0, ""},
+    {"27", 0, ""},
+    {"D4 0A", 0, ""},
+    {"9A 00 00 00 00 00 00", 0, ""},
+};
+
+static std::vector<std::byte> ParseBytes(std::string_view hex) {
+    std::vector<std::byte> bytes;
+    for (size_t i = 0; i < hex.size();) {
+        if (hex[i] == ' ') {
+            i++;
+            continue;
+        }
+        uint8_t value = 0;
+        std::from_chars(hex.data() + i, hex.data() + i + 2, value, 16);
+        bytes.push_back(std::byte{value});
+        i += 2;
+    }
+    return bytes;
+}
+
+static void TestKnownEncodings() {
+    for (const auto &decodeCase: Cases) {
+        std::vector<std::byte> bytes = ParseBytes(decodeCase.Bytes);
+        DecodedInstruction instruction = DecodeInstruction(bytes, Address);
+        Check(instruction.Length == decodeCase.Length,
+              std::format("{} is {} bytes long, not {}", decodeCase.Bytes, decodeCase.Length, instruction.Length));
+        if (decodeCase.Length == 0) {
+            continue;
+        }
+        Check(instruction.Text == decodeCase.Text,
+              std::format("{} reads \"{}\", not \"{}\"", decodeCase.Bytes, decodeCase.Text, instruction.Text));
+        Check(instruction.BranchTarget == decodeCase.BranchTarget,
+              std::format("{} has the expected branch target", decodeCase.Bytes));
+
+        // Trailing bytes belong to the next instruction.
+        bytes.resize(bytes.size() + 8, std::byte{0xCC});
+        Check(DecodeInstruction(bytes, Address).Length == decodeCase.Length,
+              std::format("{} followed by more code keeps its length", decodeCase.Bytes));
+    }
+}
+
+// Every proper prefix of a valid instruction, as at the end of the last readable page, fails to
+// decode rather than reading past the end or decoding as something shorter.
+static void TestTruncated() {
+    for (const auto &decodeCase: Cases) {
+        std::vector<std::byte> bytes = ParseBytes(decodeCase.Bytes);
+        if (decodeCase.Length == 0) {
+            continue;
+        }
+        for (size_t size = 0; size < bytes.size(); size++) {
+            // Heap allocated to the exact size, so a read past the end shows under a sanitizer.
+            auto cut = std::make_unique<std::byte[]>(size);
+            std::ranges::copy(std::span(bytes).first(size), cut.get());
+            Check(DecodeInstruction(std::span(cut.get(), size), Address).Length == 0,
+                  std::format("the first {} bytes of {} do not decode", size, decodeCase.Bytes));
+        }
+    }
+
+    // A page ending three bytes into a RIP-relative load, then the same with the next page there.
+    constexpr size_t PageSize = 4096;
+    std::vector<std::byte> page(PageSize + 16, std::byte{0x90});
+    std::vector<std::byte> load = ParseBytes("48 8B 05 10 00 00 00");
+    std::ranges::copy(load, page.begin() + PageSize - 3);
+    auto last = std::span(page).subspan(PageSize - 3);
+    Check(DecodeInstruction(last.first(3), Address + PageSize - 3).Length == 0,
+          "an instruction cut by the end of the page does not decode");
+    DecodedInstruction whole = DecodeInstruction(last, Address + PageSize - 3);
+    Check(whole.Length == 7 && whole.Text == std::format("mov rax, qword ptr [0x{:X}]", Address + PageSize + 0x14),
+          "the same instruction decodes with the next page's bytes");
+}
+
+int main() {
+    TestKnownEncodings();
+    TestTruncated();
+    return TestResult();
+}
@@ -0,0 +1,222 @@
+// Parses dissector schemas, valid and broken, and checks the layouts ParseSchema makes of them.
+// Whatever a schema says, an accepted layout only has fields that lie inside their struct and
+// inline structs that do not contain themselves.
+
+import std;
+import Engine.Dissector;
+import Tests.Check;
+
+static const FieldDef *FindField(const DissectorSchema &schema, std::string_view layout, std::string_view name) {
+    auto index = schema.Find(layout);
+    if (!index) {
+        return nullptr;
+    }
+    for (const auto &field: schema.Layouts[*index].Fields) {
+        if (field.Name == name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+// Expects the schema to be rejected with an error that mentions what.
+static void CheckRejected(std::string_view text, std::string_view what, std::string_view description,
+                          std::source_location where = std::source_location::current()) {
+    auto schema = ParseSchema(text);
+    Check(!schema.has_value(), std::format("{} is rejected", description), where);
+    if (!schema) {
+        Check(schema.error().contains(what),
+              std::format("{} is rejected for the right reason, got \"{}\"", description, schema.error()), where);
+    }
+}
+
+static void TestScalars() {
+    constexpr std::pair<std::string_view, FieldType> Scalars[] = {
+        {"int8", FieldType::Int8}, {"int16", FieldType::Int16}, {"int32", FieldType::Int32},
+        {"int64", FieldType::Int64}, {"uint8", FieldType::UInt8}, {"uint16", FieldType::UInt16},
+        {"uint32", FieldType::UInt32}, {"uint64", FieldType::UInt64}, {"float", FieldType::Float},
+        {"double", FieldType::Double}, {"bool", FieldType::Bool}, {"ptr", FieldType::Pointer},
+    };
+    constexpr uint32_t Sizes[] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8, 1, 8};
+
+    std::string text = "struct Scalars 0x100\n";
+    for (size_t i = 0; i < std::size(Scalars); i++) {
+        text += std::format("    0x{:X} {} field{}\n", i * 8, Scalars[i].first, i);
+    }
+    auto schema = ParseSchema(text);
+    Check(schema.has_value(), "a struct of every scalar parses");
+    if (!schema) {
+        return;
+    }
+    for (size_t i = 0; i < std::size(Scalars); i++) {
+        const FieldDef *field = FindField(*schema, "Scalars", std::format("field{}", i));
+        Check(field != nullptr && field->Type == Scalars[i].second && field->Offset == i * 8 && field->Count == 1,
+              std::format("{} parses as its type at its offset", Scalars[i].first));
+        Check(IsScalar(Scalars[i].second) && GetScalarSize(Scalars[i].second) == Sizes[i],
+              std::format("{} is a scalar of {} bytes", Scalars[i].first, Sizes[i]));
+        Check(field != nullptr && GetFieldSize(*schema, *field) == Sizes[i],
+              std::format("a {} field covers {} bytes", Scalars[i].first, Sizes[i]));
+        Check(std::string_view(GetFieldTypeName(Scalars[i].second)) == Scalars[i].first,
+              std::format("{} is named after itself", Scalars[i].first));
+    }
+
+    std::array<char, 64> out;
+    float health = 1.5f;
+    Check(DecodeScalar(FieldType::Float, std::as_bytes(std::span(&health, 1)), out) == "1.5", "a float decodes");
+    uint64_t pointer = 0x7FF612340000;
+    Check(DecodeScalar(FieldType::Pointer, std::as_bytes(std::span(&pointer, 1)), out) == "0x7FF612340000",
+          "a pointer decodes as hex");
+    int16_t negative = -2;
+    Check(DecodeScalar(FieldType::Int16, std::as_bytes(std::span(&negative, 1)), out) == "-2", "an int16 decodes");
+    std::byte truthy{0x7F};
+    Check(DecodeScalar(FieldType::Bool, std::span(&truthy, 1), out) == "true", "any non-zero bool byte is true");
+    Check(DecodeScalar(FieldType::Int64, std::as_bytes(std::span(&health, 1)), out).empty(),
+          "a scalar with too few bytes decodes to nothing");
+    Check(DecodeScalar(FieldType::Char, std::span(&truthy, 1), out).empty(), "char is not decoded as a scalar");
+}
+
+static void TestCharArrays() {
+    auto schema = ParseSchema("struct Named 0x40\n"
+                              "    0x00 char[32] name\n"
+                              "    0x20 char tag\n"
+                              "    0x21 char[0x1F] rest\n");
+    Check(schema.has_value(), "char arrays parse");
+    if (schema) {
+        const FieldDef *name = FindField(*schema, "Named", "name");
+        Check(name != nullptr && name->Type == FieldType::Char && name->Count == 32 &&
+              GetFieldSize(*schema, *name) == 32, "char[32] is a 32 byte char buffer");
+        const FieldDef *tag = FindField(*schema, "Named", "tag");
+        Check(tag != nullptr && tag->Type == FieldType::Char && tag->Count == 1, "a single char is one byte");
+        const FieldDef *rest = FindField(*schema, "Named", "rest");
+        Check(rest != nullptr && rest->Count == 0x1F, "array lengths take hex");
+        Check(!IsScalar(FieldType::Char) && GetScalarSize(FieldType::Char) == 1, "char is one byte and no scalar");
+    }
+
+    CheckRejected("struct Named 0x20\n    0x00 char[33] name\n", "exceeds", "a char array past the struct");
+    CheckRejected("struct Named 0x20\n    0x00 char[0] name\n", "invalid array length", "an empty char array");
+    CheckRejected("struct Named 0x20\n    0x00 char[x] name\n", "invalid array length", "a char array of no length");
+    CheckRejected("struct Named 0x20\n    0x00 char[4 name\n", "unterminated array", "an unterminated array");
+}
+
+static void TestPointers() {
+    auto schema = ParseSchema("struct Node 0x20\n"
+                              "    0x00 Node* next\n"
+                              "    0x08 Item* item\n"
+                              "    0x10 char* label\n"
+                              "    0x18 float* weights\n"
+                              "struct Item 0x8\n"
+                              "    0x00 int32 id\n");
+    Check(schema.has_value(), "pointers to structs, declared before or after, to char and to scalars parse");
+    if (!schema) {
+        return;
+    }
+    const FieldDef *next = FindField(*schema, "Node", "next");
+    Check(next != nullptr && next->Type == FieldType::Pointer && next->Layout == schema->Find("Node") &&
+          GetFieldSize(*schema, *next) == 8, "a pointer to its own struct points at it");
+    const FieldDef *item = FindField(*schema, "Node", "item");
+    Check(item != nullptr && item->Type == FieldType::Pointer && item->Layout == schema->Find("Item"),
+          "a pointer to a struct defined later is resolved");
+    const FieldDef *label = FindField(*schema, "Node", "label");
+    Check(label != nullptr && label->Type == FieldType::Pointer && !label->Layout &&
+          GetFieldSize(*schema, *label) == 8, "a char* is a plain pointer");
+    const FieldDef *weights = FindField(*schema, "Node", "weights");
+    Check(weights != nullptr && weights->Type == FieldType::Pointer && !weights->Layout,
+          "a pointer to a scalar is a plain pointer");
+
+    auto arrays = ParseSchema("struct Table 0x40\n    0x00 Table*[8] children\n");
+    const FieldDef *children = arrays ? FindField(*arrays, "Table", "children") : nullptr;
+    Check(children != nullptr && children->Type == FieldType::Pointer && children->Count == 8 &&
+          GetFieldSize(*arrays, *children) == 64, "an array of pointers covers eight bytes each");
+
+    CheckRejected("struct Node 0x10\n    0x00 Missing* next\n", "unknown type 'Missing'", "a pointer to no struct");
+    CheckRejected("struct Node 0x10\n    0x00 Missing next\n", "unknown type 'Missing'", "an unknown type");
+}
+
+static void TestNestedStructs() {
+    auto schema = ParseSchema("# comment lines and blank lines are skipped\n"
+                              "\n"
+                              "struct Player 0x60\r\n"
+                              "\t0x30 Vector3[4] path\r\n"
+                              "\t0x00 Vector3 position\r\n"
+                              "\t0x0C float health\r\n"
+                              "struct Vector3 12\n"
+                              "    0 float x\n"
+                              "    4 float y\n"
+                              "    8 float z\n");
+    Check(schema.has_value(), "inline structs, arrays of them, CRLF, tabs and comments parse");
+    if (!schema) {
+        return;
+    }
+    auto player = schema->Find("Player");
+    auto vector = schema->Find("Vector3");
+    Check(player && vector && schema->Layouts[*player].Size == 0x60 && schema->Layouts[*vector].Size == 12,
+          "struct sizes take hex and decimal");
+    const FieldDef *position = FindField(*schema, "Player", "position");
+    Check(position != nullptr && position->Type == FieldType::Struct && position->Layout == vector &&
+          GetFieldSize(*schema, *position) == 12, "an inline struct covers its struct's size");
+    const FieldDef *path = FindField(*schema, "Player", "path");
+    Check(path != nullptr && path->Count == 4 && GetFieldSize(*schema, *path) == 48,
+          "an array of structs covers all of them");
+    if (player) {
+        const auto &fields = schema->Layouts[*player].Fields;
+        Check(std::ranges::is_sorted(fields, {}, &FieldDef::Offset), "fields are sorted by offset");
+    }
+
+    CheckRejected("struct Outer 0x10\n    0x08 Inner inner\nstruct Inner 0x10\n    0x00 int32 a\n", "exceeds",
+                  "an inline struct past its enclosing struct");
+    CheckRejected("struct A 0x10\nstruct A 0x20\n", "defined twice", "a struct defined twice");
+    CheckRejected("    0x00 int32 a\n", "outside of a struct", "a field before any struct");
+    CheckRejected("struct A\n", "expected 'struct <name> <size>'", "a struct without a size");
+    CheckRejected("struct A 0x10\n    0x00 int32\n", "expected '<offset> <type> <name>'", "a field without a name");
+}
+
+static void TestInlineCycles() {
+    CheckRejected("struct Node 0x100\n    0x00 Node inner\n", "contains itself", "a struct inside itself");
+    // Only structs of the same size fit inside each other around a cycle.
+    CheckRejected("struct A 0x40\n    0x00 B b\n"
+                  "struct B 0x40\n    0x00 C c\n"
+                  "struct C 0x40\n    0x00 A a\n", "contains itself", "a cycle through three structs");
+    CheckRejected("struct A 0x40\n    0x00 B[1] b\n"
+                  "struct B 0x40\n    0x00 A a\n", "contains itself", "a cycle through an array");
+
+    auto pointerCycle = ParseSchema("struct A 0x10\n    0x00 B* b\n"
+                                    "struct B 0x10\n    0x00 A* a\n    0x08 A* other\n");
+    Check(pointerCycle.has_value(), "structs pointing at each other are no cycle");
+    auto diamond = ParseSchema("struct Top 0x40\n    0x00 Side left\n    0x20 Side right\n"
+                               "struct Side 0x20\n    0x00 Leaf leaf\n    0x10 Leaf other\n"
+                               "struct Leaf 0x10\n    0x00 int64 value\n");
+    Check(diamond.has_value(), "a struct reached inline along two paths is no cycle");
+}
+
+static void TestOffsetOverflow() {
+    CheckRejected("struct A 0x10\n    0x10 int8 a\n", "offset outside", "an offset at the struct's end");
+    CheckRejected("struct A 0x10\n    0x100000000 int8 a\n", "offset outside", "an offset past 32 bits");
+    CheckRejected("struct A 0x10\n    0xFFFFFFFFFFFFFFFF int8 a\n", "offset outside", "the largest offset");
+    CheckRejected("struct A 0x10\n    0x1FFFFFFFFFFFFFFFF int8 a\n", "invalid offset", "an offset past 64 bits");
+    CheckRejected("struct A 0x10\n    -1 int8 a\n", "invalid offset", "a negative offset");
+    CheckRejected("struct A 0x10\n    0x0F int16 a\n", "exceeds", "a scalar straddling the struct's end");
+    CheckRejected("struct A 0x10\n    0x08 int32[3] a\n", "exceeds", "an array straddling the struct's end");
+
+    // 2^24 elements of a 2^24 byte struct would wrap a 32 bit extent to 0.
+    CheckRejected("struct Big 0x1000000\n    0x00 uint8 a\n"
+                  "struct A 0x1000000\n    0x00 Big[0x1000000] big\n", "exceeds", "an extent past 32 bits");
+    // Wraps a 32 bit extent to exactly the remaining space.
+    CheckRejected("struct Big 0x1000000\n    0x00 uint8 a\n"
+                  "struct A 0x1000000\n    0x800000 Big[0x100] big\n", "exceeds", "an extent that wraps to fit");
+    CheckRejected("struct A 0x10\n    0x00 int64[0x1000001] a\n", "invalid array length", "an array too long");
+    CheckRejected("struct A 0x1000001\n", "invalid struct size", "a struct too large");
+    CheckRejected("struct A 0\n", "invalid struct size", "an empty struct");
+
+    auto full = ParseSchema("struct A 0x1000000\n    0x00 uint8[0x1000000] bytes\n");
+    Check(full.has_value(), "an array filling the largest struct exactly parses");
+}
+
+int main() {
+    TestScalars();
+    TestCharArrays();
+    TestPointers();
+    TestNestedStructs();
+    TestInlineCycles();
+    TestOffsetOverflow();
+    return TestResult();
+}
@@ -0,0 +1,366 @@
+// Opens hand built ELF cores and minidumps, well formed and malformed, and checks the regions
+// DumpSource makes of them. Malformed files either fail to open or leave out what is broken,
+// they never produce regions that overlap, wrap around or point outside the file.
+
+import std;
+import Engine.DumpSource;
+import Engine.MappedFile;
+import Tests.Check;
+
+// Every byte of a test file is the low byte of its own offset, so the bytes a region reads
+// tell which file offset they came from.
+static uint8_t ByteAt(uint64_t fileOffset) {
+    return static_cast<uint8_t>(fileOffset);
+}
+
+// A file in the temp directory, removed again when the test is done with it.
+class TempFile {
+public:
+    TempFile(std::string_view name, std::span<const std::byte> bytes)
+        : m_Path(std::filesystem::temp_directory_path() /
+                 std::format("EasyReverseDumpSourceTest-{}", name)) {
+        std::ofstream(m_Path, std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()),
+                                                      static_cast<std::streamsize>(bytes.size()));
+    }
+
+    TempFile(const TempFile &) = delete;
+
+    TempFile &operator=(const TempFile &) = delete;
+
+    ~TempFile() {
+        std::error_code error;
+        std::filesystem::remove(m_Path, error);
+    }
+
+    [[nodiscard]] const std::filesystem::path &GetPath() const { return m_Path; }
+
+private:
+    std::filesystem::path m_Path;
+};
+
+// Builds a file of size bytes filled with ByteAt, then has fields written over it.
+class FileBuilder {
+public:
+    explicit FileBuilder(size_t size) : m_Bytes(size) {
+        for (size_t i = 0; i < size; i++) {
+            m_Bytes[i] = std::byte{ByteAt(i)};
+        }
+    }
+
+    template<typename T>
+    void Put(size_t offset, T value) {
+        std::memcpy(m_Bytes.data() + offset, &value, sizeof(T));
+    }
+
+    [[nodiscard]] std::span<const std::byte> GetBytes() const { return m_Bytes; }
+
+private:
+    std::vector<std::byte> m_Bytes;
+};
+
+struct ProgramHeader {
+    uint32_t Type = 1; // PT_LOAD
+    uint32_t Flags = 4 | 2; // readable and writable
+    uint64_t Offset = 0;
+    uint64_t VirtualAddress = 0;
+    uint64_t FileSize = 0;
+    uint64_t MemorySize = 0;
+};
+
+constexpr size_t ElfHeaderSize = 64;
+constexpr size_t ProgramHeaderSize = 56;
+
+// A 64 bit little endian core whose program headers follow the ELF header, padded with ByteAt
+// bytes to fileSize.
+static FileBuilder BuildElfCore(std::span<const ProgramHeader> headers, size_t fileSize) {
+    FileBuilder file(std::max(fileSize, ElfHeaderSize + headers.size() * ProgramHeaderSize));
+    file.Put(0, std::array<uint8_t, 16>{0x7F, 'E', 'L', 'F', 2, 1, 1});
+    file.Put<uint16_t>(16, 4); // ET_CORE
+    file.Put<uint16_t>(18, 62); // x86-64
+    file.Put<uint32_t>(20, 1);
+    file.Put<uint64_t>(32, ElfHeaderSize);
+    file.Put<uint16_t>(52, ElfHeaderSize);
+    file.Put<uint16_t>(54, ProgramHeaderSize);
+    file.Put<uint16_t>(56, static_cast<uint16_t>(headers.size()));
+    for (size_t i = 0; i < headers.size(); i++) {
+        size_t at = ElfHeaderSize + i * ProgramHeaderSize;
+        file.Put(at, headers[i].Type);
+        file.Put(at + 4, headers[i].Flags);
+        file.Put(at + 8, headers[i].Offset);
+        file.Put(at + 16, headers[i].VirtualAddress);
+        file.Put(at + 24, uint64_t{0});
+        file.Put(at + 32, headers[i].FileSize);
+        file.Put(at + 40, headers[i].MemorySize);
+        file.Put(at + 48, uint64_t{0x1000});
+    }
+    return file;
+}
+
+// Regions are sorted, do not overlap, do not wrap around and read back the file bytes their
+// segment points at.
+static void CheckRegionsSound(const MemorySource &source) {
+    auto regions = source.QueryRegions();
+    for (size_t i = 0; i < regions.size(); i++) {
+        Check(regions[i].Size != 0, "region is not empty");
+        Check(regions[i].Size <= ~uint64_t{0} - regions[i].Base, "region does not wrap around");
+        if (i > 0) {
+            Check(regions[i - 1].Base + regions[i - 1].Size <= regions[i].Base, "regions are sorted and disjoint");
+        }
+        auto view = source.View(regions[i].Base, regions[i].Size);
+        Check(view.size() == regions[i].Size, "a region's view covers all of it");
+    }
+}
+
+static void TestElfCore() {
+    constexpr size_t FileSize = 0x1000;
+    constexpr uint64_t DataOffset = 0x400;
+    std::array headers{
+        // Two adjacent segments, read across as one.
+        ProgramHeader{.Offset = DataOffset, .VirtualAddress = 0x10000, .FileSize = 0x100, .MemorySize = 0x100},
+        ProgramHeader{.Offset = DataOffset + 0x100, .VirtualAddress = 0x10100, .FileSize = 0x80, .MemorySize = 0x80},
+        // Not readable, left out.
+        ProgramHeader{.Flags = 1, .Offset = DataOffset, .VirtualAddress = 0x20000, .FileSize = 0x10, .MemorySize = 0x10},
+        // Not a load segment.
+        ProgramHeader{.Type = 4, .Offset = DataOffset, .VirtualAddress = 0x30000, .FileSize = 0x10, .MemorySize = 0x10},
+        // Left out by the dumper.
+        ProgramHeader{.Offset = DataOffset, .VirtualAddress = 0x40000, .FileSize = 0, .MemorySize = 0x1000},
+        // Past the end of the file, and running past it.
+        ProgramHeader{.Offset = FileSize + 0x10, .VirtualAddress = 0x50000, .FileSize = 0x10, .MemorySize = 0x10},
+        ProgramHeader{.Offset = FileSize - 0x10, .VirtualAddress = 0x60000, .FileSize = 0x20, .MemorySize = 0x20},
+        // File size plus offset wraps around.
+        ProgramHeader{.Offset = 0x10, .VirtualAddress = 0x70000, .FileSize = ~uint64_t{0}, .MemorySize = 0x10},
+        // Only the part that was in memory counts.
+        ProgramHeader{.Offset = DataOffset, .VirtualAddress = 0x80000, .FileSize = 0x100, .MemorySize = 0x40},
+    };
+    TempFile file("core", BuildElfCore(headers, FileSize).GetBytes());
+    auto source = OpenElfCore(file.GetPath());
+    Check(source.has_value(), "a well formed core opens");
+    if (!source) {
+        return;
+    }
+
+    auto regions = (*source)->QueryRegions();
+    Check(regions.size() == 3, "only the readable, loaded segments inside the file become regions");
+    if (regions.size() == 3) {
+        Check(regions[0].Base == 0x10000 && regions[0].Size == 0x100, "first segment");
+        Check(regions[1].Base == 0x10100 && regions[1].Size == 0x80, "second segment");
+        Check(regions[2].Base == 0x80000 && regions[2].Size == 0x40, "segment cut to its memory size");
+    }
+    CheckRegionsSound(**source);
+
+    std::array<std::byte, 0x200> buffer{};
+    size_t copied = (*source)->Read(0x10000, buffer);
+    Check(copied == 0x180, "a read continues into the adjacent segment and stops at the gap");
+    bool bytesMatch = true;
+    for (size_t i = 0; i < copied; i++) {
+        bytesMatch &= buffer[i] == std::byte{ByteAt(DataOffset + i)};
+    }
+    Check(bytesMatch, "read bytes come from the segments' file offsets");
+    Check((*source)->Read(0x20000, buffer) == 0, "left out segments read as missing");
+}
+
+static void TestElfCoreWrappingSegments() {
+    constexpr uint64_t Top = ~uint64_t{0};
+    std::array headers{
+        // Would end past the end of the address space.
+        ProgramHeader{.Offset = 0x200, .VirtualAddress = Top - 0xF, .FileSize = 0x20, .MemorySize = 0x20},
+        // Overlaps the wrapping segment, and follows it once it is dropped.
+        ProgramHeader{.Offset = 0x200, .VirtualAddress = Top - 0x7, .FileSize = 0x4, .MemorySize = 0x4},
+        // Overlaps the one before.
+        ProgramHeader{.Offset = 0x200, .VirtualAddress = Top - 0x5, .FileSize = 0x4, .MemorySize = 0x4},
+        // Ends well below the top.
+        ProgramHeader{.Offset = 0x200, .VirtualAddress = Top - 0x10F, .FileSize = 0x100, .MemorySize = 0x100},
+    };
+    TempFile file("wrapping-core", BuildElfCore(headers, 0x400).GetBytes());
+    auto source = OpenElfCore(file.GetPath());
+    Check(source.has_value(), "a core with wrapping segments still opens");
+    if (!source) {
+        return;
+    }
+    auto regions = (*source)->QueryRegions();
+    Check(regions.size() == 2, "the wrapping segment and the one overlapping its successor are dropped");
+    if (regions.size() == 2) {
+        Check(regions[0].Base == Top - 0x10F, "segment below the top");
+        Check(regions[1].Base == Top - 0x7 && regions[1].Size == 0x4, "segment at the top");
+    }
+    CheckRegionsSound(**source);
+}
+
+static void TestMalformedElfCores() {
+    std::array<std::byte, 16> tiny{std::byte{0x7F}, std::byte{'E'}, std::byte{'L'}, std::byte{'F'}};
+    TempFile truncated("truncated-core", tiny);
+    Check(!OpenElfCore(truncated.GetPath()), "a file shorter than the ELF header is rejected");
+
+    ProgramHeader segment{.Offset = 0x200, .VirtualAddress = 0x1000, .FileSize = 0x10, .MemorySize = 0x10};
+    std::array headers{segment};
+
+    FileBuilder wrongClass = BuildElfCore(headers, 0x400);
+    wrongClass.Put<uint8_t>(4, 1);
+    TempFile wrongClassFile("elf32-core", wrongClass.GetBytes());
+    Check(!OpenElfCore(wrongClassFile.GetPath()), "32 bit cores are rejected");
+
+    FileBuilder notCore = BuildElfCore(headers, 0x400);
+    notCore.Put<uint16_t>(16, 2);
+    TempFile notCoreFile("executable", notCore.GetBytes());
+    Check(!OpenElfCore(notCoreFile.GetPath()), "executables are rejected");
+
+    FileBuilder smallHeaders = BuildElfCore(headers, 0x400);
+    smallHeaders.Put<uint16_t>(54, ProgramHeaderSize - 8);
+    TempFile smallHeadersFile("small-headers", smallHeaders.GetBytes());
+    Check(!OpenElfCore(smallHeadersFile.GetPath()), "program headers smaller than the struct are rejected");
+
+    FileBuilder pastEnd = BuildElfCore(headers, 0x400);
+    pastEnd.Put<uint64_t>(32, 0x400 - 8);
+    TempFile pastEndFile("headers-past-end", pastEnd.GetBytes());
+    Check(!OpenElfCore(pastEndFile.GetPath()), "program headers running past the file are rejected");
+
+    FileBuilder wrapping = BuildElfCore(headers, 0x400);
+    wrapping.Put<uint64_t>(32, ~uint64_t{0} - 8);
+    TempFile wrappingFile("headers-wrapping", wrapping.GetBytes());
+    Check(!OpenElfCore(wrappingFile.GetPath()), "a program header offset near 2^64 is rejected");
+
+    FileBuilder manyHeaders = BuildElfCore(headers, 0x400);
+    manyHeaders.Put<uint16_t>(56, 0xFFFF);
+    TempFile manyHeadersFile("many-headers", manyHeaders.GetBytes());
+    Check(!OpenElfCore(manyHeadersFile.GetPath()), "a program header count past the file is rejected");
+}
+
+constexpr size_t MinidumpHeaderSize = 32;
+constexpr size_t MinidumpDirectorySize = 12;
+
+// A minidump with a single stream, whose contents start at streamOffset.
+static FileBuilder BuildMinidump(uint32_t streamType, size_t streamOffset, size_t fileSize) {
+    FileBuilder file(fileSize);
+    file.Put<uint32_t>(0, 0x504D444D); // "MDMP"
+    file.Put<uint32_t>(4, 0xA793);
+    file.Put<uint32_t>(8, 1);
+    file.Put<uint32_t>(12, MinidumpHeaderSize);
+    file.Put<uint32_t>(MinidumpHeaderSize, streamType);
+    file.Put<uint32_t>(MinidumpHeaderSize + 4, 0);
+    file.Put<uint32_t>(MinidumpHeaderSize + 8, static_cast<uint32_t>(streamOffset));
+    return file;
+}
+
+static void TestMinidumps() {
+    constexpr uint32_t MemoryList = 5;
+    constexpr uint32_t Memory64List = 9;
+    constexpr size_t Stream = MinidumpHeaderSize + MinidumpDirectorySize;
+
+    // MemoryList: a count, then descriptors with an address, a size and an offset each.
+    FileBuilder memoryList = BuildMinidump(MemoryList, Stream, 0x400);
+    memoryList.Put<uint32_t>(Stream, 2);
+    memoryList.Put<uint64_t>(Stream + 4, 0x7000);
+    memoryList.Put<uint32_t>(Stream + 12, 0x20);
+    memoryList.Put<uint32_t>(Stream + 16, 0x100);
+    memoryList.Put<uint64_t>(Stream + 20, 0x9000);
+    memoryList.Put<uint32_t>(Stream + 28, 0x10);
+    memoryList.Put<uint32_t>(Stream + 32, 0x200);
+    TempFile memoryListFile("memory-list.dmp", memoryList.GetBytes());
+    auto source = OpenMinidump(memoryListFile.GetPath());
+    Check(source.has_value(), "a well formed memory list opens");
+    if (source) {
+        Check((*source)->QueryRegions().size() == 2, "every range becomes a region");
+        std::array<std::byte, 4> bytes{};
+        Check((*source)->Read(0x9004, bytes) == 4 && bytes[0] == std::byte{ByteAt(0x204)},
+              "ranges read from their own offset");
+        CheckRegionsSound(**source);
+    }
+
+    FileBuilder rangePastEnd = memoryList;
+    rangePastEnd.Put<uint32_t>(Stream + 32, 0x3F8);
+    TempFile rangePastEndFile("range-past-end.dmp", rangePastEnd.GetBytes());
+    Check(!OpenMinidump(rangePastEndFile.GetPath()), "a range running past the file is rejected");
+
+    FileBuilder countPastEnd = memoryList;
+    countPastEnd.Put<uint32_t>(Stream, 0xFFFFFFFF);
+    TempFile countPastEndFile("count-past-end.dmp", countPastEnd.GetBytes());
+    Check(!OpenMinidump(countPastEndFile.GetPath()), "a range count past the file is rejected");
+
+    // Memory64List: a count and the offset of the first range's bytes, then address and size
+    // pairs whose bytes follow each other.
+    FileBuilder memory64List = BuildMinidump(Memory64List, Stream, 0x400);
+    memory64List.Put<uint64_t>(Stream, 2);
+    memory64List.Put<uint64_t>(Stream + 8, 0x100);
+    memory64List.Put<uint64_t>(Stream + 16, 0x7000);
+    memory64List.Put<uint64_t>(Stream + 24, 0x80);
+    memory64List.Put<uint64_t>(Stream + 32, 0x8000);
+    memory64List.Put<uint64_t>(Stream + 40, 0x40);
+    TempFile memory64ListFile("memory64-list.dmp", memory64List.GetBytes());
+    source = OpenMinidump(memory64ListFile.GetPath());
+    Check(source.has_value(), "a well formed memory64 list opens");
+    if (source) {
+        std::array<std::byte, 1> bytes{};
+        Check((*source)->Read(0x8000, bytes) == 1 && bytes[0] == std::byte{ByteAt(0x180)},
+              "the second range's bytes follow the first one's");
+        CheckRegionsSound(**source);
+    }
+
+    // A size near 2^64, which would carry the running offset around into the file.
+    FileBuilder wrappingSize = memory64List;
+    wrappingSize.Put<uint64_t>(Stream + 40, ~uint64_t{0} - 0x100);
+    TempFile wrappingSizeFile("wrapping-size.dmp", wrappingSize.GetBytes());
+    Check(!OpenMinidump(wrappingSizeFile.GetPath()), "a range size near 2^64 is rejected");
+
+    FileBuilder baseOutside = memory64List;
+    baseOutside.Put<uint64_t>(Stream + 8, 0x1000);
+    TempFile baseOutsideFile("base-outside.dmp", baseOutside.GetBytes());
+    Check(!OpenMinidump(baseOutsideFile.GetPath()), "ranges starting past the file are rejected");
+
+    FileBuilder directoryOutside = memory64List;
+    directoryOutside.Put<uint32_t>(12, 0x3FC);
+    TempFile directoryOutsideFile("directory-outside.dmp", directoryOutside.GetBytes());
+    Check(!OpenMinidump(directoryOutsideFile.GetPath()), "a stream directory past the file is rejected");
+
+    FileBuilder streamOutside = memory64List;
+    streamOutside.Put<uint32_t>(MinidumpHeaderSize + 8, 0xFFFFFFF8);
+    TempFile streamOutsideFile("stream-outside.dmp", streamOutside.GetBytes());
+    Check(!OpenMinidump(streamOutsideFile.GetPath()), "a stream past the file is rejected");
+}
+
+static void TestSegmentFilter() {
+    FileBuilder bytes(0x100);
+    TempFile file("segments", bytes.GetBytes());
+    auto mapped = MappedFile::Open(file.GetPath());
+    Check(mapped.has_value(), "the test file maps");
+    if (!mapped) {
+        return;
+    }
+    constexpr uint64_t Top = ~uint64_t{0};
+    DumpSource source(std::move(*mapped), {
+                          {0x3000, 0x10, 0x20, RegionAccess::Read},
+                          {0x1000, 0x10, 0x00, RegionAccess::Read},
+                          {0x1008, 0x10, 0x10, RegionAccess::Read}, // overlaps the one before
+                          {0x2000, 0x00, 0x00, RegionAccess::Read}, // empty
+                          {Top - 0x7, 0x10, 0x00, RegionAccess::Read}, // wraps around
+                          {Top - 0x3, 0x02, 0x00, RegionAccess::Read}, // inside the wrapping one
+                          {Top, 0x01, 0x00, RegionAccess::Read}, // ends at 2^64, which wraps too
+                      });
+    auto regions = source.QueryRegions();
+    Check(regions.size() == 3, "overlapping, empty and wrapping segments are dropped");
+    if (regions.size() == 3) {
+        Check(regions[0].Base == 0x1000 && regions[1].Base == 0x3000 && regions[2].Base == Top - 0x3,
+              "segments are sorted by address");
+    }
+    CheckRegionsSound(source);
+
+    std::array<std::byte, 4> last{};
+    Check(source.Read(Top - 0x3, last) == 2, "a read stops at the end of the last segment");
+}
+
+static void TestOpenDump() {
+    std::array<std::byte, 64> zeros{};
+    TempFile unknown("unknown", zeros);
+    Check(!OpenDump(unknown.GetPath()), "files without a known magic are rejected");
+    Check(!OpenDump(std::filesystem::temp_directory_path() / "EasyReverseDumpSourceTest-missing"),
+          "missing files are rejected");
+}
+
+int main() {
+    TestElfCore();
+    TestElfCoreWrappingSegments();
+    TestMalformedElfCores();
+    TestMinidumps();
+    TestSegmentFilter();
+    TestOpenDump();
+    return TestResult();
+}
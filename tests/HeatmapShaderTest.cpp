@@ -0,0 +1,537 @@
+// Runs memory_heatmap.comp on a handful of known cells and compares every pixel it writes with
+// the colors the shader is meant to produce, computed here on the CPU. Needs a Vulkan device
+// with a compute queue, without one the test reports itself skipped.
+//
+//     HeatmapShaderTest <path to memory_heatmap.comp.spv>
+
+#include <vulkan/vulkan.h>
+
+import std;
+import Tests.Check;
+
+// Returned when there is no device to run on, ctest counts it as skipped.
+constexpr int SkippedResult = 77;
+
+// Mirrors struct Cell and the push constants of the shader.
+struct Cell {
+    float Entropy;
+    uint32_t ChangeCount;
+    uint32_t FirstWord;
+    uint32_t Flags;
+};
+
+struct Params {
+    uint32_t CellCount;
+    uint32_t Width;
+    uint32_t Mode;
+    uint32_t MaxChangeCount;
+};
+
+// Wider than a row of cells and taller than the cells fill, so both background cases show up.
+constexpr uint32_t ImageWidth = 5;
+constexpr uint32_t ImageHeight = 3;
+constexpr uint32_t RowWidth = 4;
+constexpr uint32_t MaxChangeCount = 7;
+
+constexpr Cell Cells[] = {
+    {0.0f, 0, 0, 1},
+    {0.5f, 1, 1, 1},
+    {1.0f, MaxChangeCount, 0xDEADBEEF, 1},
+    {0.3f, 3, 0x12345678, 1},
+    {0.5f, 2, 5, 0}, // unreadable
+    {0.9f, 2, 42, 1},
+    {-1.0f, 12, 0xFFFFFFFF, 3}, // entropy and change count out of range, flags beyond bit 0
+    {0.125f, 5, 0x80000000, 1},
+    {0.625f, 6, 7, 1},
+    {2.0f, 0, 0x00010001, 1},
+};
+
+using Color = std::array<float, 4>;
+
+static float SmoothStep(float edge0, float edge1, float x) {
+    float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static Color Ramp(float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    return {SmoothStep(0.5f, 0.75f, t), SmoothStep(0.0f, 0.25f, t) - SmoothStep(0.75f, 1.0f, t),
+            1.0f - SmoothStep(0.25f, 0.5f, t), 1.0f};
+}
+
+static Color HashColor(uint32_t v) {
+    v ^= v >> 16;
+    v *= 0x7feb352du;
+    v ^= v >> 15;
+    v *= 0x846ca68bu;
+    v ^= v >> 16;
+    return {static_cast<float>(v & 0xFFu) / 255.0f, static_cast<float>((v >> 8) & 0xFFu) / 255.0f,
+            static_cast<float>((v >> 16) & 0xFFu) / 255.0f, 1.0f};
+}
+
+static Color ExpectedColor(uint32_t x, uint32_t y, uint32_t mode) {
+    uint32_t index = y * RowWidth + x;
+    if (x >= RowWidth || index >= std::size(Cells)) {
+        return {0.05f, 0.05f, 0.06f, 1.0f};
+    }
+    const Cell &cell = Cells[index];
+    if ((cell.Flags & 1u) == 0) {
+        return {0.15f, 0.15f, 0.16f, 1.0f};
+    }
+    constexpr Color Black = {0.0f, 0.0f, 0.0f, 1.0f};
+    if (mode == 0) {
+        return Ramp(cell.Entropy);
+    }
+    if (mode == 1) {
+        float maxCount = static_cast<float>(std::max(MaxChangeCount, 1u));
+        return cell.ChangeCount == 0
+                   ? Black
+                   : Ramp(std::log2(1.0f + static_cast<float>(cell.ChangeCount)) / std::log2(1.0f + maxCount));
+    }
+    return cell.FirstWord == 0 ? Black : HashColor(cell.FirstWord);
+}
+
+static std::vector<uint32_t> ReadCode(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return {};
+    }
+    auto size = static_cast<size_t>(file.tellg());
+    std::vector<uint32_t> code(size / sizeof(uint32_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(code.data()), static_cast<std::streamsize>(code.size() * sizeof(uint32_t)));
+    return code;
+}
+
+// Everything the dispatches need, destroyed in reverse order of creation.
+class ComputeContext {
+public:
+    ComputeContext() = default;
+
+    ComputeContext(const ComputeContext &) = delete;
+
+    ComputeContext &operator=(const ComputeContext &) = delete;
+
+    ~ComputeContext() {
+        if (Device != VK_NULL_HANDLE) {
+            vkDeviceWaitIdle(Device);
+            vkDestroyCommandPool(Device, CommandPool, nullptr);
+            vkDestroyPipeline(Device, Pipeline, nullptr);
+            vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
+            vkDestroyShaderModule(Device, ShaderModule, nullptr);
+            vkDestroyDescriptorPool(Device, DescriptorPool, nullptr);
+            vkDestroyDescriptorSetLayout(Device, DescriptorSetLayout, nullptr);
+            vkDestroyImageView(Device, ImageView, nullptr);
+            vkDestroyImage(Device, Image, nullptr);
+            vkDestroyBuffer(Device, CellBuffer, nullptr);
+            vkDestroyBuffer(Device, ReadbackBuffer, nullptr);
+            for (VkDeviceMemory memory: Memory) {
+                vkFreeMemory(Device, memory, nullptr);
+            }
+            vkDestroyDevice(Device, nullptr);
+        }
+        if (Instance != VK_NULL_HANDLE) {
+            vkDestroyInstance(Instance, nullptr);
+        }
+    }
+
+    // Picks the first device with a compute queue. Returns false when there is none.
+    bool CreateDevice() {
+        VkApplicationInfo applicationInfo{
+            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .pApplicationName = "HeatmapShaderTest",
+            .apiVersion = VK_API_VERSION_1_0
+        };
+        VkInstanceCreateInfo instanceInfo{
+            .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+            .pApplicationInfo = &applicationInfo
+        };
+        if (vkCreateInstance(&instanceInfo, nullptr, &Instance) != VK_SUCCESS) {
+            return false;
+        }
+
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(Instance, &deviceCount, nullptr);
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(Instance, &deviceCount, devices.data());
+        for (VkPhysicalDevice device: devices) {
+            uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+            for (uint32_t i = 0; i < familyCount; i++) {
+                if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+                    PhysicalDevice = device;
+                    QueueFamily = i;
+                    break;
+                }
+            }
+            if (PhysicalDevice != VK_NULL_HANDLE) {
+                break;
+            }
+        }
+        if (PhysicalDevice == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        float priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo{
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = QueueFamily,
+            .queueCount = 1,
+            .pQueuePriorities = &priority
+        };
+        VkDeviceCreateInfo deviceInfo{
+            .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+            .queueCreateInfoCount = 1,
+            .pQueueCreateInfos = &queueInfo
+        };
+        if (vkCreateDevice(PhysicalDevice, &deviceInfo, nullptr, &Device) != VK_SUCCESS) {
+            return false;
+        }
+        vkGetDeviceQueue(Device, QueueFamily, 0, &Queue);
+        return true;
+    }
+
+    bool Allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, VkDeviceMemory &memory) {
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &memoryProperties);
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((requirements.memoryTypeBits & (1u << i)) != 0 &&
+                (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                VkMemoryAllocateInfo allocateInfo{
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                    .allocationSize = requirements.size,
+                    .memoryTypeIndex = i
+                };
+                if (vkAllocateMemory(Device, &allocateInfo, nullptr, &memory) != VK_SUCCESS) {
+                    return false;
+                }
+                Memory.push_back(memory);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Host visible and coherent, mapped for the lifetime of the context.
+    bool CreateHostBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer &buffer, void *&mapped) {
+        VkBufferCreateInfo bufferInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = size,
+            .usage = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+        };
+        if (vkCreateBuffer(Device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            return false;
+        }
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(Device, buffer, &requirements);
+        VkDeviceMemory memory;
+        return Allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        memory) &&
+               vkBindBufferMemory(Device, buffer, memory, 0) == VK_SUCCESS &&
+               vkMapMemory(Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS;
+    }
+
+    bool CreateImage() {
+        VkImageCreateInfo imageInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .extent = {ImageWidth, ImageHeight, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+        if (vkCreateImage(Device, &imageInfo, nullptr, &Image) != VK_SUCCESS) {
+            return false;
+        }
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(Device, Image, &requirements);
+        VkDeviceMemory memory;
+        if (!Allocate(requirements, 0, memory) || vkBindImageMemory(Device, Image, memory, 0) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkImageViewCreateInfo viewInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = Image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+        };
+        return vkCreateImageView(Device, &viewInfo, nullptr, &ImageView) == VK_SUCCESS;
+    }
+
+    bool CreatePipeline(std::span<const uint32_t> code) {
+        VkDescriptorSetLayoutBinding bindings[] = {
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        };
+        VkDescriptorSetLayoutCreateInfo layoutInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(std::size(bindings)),
+            .pBindings = bindings
+        };
+        if (vkCreateDescriptorSetLayout(Device, &layoutInfo, nullptr, &DescriptorSetLayout) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkDescriptorPoolSize poolSizes[] = {
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
+        };
+        VkDescriptorPoolCreateInfo poolInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(std::size(poolSizes)),
+            .pPoolSizes = poolSizes
+        };
+        if (vkCreateDescriptorPool(Device, &poolInfo, nullptr, &DescriptorPool) != VK_SUCCESS) {
+            return false;
+        }
+        VkDescriptorSetAllocateInfo setInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = DescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &DescriptorSetLayout
+        };
+        if (vkAllocateDescriptorSets(Device, &setInfo, &DescriptorSet) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkDescriptorBufferInfo bufferInfo{CellBuffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorImageInfo imageInfo{VK_NULL_HANDLE, ImageView, VK_IMAGE_LAYOUT_GENERAL};
+        VkWriteDescriptorSet writes[] = {
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = DescriptorSet,
+                .dstBinding = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &bufferInfo
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = DescriptorSet,
+                .dstBinding = 1,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .pImageInfo = &imageInfo
+            },
+        };
+        vkUpdateDescriptorSets(Device, static_cast<uint32_t>(std::size(writes)), writes, 0, nullptr);
+
+        VkPushConstantRange pushConstants{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Params)};
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &DescriptorSetLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstants
+        };
+        if (vkCreatePipelineLayout(Device, &pipelineLayoutInfo, nullptr, &PipelineLayout) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkShaderModuleCreateInfo moduleInfo{
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = code.size_bytes(),
+            .pCode = code.data()
+        };
+        if (vkCreateShaderModule(Device, &moduleInfo, nullptr, &ShaderModule) != VK_SUCCESS) {
+            return false;
+        }
+        VkComputePipelineCreateInfo pipelineInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = ShaderModule,
+                .pName = "main"
+            },
+            .layout = PipelineLayout
+        };
+        if (vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &Pipeline) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkCommandPoolCreateInfo commandPoolInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = QueueFamily
+        };
+        return vkCreateCommandPool(Device, &commandPoolInfo, nullptr, &CommandPool) == VK_SUCCESS;
+    }
+
+    // Dispatches the shader once over the whole image and copies the image into the readback buffer.
+    bool Run(const Params &params) {
+        VkCommandBufferAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = CommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(Device, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+            return false;
+        }
+        VkCommandBufferBeginInfo beginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        };
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        VkImageMemoryBarrier toGeneral{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = Image,
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, PipelineLayout, 0, 1, &DescriptorSet,
+                                0, nullptr);
+        vkCmdPushConstants(commandBuffer, PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+        vkCmdDispatch(commandBuffer, (ImageWidth + 15) / 16, (ImageHeight + 15) / 16, 1);
+
+        VkImageMemoryBarrier toTransfer{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = Image,
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageExtent = {ImageWidth, ImageHeight, 1}
+        };
+        vkCmdCopyImageToBuffer(commandBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ReadbackBuffer, 1, &region);
+
+        VkMemoryBarrier toHost{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1,
+                             &toHost, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer
+        };
+        bool finished = vkQueueSubmit(Queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS &&
+                        vkQueueWaitIdle(Queue) == VK_SUCCESS;
+        vkFreeCommandBuffers(Device, CommandPool, 1, &commandBuffer);
+        return finished;
+    }
+
+    VkInstance Instance = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    uint32_t QueueFamily = 0;
+    VkDevice Device = VK_NULL_HANDLE;
+    VkQueue Queue = VK_NULL_HANDLE;
+    std::vector<VkDeviceMemory> Memory;
+    VkBuffer CellBuffer = VK_NULL_HANDLE;
+    void *MappedCells = nullptr;
+    VkBuffer ReadbackBuffer = VK_NULL_HANDLE;
+    void *MappedPixels = nullptr;
+    VkImage Image = VK_NULL_HANDLE;
+    VkImageView ImageView = VK_NULL_HANDLE;
+    VkDescriptorSetLayout DescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool DescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout PipelineLayout = VK_NULL_HANDLE;
+    VkShaderModule ShaderModule = VK_NULL_HANDLE;
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+};
+
+// RGBA8 rounds each channel, allow one step either way.
+static bool SameColor(const uint8_t *pixel, const Color &expected) {
+    for (size_t channel = 0; channel < 4; channel++) {
+        float difference = std::abs(static_cast<float>(pixel[channel]) - expected[channel] * 255.0f);
+        if (difference > 1.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::println(std::cerr, "usage: HeatmapShaderTest <path to memory_heatmap.comp.spv>");
+        return 1;
+    }
+    auto code = ReadCode(argv[1]);
+    Check(!code.empty(), std::format("{} is read", argv[1]));
+    if (code.empty()) {
+        return TestResult();
+    }
+
+    ComputeContext context;
+    if (!context.CreateDevice()) {
+        std::println("no Vulkan device with a compute queue, skipped");
+        return SkippedResult;
+    }
+
+    bool created = context.CreateHostBuffer(sizeof(Cells), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, context.CellBuffer,
+                                            context.MappedCells) &&
+                   context.CreateHostBuffer(ImageWidth * ImageHeight * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                            context.ReadbackBuffer, context.MappedPixels) &&
+                   context.CreateImage() && context.CreatePipeline(code);
+    Check(created, "the buffers, the image and the pipeline are created");
+    if (!created) {
+        return TestResult();
+    }
+    std::memcpy(context.MappedCells, Cells, sizeof(Cells));
+
+    constexpr std::string_view ModeNames[] = {"entropy", "change frequency", "value"};
+    for (uint32_t mode = 0; mode < 3; mode++) {
+        Params params{
+            .CellCount = static_cast<uint32_t>(std::size(Cells)),
+            .Width = RowWidth,
+            .Mode = mode,
+            .MaxChangeCount = MaxChangeCount
+        };
+        std::memset(context.MappedPixels, 0, ImageWidth * ImageHeight * 4);
+        if (!context.Run(params)) {
+            Check(false, std::format("the {} dispatch runs", ModeNames[mode]));
+            continue;
+        }
+
+        const auto *pixels = static_cast<const uint8_t *>(context.MappedPixels);
+        for (uint32_t y = 0; y < ImageHeight; y++) {
+            for (uint32_t x = 0; x < ImageWidth; x++) {
+                const uint8_t *pixel = pixels + (y * ImageWidth + x) * 4;
+                Color expected = ExpectedColor(x, y, mode);
+                Check(SameColor(pixel, expected),
+                      std::format("{} pixel ({}, {}) is {:.0f} {:.0f} {:.0f} {:.0f}, got {} {} {} {}", ModeNames[mode],
+                                  x, y, expected[0] * 255.0f, expected[1] * 255.0f, expected[2] * 255.0f,
+                                  expected[3] * 255.0f, pixel[0], pixel[1], pixel[2], pixel[3]));
+            }
+        }
+    }
+    return TestResult();
+}
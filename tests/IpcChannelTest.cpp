@@ -0,0 +1,214 @@
+// Sends framed messages over socket pairs, whole, split at every byte and malformed, and checks
+// what IpcChannel::Receive makes of them. A message either arrives exactly as sent or Receive
+// returns nullopt, a peer never gets it to allocate more than MaxIpcPayloadSize.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+import std;
+import Engine.IpcChannel;
+import Engine.ScanProtocol;
+import Tests.Check;
+
+// Connected descriptors, wrapped in channels or written to by hand when a test forges frames.
+static std::pair<UniqueFd, UniqueFd> CreateSocketPair() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return {};
+    }
+    return {UniqueFd(fds[0]), UniqueFd(fds[1])};
+}
+
+static bool WriteAll(const UniqueFd &fd, std::span<const std::byte> bytes) {
+    while (!bytes.empty()) {
+        ssize_t written = write(fd.Get(), bytes.data(), bytes.size());
+        if (written <= 0) {
+            return false;
+        }
+        bytes = bytes.subspan(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+static std::vector<std::byte> Frame(IpcHeader header, std::span<const std::byte> payload) {
+    std::vector<std::byte> frame(sizeof(header) + payload.size());
+    std::memcpy(frame.data(), &header, sizeof(header));
+    std::ranges::copy(payload, frame.begin() + sizeof(header));
+    return frame;
+}
+
+static std::vector<std::byte> Bytes(size_t size) {
+    std::vector<std::byte> bytes(size);
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = static_cast<std::byte>(i * 7 + 3);
+    }
+    return bytes;
+}
+
+static bool SameMessage(const std::optional<IpcMessage> &message, IpcHeader header,
+                        std::span<const std::byte> payload) {
+    return message && message->Header.Type == header.Type && message->Header.RequestId == header.RequestId &&
+           message->Header.Status == header.Status && message->Header.PayloadSize == payload.size() &&
+           std::ranges::equal(message->Payload, payload);
+}
+
+static void TestRoundTrip() {
+    auto [left, right] = CreateSocketPair();
+    IpcChannel sender(std::move(left));
+    IpcChannel receiver(std::move(right));
+
+    auto payload = Bytes(100);
+    // The size the sender puts in the header is ignored, the payload's counts.
+    IpcHeader header{.Type = 3, .RequestId = 42, .Status = 1, .PayloadSize = 7};
+    Check(sender.Send(header, payload), "a message is sent");
+    header.PayloadSize = static_cast<uint32_t>(payload.size());
+    Check(SameMessage(receiver.Receive(), header, payload), "a message arrives as sent");
+
+    IpcHeader empty{.Type = 5, .RequestId = 43};
+    Check(sender.Send(empty, {}), "an empty message is sent");
+    auto message = receiver.Receive();
+    Check(SameMessage(message, empty, {}), "an empty message arrives as sent");
+    Check(message && !message->Fd, "a message without a descriptor carries none");
+}
+
+static void TestSplitFrames() {
+    auto [left, right] = CreateSocketPair();
+    IpcChannel receiver(std::move(right));
+
+    // Several frames in one write.
+    IpcHeader first{.Type = 1, .RequestId = 1, .PayloadSize = 10};
+    IpcHeader second{.Type = 2, .RequestId = 2, .PayloadSize = 0};
+    IpcHeader third{.Type = 3, .RequestId = 3, .PayloadSize = 3};
+    auto payload = Bytes(10);
+    std::vector<std::byte> stream;
+    for (const auto &frame: {Frame(first, payload), Frame(second, {}), Frame(third, std::span(payload).first(3))}) {
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    Check(WriteAll(left, stream), "frames are written");
+    Check(SameMessage(receiver.Receive(), first, payload), "the first of several frames in one write arrives");
+    Check(SameMessage(receiver.Receive(), second, {}), "the second of several frames in one write arrives");
+    Check(SameMessage(receiver.Receive(), third, std::span(payload).first(3)),
+          "the third of several frames in one write arrives");
+
+    // One byte at a time, from another thread so every read finds only part of the frame.
+    std::jthread writer([&left, frame = Frame(first, payload)] {
+        for (std::byte value: frame) {
+            WriteAll(left, std::span(&value, 1));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    Check(SameMessage(receiver.Receive(), first, payload), "a frame written byte by byte arrives");
+}
+
+static void TestLargePayload() {
+    auto [left, right] = CreateSocketPair();
+    IpcChannel sender(std::move(left));
+    IpcChannel receiver(std::move(right));
+
+    // Much more than the socket buffers, so Send has to go on after partial writes.
+    auto payload = Bytes(8 * 1024 * 1024);
+    IpcHeader header{.Type = 1, .RequestId = 9, .PayloadSize = static_cast<uint32_t>(payload.size())};
+    std::jthread writer([&] { Check(sender.Send(header, payload), "a large message is sent"); });
+    Check(SameMessage(receiver.Receive(), header, payload), "a large message arrives as sent");
+}
+
+static void TestMalformedFrames() {
+    {
+        // Would have the receiver allocate more than the limit, rejected before reading on.
+        auto [left, right] = CreateSocketPair();
+        IpcChannel receiver(std::move(right));
+        IpcHeader header{.Type = 1, .PayloadSize = MaxIpcPayloadSize + 1};
+        Check(WriteAll(left, Frame(header, {})), "an oversized frame is written");
+        Check(!receiver.Receive().has_value(), "a payload over the limit is rejected");
+    }
+    {
+        auto [left, right] = CreateSocketPair();
+        IpcChannel receiver(std::move(right));
+        IpcHeader header{.Type = 1, .PayloadSize = MaxIpcPayloadSize};
+        auto payload = Bytes(16);
+        auto frame = Frame(header, payload);
+        Check(WriteAll(left, frame), "a frame of the largest size is started");
+        left.Reset();
+        Check(!receiver.Receive().has_value(), "a payload cut short is rejected");
+    }
+    {
+        auto [left, right] = CreateSocketPair();
+        IpcChannel receiver(std::move(right));
+        auto frame = Frame(IpcHeader{.Type = 1}, {});
+        Check(WriteAll(left, std::span(frame).first(sizeof(IpcHeader) - 1)), "part of a header is written");
+        left.Reset();
+        Check(!receiver.Receive().has_value(), "a header cut short is rejected");
+    }
+    {
+        auto [left, right] = CreateSocketPair();
+        IpcChannel receiver(std::move(right));
+        left.Reset();
+        Check(!receiver.Receive().has_value(), "nothing is received once the peer closed");
+    }
+}
+
+static void TestPassedDescriptor() {
+    auto [left, right] = CreateSocketPair();
+    IpcChannel sender(std::move(left));
+    IpcChannel receiver(std::move(right));
+
+    auto bytes = Bytes(10000);
+    UniqueFd shared = CreateSharedBytes(bytes);
+    Check(static_cast<bool>(shared), "shared bytes are created");
+    IpcHeader header{.Type = 8, .RequestId = 5};
+    auto payload = Bytes(4);
+    Check(sender.Send(header, payload, shared.Get()), "a message with a descriptor is sent");
+    auto message = receiver.Receive();
+    Check(SameMessage(message, header, payload), "a message with a descriptor arrives as sent");
+    if (!message || !message->Fd) {
+        Check(false, "the descriptor arrives");
+        return;
+    }
+    auto mapping = SharedMapping::Map(message->Fd, bytes.size());
+    Check(mapping && std::ranges::equal(mapping->GetData(), bytes), "the passed descriptor maps the shared bytes");
+    Check(!SharedMapping::Map(message->Fd, bytes.size() + 1).has_value(), "a mapping past the shared bytes fails");
+}
+
+static void TestListener() {
+    auto path = std::filesystem::temp_directory_path() / std::format("EasyReverseIpcTest-{}.sock", getpid());
+    auto listener = IpcListener::Listen(path, GetInvokingUser());
+    Check(listener.has_value(), "the listener starts");
+    if (!listener) {
+        return;
+    }
+    Check((std::filesystem::status(path).permissions() & std::filesystem::perms::all) ==
+          (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write),
+          "only the owner may open the socket file");
+
+    auto client = IpcChannel::Connect(path);
+    Check(client.has_value(), "a client of the same user connects");
+    auto server = listener->Accept();
+    Check(server.has_value(), "a client of the same user is accepted");
+    if (client && server) {
+        IpcHeader header{.Type = 1, .RequestId = 77};
+        auto payload = Bytes(12);
+        Check(client->Send(header, payload), "the client sends");
+        Check(SameMessage(server->Receive(), header, payload), "the server receives what the client sent");
+    }
+    std::filesystem::remove(path);
+}
+
+static void TestPayloads() {
+    TargetPayload target{.TargetId = 12};
+    auto bytes = AsPayload(target);
+    auto parsed = FromPayload<TargetPayload>(bytes);
+    Check(parsed && parsed->TargetId == 12, "a payload reads back");
+    Check(!FromPayload<TargetPayload>(bytes.first(bytes.size() - 1)).has_value(), "a short payload is rejected");
+    Check(!FromPayload<ReadPayload>(bytes).has_value(), "a payload of a smaller type is rejected");
+}
+
+int main() {
+    TestRoundTrip();
+    TestSplitFrames();
+    TestLargePayload();
+    TestMalformedFrames();
+    TestPassedDescriptor();
+    TestListener();
+    TestPayloads();
+    return TestResult();
+}
@@ -0,0 +1,125 @@
+// Drives a PageCache over a source whose reads can be held back, so the test decides what is
+// queued while the reader is busy. Every page a view asks for has to arrive eventually, whatever
+// the prefetch queue did with it before.
+
+import std;
+import Engine.PageCache;
+import Tests.Check;
+
+constexpr uint64_t PageSize = PageCache::PageSize;
+
+// Each byte is the low byte of its address. Reads wait while the source is held.
+class HeldSource final : public MemorySource {
+public:
+    size_t Read(uint64_t address, std::span<std::byte> buffer) const override {
+        std::unique_lock lock(m_Mutex);
+        m_Reading = true;
+        m_Condition.notify_all();
+        m_Condition.wait(lock, [this] { return !m_Held; });
+        for (size_t i = 0; i < buffer.size(); i++) {
+            buffer[i] = static_cast<std::byte>(address + i);
+        }
+        return buffer.size();
+    }
+
+    [[nodiscard]] std::vector<MemoryRegion> QueryRegions() const override {
+        return {{0, 1ull << 40, RegionAccess::Read}};
+    }
+
+    // Returns once the reader is inside Read.
+    void WaitForReader() const {
+        std::unique_lock lock(m_Mutex);
+        m_Condition.wait(lock, [this] { return m_Reading; });
+    }
+
+    void Release() {
+        std::lock_guard lock(m_Mutex);
+        m_Held = false;
+        m_Condition.notify_all();
+    }
+
+private:
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_Condition;
+    mutable bool m_Reading = false;
+    bool m_Held = true;
+};
+
+// Reads the page until it is cached or a generous deadline passed.
+static bool ReadPage(PageCache &cache, uint64_t address) {
+    std::array<std::byte, PageSize> data;
+    std::array<uint8_t, PageSize> flags;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        cache.Read(address, data, flags);
+        if (std::ranges::all_of(flags, [](uint8_t flag) { return (flag & CachedByte::Valid) != 0; })) {
+            for (size_t i = 0; i < PageSize; i++) {
+                if (data[i] != static_cast<std::byte>(address + i)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+static void TestReadAfterPrefetchOverflow() {
+    auto source = std::make_shared<HeldSource>();
+    PageCache cache(64);
+    cache.SetProcess(source);
+
+    // Keeps the reader busy, everything prefetched below stays queued.
+    std::array<std::byte, 16> data;
+    std::array<uint8_t, 16> flags;
+    cache.Read(0, data, flags);
+    source->WaitForReader();
+
+    // More pages than the prefetch backlog holds, the oldest ones are dropped.
+    constexpr uint64_t PrefetchBase = 0x100000;
+    constexpr uint64_t PrefetchPages = 48;
+    cache.Prefetch(PrefetchBase, PrefetchPages * PageSize);
+    source->Release();
+
+    Check(ReadPage(cache, 0), "the page read first arrives");
+    Check(ReadPage(cache, PrefetchBase), "a page dropped from the prefetch queue arrives when read");
+    Check(ReadPage(cache, PrefetchBase + PageSize * (PrefetchPages / 2)),
+          "a page from the middle of the prefetched range arrives when read");
+    Check(ReadPage(cache, PrefetchBase + PageSize * (PrefetchPages - 1)), "the last prefetched page arrives");
+    Check(cache.GetStats().CachedPages <= 64, "the cache stays within its capacity");
+}
+
+static void TestPrefetchAgainAfterOverflow() {
+    auto source = std::make_shared<HeldSource>();
+    PageCache cache(64);
+    cache.SetProcess(source);
+    // No refreshes, every read counted below is one of the queued pages.
+    cache.SetRefreshInterval(std::chrono::hours(1));
+
+    std::array<std::byte, 16> data;
+    std::array<uint8_t, 16> flags;
+    cache.Read(0, data, flags);
+    source->WaitForReader();
+
+    // Dropped pages can be prefetched again and are then read without anyone asking for them.
+    // The backlog holds a quarter of the capacity, so with the page read first that makes 17.
+    constexpr uint64_t PrefetchBase = 0x200000;
+    cache.Prefetch(PrefetchBase, 48 * PageSize);
+    cache.Prefetch(PrefetchBase, PageSize);
+    source->Release();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cache.GetStats().PageReads < 17 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint64_t readsBefore = cache.GetStats().PageReads;
+    Check(ReadPage(cache, PrefetchBase), "a page prefetched again is cached");
+    Check(cache.GetStats().PageReads == readsBefore, "a page prefetched again is read by the prefetch");
+}
+
+int main() {
+    TestReadAfterPrefetchOverflow();
+    TestPrefetchAgainAfterOverflow();
+    return TestResult();
+}
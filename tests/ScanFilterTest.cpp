@@ -0,0 +1,136 @@
+// Runs filters through both of ScanFilter's evaluators and checks they agree. Every case is a
+// filter the specialized linear kernels take and the same filter with its fields written as
+// "(field + 0)", which keeps the meaning but has it run as register bytecode instead.
+
+import std;
+import Engine.Scanner;
+import Tests.Check;
+
+struct FilterCase {
+    ScanValueType Type;
+    std::string_view Linear;
+    std::string_view Bytecode;
+};
+
+constexpr FilterCase Cases[] = {
+    {ScanValueType::Int32, "value > 100", "(value + 0) > 100"},
+    {ScanValueType::Int32, "value == old", "(value + 0) == old"},
+    {ScanValueType::Int32, "value between old - 10 and old + 10", "(value + 0) between old - 10 and old + 10"},
+    {ScanValueType::Int32, "5 < value", "5 < (value + 0)"},
+    {ScanValueType::Int32, "-old <= value", "-old <= (value + 0)"},
+    {ScanValueType::Int32, "value > 2.5", "(value + 0) > 2.5"},
+    {ScanValueType::Int32, "u8 at 4 == 1, value != 0", "(u8 at 4 + 0) == 1, (value + 0) != 0"},
+    {ScanValueType::Int32, "i16 at -2 < old and value >= 0", "(i16 at -2 + 0) < old and (value + 0) >= 0"},
+    {ScanValueType::UInt8, "value != old", "(value + 0) != old"},
+    {ScanValueType::Int8, "value < old * 2 - 1", "(value + 0) < old * 2 - 1"},
+    {ScanValueType::UInt16, "value >= old * 4", "(value + 0) >= old * 4"},
+    {ScanValueType::UInt32, "value == 0xFFFFFFFF", "(value + 0) == 0xFFFFFFFF"},
+    // Wraps around in int64, which both have to do the same way.
+    {ScanValueType::Int64, "value < old * 3 - 7", "(value + 0) < old * 3 - 7"},
+    {ScanValueType::UInt64, "value > 0x7F7F", "(value + 0) > 0x7F7F"},
+    {ScanValueType::Pointer64, "value <= old + 16", "(value + 0) <= old + 16"},
+    {ScanValueType::Float, "value <= old * 0.5 + 1.25", "(value + 0) <= old * 0.5 + 1.25"},
+    {ScanValueType::Double, "value == old", "(value + 0) == old"},
+    {ScanValueType::Double, "f32 at 8 > old, value > -1", "(f32 at 8 + 0) > old, (value + 0) > -1"},
+};
+
+// Bytes drawn mostly from values at the edges of their types, so comparisons land on either
+// side of their bounds and on them.
+static std::byte RandomByte(std::mt19937_64 &random) {
+    constexpr uint8_t Interesting[] = {0x00, 0x01, 0x02, 0x7F, 0x80, 0xFF, 0x3F, 0x40};
+    uint64_t pick = random();
+    if (pick % 4 == 0) {
+        return std::byte{static_cast<uint8_t>(pick >> 8)};
+    }
+    return std::byte{Interesting[(pick >> 8) % std::size(Interesting)]};
+}
+
+// Evaluates both filters over blocks of candidates at random places in a random buffer. Returns
+// how many candidates passed and how many were evaluated, to tell the case is not trivially true
+// or false.
+static std::pair<size_t, size_t> CompareEvaluators(const FilterCase &filterCase, const ScanFilter &linear,
+                                                   const ScanFilter &bytecode, std::mt19937_64 &random) {
+    size_t passed = 0;
+    size_t evaluated = 0;
+    uint64_t lead = std::max(linear.GetLead(), bytecode.GetLead());
+    uint64_t extent = std::max(linear.GetExtent(), bytecode.GetExtent());
+    size_t valueSize = GetScanValueSize(filterCase.Type);
+    bool floating = filterCase.Type == ScanValueType::Float || filterCase.Type == ScanValueType::Double;
+    std::vector<std::byte> buffer(4096);
+    for (int round = 0; round < 64; round++) {
+        std::ranges::generate(buffer, [&] { return RandomByte(random); });
+        // Full blocks and the short blocks a region's tail ends up in.
+        size_t count = round % 4 == 0 ? 1 + random() % ScanFilter::BlockSize : ScanFilter::BlockSize;
+        std::vector<const std::byte *> values(count);
+        std::vector<uint64_t> old(count);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = buffer.data() + lead + random() % (buffer.size() - lead - extent + 1);
+            // Often the current value, or close to it, so conditions relating the two hold now and then.
+            const std::byte *from = random() % 2 == 0 ? values[i] : buffer.data() + random() % (buffer.size() - 8);
+            std::memcpy(&old[i], from, valueSize);
+            if (!floating && random() % 4 == 0) {
+                old[i] += random() % 3;
+            }
+        }
+
+        std::vector<uint8_t> linearPass(count);
+        std::vector<uint8_t> bytecodePass(count);
+        linear.Evaluate(values, old, linearPass);
+        bytecode.Evaluate(values, old, bytecodePass);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; i++) {
+            mismatches += (linearPass[i] != 0) != (bytecodePass[i] != 0);
+            passed += linearPass[i] != 0;
+        }
+        evaluated += count;
+        Check(mismatches == 0, std::format("\"{}\" agrees with its bytecode ({} of {} differ)", filterCase.Linear,
+                                           mismatches, count));
+    }
+    return {passed, evaluated};
+}
+
+static void TestEvaluatorsAgree() {
+    std::mt19937_64 random(12345);
+    for (const auto &filterCase: Cases) {
+        auto linear = ScanFilter::Compile(filterCase.Linear, filterCase.Type);
+        auto bytecode = ScanFilter::Compile(filterCase.Bytecode, filterCase.Type);
+        Check(linear.has_value(), std::format("\"{}\" compiles", filterCase.Linear));
+        Check(bytecode.has_value(), std::format("\"{}\" compiles", filterCase.Bytecode));
+        if (!linear || !bytecode) {
+            continue;
+        }
+        Check(linear->IsSpecialized(), std::format("\"{}\" runs on the linear kernels", filterCase.Linear));
+        Check(!bytecode->IsSpecialized(), std::format("\"{}\" runs as bytecode", filterCase.Bytecode));
+        Check(linear->UsesOld() == bytecode->UsesOld() && linear->GetLead() == bytecode->GetLead() &&
+              linear->GetExtent() == bytecode->GetExtent(),
+              std::format("\"{}\" reads the same bytes as its bytecode", filterCase.Linear));
+
+        auto [passed, evaluated] = CompareEvaluators(filterCase, *linear, *bytecode, random);
+        Check(passed != 0 && passed != evaluated,
+              std::format("\"{}\" both passes and fails some candidates", filterCase.Linear));
+    }
+}
+
+static void TestCompileErrors() {
+    constexpr std::string_view Invalid[] = {
+        "", "value", "value >", "value > 1 and", "(value > 1", "value > (1", "u8 at value > 1", "u8 at 5000 > 1",
+        "u8 at 1.5 > 1", "nothing > 1", "value > 1 garbage", "value between 1 or 2",
+    };
+    for (std::string_view text: Invalid) {
+        Check(!ScanFilter::Compile(text, ScanValueType::Int32).has_value(), std::format("\"{}\" is rejected", text));
+    }
+    Check(!ScanFilter::Compile("value > 1", ScanValueType::String).has_value(), "strings cannot be filtered");
+
+    // Deeper than a block's registers allow.
+    std::string deep = "value > 0";
+    for (int i = 0; i < 40; i++) {
+        deep += std::format(" and value != {}", i);
+    }
+    Check(!ScanFilter::Compile(deep, ScanValueType::Int32).has_value(), "a filter with too many nodes is rejected");
+}
+
+int main() {
+    TestEvaluatorsAgree();
+    TestCompileErrors();
+    return TestResult();
+}
@@ -0,0 +1,179 @@
+// Writes sessions with SessionWriter and opens them again. The records have to come back as they
+// were written, and a byte flipped in any section has to fail that section's checksum, so
+// loading rejects the file instead of handing out the damaged records.
+
+import std;
+import Engine.Session;
+import Tests.Check;
+
+// A session path in the temp directory, removed again when the test is done with it.
+class TempSession {
+public:
+    explicit TempSession(std::string_view name)
+        : m_Path(std::filesystem::temp_directory_path() / std::format("EasyReverseSessionTest-{}.ers", name)) {
+    }
+
+    TempSession(const TempSession &) = delete;
+
+    TempSession &operator=(const TempSession &) = delete;
+
+    ~TempSession() {
+        std::error_code error;
+        std::filesystem::remove(m_Path, error);
+    }
+
+    [[nodiscard]] const std::filesystem::path &GetPath() const { return m_Path; }
+
+    // Flips every bit of the byte at offset.
+    void Corrupt(uint64_t offset) const {
+        std::fstream file(m_Path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(~byte);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(&byte, 1);
+    }
+
+private:
+    std::filesystem::path m_Path;
+};
+
+struct SessionContent {
+    SessionMetadata Metadata;
+    std::vector<ScanResultRecord> Results;
+    std::vector<WatchRecord> Watches;
+    std::vector<WatchExpressionRecord> Expressions;
+};
+
+static SessionContent MakeContent() {
+    SessionContent content;
+    CopyToField(content.Metadata.GameName, "game.exe");
+    CopyToField(content.Metadata.Address, "[game.exe+1A2B30]+8");
+    content.Metadata.DataType = 3;
+    content.Metadata.ProcessId = 4242;
+    for (uint64_t i = 0; i < 1000; i++) {
+        content.Results.push_back({0x10000 + i * 8, i * i});
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        WatchRecord &watch = content.Watches.emplace_back();
+        watch.Address = 0x20000 + i * 4;
+        watch.FreezeValue = i;
+        watch.Type = i;
+        watch.Flags = i == 1 ? WatchFlags::Frozen : 0;
+        CopyToField(watch.Label, std::format("watch {}", i));
+    }
+    WatchExpressionRecord &expression = content.Expressions.emplace_back();
+    expression.WatchIndex = 2;
+    CopyToField(expression.Text, "[game.exe+10]+4");
+    return content;
+}
+
+// The same sections AttachedTarget::SaveSession writes.
+static bool WriteSession(const std::filesystem::path &path, const SessionContent &content) {
+    SessionWriter writer(path);
+    writer.AddSection(SessionSectionKind::Metadata, {}, std::span(&content.Metadata, 1));
+    writer.AddSection(SessionSectionKind::ScanResults, {}, std::span(content.Results));
+    writer.AddSection(SessionSectionKind::WatchList, {}, std::span(content.Watches));
+    writer.AddSection(SessionSectionKind::WatchExpressions, {}, std::span(content.Expressions));
+    return writer.Finish();
+}
+
+template<SessionRecord T>
+static bool SameRecords(std::span<const T> read, std::span<const T> written) {
+    return std::ranges::equal(std::as_bytes(read), std::as_bytes(written));
+}
+
+static void TestRoundTrip() {
+    TempSession path("round-trip");
+    const SessionContent content = MakeContent();
+    Check(WriteSession(path.GetPath(), content), "the session is written");
+
+    auto session = SessionFile::Open(path.GetPath());
+    Check(session.has_value(), "the session opens");
+    if (!session) {
+        return;
+    }
+    Check(session->GetSections().size() == 4, "every section is in the index");
+    Check(session->VerifyAll().has_value(), "every section matches its checksum");
+    Check(SameRecords(session->Get<SessionMetadata>(SessionSectionKind::Metadata), std::span(&content.Metadata, 1)),
+          "the metadata comes back");
+    Check(SameRecords(session->Get<ScanResultRecord>(SessionSectionKind::ScanResults), std::span(content.Results)),
+          "the scan results come back");
+    Check(SameRecords(session->Get<WatchRecord>(SessionSectionKind::WatchList), std::span(content.Watches)),
+          "the watch list comes back");
+    Check(SameRecords(session->Get<WatchExpressionRecord>(SessionSectionKind::WatchExpressions),
+                      std::span(content.Expressions)), "the watch expressions come back");
+    Check(session->Get<WatchRecord>(SessionSectionKind::ScanResults).empty(),
+          "a section read with the wrong record size is empty");
+    Check(session->Get<PointerMapRecord>(SessionSectionKind::PointerMap).empty(), "a missing section is empty");
+}
+
+// Damages one byte of each section in turn, at its start, middle and end.
+static void TestCorruptSection() {
+    const SessionContent content = MakeContent();
+    std::vector<SessionSectionEntry> sections; {
+        TempSession path("layout");
+        WriteSession(path.GetPath(), content);
+        auto session = SessionFile::Open(path.GetPath());
+        if (!session) {
+            Check(false, "the session opens");
+            return;
+        }
+        sections.assign(session->GetSections().begin(), session->GetSections().end());
+    }
+
+    for (const auto &section: sections) {
+        for (uint64_t offset: {uint64_t{0}, section.Size / 2, section.Size - 1}) {
+            TempSession path("corrupt");
+            WriteSession(path.GetPath(), content);
+            path.Corrupt(section.Offset + offset);
+
+            // Only the header and index are checked on open, the damage shows when verifying.
+            auto session = SessionFile::Open(path.GetPath());
+            Check(session.has_value(), "a session with a corrupt section still opens");
+            if (!session) {
+                continue;
+            }
+            const SessionSectionEntry *entry = session->Find(section.Kind);
+            std::string what = std::format("byte {} of section kind {}", offset, std::to_underlying(section.Kind));
+            Check(entry != nullptr && !session->VerifySection(*entry), what + " fails its checksum");
+            Check(!session->VerifyAll().has_value(), what + " rejects the session");
+            for (const auto &other: session->GetSections()) {
+                if (other.Kind != section.Kind) {
+                    Check(session->VerifySection(other), what + " leaves the other sections intact");
+                }
+            }
+        }
+    }
+}
+
+static void TestCorruptIndex() {
+    TempSession path("index");
+    WriteSession(path.GetPath(), MakeContent());
+    auto size = std::filesystem::file_size(path.GetPath());
+    path.Corrupt(size - 1);
+    Check(!SessionFile::Open(path.GetPath()).has_value(), "a session with a corrupt index does not open");
+
+    TempSession header("header");
+    WriteSession(header.GetPath(), MakeContent());
+    header.Corrupt(offsetof(SessionHeader, SectionCount));
+    Check(!SessionFile::Open(header.GetPath()).has_value(), "a session with a corrupt header does not open");
+}
+
+static void TestDiffScanResults() {
+    std::vector<ScanResultRecord> before{{0x10, 1}, {0x20, 2}, {0x30, 3}};
+    std::vector<ScanResultRecord> after{{0x20, 2}, {0x30, 4}, {0x40, 5}};
+    ScanResultDiff diff = DiffScanResults(before, after);
+    Check(diff.Added == std::vector<uint64_t>{0x40}, "added addresses");
+    Check(diff.Removed == std::vector<uint64_t>{0x10}, "removed addresses");
+    Check(diff.Changed == std::vector<uint64_t>{0x30}, "changed addresses");
+}
+
+int main() {
+    TestRoundTrip();
+    TestCorruptSection();
+    TestCorruptIndex();
+    TestDiffScanResults();
+    return TestResult();
+}
@@ -0,0 +1,117 @@
+// Checks the debug register bits a WatchpointSession writes and reads: the DR7 enable, access
+// and length fields of every slot, taking slots in and out of a control value, and which slots
+// a DR6 value reports as hit. No process is traced.
+
+import std;
+import Engine.Watchpoints;
+import Tests.Check;
+
+// Local enable in bit 2 * slot, R/W in bits 16 + 4 * slot and up, LEN in the two bits above.
+static uint64_t SlotBits(size_t slot, uint64_t access, uint64_t length) {
+    return 1ull << (slot * 2) | (access | length << 2) << (16 + slot * 4);
+}
+
+static void TestEncodeSlot() {
+    struct LengthCase {
+        uint8_t Length;
+        uint64_t Bits;
+    };
+    constexpr LengthCase Lengths[] = {{1, 0b00}, {2, 0b01}, {4, 0b11}, {8, 0b10}};
+    for (size_t slot = 0; slot < MaxWatchpoints; slot++) {
+        for (const auto &length: Lengths) {
+            WatchpointSpec write{0x1000, length.Length, WatchpointKind::Write};
+            WatchpointSpec access{0x1000, length.Length, WatchpointKind::Access};
+            Check(EncodeDebugControlSlot(0, slot, write) == SlotBits(slot, 0b01, length.Bits),
+                  std::format("slot {} watching writes of {} bytes", slot, length.Length));
+            Check(EncodeDebugControlSlot(0, slot, access) == SlotBits(slot, 0b11, length.Bits),
+                  std::format("slot {} watching accesses of {} bytes", slot, length.Length));
+        }
+    }
+
+    // Re-encoding a slot replaces its fields instead of or-ing into them.
+    uint64_t control = EncodeDebugControlSlot(0, 2, {0x1000, 8, WatchpointKind::Access});
+    control = EncodeDebugControlSlot(control, 2, {0x1000, 1, WatchpointKind::Write});
+    Check(control == SlotBits(2, 0b01, 0b00), "a slot encoded twice keeps only the second spec");
+}
+
+static void TestBuild() {
+    Check(BuildDebugControl({}) == 0, "no specs arm nothing");
+
+    const WatchpointSpec specs[] = {
+        {0x1000, 4, WatchpointKind::Write},
+        {0x2000, 1, WatchpointKind::Access},
+        {0x3000, 8, WatchpointKind::Write},
+        {0x4000, 2, WatchpointKind::Access},
+    };
+    uint64_t expected = 0;
+    for (size_t count = 1; count <= std::size(specs); count++) {
+        const WatchpointSpec &spec = specs[count - 1];
+        expected |= SlotBits(count - 1, spec.Kind == WatchpointKind::Write ? 0b01 : 0b11,
+                             spec.Length == 1 ? 0b00 : spec.Length == 2 ? 0b01 : spec.Length == 8 ? 0b10 : 0b11);
+        Check(BuildDebugControl(std::span(specs).first(count)) == expected,
+              std::format("{} specs take slots 0 to {} in order", count, count - 1));
+    }
+    // Nothing outside the enable and condition fields, the kernel rejects reserved bits.
+    Check((expected & ~0xFFFF00FFull) == 0, "only slot fields are set");
+}
+
+static void TestRelease() {
+    const WatchpointSpec specs[] = {
+        {0x1000, 4, WatchpointKind::Write},
+        {0x2000, 1, WatchpointKind::Access},
+        {0x3000, 8, WatchpointKind::Write},
+        {0x4000, 2, WatchpointKind::Access},
+    };
+    uint64_t control = BuildDebugControl(specs);
+    for (size_t slot = 0; slot < MaxWatchpoints; slot++) {
+        uint64_t released = ReleaseDebugControlSlot(control, slot);
+        uint64_t others = 0;
+        for (size_t other = 0; other < MaxWatchpoints; other++) {
+            if (other != slot) {
+                others = EncodeDebugControlSlot(others, other, specs[other]);
+            }
+        }
+        Check(released == others, std::format("releasing slot {} leaves the other three", slot));
+        Check(EncodeDebugControlSlot(released, slot, specs[slot]) == control,
+              std::format("slot {} can be taken again once released", slot));
+    }
+
+    // Global enables and bits outside the slots, as a thread may have had them, survive.
+    uint64_t foreign = 0b10ull << 2 | 1ull << 8 | 1ull << 10;
+    uint64_t mixed = EncodeDebugControlSlot(foreign, 0, specs[0]);
+    Check(ReleaseDebugControlSlot(mixed, 0) == foreign, "releasing a slot keeps the bits of other owners");
+    Check(ReleaseDebugControlSlot(foreign, 1) == (foreign & ~(0b11ull << 2)),
+          "releasing a slot clears its global enable too");
+
+    uint64_t empty = control;
+    for (size_t slot = 0; slot < MaxWatchpoints; slot++) {
+        empty = ReleaseDebugControlSlot(empty, slot);
+    }
+    Check(empty == 0, "releasing every slot leaves nothing armed");
+}
+
+static void TestDecodeStatus() {
+    Check(DecodeDebugStatus(0, 4) == 0, "no hit");
+    for (size_t slot = 0; slot < MaxWatchpoints; slot++) {
+        Check(DecodeDebugStatus(1ull << slot, MaxWatchpoints) == 1u << slot, std::format("slot {} hit", slot));
+    }
+    Check(DecodeDebugStatus(0b1010, 4) == 0b1010, "two slots hit by one instruction");
+
+    // DR6 as the processor leaves it: reserved bits read as 1, BS (bit 14) after a single step.
+    constexpr uint64_t Reserved = 0xFFFF0FF0;
+    Check(DecodeDebugStatus(Reserved | 0b0100, 4) == 0b0100, "reserved bits are not hits");
+    Check(DecodeDebugStatus(Reserved | 1ull << 14, 4) == 0, "a single step is not a hit");
+
+    // The processor also reports conditions met in slots that are not enabled.
+    Check(DecodeDebugStatus(0b1111, 2) == 0b0011, "only armed slots count");
+    Check(DecodeDebugStatus(0b1100, 2) == 0, "a hit in an unarmed slot is ignored");
+    Check(DecodeDebugStatus(0b1111, 0) == 0, "no slots armed, no hits");
+}
+
+int main() {
+    TestEncodeSlot();
+    TestBuild();
+    TestRelease();
+    TestDecodeStatus();
+    return TestResult();
+}